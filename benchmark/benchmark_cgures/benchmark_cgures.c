@@ -0,0 +1,73 @@
+#include "benchmark_cgures.h"
+#include "benchmark_harness/benchmark_harness.h"
+#include "cg_resource_wrapper/resource_wrapper.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct{
+    CGRWChar* file_data;
+    /**
+     * @brief The file data is copied into this every iteration, because it is changed by the parser.
+     */
+    CGRWChar* buffer;
+    size_t length;
+}CGBResourceFileContext;
+
+static void CGBPhraseResourceFile(void* context)
+{
+    CGBResourceFileContext* data = (CGBResourceFileContext*)context;
+    memcpy(data->buffer, data->file_data, sizeof(CGRWChar) * (data->length + 1));
+    CGRWFreeResourceData(CGRWPhraseResourceData(data->buffer));
+}
+
+// generate a file in the same format as resource.cgures, with a comment on every resource
+static CGRWChar* CGBCreateResourceFile(unsigned int resource_count, size_t* length)
+{
+    const size_t max_entry_length = 160;
+    char* text = (char*)malloc(max_entry_length * resource_count + 1);
+    if (text == NULL)
+        return NULL;
+    size_t position = 0;
+    for (unsigned int i = 0; i < resource_count; ++i)
+    {
+        if (CGBRandom() % 2 == 0)
+        {
+            position += sprintf(text + position, "# resource %u\n[\"image\"]\n{\n    key = \"image_%u\";\n"
+                "    path = \"./assets/image_%u.png\";\n};\n\n", i, i, CGBRandom() % 1000);
+        }
+        else
+        {
+            position += sprintf(text + position, "# resource %u\n[\"text\"]\n{\n    key = \"text_%u\";\n"
+                "    value = \"text value %u\";\n};\n\n", i, i, CGBRandom() % 1000);
+        }
+    }
+    text[position] = '\0';
+    *length = position;
+#ifdef CGRW_USE_WCHAR
+    CGRWChar* file_data = (CGRWChar*)malloc(sizeof(CGRWChar) * (position + 1));
+    if (file_data != NULL)
+    {
+        for (size_t i = 0; i <= position; ++i)
+            file_data[i] = (CGRWChar)text[i];
+    }
+    free(text);
+    return file_data;
+#else
+    return text;
+#endif
+}
+
+void CGBenchmarkResourceFileParser()
+{
+    const unsigned int resource_counts[] = {16, 256, 1024};
+    for (unsigned int i = 0; i < sizeof(resource_counts) / sizeof(resource_counts[0]); ++i)
+    {
+        CGBResourceFileContext context = {0};
+        context.file_data = CGBCreateResourceFile(resource_counts[i], &context.length);
+        context.buffer = (CGRWChar*)malloc(sizeof(CGRWChar) * (context.length + 1));
+        if (context.file_data != NULL && context.buffer != NULL)
+            CGBMeasure("phrase_resource_file", resource_counts[i], resource_counts[i], CGBPhraseResourceFile, &context);
+        free(context.file_data);
+        free(context.buffer);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef _CGB_CGURES_H_
+#define _CGB_CGURES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Measure how fast the resource wrapper phrases .cgures files with several counts of resources.
+ * The files are generated in memory. The results are written with @ref CGBMeasure.
+ * @note This only includes the headers of the resource wrapper, because they define the same
+ * macros as the library.
+ */
+void CGBenchmarkResourceFileParser();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+#include "benchmark_cpu.h"
+#include "benchmark_harness/benchmark_harness.h"
+#include "cos_graphics/graphics.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/utils.h"
+#include <math.h>
+#include <stdlib.h>
+
+/************TRIANGULATION************/
+
+static void CGBTriangulatePolygon(void* context)
+{
+    CGTriangleListNode* triangles = CGTriangulatePolygon((CGPolygon*)context, CG_FALSE);
+    for (CGTriangleListNode* p = triangles; p != NULL;)
+    {
+        CGFree(p->triangle);
+        CGTriangleListNode* temp = p;
+        p = p->next;
+        free(temp);
+    }
+}
+
+static void CGBenchmarkTriangulation(unsigned int vertex_count)
+{
+    CGVector2* vertices = (CGVector2*)malloc(sizeof(CGVector2) * vertex_count);
+    if (vertices == NULL)
+        return;
+    // star shaped around the center, so that the polygon is concave but never self intersecting
+    for (unsigned int i = 0; i < vertex_count; ++i)
+    {
+        float angle = 2.0f * 3.14159265f * i / vertex_count;
+        float distance = 100.0f * CGBRandomRange(0.5f, 1.0f);
+        vertices[i] = CGConstructVector2(cosf(angle) * distance, sinf(angle) * distance);
+    }
+    CGPolygon* polygon = CGCreatePolygon(vertices, vertex_count, CG_FALSE);
+    free(vertices);
+    if (polygon == NULL)
+        return;
+    CGBMeasure("triangulate_polygon", vertex_count, 1, CGBTriangulatePolygon, polygon);
+    CGFree(polygon);
+}
+
+/************MATRICES************/
+
+typedef struct{
+    CGTriangle triangle;
+    CGRenderObjectProperty** properties;
+    unsigned int count;
+}CGBMatrixContext;
+
+// the bounds of a render object are computed with the same model matrix as it is drawn with
+static void CGBGetRenderObjectBounds(void* context)
+{
+    CGBMatrixContext* data = (CGBMatrixContext*)context;
+    CGAABB bounds;
+    for (unsigned int i = 0; i < data->count; ++i)
+        CGGetRenderObjectBounds(&data->triangle, CG_RD_TYPE_TRIANGLE, data->properties[i], &bounds);
+}
+
+static void CGBenchmarkMatrices(unsigned int object_count)
+{
+    CGBMatrixContext context;
+    context.triangle = CGConstructTriangle(
+        CGConstructVector2(-8.0f, -8.0f), CGConstructVector2(8.0f, -8.0f), CGConstructVector2(0.0f, 8.0f));
+    context.count = object_count;
+    context.properties = (CGRenderObjectProperty**)malloc(sizeof(CGRenderObjectProperty*) * object_count);
+    if (context.properties == NULL)
+        return;
+    for (unsigned int i = 0; i < object_count; ++i)
+    {
+        context.properties[i] = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+            CGConstructVector2(CGBRandomRange(-400.0f, 400.0f), CGBRandomRange(-300.0f, 300.0f)),
+            CGConstructVector2(CGBRandomRange(0.5f, 2.0f), CGBRandomRange(0.5f, 2.0f)), CGBRandomRange(0.0f, 6.28f));
+    }
+    CGBMeasure("render_object_matrix", object_count, object_count, CGBGetRenderObjectBounds, &context);
+    for (unsigned int i = 0; i < object_count; ++i)
+        CGFree(context.properties[i]);
+    free(context.properties);
+}
+
+/************RESOURCES************/
+
+/**
+ * @brief The keys of the default resource file, in the order that they are stored in.
+ */
+static const CGChar* cgb_resource_keys[] = {
+    CGSTR("default_geometry_shader_vertex"),
+    CGSTR("default_geometry_shader_fragment"),
+    CGSTR("default_visual_image_shader_vertex"),
+    CGSTR("default_visual_image_shader_fragment"),
+    CGSTR("default_bitmap_visual_image_shader_fragment"),
+    CGSTR("default_colored_geometry_shader_vertex"),
+    CGSTR("default_colored_geometry_shader_fragment"),
+    CGSTR("default_font")
+};
+
+static void CGBLoadResource(void* context)
+{
+    CGByte* data = CGLoadResource((const CGChar*)context, NULL, NULL);
+    free(data);
+}
+
+typedef struct{
+    void** data;
+    unsigned int count;
+}CGBRegisterContext;
+
+static void CGBRegisterAndFreeResources(void* context)
+{
+    CGBRegisterContext* data = (CGBRegisterContext*)context;
+    for (unsigned int i = 0; i < data->count; ++i)
+    {
+        data->data[i] = CGMalloc(16);
+        CGRegisterResource(data->data[i], free);
+    }
+    for (unsigned int i = 0; i < data->count; ++i)
+        CGFree(data->data[i]);
+}
+
+static void CGBenchmarkResourceRegistration(unsigned int count)
+{
+    CGBRegisterContext context = {(void**)malloc(sizeof(void*) * count), count};
+    if (context.data == NULL)
+        return;
+    CGBMeasure("register_free_resource", count, count, CGBRegisterAndFreeResources, &context);
+    free(context.data);
+}
+
+/************LINKED_LIST************/
+
+static void CGBAppendListNodes(void* context)
+{
+    unsigned int count = *(unsigned int*)context;
+    CGLinkedListNode* head = CGCreateLinkedListNode(NULL, 0);
+    for (unsigned int i = 0; i < count; ++i)
+        CGAppendListNode(head, CGCreateLinkedListNode((void*)(size_t)(i + 1), 0));
+    CGDeleteList(head);
+}
+
+typedef struct{
+    CGLinkedListNode* head;
+    unsigned int count;
+}CGBListContext;
+
+static void CGBFindListNode(void* context)
+{
+    CGBListContext* data = (CGBListContext*)context;
+    // the last node, which is the slowest to find
+    CGFindLinkedListNodeByData(data->head, (void*)(size_t)data->count);
+}
+
+static void CGBenchmarkLinkedList(unsigned int count)
+{
+    CGBMeasure("linked_list_append", count, count, CGBAppendListNodes, &count);
+    CGBListContext context = {CGCreateLinkedListNode(NULL, 0), count};
+    for (unsigned int i = 0; i < count; ++i)
+        CGAppendListNode(context.head, CGCreateLinkedListNode((void*)(size_t)(i + 1), 0));
+    CGBMeasure("linked_list_find", count, 1, CGBFindListNode, &context);
+    CGDeleteList(context.head);
+}
+
+/************TEXT************/
+
+static void CGBCreateTextImage(void* context)
+{
+    CGImage* image = CGCreateTextImage((const CGChar*)context, NULL, CGConstructTextProperty(16, 16, 8, 1));
+    if (image != NULL)
+        CGFree(image);
+}
+
+static void CGBenchmarkTextImage(unsigned int length)
+{
+    CGChar* text = (CGChar*)malloc(sizeof(CGChar) * (length + 1));
+    if (text == NULL)
+        return;
+    for (unsigned int i = 0; i < length; ++i)
+        text[i] = (CGChar)('!' + CGBRandom() % ('~' - '!' + 1));
+    text[length] = 0;
+    CGBMeasure("text_image", length, length, CGBCreateTextImage, text);
+    free(text);
+}
+
+void CGBenchmarkCPU()
+{
+    CGBSeedRandom(CGB_CPU_SEED);
+    if (!CGResourceSystemInitialized())
+        CGInitResourceSystem();
+
+    const unsigned int polygon_sizes[] = {8, 32, 128, 512};
+    for (unsigned int i = 0; i < sizeof(polygon_sizes) / sizeof(polygon_sizes[0]); ++i)
+        CGBenchmarkTriangulation(polygon_sizes[i]);
+
+    const unsigned int object_counts[] = {16, 1024, 65536};
+    for (unsigned int i = 0; i < sizeof(object_counts) / sizeof(object_counts[0]); ++i)
+        CGBenchmarkMatrices(object_counts[i]);
+
+    // the resources are found by reading the resource file from the start, so the later ones are slower
+    for (unsigned int i = 0; i < sizeof(cgb_resource_keys) / sizeof(cgb_resource_keys[0]); ++i)
+        CGBMeasure("load_resource", i, 1, CGBLoadResource, (void*)cgb_resource_keys[i]);
+
+    const unsigned int list_sizes[] = {16, 256, 4096};
+    for (unsigned int i = 0; i < sizeof(list_sizes) / sizeof(list_sizes[0]); ++i)
+    {
+        CGBenchmarkResourceRegistration(list_sizes[i]);
+        CGBenchmarkLinkedList(list_sizes[i]);
+    }
+
+    const unsigned int text_lengths[] = {8, 32, 128};
+    for (unsigned int i = 0; i < sizeof(text_lengths) / sizeof(text_lengths[0]); ++i)
+        CGBenchmarkTextImage(text_lengths[i]);
+}
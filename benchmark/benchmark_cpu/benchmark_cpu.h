@@ -0,0 +1,25 @@
+#ifndef _CGB_CPU_H_
+#define _CGB_CPU_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The seed that the random content of the CPU benchmarks is generated from.
+ */
+#define CGB_CPU_SEED 20240601u
+
+/**
+ * @brief Measure the parts of the library that run on the CPU only, at several sizes each:
+ * polygon triangulation, render object matrices, resource lookups, resource registration,
+ * the linked list and text image composition. No window or OpenGL context is created.
+ * The results are written with @ref CGBMeasure.
+ */
+void CGBenchmarkCPU();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
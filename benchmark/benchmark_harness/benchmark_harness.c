@@ -0,0 +1,161 @@
+#include "benchmark_harness.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define CGB_HAS_CYCLE_COUNTER
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define CGB_HAS_CYCLE_COUNTER
+#endif
+
+static unsigned int cgb_random_state = 0;
+static FILE* cgb_measurement_output = NULL;
+static unsigned int cgb_measurement_count = 0;
+
+void CGBSeedRandom(unsigned int seed)
+{
+    cgb_random_state = seed;
+}
+
+// a linear congruential generator, so that the sequence is the same on every platform
+unsigned int CGBRandom()
+{
+    cgb_random_state = cgb_random_state * 1664525u + 1013904223u;
+    return cgb_random_state >> 8;
+}
+
+float CGBRandomRange(float min, float max)
+{
+    return min + (max - min) * (float)(CGBRandom() & 0xFFFF) / 65535.0f;
+}
+
+double CGBGetTime()
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency = {{0}};
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1000000000.0;
+#endif
+}
+
+static unsigned long long CGBReadCycleCounter()
+{
+#ifdef CGB_HAS_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int CGBCompareDouble(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void CGBBeginMeasurements(FILE* output)
+{
+    cgb_measurement_output = output;
+    cgb_measurement_count = 0;
+    fprintf(output, "[");
+}
+
+void CGBEndMeasurements()
+{
+    if (cgb_measurement_output == NULL)
+        return;
+    fprintf(cgb_measurement_output, "\n  ]");
+    cgb_measurement_output = NULL;
+}
+
+static void CGBWriteMeasurement(const CGBMeasurement* result)
+{
+    fprintf(stderr, "%-24s %8u %12.1f ns/item  p99 %12.1f ns/item", result->name, result->size, result->median, result->p99);
+    if (result->cycles >= 0.0)
+        fprintf(stderr, "  %12.1f cycles/item", result->cycles);
+    fprintf(stderr, "\n");
+    if (cgb_measurement_output == NULL)
+        return;
+    fprintf(cgb_measurement_output, "%s\n    {\"name\": \"%s\", \"size\": %u, \"items_per_iteration\": %u, "
+        "\"iterations_per_repetition\": %u, \"repetition_count\": %u, \"ns_per_item\": {\"min\": %.3f, \"median\": %.3f, "
+        "\"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f}, ",
+        cgb_measurement_count == 0 ? "" : ",", result->name, result->size, result->items_per_iteration,
+        result->iterations_per_repetition, result->repetition_count, result->min, result->median,
+        result->p90, result->p99, result->max, result->mean);
+    if (result->cycles >= 0.0)
+        fprintf(cgb_measurement_output, "\"cycles_per_item\": %.3f}", result->cycles);
+    else
+        fprintf(cgb_measurement_output, "\"cycles_per_item\": null}");
+    ++cgb_measurement_count;
+}
+
+// run the iterations of a repetition, and return the time it takes in seconds
+static double CGBRunRepetition(CGBIteration iteration, void* context, unsigned int iteration_count, unsigned long long* cycles)
+{
+    unsigned long long start_cycles = CGBReadCycleCounter();
+    double start_time = CGBGetTime();
+    for (unsigned int i = 0; i < iteration_count; ++i)
+        iteration(context);
+    double time = CGBGetTime() - start_time;
+    *cycles = CGBReadCycleCounter() - start_cycles;
+    return time;
+}
+
+CGBMeasurement CGBMeasure(const char* name, unsigned int size, unsigned int items_per_iteration, CGBIteration iteration, void* context)
+{
+    CGBMeasurement result;
+    memset(&result, 0, sizeof(result));
+    result.name = name;
+    result.size = size;
+    result.items_per_iteration = items_per_iteration;
+    result.iterations_per_repetition = 1;
+    result.repetition_count = CGB_REPETITION_COUNT;
+    unsigned long long cycles = 0;
+    // find the iterations that a repetition needs to be long enough, which also warms up the caches
+    while (CGBRunRepetition(iteration, context, result.iterations_per_repetition, &cycles) < CGB_MIN_REPETITION_TIME
+        && result.iterations_per_repetition < (1u << 24))
+        result.iterations_per_repetition *= 2;
+    for (unsigned int i = 0; i < CGB_WARM_UP_REPETITIONS; ++i)
+        CGBRunRepetition(iteration, context, result.iterations_per_repetition, &cycles);
+
+    double times[CGB_REPETITION_COUNT];
+    double cycle_counts[CGB_REPETITION_COUNT];
+    const double item_count = (double)result.iterations_per_repetition * (items_per_iteration > 0 ? items_per_iteration : 1);
+    double sum = 0.0;
+    for (unsigned int i = 0; i < CGB_REPETITION_COUNT; ++i)
+    {
+        times[i] = CGBRunRepetition(iteration, context, result.iterations_per_repetition, &cycles) * 1000000000.0 / item_count;
+        cycle_counts[i] = (double)cycles / item_count;
+        sum += times[i];
+    }
+    qsort(times, CGB_REPETITION_COUNT, sizeof(double), CGBCompareDouble);
+    qsort(cycle_counts, CGB_REPETITION_COUNT, sizeof(double), CGBCompareDouble);
+    result.min = times[0];
+    result.median = times[(CGB_REPETITION_COUNT - 1) / 2];
+    result.p90 = times[(CGB_REPETITION_COUNT * 90 - 1) / 100];
+    result.p99 = times[(CGB_REPETITION_COUNT * 99 - 1) / 100];
+    result.max = times[CGB_REPETITION_COUNT - 1];
+    result.mean = sum / CGB_REPETITION_COUNT;
+#ifdef CGB_HAS_CYCLE_COUNTER
+    result.cycles = cycle_counts[(CGB_REPETITION_COUNT - 1) / 2];
+#else
+    result.cycles = -1.0;
+#endif
+    CGBWriteMeasurement(&result);
+    return result;
+}
@@ -0,0 +1,120 @@
+#ifndef _CGB_HARNESS_H_
+#define _CGB_HARNESS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+
+/**
+ * @brief The shortest time of a repetition in seconds. The iterations of a repetition are
+ * increased until a repetition takes at least this long, so that the timer resolution doesn't
+ * affect the results.
+ */
+#define CGB_MIN_REPETITION_TIME 0.002
+
+/**
+ * @brief The count of repetitions run before a benchmark is measured.
+ */
+#define CGB_WARM_UP_REPETITIONS 3
+
+/**
+ * @brief The count of repetitions that the results of a benchmark are computed from.
+ */
+#define CGB_REPETITION_COUNT 31
+
+/**
+ * @brief The result of a benchmark. The times are in nanoseconds per item.
+ */
+typedef struct{
+    const char* name;
+    /**
+     * @brief The size that the benchmark is scaled with, such as the vertex count of a polygon.
+     */
+    unsigned int size;
+    /**
+     * @brief The count of items processed in an iteration.
+     */
+    unsigned int items_per_iteration;
+    unsigned int iterations_per_repetition;
+    unsigned int repetition_count;
+    double min;
+    double median;
+    double p90;
+    double p99;
+    double max;
+    double mean;
+    /**
+     * @brief The median time stamp counter ticks per item. Negative if the CPU has no time stamp counter.
+     */
+    double cycles;
+}CGBMeasurement;
+
+/**
+ * @brief An iteration of a benchmark.
+ *
+ * @param context The context of the benchmark.
+ */
+typedef void (*CGBIteration)(void* context);
+
+/**
+ * @brief Set the seed of the random numbers.
+ *
+ * @param seed The seed.
+ */
+void CGBSeedRandom(unsigned int seed);
+
+/**
+ * @brief Get a random number. The sequence only depends on the seed, so it is the same on every platform.
+ *
+ * @return unsigned int A random number in [0, 2^24).
+ */
+unsigned int CGBRandom();
+
+/**
+ * @brief Get a random number in a range.
+ *
+ * @param min The minimum value.
+ * @param max The maximum value.
+ * @return float A random number in [min, max].
+ */
+float CGBRandomRange(float min, float max);
+
+/**
+ * @brief Get the time of a monotonic clock, which doesn't need the graphics to be initialized.
+ *
+ * @return double The time in seconds.
+ */
+double CGBGetTime();
+
+/**
+ * @brief Start writing the results of the benchmarks as a JSON array.
+ *
+ * @param output The file that the array is written into.
+ */
+void CGBBeginMeasurements(FILE* output);
+
+/**
+ * @brief Finish the JSON array started with @ref CGBBeginMeasurements.
+ */
+void CGBEndMeasurements();
+
+/**
+ * @brief Run a benchmark and write its result. The benchmark is warmed up, then measured for
+ * a count of repetitions, each of which runs the iteration many times.
+ *
+ * @param name The name of the benchmark.
+ * @param size The size that the benchmark is scaled with.
+ * @param items_per_iteration The count of items processed in an iteration, which the results are divided by.
+ * @param iteration The iteration of the benchmark.
+ * @param context The context passed to the iteration.
+ * @return CGBMeasurement The result.
+ */
+CGBMeasurement CGBMeasure(const char* name, unsigned int size, unsigned int items_per_iteration, CGBIteration iteration, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+#include "cos_graphics/graphics.h"
+#include "benchmark_vertex/benchmark_vertex.h"
+#include "benchmark_scene/benchmark_scene.h"
+#include "benchmark_harness/benchmark_harness.h"
+#include "benchmark_cpu/benchmark_cpu.h"
+#include "benchmark_cgures/benchmark_cgures.h"
+#include "benchmark_replay/benchmark_replay.h"
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CGB_WINDOW_WIDTH 800
+#define CGB_WINDOW_HEIGHT 600
+#define CGB_DEFAULT_FRAME_COUNT 60
+
+static void CGBPrintUsage()
+{
+    fprintf(stderr, "Usage: CosGraphicsBenchmark [--output <path>] [--frames <count>] [--hardware] [--cpu] [--replay <path>]\n"
+        "  --output <path>   Write the JSON results into a file instead of the standard output.\n"
+        "  --frames <count>  The count of frames that each scene is measured for. Default: %d.\n"
+        "  --hardware        Use the default OpenGL driver instead of forcing the software renderer.\n"
+        "  --cpu             Run the CPU micro-benchmarks, which don't create a window, instead of the scenes.\n"
+        "  --replay <path>   Measure the frames of a recorded command stream instead of the scenes.\n",
+        CGB_DEFAULT_FRAME_COUNT);
+}
+
+int main(int argc, char** argv)
+{
+    const char* output_path = NULL;
+    unsigned int frame_count = CGB_DEFAULT_FRAME_COUNT;
+    int use_hardware = 0;
+    int is_cpu_only = 0;
+    const char* replay_path = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            output_path = argv[++i];
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frame_count = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--hardware") == 0)
+            use_hardware = 1;
+        else if (strcmp(argv[i], "--cpu") == 0)
+            is_cpu_only = 1;
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replay_path = argv[++i];
+        else
+        {
+            CGBPrintUsage();
+            return 1;
+        }
+    }
+
+    FILE* output = stdout;
+    if (output_path != NULL)
+    {
+        output = fopen(output_path, "w");
+        if (output == NULL)
+        {
+            fprintf(stderr, "Failed to open output file: %s\n", output_path);
+            return 1;
+        }
+    }
+
+    if (is_cpu_only)
+    {
+        fprintf(output, "{\n  \"benchmark\": \"CosGraphicsCPU\",\n  \"seed\": %u,\n  \"benchmarks\": ", CGB_CPU_SEED);
+        CGBBeginMeasurements(output);
+        CGBenchmarkCPU();
+        CGBenchmarkResourceFileParser();
+        CGBEndMeasurements();
+        fprintf(output, "\n}\n");
+        if (output != stdout)
+            fclose(output);
+        CGTerminateGraphics();
+        return 0;
+    }
+
+    // the software renderer (Mesa llvmpipe) gives results that are comparable between machines
+    // and releases, because they don't depend on the GPU and its driver
+    if (!use_hardware)
+    {
+#ifdef CG_TG_WIN
+        _putenv_s("LIBGL_ALWAYS_SOFTWARE", "1");
+#else
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+#endif
+    }
+
+    CGCommandReplay* replay = NULL;
+    int window_width = CGB_WINDOW_WIDTH, window_height = CGB_WINDOW_HEIGHT;
+    if (replay_path != NULL)
+    {
+        CGChar replay_path_cg[512];
+        size_t length = strlen(replay_path);
+        if (length >= sizeof(replay_path_cg) / sizeof(CGChar))
+            length = sizeof(replay_path_cg) / sizeof(CGChar) - 1;
+        for (size_t i = 0; i < length; ++i)
+            replay_path_cg[i] = (CGChar)replay_path[i];
+        replay_path_cg[length] = 0;
+        replay = CGLoadCommandReplay(replay_path_cg);
+        if (replay == NULL)
+        {
+            if (output != stdout)
+                fclose(output);
+            return 1;
+        }
+        // the frames are replayed at the size they are recorded at
+        CGGetCommandReplayWindowSize(replay, &window_width, &window_height);
+    }
+
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* window = CGCreateWindow(window_width, window_height, CGSTR("Benchmark"), sub_property);
+    if (window == NULL)
+    {
+        if (output != stdout)
+            fclose(output);
+        return 1;
+    }
+
+    if (replay != NULL)
+        fprintf(output, "{\n  \"benchmark\": \"CosGraphicsReplay\",\n  \"stream\": \"%s\",\n", replay_path);
+    else
+        fprintf(output, "{\n  \"benchmark\": \"CosGraphics\",\n  \"seed\": %u,\n", CGB_SCENE_SEED);
+    fprintf(output, "  \"renderer\": \"%s\",\n  \"gl_version\": \"%s\",\n",
+        (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+    fprintf(output, "  \"window\": {\"width\": %d, \"height\": %d},\n", window_width, window_height);
+    if (replay != NULL)
+        CGBenchmarkReplay(replay, window, output);
+    else
+    {
+        // every frame of the scenes is at the same time on every run
+        CGSetFixedStepTimeSource(0.0, 1.0 / 60.0);
+        fprintf(output, "  \"scenes\": ");
+        CGBenchmarkScenes(window, frame_count, output);
+        CGSetRealTimeSource();
+    }
+    fprintf(output, "\n}\n");
+    if (output != stdout)
+        fclose(output);
+
+    if (replay == NULL)
+        CGBenchmarkSpriteVertexUpload(100000, 100);
+
+    CGTerminateGraphics();
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "benchmark_replay.h"
+#include "benchmark_harness/benchmark_harness.h"
+#include <glad/glad.h>
+#include <stdlib.h>
+
+typedef struct{
+    CGCommandReplay* replay;
+    /**
+     * @brief The index of the frame that is being replayed.
+     */
+    unsigned int frame;
+}CGBReplayClock;
+
+// the frames are replayed at the time they were recorded at, so the time dependent
+// parts of the frames, such as the performance overlay, are the same on every run
+static double CGBGetReplayTime(void* user_data)
+{
+    CGBReplayClock* clock = (CGBReplayClock*)user_data;
+    return CGGetCommandReplayFrameTime(clock->replay, clock->frame);
+}
+
+static int CGBCompareFrameTime(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void CGBenchmarkReplay(CGCommandReplay* replay, CGWindow* window, FILE* output)
+{
+    unsigned int frame_count = CGGetCommandReplayFrameCount(replay);
+    const unsigned int sample_count = frame_count * CGB_REPLAY_PASSES;
+    double* frame_times = (double*)malloc(sizeof(double) * (sample_count + 1));
+    if (frame_times == NULL)
+        return;
+    CGBReplayClock clock = {replay, 0};
+    CGSetTimeSourceCallback(CGBGetReplayTime, &clock);
+    // finish the work done before the replay
+    CGTickRenderEnd();
+    for (unsigned int i = 0; i < CGB_REPLAY_WARM_UP_PASSES; ++i)
+    {
+        CGRewindCommandReplay(replay);
+        for (clock.frame = 0; CGReplayCommandFrame(replay, window); ++clock.frame)
+            CGTickRenderEnd();
+    }
+    glFinish();
+
+    unsigned int sample = 0;
+    double sum = 0.0, draw_calls = 0.0, vertices_submitted = 0.0;
+    for (unsigned int i = 0; i < CGB_REPLAY_PASSES; ++i)
+    {
+        CGRewindCommandReplay(replay);
+        for (clock.frame = 0;; ++clock.frame)
+        {
+            // the frames are measured until they are finished on the GPU
+            double start_time = CGBGetTime();
+            if (!CGReplayCommandFrame(replay, window))
+                break;
+            glFinish();
+            CGTickRenderEnd();
+            frame_times[sample] = (CGBGetTime() - start_time) * 1000.0;
+            sum += frame_times[sample++];
+            CGFrameStats stats = CGGetFrameStats();
+            draw_calls += stats.draw_calls;
+            vertices_submitted += stats.vertices_submitted;
+        }
+    }
+    CGSetRealTimeSource();
+
+    fprintf(output, "  \"replay\": {\"frame_count\": %u, \"passes\": %u", frame_count, CGB_REPLAY_PASSES);
+    if (sample > 0)
+    {
+        qsort(frame_times, sample, sizeof(double), CGBCompareFrameTime);
+        fprintf(output, ", \"frame_time_ms\": {\"min\": %.4f, \"median\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mean\": %.4f}",
+            frame_times[0], frame_times[(sample - 1) / 2], frame_times[(sample * 90 - 1) / 100],
+            frame_times[(sample * 99 - 1) / 100], frame_times[sample - 1], sum / sample);
+        fprintf(output, ", \"draw_calls\": %.1f, \"vertices_submitted\": %.1f", draw_calls / sample, vertices_submitted / sample);
+        fprintf(stderr, "replay: %u frames, median %.3f ms/frame, p99 %.3f ms/frame\n",
+            frame_count, frame_times[(sample - 1) / 2], frame_times[(sample * 99 - 1) / 100]);
+    }
+    fprintf(output, "}");
+    free(frame_times);
+}
@@ -0,0 +1,38 @@
+#ifndef _CGB_REPLAY_H_
+#define _CGB_REPLAY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cos_graphics/graphics.h"
+#include "cos_graphics/command_recorder.h"
+#include <stdio.h>
+
+/**
+ * @brief The count of times that the frames of a replay are drawn before they are measured.
+ */
+#define CGB_REPLAY_WARM_UP_PASSES 1
+
+/**
+ * @brief The count of times that the frames of a replay are measured.
+ */
+#define CGB_REPLAY_PASSES 5
+
+/**
+ * @brief Measure the time of each frame of a recorded command stream, replayed several times,
+ * and write the results as the members of a JSON object. While the frames are replayed, the
+ * time source gives the time that each frame was recorded at.
+ *
+ * @param replay The loaded command stream.
+ * @param window The window that the frames are replayed into. It should be headless, and of
+ * the size that the stream is recorded with.
+ * @param output The file that the results are written into.
+ */
+void CGBenchmarkReplay(CGCommandReplay* replay, CGWindow* window, FILE* output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
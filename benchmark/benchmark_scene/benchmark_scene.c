@@ -0,0 +1,428 @@
+#include "benchmark_scene.h"
+#include "benchmark_harness/benchmark_harness.h"
+#include "cos_graphics/resource.h"
+#include <glad/glad.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CGB_SPRITE_COUNT 10000
+#define CGB_SPRITE_SIZE 32
+#define CGB_TRIANGLE_COUNT 10000
+#define CGB_POLYGON_COUNT 1000
+#define CGB_TEXT_COUNT 50
+#define CGB_TEXT_LENGTH 32
+#define CGB_RESOURCE_LOAD_COUNT 200
+
+static CGColor CGBRandomColor()
+{
+    return CGConstructColor(CGBRandomRange(0.2f, 1.0f), CGBRandomRange(0.2f, 1.0f), CGBRandomRange(0.2f, 1.0f), 1.0f);
+}
+
+/**
+ * @brief A scene. The objects of the scene are created before it is measured, and submitted
+ * every frame.
+ */
+typedef struct{
+    CGBSceneResult result;
+    CGWindow* window;
+    void* objects;
+    CGRenderObjectProperty** properties;
+    /**
+     * @brief Submit the objects of a frame. Returns the count of items submitted.
+     */
+    unsigned int (*submit)(void* scene);
+}CGBScene;
+
+// the measured fields of the result are filled in when the scene is measured
+static CGBSceneResult CGBConstructSceneResult(const char* name, const char* unit, unsigned int item_count, unsigned int frame_count)
+{
+    CGBSceneResult result;
+    memset(&result, 0, sizeof(result));
+    result.name = name;
+    result.unit = unit;
+    result.item_count = item_count;
+    result.frame_count = frame_count;
+    return result;
+}
+
+static CGBScene CGBConstructScene(const char* name, const char* unit, unsigned int item_count, CGWindow* window)
+{
+    CGBScene scene;
+    memset(&scene, 0, sizeof(scene));
+    scene.result = CGBConstructSceneResult(name, unit, item_count, 0);
+    scene.window = window;
+    return scene;
+}
+
+static CGRenderObjectProperty** CGBCreateProperties(CGWindow* window, unsigned int count)
+{
+    CGRenderObjectProperty** properties = (CGRenderObjectProperty**)malloc(sizeof(CGRenderObjectProperty*) * count);
+    if (properties == NULL)
+        return NULL;
+    float half_width = window->width / 2.0f, half_height = window->height / 2.0f;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        properties[i] = CGCreateRenderObjectProperty(CGBRandomColor(),
+            CGConstructVector2(CGBRandomRange(-half_width, half_width), CGBRandomRange(-half_height, half_height)),
+            CGConstructVector2(1.0f, 1.0f), 0.0f);
+    }
+    return properties;
+}
+
+static void CGBFreeProperties(CGRenderObjectProperty** properties, unsigned int count)
+{
+    if (properties == NULL)
+        return;
+    for (unsigned int i = 0; i < count; ++i)
+        CGFree(properties[i]);
+    free(properties);
+}
+
+/**
+ * @brief Draw the frames of a scene, and measure the time from the first measured frame
+ * starting to the last one finished on the GPU.
+ */
+static void CGBRunScene(CGBScene* scene, unsigned int frame_count)
+{
+    CGBSceneResult* result = &scene->result;
+    result->frame_count = frame_count;
+    // finish the work done before this scene
+    CGTickRenderEnd();
+    for (unsigned int i = 0; i < CGB_SCENE_WARM_UP_FRAMES; ++i)
+    {
+        CGTickRenderStart(scene->window);
+        scene->submit(scene);
+        CGWindowDraw(scene->window);
+        CGTickRenderEnd();
+    }
+    glFinish();
+
+    unsigned long long item_count = 0;
+    double draw_calls = 0.0, vertices_submitted = 0.0;
+    double start_time = CGGetRealTime();
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        CGTickRenderStart(scene->window);
+        item_count += scene->submit(scene);
+        CGWindowDraw(scene->window);
+        glFinish();
+        CGTickRenderEnd();
+        CGFrameStats stats = CGGetFrameStats();
+        draw_calls += stats.draw_calls;
+        vertices_submitted += stats.vertices_submitted;
+    }
+    double total_time = CGGetRealTime() - start_time;
+
+    if (frame_count == 0)
+        return;
+    result->frame_time = total_time / frame_count;
+    result->items_per_second = total_time > 0.0 ? (double)item_count / total_time : 0.0;
+    result->draw_calls = draw_calls / frame_count;
+    result->vertices_submitted = vertices_submitted / frame_count;
+}
+
+/************SPRITES************/
+
+static unsigned int CGBSubmitSprites(void* data)
+{
+    CGBScene* scene = (CGBScene*)data;
+    for (unsigned int i = 0; i < scene->result.item_count; ++i)
+        CGDrawVisualImage(scene->objects, scene->properties[i], scene->window);
+    return scene->result.item_count;
+}
+
+static CGBSceneResult CGBBenchmarkSprites(CGWindow* window, unsigned int frame_count)
+{
+    CGBSeedRandom(CGB_SCENE_SEED);
+    CGBScene scene = CGBConstructScene("sprites", "sprites", CGB_SPRITE_COUNT, window);
+    scene.submit = CGBSubmitSprites;
+
+    CGUByte pixels[CGB_SPRITE_SIZE * CGB_SPRITE_SIZE * 4];
+    for (unsigned int i = 0; i < CGB_SPRITE_SIZE * CGB_SPRITE_SIZE; ++i)
+    {
+        unsigned int color = CGBRandom();
+        pixels[i * 4] = (CGUByte)color;
+        pixels[i * 4 + 1] = (CGUByte)(color >> 8);
+        pixels[i * 4 + 2] = (CGUByte)(color >> 16);
+        pixels[i * 4 + 3] = 255;
+    }
+    CGImage* image = CGCreateImage(CGB_SPRITE_SIZE, CGB_SPRITE_SIZE, 4, pixels);
+    if (image == NULL)
+        return scene.result;
+    CGVisualImage sprite = {0};
+    sprite.texture_id = CGCreateTexture(image);
+    sprite.img_width = CGB_SPRITE_SIZE;
+    sprite.img_height = CGB_SPRITE_SIZE;
+    sprite.img_channels = 4;
+    sprite.clamp_bottom_right = CGConstructVector2(CGB_SPRITE_SIZE, CGB_SPRITE_SIZE);
+    sprite.in_window = window;
+    CGFree(image);
+    scene.objects = &sprite;
+    scene.properties = CGBCreateProperties(window, CGB_SPRITE_COUNT);
+
+    if (scene.properties != NULL)
+        CGBRunScene(&scene, frame_count);
+
+    CGBFreeProperties(scene.properties, CGB_SPRITE_COUNT);
+    CGDeleteTexture(sprite.texture_id);
+    return scene.result;
+}
+
+/************TRIANGLES************/
+
+static unsigned int CGBSubmitTriangles(void* data)
+{
+    CGBScene* scene = (CGBScene*)data;
+    CGTriangle* triangles = (CGTriangle*)scene->objects;
+    for (unsigned int i = 0; i < scene->result.item_count; ++i)
+        CGDrawTriangle(&triangles[i], scene->properties[i], scene->window);
+    return scene->result.item_count;
+}
+
+static unsigned int CGBSubmitColoredTriangles(void* data)
+{
+    CGBScene* scene = (CGBScene*)data;
+    CGColoredTriangle* triangles = (CGColoredTriangle*)scene->objects;
+    for (unsigned int i = 0; i < scene->result.item_count; ++i)
+        CGDrawColoredTriangle(&triangles[i], scene->properties[i], scene->window);
+    return scene->result.item_count;
+}
+
+static void CGBRandomTriangleVertices(CGVector2* vertices)
+{
+    float size = CGBRandomRange(4.0f, 24.0f);
+    vertices[0] = CGConstructVector2(-size, -size);
+    vertices[1] = CGConstructVector2(size, -size);
+    vertices[2] = CGConstructVector2(CGBRandomRange(-size, size), size);
+}
+
+static CGBSceneResult CGBBenchmarkTriangles(CGWindow* window, unsigned int frame_count, CG_BOOL is_colored)
+{
+    CGBSeedRandom(CGB_SCENE_SEED);
+    CGBScene scene = CGBConstructScene(is_colored ? "colored_triangles" : "triangles", "triangles", CGB_TRIANGLE_COUNT, window);
+    if (is_colored)
+    {
+        CGColoredTriangle* triangles = (CGColoredTriangle*)malloc(sizeof(CGColoredTriangle) * CGB_TRIANGLE_COUNT);
+        for (unsigned int i = 0; triangles != NULL && i < CGB_TRIANGLE_COUNT; ++i)
+        {
+            CGVector2 vertices[3];
+            CGColor colors[3] = {CGBRandomColor(), CGBRandomColor(), CGBRandomColor()};
+            CGBRandomTriangleVertices(vertices);
+            triangles[i] = CGConstructColoredTriangle(vertices, colors);
+        }
+        scene.objects = triangles;
+        scene.submit = CGBSubmitColoredTriangles;
+    }
+    else
+    {
+        CGTriangle* triangles = (CGTriangle*)malloc(sizeof(CGTriangle) * CGB_TRIANGLE_COUNT);
+        for (unsigned int i = 0; triangles != NULL && i < CGB_TRIANGLE_COUNT; ++i)
+        {
+            CGVector2 vertices[3];
+            CGBRandomTriangleVertices(vertices);
+            triangles[i] = CGConstructTriangle(vertices[0], vertices[1], vertices[2]);
+        }
+        scene.objects = triangles;
+        scene.submit = CGBSubmitTriangles;
+    }
+    scene.properties = CGBCreateProperties(window, CGB_TRIANGLE_COUNT);
+
+    if (scene.objects != NULL && scene.properties != NULL)
+        CGBRunScene(&scene, frame_count);
+
+    CGBFreeProperties(scene.properties, CGB_TRIANGLE_COUNT);
+    free(scene.objects);
+    return scene.result;
+}
+
+/************POLYGONS************/
+
+static unsigned int CGBSubmitPolygons(void* data)
+{
+    CGBScene* scene = (CGBScene*)data;
+    CGPolygon** polygons = (CGPolygon**)scene->objects;
+    for (unsigned int i = 0; i < scene->result.item_count; ++i)
+        CGDrawPolygon(polygons[i], scene->properties[i], scene->window);
+    return scene->result.item_count;
+}
+
+static CGBSceneResult CGBBenchmarkPolygons(CGWindow* window, unsigned int frame_count, const char* name, unsigned int vertex_count)
+{
+    CGBSeedRandom(CGB_SCENE_SEED);
+    CGBScene scene = CGBConstructScene(name, "polygons", CGB_POLYGON_COUNT, window);
+    scene.submit = CGBSubmitPolygons;
+    CGPolygon** polygons = (CGPolygon**)calloc(CGB_POLYGON_COUNT, sizeof(CGPolygon*));
+    CGVector2* vertices = (CGVector2*)malloc(sizeof(CGVector2) * vertex_count);
+    if (polygons != NULL && vertices != NULL)
+    {
+        for (unsigned int i = 0; i < CGB_POLYGON_COUNT; ++i)
+        {
+            // star shaped around the center, so that the polygons are concave but never self intersecting
+            float radius = CGBRandomRange(8.0f, 32.0f);
+            for (unsigned int j = 0; j < vertex_count; ++j)
+            {
+                float angle = 2.0f * 3.14159265f * j / vertex_count;
+                float distance = radius * CGBRandomRange(0.5f, 1.0f);
+                vertices[j] = CGConstructVector2(cosf(angle) * distance, sinf(angle) * distance);
+            }
+            polygons[i] = CGCreatePolygon(vertices, vertex_count, CG_FALSE);
+        }
+    }
+    free(vertices);
+    scene.objects = polygons;
+    scene.properties = CGBCreateProperties(window, CGB_POLYGON_COUNT);
+
+    if (polygons != NULL && scene.properties != NULL)
+        CGBRunScene(&scene, frame_count);
+
+    CGBFreeProperties(scene.properties, CGB_POLYGON_COUNT);
+    for (unsigned int i = 0; polygons != NULL && i < CGB_POLYGON_COUNT; ++i)
+        CGFree(polygons[i]);
+    free(polygons);
+    return scene.result;
+}
+
+/************TEXT************/
+
+static unsigned int CGBSubmitText(void* data)
+{
+    CGBScene* scene = (CGBScene*)data;
+    const CGTextProperty text_property = CGConstructTextProperty(16, 16, 8, 1);
+    CGChar text[CGB_TEXT_LENGTH + 1];
+    unsigned int glyph_count = 0;
+    for (unsigned int i = 0; i < CGB_TEXT_COUNT; ++i)
+    {
+        for (unsigned int j = 0; j < CGB_TEXT_LENGTH; ++j)
+            text[j] = (CGChar)('!' + CGBRandom() % ('~' - '!' + 1));
+        text[CGB_TEXT_LENGTH] = 0;
+        // the text images are temporary, so the glyphs are rendered again every frame
+        CGVisualImage* text_image = CGCreateTextVisualImageRaw(text, NULL, text_property, scene->window, CG_TRUE);
+        if (text_image == NULL)
+            continue;
+        CGDrawVisualImage(text_image, scene->properties[i], scene->window);
+        glyph_count += CGB_TEXT_LENGTH;
+    }
+    return glyph_count;
+}
+
+static CGBSceneResult CGBBenchmarkText(CGWindow* window, unsigned int frame_count)
+{
+    CGBSeedRandom(CGB_SCENE_SEED);
+    CGBScene scene = CGBConstructScene("text", "glyphs", CGB_TEXT_COUNT * CGB_TEXT_LENGTH, window);
+    scene.submit = CGBSubmitText;
+    scene.properties = CGBCreateProperties(window, CGB_TEXT_COUNT);
+
+    if (scene.properties != NULL)
+        CGBRunScene(&scene, frame_count);
+
+    CGBFreeProperties(scene.properties, CGB_TEXT_COUNT);
+    return scene.result;
+}
+
+// the same glyphs as the text scene, drawn from the glyph atlas in one batch
+static unsigned int CGBSubmitTextBatch(void* data)
+{
+    CGBScene* scene = (CGBScene*)data;
+    if (!CGDrawTextBatch((CGTextBatch*)scene->objects, NULL, scene->window))
+        return 0;
+    return scene->result.item_count;
+}
+
+static CGBSceneResult CGBBenchmarkTextBatch(CGWindow* window, unsigned int frame_count)
+{
+    CGBSeedRandom(CGB_SCENE_SEED);
+    CGBScene scene = CGBConstructScene("text_batch", "glyphs", CGB_TEXT_COUNT * CGB_TEXT_LENGTH, window);
+    scene.submit = CGBSubmitTextBatch;
+    CGTextBatch* batch = CGCreateTextBatch();
+    if (batch == NULL)
+        return scene.result;
+    const CGTextProperty text_property = CGConstructTextProperty(16, 16, 8, 1);
+    CGChar text[CGB_TEXT_LENGTH + 1];
+    float half_width = window->width / 2.0f, half_height = window->height / 2.0f;
+    for (unsigned int i = 0; i < CGB_TEXT_COUNT; ++i)
+    {
+        for (unsigned int j = 0; j < CGB_TEXT_LENGTH; ++j)
+            text[j] = (CGChar)('!' + CGBRandom() % ('~' - '!' + 1));
+        text[CGB_TEXT_LENGTH] = 0;
+        CGAddTextToBatch(batch, text, NULL, text_property,
+            CGConstructVector2(CGBRandomRange(-half_width, half_width), CGBRandomRange(-half_height, half_height)));
+    }
+    scene.objects = batch;
+    CGBRunScene(&scene, frame_count);
+    CGFree(batch);
+    return scene.result;
+}
+
+/************RESOURCES************/
+
+/**
+ * @brief The resources in the default resource file, which every program has.
+ */
+static const CGChar* cgb_resource_keys[] = {
+    CGSTR("default_geometry_shader_vertex"),
+    CGSTR("default_geometry_shader_fragment"),
+    CGSTR("default_visual_image_shader_vertex"),
+    CGSTR("default_visual_image_shader_fragment"),
+    CGSTR("default_colored_geometry_shader_vertex"),
+    CGSTR("default_colored_geometry_shader_fragment"),
+    CGSTR("default_font")
+};
+
+static CGBSceneResult CGBBenchmarkResources(unsigned int frame_count)
+{
+    CGBSeedRandom(CGB_SCENE_SEED);
+    CGBSceneResult result = CGBConstructSceneResult("resources", "resources", CGB_RESOURCE_LOAD_COUNT, frame_count);
+    const unsigned int key_count = sizeof(cgb_resource_keys) / sizeof(cgb_resource_keys[0]);
+    unsigned long long load_count = 0;
+    double start_time = CGGetRealTime();
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        for (unsigned int j = 0; j < CGB_RESOURCE_LOAD_COUNT; ++j)
+        {
+            CGByte* data = CGLoadResource(cgb_resource_keys[CGBRandom() % key_count], NULL, NULL);
+            if (data == NULL)
+                continue;
+            free(data);
+            ++load_count;
+        }
+    }
+    double total_time = CGGetRealTime() - start_time;
+    if (frame_count == 0)
+        return result;
+    result.frame_time = total_time / frame_count;
+    result.items_per_second = total_time > 0.0 ? (double)load_count / total_time : 0.0;
+    return result;
+}
+
+static void CGBWriteSceneResult(FILE* output, const CGBSceneResult* result, CG_BOOL is_last)
+{
+    fprintf(output, "    {\"name\": \"%s\", \"unit\": \"%s\", \"item_count\": %u, \"frame_count\": %u, "
+        "\"items_per_second\": %.1f, \"frame_time_ms\": %.4f, \"draw_calls\": %.1f, \"vertices_submitted\": %.1f}%s\n",
+        result->name, result->unit, result->item_count, result->frame_count, result->items_per_second,
+        result->frame_time * 1000.0, result->draw_calls, result->vertices_submitted, is_last ? "" : ",");
+}
+
+void CGBenchmarkScenes(CGWindow* window, unsigned int frame_count, FILE* output)
+{
+    CGBSceneResult results[9];
+    unsigned int result_count = 0;
+    results[result_count++] = CGBBenchmarkSprites(window, frame_count);
+    results[result_count++] = CGBBenchmarkTriangles(window, frame_count, CG_FALSE);
+    results[result_count++] = CGBBenchmarkTriangles(window, frame_count, CG_TRUE);
+    results[result_count++] = CGBBenchmarkPolygons(window, frame_count, "polygons_8", 8);
+    results[result_count++] = CGBBenchmarkPolygons(window, frame_count, "polygons_32", 32);
+    results[result_count++] = CGBBenchmarkPolygons(window, frame_count, "polygons_128", 128);
+    results[result_count++] = CGBBenchmarkText(window, frame_count);
+    results[result_count++] = CGBBenchmarkTextBatch(window, frame_count);
+    results[result_count++] = CGBBenchmarkResources(frame_count);
+
+    fprintf(output, "[\n");
+    for (unsigned int i = 0; i < result_count; ++i)
+    {
+        CGBWriteSceneResult(output, &results[i], i == result_count - 1);
+        fprintf(stderr, "%-20s %14.1f %s/s  %8.3f ms/frame\n", results[i].name, results[i].items_per_second,
+            results[i].unit, results[i].frame_time * 1000.0);
+    }
+    fprintf(output, "  ]");
+}
@@ -0,0 +1,66 @@
+#ifndef _CGB_SCENE_H_
+#define _CGB_SCENE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cos_graphics/graphics.h"
+#include <stdio.h>
+
+/**
+ * @brief The seed that the random content of every scene is generated from. Each scene
+ * starts from this seed, so that the scenes are the same on every run and in any order.
+ */
+#define CGB_SCENE_SEED 20240601u
+
+/**
+ * @brief The count of frames drawn before a scene is measured.
+ */
+#define CGB_SCENE_WARM_UP_FRAMES 5
+
+/**
+ * @brief The result of a scene.
+ */
+typedef struct{
+    const char* name;
+    /**
+     * @brief What the items of the scene are, such as "sprites" or "glyphs".
+     */
+    const char* unit;
+    /**
+     * @brief The count of items drawn or loaded in a frame.
+     */
+    unsigned int item_count;
+    unsigned int frame_count;
+    double items_per_second;
+    /**
+     * @brief The average time of a frame in seconds.
+     */
+    double frame_time;
+    /**
+     * @brief The average draw calls of a frame.
+     */
+    double draw_calls;
+    /**
+     * @brief The average vertices submitted in a frame.
+     */
+    double vertices_submitted;
+}CGBSceneResult;
+
+/**
+ * @brief Measure how fast sprites, triangles, colored triangles, polygons of several vertex
+ * counts, text and resources are drawn or loaded, and write the results as a JSON array.
+ *
+ * @param window The window that the scenes are drawn in. It should be headless, so that the
+ * results are not limited by the refresh rate of the display.
+ * @param frame_count The count of frames that each scene is measured for.
+ * @param output The file that the JSON array is written into.
+ */
+void CGBenchmarkScenes(CGWindow* window, unsigned int frame_count, FILE* output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,113 @@
+#include "benchmark_vertex.h"
+#include "cos_graphics/graphics.h"
+#include "cos_graphics/vertex.h"
+#include <glad/glad.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief The vertex layout that was used before the compact vertices.
+ */
+typedef struct{
+    float position[3];
+    float tex_coord[2];
+}CGBFloatImageVertex;
+
+static const float cgb_tex_coords[4][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+static CGVector2 CGBGetSpriteCorner(unsigned int sprite, unsigned int corner)
+{
+    float x = (float)(sprite % 400) * 2.0f - 400.0f;
+    float y = (float)(sprite / 400 % 300) * 2.0f - 300.0f;
+    return CGConstructVector2(
+        x + (corner == 1 || corner == 2 ? 16.0f : 0.0f), 
+        y + (corner == 0 || corner == 1 ? 16.0f : 0.0f));
+}
+
+static void CGBFillFloatVertices(CGBFloatImageVertex* vertices, unsigned int sprite_count)
+{
+    for (unsigned int i = 0; i < sprite_count; ++i)
+    {
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            CGVector2 corner = CGBGetSpriteCorner(i, j);
+            CGBFloatImageVertex* vertex = &vertices[i * 4 + j];
+            vertex->position[0] = corner.x;
+            vertex->position[1] = corner.y;
+            vertex->position[2] = 0.5f;
+            vertex->tex_coord[0] = cgb_tex_coords[j][0];
+            vertex->tex_coord[1] = cgb_tex_coords[j][1];
+        }
+    }
+}
+
+static void CGBFillCompactVertices(CGCompactImageVertex* vertices, unsigned int sprite_count, const CGVertexBounds* bounds)
+{
+    CGVertexStream stream = CGConstructVertexStream(vertices, sizeof(CGCompactImageVertex), sprite_count * 4);
+    for (unsigned int i = 0; i < sprite_count; ++i)
+    {
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            CGPushCompactImageVertex(&stream, bounds, CGBGetSpriteCorner(i, j), 
+                CGConstructVector2(cgb_tex_coords[j][0], cgb_tex_coords[j][1]));
+        }
+    }
+}
+
+/**
+ * @brief Upload a vertex buffer a number of times and print the result to the standard error, which
+ * keeps the standard output for the JSON results.
+ */
+static void CGBMeasureUpload(const char* name, unsigned int buffer, const void* data, size_t size, unsigned int iterations, double fill_time)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    // warm up, so that the first allocation of the buffer is not measured
+    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW);
+    glFinish();
+    double start_time = CGGetRealTime();
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+        glFinish();
+    }
+    double upload_time = (CGGetRealTime() - start_time) / iterations;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    fprintf(stderr, "%-8s %10.2f KiB  fill %8.3f ms  upload %8.3f ms  %9.2f MiB/s\n", 
+        name, (double)size / 1024.0, fill_time * 1000.0, upload_time * 1000.0, 
+        upload_time > 0.0 ? (double)size / (1024.0 * 1024.0) / upload_time : 0.0);
+}
+
+void CGBenchmarkSpriteVertexUpload(unsigned int sprite_count, unsigned int iterations)
+{
+    size_t float_size = sizeof(CGBFloatImageVertex) * 4 * sprite_count;
+    size_t compact_size = sizeof(CGCompactImageVertex) * 4 * sprite_count;
+    CGBFloatImageVertex* float_vertices = (CGBFloatImageVertex*)malloc(float_size);
+    CGCompactImageVertex* compact_vertices = (CGCompactImageVertex*)malloc(compact_size);
+    if (float_vertices == NULL || compact_vertices == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for the vertices.\n");
+        free(float_vertices);
+        free(compact_vertices);
+        return;
+    }
+    CGVertexBounds bounds = {-400.0f, -300.0f, 416.0f, 316.0f};
+
+    fprintf(stderr, "Sprite vertex upload: %u sprites, %u iterations\n", sprite_count, iterations);
+    double start_time = CGGetRealTime();
+    CGBFillFloatVertices(float_vertices, sprite_count);
+    double float_fill_time = CGGetRealTime() - start_time;
+    start_time = CGGetRealTime();
+    CGBFillCompactVertices(compact_vertices, sprite_count, &bounds);
+    double compact_fill_time = CGGetRealTime() - start_time;
+
+    unsigned int buffer = 0;
+    glGenBuffers(1, &buffer);
+    CGBMeasureUpload("float", buffer, float_vertices, float_size, iterations, float_fill_time);
+    CGBMeasureUpload("compact", buffer, compact_vertices, compact_size, iterations, compact_fill_time);
+    glDeleteBuffers(1, &buffer);
+    fprintf(stderr, "compact / float size: %.2f\n", (double)compact_size / (double)float_size);
+
+    free(float_vertices);
+    free(compact_vertices);
+}
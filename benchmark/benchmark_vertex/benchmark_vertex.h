@@ -0,0 +1,21 @@
+#ifndef _CGB_VERTEX_H_
+#define _CGB_VERTEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Measure how fast the vertices of sprites can be built and uploaded, with the float
+ * vertex layout (3 floats position, 2 floats texture coordinate) and with the compact layout.
+ * 
+ * @param sprite_count The count of the sprites in one upload.
+ * @param iterations How many times the vertices are uploaded.
+ */
+void CGBenchmarkSpriteVertexUpload(unsigned int sprite_count, unsigned int iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -147,6 +147,21 @@ void CGRWAddResource(CGRWResourceData* res_data);
 
 CGRWResourceData* CGRWPhraseUsedResource(const CGRWChar* file_path);
 
+/**
+ * @brief Phrase the resources declared in the content of a resource file.
+ * 
+ * @param file_data The content of the resource file. The comments in it are removed in place.
+ * @return CGRWResourceData* The list of the resources.
+ */
+CGRWResourceData* CGRWPhraseResourceData(CGRWChar* file_data);
+
+/**
+ * @brief Free a list of resources returned by CGRWPhraseUsedResource or CGRWPhraseResourceData.
+ * 
+ * @param data_head The first resource of the list.
+ */
+void CGRWFreeResourceData(CGRWResourceData* data_head);
+
 /**
  * @brief Terminate CG resource wrapper.
  */
@@ -239,13 +239,21 @@ CGRWResourceData* CGRWPhraseUsedResource(const CGRWChar* file_path)
     CGRWChar* file_data = CGRWGetFileData(file);
     fclose(file);
 
+    CGRWResourceData* data_head = CGRWPhraseResourceData(file_data);
+    free(file_data);
+    CGRW_PRINT(CGSTR("Resource phrase finished."));
+    return data_head;
+}
+
+CGRWResourceData* CGRWPhraseResourceData(CGRWChar* file_data)
+{
+    CGRW_ERROR_COND_EXIT(file_data == NULL, -1, CGSTR("Cannot phrase resource: File data is NULL."));
     CGRWDeleteComments(file_data);
     CGRWResourceData* data_head = (CGRWResourceData*)malloc(sizeof(CGRWResourceData));
     CGRW_ERROR_COND_EXIT(data_head == NULL, -1, CGSTR("Failed to allocate memory for resource data."));
+    data_head->is_data_value = CGRW_FALSE;
     CGRWPhraseData(file_data, data_head);
-    free(file_data);
 
-    CGRW_PRINT(CGSTR("Resource phrase finished."));
     CGRWResourceData* p = data_head;
 
     // check is resource valid
@@ -277,6 +285,22 @@ CGRWResourceData* CGRWPhraseUsedResource(const CGRWChar* file_path)
     return data_head;
 }
 
+void CGRWFreeResourceData(CGRWResourceData* data_head)
+{
+    while (data_head != NULL)
+    {
+        CGRWResourceData* temp = data_head;
+        data_head = data_head->next;
+        if (temp->is_data_value)
+            free(temp->data.value.data);
+        else
+            free(temp->data.path);
+        free(temp->key);
+        free(temp->type);
+        free(temp);
+    }
+}
+
 static void CGRWPhraseData(const CGRWChar* file_data, CGRWResourceData* data_head)
 {
     CGRW_PRINT_VERBOSE(CGSTR("Phrasing data..."));
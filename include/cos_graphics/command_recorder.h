@@ -0,0 +1,167 @@
+#ifndef _CG_COMMAND_RECORDER_H_
+#define _CG_COMMAND_RECORDER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+#include "graphics.h"
+
+/**
+ * @brief The version of the command stream format. Streams of other versions cannot be replayed.
+ */
+#define CG_COMMAND_STREAM_VERSION 2
+
+/**
+ * @brief Records the render commands of the frames of a window into a command stream file.
+ * @details Everything that is passed to @ref CGDraw and @ref CGDrawText is recorded by value,
+ * with its type and render property, together with the textures that are created while recording.
+ * The textures that are drawn but were created before the recording started are read back from
+ * OpenGL the first time they are drawn. Text is recorded with its font resource key, so the fonts
+ * must be in the resource file of the program that replays the stream.
+ * Only one command recorder can exist at a time.
+ */
+typedef struct CGCommandRecorder CGCommandRecorder;
+
+/**
+ * @brief Create a command recorder and attach it to a window. The recording starts from the
+ * next @ref CGTickRenderStart of the window.
+ *
+ * @param window The window to be recorded.
+ * @param path The path of the command stream file.
+ * @param frame_count The count of frames to be recorded. 0 to record until the recorder is freed.
+ * @return CGCommandRecorder* The command recorder. Returns NULL if failed.
+ */
+CGCommandRecorder* CGCreateCommandRecorder(CGWindow* window, const CGChar* path, unsigned int frame_count);
+
+/**
+ * @brief Get the count of frames that are recorded.
+ *
+ * @param recorder The command recorder.
+ * @return unsigned int The count of frames recorded.
+ */
+unsigned int CGGetCommandRecorderFrameCount(const CGCommandRecorder* recorder);
+
+/**
+ * @brief Is the recording finished. The file is complete when all the frames are recorded,
+ * or when the recorder is freed.
+ *
+ * @param recorder The command recorder.
+ * @return CG_BOOL CG_TRUE if the recording is finished.
+ */
+CG_BOOL CGIsCommandRecorderFinished(const CGCommandRecorder* recorder);
+
+/**
+ * @brief Start a new frame of a recorder.
+ * @note This is called by @ref CGTickRenderStart.
+ * @param recorder The command recorder.
+ */
+void CGCommandRecorderNextFrame(CGCommandRecorder* recorder);
+
+/**
+ * @brief Record an object passed to @ref CGDraw.
+ * @note This is called by @ref CGDraw.
+ * @param recorder The command recorder.
+ * @param object The object to be drawn.
+ * @param property The render property of the object. Can be NULL.
+ * @param object_type The type of the object (CG_RD_TYPE_XXX).
+ */
+void CGCommandRecorderDraw(CGCommandRecorder* recorder, const void* object, const CGRenderObjectProperty* property, int object_type);
+
+/**
+ * @brief Record a text drawn with @ref CGDrawText, @ref CGDrawTextRaw or in a text batch.
+ * @note This is called by @ref CGDrawTextRaw and @ref CGDrawTextBatch.
+ * @param recorder The command recorder.
+ * @param text The text to be drawn.
+ * @param font_rk The resource key of the font. NULL for the default font.
+ * @param text_property The property of the text.
+ * @param position The position of the start of the baseline of the text. (0, 0) if it is not in a batch.
+ * @param render_property The render property of the text. Can be NULL.
+ */
+void CGCommandRecorderDrawText(CGCommandRecorder* recorder, const CGChar* text, const CGChar* font_rk,
+    const CGTextProperty* text_property, CGVector2 position, const CGRenderObjectProperty* render_property);
+
+/**
+ * @brief Record that the render list of the window is drawn.
+ * @note This is called by @ref CGWindowDraw.
+ * @param recorder The command recorder.
+ */
+void CGCommandRecorderWindowDraw(CGCommandRecorder* recorder);
+
+/**
+ * @brief Record a texture created while the command recorder is recording. Does nothing if
+ * there is no command recorder.
+ * @note This is called when a texture is created.
+ * @param texture_id The OpenGL texture id.
+ * @param width The width of the texture.
+ * @param height The height of the texture.
+ * @param channels The count of channels of the pixels.
+ * @param data The pixels of the texture, from the first row to the last row.
+ */
+void CGCommandRecorderTexture(unsigned int texture_id, unsigned int width, unsigned int height, unsigned int channels, const CGUByte* data);
+
+/**
+ * @brief A command stream loaded to be replayed.
+ * @details The frames are replayed through the same renderer as they were recorded with, but
+ * as fast as they can be drawn. The time of each recorded frame is kept, so that the frames
+ * can be replayed with the time they were recorded at.
+ */
+typedef struct CGCommandReplay CGCommandReplay;
+
+/**
+ * @brief Load a command stream file to be replayed.
+ *
+ * @param path The path of the command stream file.
+ * @return CGCommandReplay* The loaded replay. Returns NULL if the file cannot be read or is invalid.
+ */
+CGCommandReplay* CGLoadCommandReplay(const CGChar* path);
+
+/**
+ * @brief Get the size of the window that the replay is recorded from.
+ *
+ * @param replay The replay.
+ * @param width The width of the window.
+ * @param height The height of the window.
+ */
+void CGGetCommandReplayWindowSize(const CGCommandReplay* replay, int* width, int* height);
+
+/**
+ * @brief Get the count of frames of a replay.
+ *
+ * @param replay The replay.
+ * @return unsigned int The count of frames.
+ */
+unsigned int CGGetCommandReplayFrameCount(const CGCommandReplay* replay);
+
+/**
+ * @brief Get the time that a frame was recorded at, in seconds from the first frame.
+ *
+ * @param replay The replay.
+ * @param frame The index of the frame.
+ * @return double The time of the frame. Returns 0 if the index is out of range.
+ */
+double CGGetCommandReplayFrameTime(const CGCommandReplay* replay, unsigned int frame);
+
+/**
+ * @brief Replay the next frame of a replay into a window, from @ref CGTickRenderStart to
+ * @ref CGWindowDraw. Call @ref CGTickRenderEnd after it, as with a frame that is not replayed.
+ *
+ * @param replay The replay.
+ * @param window The window to be drawn into.
+ * @return CG_BOOL CG_TRUE if a frame is replayed. CG_FALSE when all the frames are replayed.
+ */
+CG_BOOL CGReplayCommandFrame(CGCommandReplay* replay, CGWindow* window);
+
+/**
+ * @brief Replay a replay from the first frame again.
+ *
+ * @param replay The replay.
+ */
+void CGRewindCommandReplay(CGCommandReplay* replay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_COMMAND_RECORDER_H_
@@ -0,0 +1,92 @@
+#ifndef _CG_FRAME_CAPTURE_H_
+#define _CG_FRAME_CAPTURE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+#include "graphics.h"
+
+/**
+ * @brief The default count of frames that can be read at the same time.
+ */
+#define CG_FRAME_CAPTURE_DEFAULT_BUFFER_COUNT 3
+
+/**
+ * @brief A frame read by a frame capture.
+ */
+typedef struct{
+    /**
+     * @brief The pixels in RGBA, 4 bytes for each pixel. The rows are in OpenGL order,
+     * from the bottom row to the top row.
+     */
+    const CGUByte* pixels;
+    /**
+     * @brief The width of the frame in pixels.
+     */
+    int width;
+    /**
+     * @brief The height of the frame in pixels.
+     */
+    int height;
+    /**
+     * @brief The index of the frame in the frames captured, starting from 0.
+     */
+    unsigned int index;
+}CGCapturedFrame;
+
+/**
+ * @brief Called when a captured frame is read. The pixels are only valid in the callback.
+ */
+typedef void (*CGFrameCaptureCallback)(const CGCapturedFrame* frame, void* user_data);
+
+/**
+ * @brief Reads the frames of a window without waiting for the GPU to finish drawing them.
+ * @details Each captured frame is copied into one of a ring of pixel buffers, and handed to
+ * the callback frames later when the copy is finished.
+ */
+typedef struct CGFrameCapture CGFrameCapture;
+
+/**
+ * @brief Create a frame capture of a window.
+ *
+ * @param window The window to be captured.
+ * @param buffer_count The count of frames that can be read at the same time. More buffers
+ * delay the frames more, but are less likely to wait for the GPU.
+ * @param callback Called for each captured frame that is read.
+ * @param user_data Passed to the callback.
+ * @return CGFrameCapture* The frame capture. Returns NULL if failed.
+ */
+CGFrameCapture* CGCreateFrameCapture(CGWindow* window, unsigned int buffer_count, CGFrameCaptureCallback callback, void* user_data);
+
+/**
+ * @brief Capture the current frame of the window. Call this after @ref CGWindowDraw.
+ * If every buffer is in use, the oldest frame is handed to the callback first.
+ *
+ * @param capture The frame capture.
+ * @return CG_BOOL CG_TRUE if the frame is captured.
+ */
+CG_BOOL CGCaptureFrame(CGFrameCapture* capture);
+
+/**
+ * @brief Hand the captured frames that are finished reading to the callback, without waiting.
+ *
+ * @param capture The frame capture.
+ * @return unsigned int The count of frames handed to the callback.
+ */
+unsigned int CGPollFrameCapture(CGFrameCapture* capture);
+
+/**
+ * @brief Wait for all the captured frames to finish reading, and hand them to the callback.
+ *
+ * @param capture The frame capture.
+ * @return unsigned int The count of frames handed to the callback.
+ */
+unsigned int CGFinishFrameCapture(CGFrameCapture* capture);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_FRAME_CAPTURE_H_
@@ -0,0 +1,88 @@
+#ifndef _CG_FRAME_ENCODER_H_
+#define _CG_FRAME_ENCODER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+#include "frame_capture.h"
+
+/**
+ * @brief Encode each frame into a PNG file. The path of the encoder is a printf format
+ * with one unsigned integer, the index of the frame, for example "frames/frame_%05u.png".
+ * The path must have exactly one %u, %d or %i conversion, with optional flags and width,
+ * and no other % than %%.
+ */
+#define CG_FRAME_FORMAT_PNG 0
+
+/**
+ * @brief Encode all the frames into one uncompressed YUV4MPEG2 (Y4M) stream with 4:4:4 chroma.
+ * The path of the encoder is the path of the stream.
+ */
+#define CG_FRAME_FORMAT_Y4M 1
+
+/**
+ * @brief The default count of frames that can wait to be encoded.
+ */
+#define CG_FRAME_ENCODER_DEFAULT_QUEUE_SIZE 8
+
+/**
+ * @brief Encodes frames on a pool of worker threads.
+ * @details Frames are copied into a bounded queue, so that the render loop never waits for
+ * the encoding unless it asks to. Frames that don't fit in the queue are dropped.
+ */
+typedef struct CGFrameEncoder CGFrameEncoder;
+
+/**
+ * @brief Create a frame encoder.
+ *
+ * @param format The format of the output (CG_FRAME_FORMAT_XXX).
+ * @param path The path of the output. See the formats for what the path means.
+ * @param frame_rate The frame rate written into the stream. Only used by streams.
+ * @param thread_count The count of worker threads. 0 to use one less than the count of processors.
+ * @param queue_size The count of frames that can wait to be encoded. Must be larger than 0.
+ * @return CGFrameEncoder* The frame encoder. Returns NULL if failed.
+ */
+CGFrameEncoder* CGCreateFrameEncoder(int format, const CGChar* path, unsigned int frame_rate, unsigned int thread_count, unsigned int queue_size);
+
+/**
+ * @brief Copy a frame into the queue of the encoder. Frames are numbered in the order that
+ * they are added, starting from 0.
+ *
+ * @param encoder The frame encoder.
+ * @param frame The frame, for example the one handed to a @ref CGFrameCaptureCallback.
+ * @param wait If the queue is full, CG_TRUE to wait for a frame to be encoded,
+ * CG_FALSE to drop the frame.
+ * @return CG_BOOL CG_TRUE if the frame is added to the queue.
+ */
+CG_BOOL CGEncodeFrame(CGFrameEncoder* encoder, const CGCapturedFrame* frame, CG_BOOL wait);
+
+/**
+ * @brief Wait for all the frames in the queue to be encoded.
+ *
+ * @param encoder The frame encoder.
+ */
+void CGFinishFrameEncoder(CGFrameEncoder* encoder);
+
+/**
+ * @brief Get the count of frames that are dropped because the queue is full.
+ *
+ * @param encoder The frame encoder.
+ * @return unsigned int The count of frames dropped.
+ */
+unsigned int CGGetFrameEncoderDroppedCount(CGFrameEncoder* encoder);
+
+/**
+ * @brief Get the count of frames that failed to be encoded or written.
+ *
+ * @param encoder The frame encoder.
+ * @return unsigned int The count of frames failed.
+ */
+unsigned int CGGetFrameEncoderFailedCount(CGFrameEncoder* encoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_FRAME_ENCODER_H_
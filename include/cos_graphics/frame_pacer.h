@@ -0,0 +1,115 @@
+#ifndef _CG_FRAME_PACER_H_
+#define _CG_FRAME_PACER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+
+/**
+ * @brief The default time in seconds before a deadline that the frame pacer stops sleeping
+ * and spins, so that it wakes up on time even if the system wakes it up late.
+ */
+#define CG_FRAME_PACER_DEFAULT_SPIN_TIME 0.001
+
+/**
+ * @brief The count of recent frames that the timing statistics are computed from.
+ */
+#define CG_FRAME_PACER_HISTORY_SIZE 120
+
+/**
+ * @brief Timing statistics of the frames paced by a frame pacer. The times are in seconds,
+ * measured with @ref CGGetCurrentTime.
+ */
+typedef struct{
+    /**
+     * @brief The time between the end of the last two frames.
+     */
+    double frame_time;
+    /**
+     * @brief The time of the last frame before the pacer started waiting.
+     */
+    double work_time;
+    /**
+     * @brief The time that the pacer waited in the last frame.
+     */
+    double wait_time;
+    /**
+     * @brief The average frame time of the recent frames.
+     */
+    double average_frame_time;
+    /**
+     * @brief The shortest frame time of the recent frames.
+     */
+    double min_frame_time;
+    /**
+     * @brief The longest frame time of the recent frames.
+     */
+    double max_frame_time;
+    /**
+     * @brief The count of frames that finished after their deadline.
+     */
+    unsigned int missed_count;
+    /**
+     * @brief The count of frames paced.
+     */
+    unsigned int frame_count;
+}CGFrameTiming;
+
+/**
+ * @brief Keeps the frames at a target rate.
+ * @details Each frame is given a deadline one frame time after the last one. The pacer sleeps
+ * until shortly before the deadline, and spins for the rest of the time, which is both precise
+ * and cheap on the CPU. Frames that miss their deadline by more than a frame time don't make
+ * the following frames hurry to catch up.
+ */
+typedef struct CGFramePacer CGFramePacer;
+
+/**
+ * @brief Create a frame pacer.
+ *
+ * @param target_fps The target frames per second. 0 to not limit the frames, and only measure them.
+ * @return CGFramePacer* The frame pacer. Returns NULL if failed.
+ */
+CGFramePacer* CGCreateFramePacer(double target_fps);
+
+/**
+ * @brief Set the target frames per second of a frame pacer.
+ *
+ * @param pacer The frame pacer.
+ * @param target_fps The target frames per second. 0 to not limit the frames.
+ */
+void CGSetFramePacerTargetFPS(CGFramePacer* pacer, double target_fps);
+
+/**
+ * @brief Set the time before a deadline that a frame pacer stops sleeping and spins.
+ * Longer times are more precise, and use more CPU.
+ *
+ * @param pacer The frame pacer.
+ * @param spin_time The time in seconds.
+ */
+void CGSetFramePacerSpinTime(CGFramePacer* pacer, double spin_time);
+
+/**
+ * @brief Wait until the deadline of the current frame. Call this once every frame, after
+ * @ref CGTickRenderEnd. The pacer never waits if the time source is not the real time,
+ * so that simulated frames run as fast as they can.
+ *
+ * @param pacer The frame pacer.
+ */
+void CGPaceFrame(CGFramePacer* pacer);
+
+/**
+ * @brief Get the timing statistics of the frames paced by a frame pacer.
+ *
+ * @param pacer The frame pacer.
+ * @return CGFrameTiming The timing statistics.
+ */
+CGFrameTiming CGGetFrameTiming(const CGFramePacer* pacer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_FRAME_PACER_H_
@@ -0,0 +1,164 @@
+#ifndef _CG_GLYPH_ATLAS_H_
+#define _CG_GLYPH_ATLAS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+
+/**
+ * @brief The default width and height of the pages of a glyph atlas (in pixels).
+ */
+#define CG_GLYPH_ATLAS_DEFAULT_PAGE_SIZE 1024
+
+/**
+ * @brief The default largest count of pages of a glyph atlas.
+ */
+#define CG_GLYPH_ATLAS_DEFAULT_MAX_PAGE_COUNT 4
+
+/**
+ * @brief The count of empty pixels around each glyph in a page, so that glyphs drawn
+ * scaled or rotated don't sample the pixels of their neighbors.
+ */
+#define CG_GLYPH_ATLAS_PADDING 1
+
+/**
+ * @brief The page of a glyph that has no pixels, such as a glyph of a control character.
+ */
+#define CG_GLYPH_ATLAS_NO_PAGE 0xffffffffu
+
+/**
+ * @brief Identifies a rasterized glyph.
+ */
+typedef struct{
+    /**
+     * @brief The hash of the font of the glyph.
+     */
+    unsigned long long font;
+    /**
+     * @brief The pixel width that the glyph is rasterized with.
+     */
+    unsigned int pixel_width;
+    /**
+     * @brief The pixel height that the glyph is rasterized with.
+     */
+    unsigned int pixel_height;
+    /**
+     * @brief The character code of the glyph.
+     */
+    unsigned int codepoint;
+}CGGlyphKey;
+
+/**
+ * @brief A glyph stored in a glyph atlas.
+ */
+typedef struct{
+    /**
+     * @brief The index of the page that the glyph is in. CG_GLYPH_ATLAS_NO_PAGE if the glyph
+     * has no pixels.
+     */
+    unsigned int page;
+    /**
+     * @brief The position of the top left pixel of the glyph in the page.
+     */
+    unsigned int x;
+    unsigned int y;
+    /**
+     * @brief The size of the bitmap of the glyph (in pixels).
+     */
+    unsigned int width;
+    unsigned int height;
+    /**
+     * @brief The distance from the pen position to the left of the bitmap.
+     */
+    int left;
+    /**
+     * @brief The distance from the baseline to the top of the bitmap.
+     */
+    int top;
+}CGAtlasGlyph;
+
+/**
+ * @brief A cache of rasterized glyphs packed into square pages.
+ * @details The glyphs are packed into shelves, which are rows as high as the first glyph put
+ * in them. When all the pages are full, the page that is used least recently is cleared and
+ * reused, and every glyph in it is removed from the atlas. The atlas only allocates the space
+ * of the glyphs; the pixels are stored by the owner of the atlas, in a texture for each page.
+ */
+typedef struct CGGlyphAtlas CGGlyphAtlas;
+
+/**
+ * @brief Create a glyph atlas.
+ *
+ * @param page_size The width and height of the pages (in pixels).
+ * @param max_page_count The largest count of pages. Must be larger than 0.
+ * @return CGGlyphAtlas* The glyph atlas. Returns NULL if failed.
+ */
+CGGlyphAtlas* CGCreateGlyphAtlas(unsigned int page_size, unsigned int max_page_count);
+
+/**
+ * @brief Get the width and height of the pages of a glyph atlas.
+ *
+ * @param atlas The glyph atlas.
+ * @return unsigned int The size of the pages (in pixels).
+ */
+unsigned int CGGetGlyphAtlasPageSize(const CGGlyphAtlas* atlas);
+
+/**
+ * @brief Get the count of pages that a glyph atlas has used. Pages are never freed, so the
+ * count only grows until it reaches the largest count of pages.
+ *
+ * @param atlas The glyph atlas.
+ * @return unsigned int The count of pages.
+ */
+unsigned int CGGetGlyphAtlasPageCount(const CGGlyphAtlas* atlas);
+
+/**
+ * @brief Get the count of glyphs in a glyph atlas.
+ *
+ * @param atlas The glyph atlas.
+ * @return unsigned int The count of glyphs.
+ */
+unsigned int CGGetGlyphAtlasGlyphCount(const CGGlyphAtlas* atlas);
+
+/**
+ * @brief Find a glyph in a glyph atlas, and mark its page as the most recently used.
+ *
+ * @param atlas The glyph atlas.
+ * @param key The key of the glyph.
+ * @return const CGAtlasGlyph* The glyph, which is valid until the next glyph is added.
+ * Returns NULL if the glyph is not in the atlas.
+ */
+const CGAtlasGlyph* CGFindAtlasGlyph(CGGlyphAtlas* atlas, const CGGlyphKey* key);
+
+/**
+ * @brief Add a glyph to a glyph atlas, and allocate the space of its bitmap in a page. The
+ * glyph must not be in the atlas.
+ *
+ * @param atlas The glyph atlas.
+ * @param key The key of the glyph.
+ * @param width The width of the bitmap of the glyph.
+ * @param height The height of the bitmap of the glyph.
+ * @param left The distance from the pen position to the left of the bitmap.
+ * @param top The distance from the baseline to the top of the bitmap.
+ * @param evicted_page This will be set to the page that is cleared to fit the glyph, or
+ * CG_GLYPH_ATLAS_NO_PAGE if no page is cleared. Can be NULL.
+ * @return const CGAtlasGlyph* The glyph, which is valid until the next glyph is added.
+ * Returns NULL if the glyph is larger than a page, or if failed.
+ */
+const CGAtlasGlyph* CGAddAtlasGlyph(CGGlyphAtlas* atlas, const CGGlyphKey* key, unsigned int width, unsigned int height,
+    int left, int top, unsigned int* evicted_page);
+
+/**
+ * @brief Remove all the glyphs from a glyph atlas. The pages are kept.
+ *
+ * @param atlas The glyph atlas.
+ */
+void CGClearGlyphAtlas(CGGlyphAtlas* atlas);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_GLYPH_ATLAS_H_
@@ -0,0 +1,136 @@
+#ifndef _CG_GPU_PROFILER_H_
+#define _CG_GPU_PROFILER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+#include "graphics.h"
+
+/**
+ * @brief Work that is not in any other zone, such as clearing the window.
+ */
+#define CG_GPU_ZONE_OTHER 0
+/**
+ * @brief Triangles, quadrangles and polygons.
+ */
+#define CG_GPU_ZONE_GEOMETRY 1
+/**
+ * @brief Visual images.
+ */
+#define CG_GPU_ZONE_VISUAL_IMAGE 2
+/**
+ * @brief The batches of colored geometries.
+ */
+#define CG_GPU_ZONE_COLORED_BATCH 3
+/**
+ * @brief Text drawn with @ref CGDrawText.
+ */
+#define CG_GPU_ZONE_TEXT 4
+/**
+ * @brief The whole frame, from one @ref CGTickRenderStart to the next.
+ */
+#define CG_GPU_ZONE_FRAME 5
+#define CG_GPU_ZONE_COUNT 6
+
+/**
+ * @brief The count of frames that the queries of a frame are read after. The GPU is expected
+ * to finish a frame within this count of frames, otherwise the results of the frame are dropped.
+ */
+#define CG_GPU_PROFILER_FRAME_LATENCY 4
+
+/**
+ * @brief The most zone changes that are measured in a frame. The changes after it are measured
+ * as part of the last zone.
+ */
+#define CG_GPU_PROFILER_MAX_MARKERS 256
+
+/**
+ * @brief The count of recent frames that the statistics are computed from.
+ */
+#define CG_GPU_PROFILER_HISTORY_SIZE 240
+
+/**
+ * @brief The GPU time of a zone over the recent frames, in milliseconds.
+ */
+typedef struct{
+    double last;
+    double min;
+    double average;
+    /**
+     * @brief The 99th percentile.
+     */
+    double p99;
+    /**
+     * @brief The count of frames that the statistics are computed from.
+     */
+    unsigned int sample_count;
+}CGGPUZoneStats;
+
+/**
+ * @brief Measures the GPU time of the zones of the frames of a window with timestamp queries.
+ * @details A timestamp is written into the command stream every time the zone that is drawn
+ * changes, and the time between two timestamps is counted for the zone before it. The queries
+ * of a frame are read CG_GPU_PROFILER_FRAME_LATENCY frames later when they are already finished,
+ * so the profiler never waits for the GPU.
+ */
+typedef struct CGGPUProfiler CGGPUProfiler;
+
+/**
+ * @brief Create a GPU profiler and attach it to a window. The window is profiled until the profiler is freed.
+ *
+ * @param window The window to be profiled.
+ * @return CGGPUProfiler* The GPU profiler. Returns NULL if failed.
+ */
+CGGPUProfiler* CGCreateGPUProfiler(CGWindow* window);
+
+/**
+ * @brief Get the statistics of a zone.
+ *
+ * @param profiler The GPU profiler.
+ * @param zone The zone (CG_GPU_ZONE_XXX).
+ * @return CGGPUZoneStats The statistics of the zone. All 0 if no frame is measured yet.
+ */
+CGGPUZoneStats CGGetGPUZoneStats(const CGGPUProfiler* profiler, int zone);
+
+/**
+ * @brief Get the count of frames whose results are dropped, because the GPU didn't finish
+ * them in time, or the system doesn't support timestamp queries.
+ *
+ * @param profiler The GPU profiler.
+ * @return unsigned int The count of frames dropped.
+ */
+unsigned int CGGetGPUProfilerDroppedCount(const CGGPUProfiler* profiler);
+
+/**
+ * @brief Finish the current frame of a profiler and start the next one.
+ * @note This is called by @ref CGTickRenderStart.
+ *
+ * @param profiler The GPU profiler.
+ */
+void CGGPUProfilerNextFrame(CGGPUProfiler* profiler);
+
+/**
+ * @brief Measure the current frame of a profiler again from the start, so that the time
+ * that an idle window waits for events is not counted.
+ * @note This is called by @ref CGTickRenderStart.
+ *
+ * @param profiler The GPU profiler.
+ */
+void CGGPUProfilerSkipFrame(CGGPUProfiler* profiler);
+
+/**
+ * @brief Count the GPU work after this call for a zone, until the zone is changed.
+ * @note This is called when objects are drawn.
+ *
+ * @param profiler The GPU profiler.
+ * @param zone The zone (CG_GPU_ZONE_XXX), except CG_GPU_ZONE_FRAME.
+ */
+void CGGPUProfilerSetZone(CGGPUProfiler* profiler, int zone);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_GPU_PROFILER_H_
@@ -8,6 +8,11 @@
 #define CG_VIEWPORT_SCALE_FILL 1
 #define CG_VIEWPORT_SCALE_KEEP_ASPECT_RATIO 2
 
+#define CG_VSYNC_OFF 0
+#define CG_VSYNC_ON 1
+// swap with vertical sync, or right away if the frame is late. Same as CG_VSYNC_ON if the driver doesn't support it.
+#define CG_VSYNC_ADAPTIVE 2
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,36 +21,6 @@ extern "C" {
     #include <windows.h>
 #endif
 
-#ifndef CG_RENDER_FAR
-    /**
-     * @brief This value is the smallest assigned z index being started. Note that it does not have any
-     * relationship with the z value of each render object. If you have too many objects that needs to 
-     * be rendered, and you found out that part of them are not be rendered, you can try to set this to
-     * a larger value.
-     * You can modify this by defining CG_RENDER_FAR before including this header file.
-     * @example 
-     * // this is how you can change CG_RENDER_FAR to 8
-     * #define CG_RENDER_FAR 8
-     * #include "cos_graphics/graphics.h"
-     */
-    #define CG_RENDER_FAR 128
-#endif
-
-#ifndef CG_RENDER_NEAR
-    /**
-     * @brief This value is the smallest assigned z index being started. Note that it does not have any
-     * relationship with the z value of each render object. If you have too many objects that needs to 
-     * be rendered, and you found out that part of them are not be rendered, you can try to set this to
-     * a smaller value.
-     * You can modify this by defining CG_RENDER_FAR before including this header file.
-     * @example 
-     * // this is how you can change CG_RENDER_NEAR to -8
-     * #define CG_RENDER_NEAR -8
-     * #include "cos_graphics/graphics.h"
-     */
-    #define CG_RENDER_NEAR -128
-#endif
-
 /**
  * @brief Draw triangle.
  */
@@ -66,6 +41,21 @@ extern "C" {
  */
 #define CGDrawPolygon(polygon_object, property, window) CGDraw(polygon_object, property, window, CG_RD_TYPE_POLYGON)
 
+/**
+ * @brief Draw colored triangle.
+ */
+#define CGDrawColoredTriangle(triangle_object, property, window) CGDraw(triangle_object, property, window, CG_RD_TYPE_COLORED_TRIANGLE)
+
+/**
+ * @brief Draw colored quadrangle.
+ */
+#define CGDrawColoredQuadrangle(quadrangle_object, property, window) CGDraw(quadrangle_object, property, window, CG_RD_TYPE_COLORED_QUADRANGLE)
+
+/**
+ * @brief Draw colored polygon.
+ */
+#define CGDrawColoredPolygon(polygon_object, property, window) CGDraw(polygon_object, property, window, CG_RD_TYPE_COLORED_POLYGON)
+
 typedef CGLinkedListNode CGRenderNode, CGAnimationNode;
 
 /**
@@ -115,8 +105,79 @@ typedef struct{
      * @default CG_VIEWPORT_SCALE_KEEP_ASPECT_RATIO
      */
     CGByte viewport_scale_mode;
+    /**
+     * @brief Is the window headless. A headless window is never shown, and it is drawn into
+     * an offscreen frame buffer of the size of the window. Use @ref CGReadPixels to get the
+     * pixels that are drawn.
+     * @default CG_FALSE
+     */
+    CG_BOOL headless;
+    /**
+     * @brief Only redraw the parts of the window that changed since the last frame. The frame is
+     * kept in a frame buffer, and the objects that are added, removed or changed are redrawn
+     * in the union of their bounds. Draw text with @ref CGDrawText after @ref CGWindowDraw;
+     * it is drawn on top of the presented frame and is not kept in the frame buffer, so it is
+     * drawn again in every frame.
+     * @default CG_FALSE
+     */
+    CG_BOOL partial_redraw;
+    /**
+     * @brief Skip drawing and presenting the frames whose objects are the same as the last
+     * frame, and wait for events instead of polling them while the window is idle. The window
+     * is cleared in @ref CGWindowDraw instead of @ref CGTickRenderStart, so draw text with
+     * @ref CGDrawText after CGWindowDraw, and call @ref CGRequestWindowRedraw when it changes.
+     * Text is not drawn in skipped frames, as the last frame is still on the screen with its text.
+     * @default CG_FALSE
+     */
+    CG_BOOL idle_mode;
+    /**
+     * @brief How the swaps of the window are synchronized with the display (CG_VSYNC_XXX).
+     * @default CG_VSYNC_OFF
+     */
+    CGByte vsync_mode;
 } CGWindowSubProperty;
 
+/**
+ * @brief If the dirty area of a window with partial redraw is larger than this ratio of
+ * the window, the whole window is redrawn.
+ */
+#define CG_PARTIAL_REDRAW_FULL_THRESHOLD 0.5f
+
+/**
+ * @brief The default longest time in seconds that an idle window waits for events.
+ */
+#define CG_IDLE_DEFAULT_TIMEOUT 1.0
+
+/**
+ * @brief Spatial index of render objects. See spatial_index.h.
+ */
+typedef struct CGSpatialIndex CGSpatialIndex;
+
+/**
+ * @brief The state of a window with partial redraw.
+ */
+typedef struct CGRedrawState CGRedrawState;
+
+/**
+ * @brief GPU profiler of a window. See gpu_profiler.h.
+ */
+typedef struct CGGPUProfiler CGGPUProfiler;
+
+/**
+ * @brief Command recorder of a window. See command_recorder.h.
+ */
+typedef struct CGCommandRecorder CGCommandRecorder;
+
+/**
+ * @brief The count of recent frames shown in the frame time graph of the performance overlay.
+ */
+#define CG_PERFORMANCE_OVERLAY_HISTORY_SIZE 120
+
+/**
+ * @brief The performance overlay of a window.
+ */
+typedef struct CGPerformanceOverlay CGPerformanceOverlay;
+
 /**
  * @brief Window
  */
@@ -153,10 +214,84 @@ typedef struct{
      * @brief The vao for rendering visual_image.
      */
     unsigned int visual_image_vao;
+    /**
+     * @brief The vao for rendering batched colored geometries.
+     */
+    unsigned int colored_geometry_vao;
+    /**
+     * @brief The vao for rendering text from the glyph atlas.
+     */
+    unsigned int text_vao;
     /**
      * @brief The list of rendering objects.
      */
     CGRenderNode* render_list;
+    /**
+     * @brief The last node of the render list.
+     */
+    CGRenderNode* render_list_tail;
+    /**
+     * @brief The count of the objects in the render list.
+     */
+    unsigned int render_list_count;
+    /**
+     * @brief The spatial index whose visible objects are drawn every frame. NULL if not set.
+     */
+    CGSpatialIndex* spatial_index;
+    /**
+     * @brief The offscreen frame buffer that a headless window is drawn into. 0 if the window is not headless.
+     */
+    unsigned int offscreen_frame_buffer;
+    /**
+     * @brief The color and depth render buffers of the offscreen frame buffer.
+     */
+    unsigned int offscreen_render_buffers[2];
+    /**
+     * @brief The frame buffer that a multisampled offscreen frame buffer is resolved into
+     * before it is read. 0 if the offscreen frame buffer is not multisampled.
+     */
+    unsigned int resolve_frame_buffer;
+    /**
+     * @brief The color render buffer of the resolve frame buffer.
+     */
+    unsigned int resolve_render_buffer;
+    /**
+     * @brief The state of partial redraw. NULL if the window doesn't use partial redraw.
+     */
+    CGRedrawState* redraw_state;
+    /**
+     * @brief Was the last frame skipped because nothing changed. Only used in idle mode.
+     */
+    CG_BOOL is_idle;
+    /**
+     * @brief Should the next frame be drawn even if nothing changed. Only used in idle mode.
+     */
+    CG_BOOL is_redraw_requested;
+    /**
+     * @brief Is @ref CGWindowDraw called in the current frame. Text of windows with partial
+     * redraw or idle mode can only be drawn after it.
+     */
+    CG_BOOL is_drawn;
+    /**
+     * @brief The hash of the objects drawn in the last frame. Only used in idle mode.
+     */
+    unsigned long long frame_hash;
+    /**
+     * @brief The longest time in seconds that the window waits for events while it is idle.
+     */
+    double idle_timeout;
+    /**
+     * @brief The GPU profiler that measures the frames of the window. NULL if not set.
+     */
+    CGGPUProfiler* gpu_profiler;
+    /**
+     * @brief The performance overlay drawn on top of the window. NULL if it is not shown.
+     */
+    CGPerformanceOverlay* performance_overlay;
+    /**
+     * @brief The command recorder that records the frames of the window. NULL if not set.
+     */
+    CGCommandRecorder* command_recorder;
     /**
      * @brief The sub property of the window.
      */
@@ -224,6 +359,29 @@ CGVector2 CGVector2Add(CGVector2 vec_1, CGVector2 vec_2);
  */
 CGVector2 CGVector2Sub(CGVector2 vec_1, CGVector2 vec_2);
 
+/**
+ * @brief Axis aligned bounding box.
+ */
+typedef struct{
+    /**
+     * @brief The bottom left corner of the box.
+     */
+    CGVector2 min;
+    /**
+     * @brief The top right corner of the box.
+     */
+    CGVector2 max;
+}CGAABB;
+
+/**
+ * @brief Do two bounding boxes overlap. Boxes that only touch each other are overlapping.
+ * 
+ * @param aabb_1 The first bounding box.
+ * @param aabb_2 The second bounding box.
+ * @return CG_BOOL CG_TRUE if the boxes overlap.
+ */
+CG_BOOL CGIsAABBOverlapping(const CGAABB* aabb_1, const CGAABB* aabb_2);
+
 /**
  * @brief Construct a Color
  * 
@@ -366,9 +524,64 @@ void CGSetClearScreenColor(const CGColor color);
 
 /**
  * @brief start the tick render. Call this every frame before the render.
+ * @details If the window is in idle mode and the last frame was skipped, this waits until an
+ * event is received, a redraw is requested or the idle timeout passes.
  */
 void CGTickRenderStart(CGWindow* window);
 
+/**
+ * @brief Draw the next frame of a window in idle mode even if its objects didn't change.
+ * This can be called from any thread, and wakes up the window if it is waiting for events.
+ * 
+ * @param window The window.
+ */
+void CGRequestWindowRedraw(CGWindow* window);
+
+/**
+ * @brief Set the longest time that a window in idle mode waits for events, so that the
+ * timers of the application still run.
+ * 
+ * @param window The window.
+ * @param timeout The time in seconds. Negative to wait until an event is received.
+ */
+void CGSetWindowIdleTimeout(CGWindow* window, double timeout);
+
+/**
+ * @brief Check if the last frame of a window in idle mode was skipped because nothing changed.
+ * 
+ * @param window The window.
+ * @return CG_BOOL CG_TRUE if the last frame was skipped.
+ */
+CG_BOOL CGIsWindowIdle(const CGWindow* window);
+
+/**
+ * @brief Set how the swaps of a window are synchronized with the display.
+ * Does nothing for headless windows, which are never swapped.
+ * 
+ * @param window The window.
+ * @param vsync_mode The vsync mode (CG_VSYNC_XXX).
+ */
+void CGSetWindowVSyncMode(CGWindow* window, int vsync_mode);
+
+/**
+ * @brief Show or hide the performance overlay of a window. The overlay is drawn on the top left
+ * of the window by @ref CGWindowDraw, and shows the frame times, the frame statistics and the
+ * resources loaded in the last second. It is drawn in one batch, which is not counted in the
+ * frame statistics.
+ * 
+ * @param window The window.
+ * @param is_shown CG_TRUE to show the overlay.
+ */
+void CGSetWindowPerformanceOverlay(CGWindow* window, CG_BOOL is_shown);
+
+/**
+ * @brief Check if the performance overlay of a window is shown.
+ * 
+ * @param window The window.
+ * @return CG_BOOL CG_TRUE if the overlay is shown.
+ */
+CG_BOOL CGIsWindowPerformanceOverlayShown(const CGWindow* window);
+
 /**
  * @brief Draw the window every frame
  * 
@@ -383,6 +596,112 @@ void CGWindowDraw(CGWindow* window);
  */
 void CGTickRenderEnd();
 
+/**
+ * @brief Get the size of the frame buffer that a window is drawn into, in pixels.
+ * 
+ * @param window The window.
+ * @param width The width of the frame buffer.
+ * @param height The height of the frame buffer.
+ */
+void CGGetWindowFrameBufferSize(CGWindow* window, int* width, int* height);
+
+/**
+ * @brief Bind the frame buffer that holds the drawn pixels of a window as the OpenGL read frame buffer.
+ * Multisampled frame buffers are resolved first.
+ * 
+ * @param window The window.
+ */
+void CGBindWindowReadFrameBuffer(CGWindow* window);
+
+/**
+ * @brief Read the pixels that are drawn in the current frame. Call this after @ref CGWindowDraw.
+ * 
+ * @param window The window.
+ * @param x The x of the top left corner of the area, in pixels from the left of the frame buffer.
+ * @param y The y of the top left corner of the area, in pixels from the top of the frame buffer.
+ * @param width The width of the area.
+ * @param height The height of the area.
+ * @param result The pixels in RGBA, 4 bytes for each pixel, from the top row to the bottom row.
+ * The size must be at least width * height * 4.
+ * @return CG_BOOL CG_TRUE if the pixels are read.
+ */
+CG_BOOL CGReadPixels(CGWindow* window, int x, int y, int width, int height, CGUByte* result);
+
+/**
+ * @brief Statistics of a rendered frame. The work done between two @ref CGTickRenderEnd is counted
+ * for the frame, including the work outside of drawing, such as creating textures.
+ */
+typedef struct{
+    /**
+     * @brief The count of objects that are passed to CGDraw.
+     */
+    unsigned int objects_submitted;
+    /**
+     * @brief The count of objects that are not drawn because they are out of the viewport.
+     */
+    unsigned int objects_culled;
+    /**
+     * @brief The count of objects that are drawn in a batch instead of with their own draw call.
+     */
+    unsigned int objects_batched;
+    /**
+     * @brief The count of OpenGL draw calls.
+     */
+    unsigned int draw_calls;
+    /**
+     * @brief The count of vertices drawn without indices.
+     */
+    unsigned int vertices_submitted;
+    /**
+     * @brief The count of indices drawn.
+     */
+    unsigned int indices_submitted;
+    /**
+     * @brief The count of bytes uploaded to buffers and textures.
+     */
+    unsigned long long bytes_uploaded;
+    /**
+     * @brief The count of textures created.
+     */
+    unsigned int textures_created;
+    /**
+     * @brief The count of textures deleted.
+     */
+    unsigned int textures_destroyed;
+    /**
+     * @brief The count of times that a shader program is bound.
+     */
+    unsigned int program_binds;
+    /**
+     * @brief The count of times that a vertex array is bound.
+     */
+    unsigned int vertex_array_binds;
+    /**
+     * @brief The count of times that a texture is bound.
+     */
+    unsigned int texture_binds;
+    /**
+     * @brief The count of uniforms set.
+     */
+    unsigned int uniform_sets;
+    /**
+     * @brief The count of memory allocations done by the library. See @ref CGMalloc.
+     */
+    unsigned int allocations;
+    /**
+     * @brief The memory of the textures that exist at the end of the frame in bytes,
+     * estimated from their sizes and formats.
+     */
+    unsigned long long texture_memory;
+}CGFrameStats;
+
+/**
+ * @brief Get the statistics of the last frame that is finished by @ref CGTickRenderEnd.
+ * 
+ * @return CGFrameStats The statistics of the last frame.
+ */
+CGFrameStats CGGetFrameStats();
+
 /**
  * @brief should the window be closed
  * 
@@ -391,12 +710,70 @@ void CGTickRenderEnd();
 CG_BOOL CGShouldWindowClose(CGWindow* window);
 
 /**
- * @brief Get current time
+ * @brief The time is the real time since GLFW is initialized. This is the default.
+ */
+#define CG_TIME_SOURCE_REAL 0
+/**
+ * @brief The time is simulated, and advances by a fixed step at every @ref CGTickRenderEnd.
+ */
+#define CG_TIME_SOURCE_FIXED_STEP 1
+/**
+ * @brief The time is given by a callback.
+ */
+#define CG_TIME_SOURCE_CALLBACK 2
+
+/**
+ * @brief The callback function of a time source.
+ * @param user_data The user data passed to @ref CGSetTimeSourceCallback.
+ * @return double The current time in seconds.
+ */
+typedef double (*CGTimeSourceCallback)(void* user_data);
+
+/**
+ * @brief Use the real time as the time source.
+ */
+void CGSetRealTimeSource();
+
+/**
+ * @brief Use a simulated time that advances by a fixed step at every @ref CGTickRenderEnd,
+ * no matter how long the frames take. Frames can then run faster than real time, and the time
+ * of every frame is the same on every run.
  * 
- * @return double number of seconds after this program is initialized
+ * @param start_time The time in seconds until the first step.
+ * @param step The time in seconds that each frame advances the time by.
+ */
+void CGSetFixedStepTimeSource(double start_time, double step);
+
+/**
+ * @brief Use a callback as the time source.
+ * 
+ * @param callback The callback that gives the current time.
+ * @param user_data Passed to the callback.
+ */
+void CGSetTimeSourceCallback(CGTimeSourceCallback callback, void* user_data);
+
+/**
+ * @brief Get the time source that is in use.
+ * 
+ * @return int The time source (CG_TIME_SOURCE_XXX).
+ */
+int CGGetTimeSource();
+
+/**
+ * @brief Get current time from the time source.
+ * 
+ * @return double number of seconds after this program is initialized, or the time of the time source.
  */
 double CGGetCurrentTime();
 
+/**
+ * @brief Get the real time, no matter what the time source is. Use this to measure how long
+ * something takes.
+ * 
+ * @return double number of seconds after this program is initialized
+ */
+double CGGetRealTime();
+
 /**************SHADER**************/
 
 /**
@@ -564,7 +941,10 @@ enum CGIdentifiers{
     CG_RD_TYPE_TRIANGLE,
     CG_RD_TYPE_QUADRANGLE,
     CG_RD_TYPE_VISUAL_IMAGE,
-    CG_RD_TYPE_POLYGON
+    CG_RD_TYPE_POLYGON,
+    CG_RD_TYPE_COLORED_TRIANGLE,
+    CG_RD_TYPE_COLORED_QUADRANGLE,
+    CG_RD_TYPE_COLORED_POLYGON
 };
 
 /************GEOMETRIES************/
@@ -578,7 +958,8 @@ typedef struct{
      */
     float rotation;
     /**
-     * @brief The depth of the object.
+     * @brief The depth of the object. Objects with larger z are drawn behind objects with smaller z,
+     * and objects with the same z are drawn in the order they are passed to CGDraw.
      */
     float z;
     /**
@@ -602,6 +983,13 @@ typedef struct{
      * want to apply aditional transformation, you can leave this to NULL.
      */
     float* modify_matrix;
+    /**
+     * @brief Set this to CG_TRUE if the object is known to be opaque. Objects with a modify
+     * matrix can be moved out of their depth order or drawn in a way that the library cannot
+     * see, so they are blended as translucent objects unless this is CG_TRUE. Objects without
+     * a modify matrix are checked by their colors, and this is ignored.
+     */
+    CG_BOOL is_opaque;
 }CGRenderObjectProperty;
 
 /**
@@ -634,6 +1022,49 @@ void CGRotateRenderObject(CGRenderObjectProperty* property, float rotation, CGVe
  */
 void CGDraw(void* draw_object, CGRenderObjectProperty* draw_property, CGWindow* window, int object_type);
 
+/**
+ * @brief Get the bounding box of a render object after its property is applied.
+ * 
+ * @param object The render object.
+ * @param object_type The type of the object (CG_RD_TYPE_XXX).
+ * @param property The property of the object. NULL for the default property.
+ * @param result The bounding box of the object.
+ * @return CG_BOOL CG_TRUE if the bounding box is computed.
+ */
+CG_BOOL CGGetRenderObjectBounds(const void* object, int object_type, const CGRenderObjectProperty* property, CGAABB* result);
+
+/**
+ * @brief Does the drawn shape of a render object overlap a rectangle. The shape is split into
+ * triangles the same way as it is drawn, and the clamped part of visual images is excluded.
+ * 
+ * @param object The render object.
+ * @param object_type The type of the object (CG_RD_TYPE_XXX).
+ * @param property The property of the object. NULL for the default property.
+ * @param rect The rectangle. A rectangle whose min equals to its max tests a point.
+ * @return CG_BOOL CG_TRUE if the object overlaps the rectangle.
+ */
+CG_BOOL CGIsRenderObjectOverlappingRect(const void* object, int object_type, const CGRenderObjectProperty* property, const CGAABB* rect);
+
+/**
+ * @brief Set the spatial index of a window. Every frame, the objects in the index that are
+ * in the viewport are drawn together with the objects passed to @ref CGDraw, without testing
+ * the objects out of the viewport. Objects with the same z are drawn after the ones passed to
+ * @ref CGDraw, in the order that they are added to the index.
+ * 
+ * @param window The window.
+ * @param index The spatial index. NULL to remove the spatial index from the window.
+ */
+void CGSetWindowSpatialIndex(CGWindow* window, CGSpatialIndex* index);
+
+/**
+ * @brief Mark an area of a window with partial redraw to be redrawn in the next frame.
+ * Does nothing if the window doesn't use partial redraw.
+ * 
+ * @param window The window.
+ * @param rect The area in the coordinates of the window. NULL to redraw the whole window.
+ */
+void CGInvalidateWindowRect(CGWindow* window, const CGAABB* rect);
+
 /**
  * @brief Triangle
  */
@@ -734,6 +1165,150 @@ CGQuadrangle CGConstructQuadrangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2
  */
 CGQuadrangle* CGCreateQuadrangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 vert_3, CGVector2 vert_4, CG_BOOL is_temp);
 
+/**
+ * @brief Triangle with a color for each vertex.
+ * @details The colors are interpolated across the triangle and multiplied by the color of the
+ * render property. Colored geometries that are drawn one after another are merged into a
+ * single draw call, no matter what colors or properties they have.
+ */
+typedef struct{
+    /**
+     * @brief Is this a temporary triangle. If true, the triangle will be automatically deleted after the render.
+     * This will be set to CG_FALSE by default.
+     */
+    CG_BOOL is_temp;
+    union
+    {
+        struct
+        {
+            /**
+             * @brief first vertex position
+             */
+            CGVector2 vert_1;
+            /**
+             * @brief second vertex position
+             */
+            CGVector2 vert_2;
+            /**
+             * @brief third vertex position
+             */
+            CGVector2 vert_3;
+        };
+        CGVector2 vertices[3];
+    };
+    union
+    {
+        struct
+        {
+            /**
+             * @brief first vertex color
+             */
+            CGColor color_1;
+            /**
+             * @brief second vertex color
+             */
+            CGColor color_2;
+            /**
+             * @brief third vertex color
+             */
+            CGColor color_3;
+        };
+        CGColor colors[3];
+    };
+}CGColoredTriangle;
+
+/**
+ * @brief Construct a colored triangle
+ * 
+ * @param vertices The 3 vertices of the triangle.
+ * @param colors The 3 colors of the vertices.
+ * @return CGColoredTriangle colored triangle instance
+ */
+CGColoredTriangle CGConstructColoredTriangle(const CGVector2* vertices, const CGColor* colors);
+
+/**
+ * @brief Create a colored triangle
+ * 
+ * @param vertices The 3 vertices of the triangle.
+ * @param colors The 3 colors of the vertices.
+ * @return CGColoredTriangle* colored triangle instance
+ */
+CGColoredTriangle* CGCreateColoredTriangle(const CGVector2* vertices, const CGColor* colors, CG_BOOL is_temp);
+
+/**
+ * @brief Quadrangle with a color for each vertex.
+ * @details The colors are interpolated across the quadrangle and multiplied by the color of the
+ * render property. Colored geometries that are drawn one after another are merged into a
+ * single draw call, no matter what colors or properties they have.
+ */
+typedef struct{
+    /**
+     * @brief Is this a temporary quadrangle. If true, the quadrangle will be automatically deleted after the render.
+     * This will be set to CG_FALSE by default.
+     */
+    CG_BOOL is_temp;
+    union {
+        struct {
+            /**
+             * @brief first vertex position
+             */
+            CGVector2 vert_1;
+            /**
+             * @brief second vertex position
+             */
+            CGVector2 vert_2;
+            /**
+             * @brief third vertex position
+             */
+            CGVector2 vert_3;
+            /**
+             * @brief forth vertex position
+             */
+            CGVector2 vert_4;
+        };
+        CGVector2 vertices[4];
+    };
+    union {
+        struct {
+            /**
+             * @brief first vertex color
+             */
+            CGColor color_1;
+            /**
+             * @brief second vertex color
+             */
+            CGColor color_2;
+            /**
+             * @brief third vertex color
+             */
+            CGColor color_3;
+            /**
+             * @brief forth vertex color
+             */
+            CGColor color_4;
+        };
+        CGColor colors[4];
+    };
+}CGColoredQuadrangle;
+
+/**
+ * @brief Construct a colored quadrangle. The verticies must be assigned counter-clockwise.
+ * 
+ * @param vertices The 4 vertices of the quadrangle.
+ * @param colors The 4 colors of the vertices.
+ * @return CGColoredQuadrangle colored quadrangle instance
+ */
+CGColoredQuadrangle CGConstructColoredQuadrangle(const CGVector2* vertices, const CGColor* colors);
+
+/**
+ * @brief Create a colored quadrangle. The verticies must be assigned counter-clockwise.
+ * 
+ * @param vertices The 4 vertices of the quadrangle.
+ * @param colors The 4 colors of the vertices.
+ * @return CGColoredQuadrangle* colored quadrangle instance
+ */
+CGColoredQuadrangle* CGCreateColoredQuadrangle(const CGVector2* vertices, const CGColor* colors, CG_BOOL is_temp);
+
 
 /************VISUAL_IMAGES************/
 
@@ -749,6 +1324,18 @@ typedef struct{
      */
     CG_BOOL is_clamped;
 
+    /**
+     * @brief Does the texture have any pixel that is not fully opaque. This is computed when the
+     * texture is loaded. Visual images without transparency are drawn in the opaque pass.
+     */
+    CG_BOOL has_transparency;
+
+    /**
+     * @brief Are the colors of the texture already multiplied by its alpha, as in the texture
+     * of a render layer. Such textures are blended without applying the alpha again.
+     */
+    CG_BOOL is_premultiplied;
+
     /**
      * @brief Texture's OpenGL ID
      */
@@ -868,12 +1455,28 @@ CGVisualImage* CGCreateTextVisualImage(const CGChar* text_rk, const CGChar* font
  */
 CGVisualImage* CGCreateTextVisualImageRaw(const CGChar* text, const CGChar* font_rk, CGTextProperty text_property, CGWindow* window, CG_BOOL is_temp);
 
+/**
+ * @brief Render a text into an RGBA image on the CPU. The color of the image is white, and the
+ * alpha is the glyphs. This doesn't need a window or an OpenGL context.
+ * 
+ * @param text The string of the text.
+ * @param font_rk The key of the font to be used. You can set this to NULL if you want to use the default font.
+ * @param text_property The property of the text.
+ * @return CGImage* The created image. Returns NULL if failed.
+ */
+CGImage* CGCreateTextImage(const CGChar* text, const CGChar* font_rk, CGTextProperty text_property);
+
 /**
  * @brief Draw a text on the screen. Compare to @ref CGCreateTextVisualImage, this function is more efficient
  * if you only want to draw an image but not getting an image visual image object.
  * 
  * @note Different from other rander objects, the text will be drawn on the screen directly, and it will be always
  * at the top among all other render objects.
+ * @note Text of windows with partial redraw or idle mode must be drawn after @ref CGWindowDraw,
+ * otherwise it is not drawn and an error is raised.
+ * @note The glyphs are rasterized the first time they are drawn with a font and a size, and kept
+ * in a glyph atlas (see glyph_atlas.h) for the later frames. The whole text is drawn with one
+ * draw call for each page of the atlas that its glyphs are in.
  * 
  * @param window The window that the text will be drawn on
  * @param text_rk The resource key of the text.
@@ -884,6 +1487,156 @@ CGVisualImage* CGCreateTextVisualImageRaw(const CGChar* text, const CGChar* font
  */
 CG_BOOL CGDrawText(const CGChar* text_rk, const CGChar* font_rk, CGTextProperty text_property, const CGRenderObjectProperty* render_property, const CGWindow* window);
 
+/**
+ * @brief Draw a text on the screen. Compare to @ref CGDrawText, this function takes the text
+ * itself instead of its resource key.
+ * 
+ * @param window The window that the text will be drawn on
+ * @param text The text.
+ * @param font_rk The resource key of the font. If you want to use the default font, you can set this to NULL.
+ * @param text_property The property of the text.
+ * @param render_property The render property.
+ * @return CG_TRUE if the text is successfully drawn. CG_FALSE if failed.
+ */
+CG_BOOL CGDrawTextRaw(const CGChar* text, const CGChar* font_rk, CGTextProperty text_property, const CGRenderObjectProperty* render_property, const CGWindow* window);
+
+/**
+ * @brief A list of texts that are drawn together with @ref CGDrawTextBatch.
+ * @details The glyphs of all the texts in a batch are put into one vertex stream, and drawn
+ * with one draw call for each page of the glyph atlas that they are in. Use a batch to draw
+ * many texts with the same render property, such as the labels of a panel.
+ */
+typedef struct CGTextBatch CGTextBatch;
+
+/**
+ * @brief Create an empty text batch.
+ * 
+ * @return CGTextBatch* The text batch. Returns NULL if failed.
+ */
+CGTextBatch* CGCreateTextBatch();
+
+/**
+ * @brief Add a text to a text batch. The text and the font resource key are copied.
+ * 
+ * @param batch The text batch.
+ * @param text The text.
+ * @param font_rk The resource key of the font. If you want to use the default font, you can set this to NULL.
+ * @param text_property The property of the text.
+ * @param position The position of the start of the baseline of the text in the batch.
+ * @return CG_TRUE if the text is added. CG_FALSE if failed.
+ */
+CG_BOOL CGAddTextToBatch(CGTextBatch* batch, const CGChar* text, const CGChar* font_rk, CGTextProperty text_property, CGVector2 position);
+
+/**
+ * @brief Remove all the texts from a text batch.
+ * 
+ * @param batch The text batch.
+ */
+void CGClearTextBatch(CGTextBatch* batch);
+
+/**
+ * @brief Get the count of texts in a text batch.
+ * 
+ * @param batch The text batch.
+ * @return unsigned int The count of texts.
+ */
+unsigned int CGGetTextBatchSize(const CGTextBatch* batch);
+
+/**
+ * @brief Draw all the texts in a text batch on the screen. Like @ref CGDrawText, the texts are
+ * drawn directly, on top of the other render objects.
+ * 
+ * @note Each text of the batch is recorded by the command recorder of the window.
+ * @param batch The text batch.
+ * @param render_property The render property of the whole batch.
+ * @param window The window that the texts will be drawn on.
+ * @return CG_TRUE if the texts are successfully drawn. CG_FALSE if failed.
+ */
+CG_BOOL CGDrawTextBatch(const CGTextBatch* batch, const CGRenderObjectProperty* render_property, const CGWindow* window);
+
+/************RENDER_LAYERS************/
+
+/**
+ * @brief An offscreen texture that a group of objects is drawn into once, and then drawn
+ * as one visual image every frame until it is invalidated.
+ * @details Draw a layer with @ref CGDrawVisualImage and its visual_image. The objects drawn
+ * between @ref CGBeginRenderLayer and @ref CGEndRenderLayer are drawn into the layer instead of
+ * the window, with the origin at the center of the layer.
+ */
+typedef struct{
+    /**
+     * @brief The visual image of the texture of the layer. It is owned by the layer, so it
+     * should not be freed or copied.
+     */
+    CGVisualImage visual_image;
+    /**
+     * @brief Is the texture drawn and not invalidated since.
+     */
+    CG_BOOL is_valid;
+    /**
+     * @brief The OpenGL frame buffer that the texture is attached to.
+     */
+    unsigned int frame_buffer;
+    /**
+     * @brief The depth render buffer of the frame buffer.
+     */
+    unsigned int depth_render_buffer;
+    /**
+     * @brief The render list of the window that is set aside while the layer is drawn.
+     */
+    CGRenderNode* saved_render_list;
+    CGRenderNode* saved_render_list_tail;
+    unsigned int saved_render_list_count;
+    /**
+     * @brief The viewport and clear color of the window that are restored when the layer ends.
+     */
+    int saved_viewport[4];
+    float saved_clear_color[4];
+}CGRenderLayer;
+
+/**
+ * @brief Create a render layer. The layer is invalid until it is drawn.
+ * 
+ * @param width The width of the layer in pixels.
+ * @param height The height of the layer in pixels.
+ * @param window The window that the layer is drawn in.
+ * @return CGRenderLayer* The created render layer. Returns NULL if failed.
+ */
+CGRenderLayer* CGCreateRenderLayer(int width, int height, CGWindow* window);
+
+/**
+ * @brief Start drawing into a render layer. The layer is cleared to transparent, and the
+ * objects drawn into its window are drawn into the layer until @ref CGEndRenderLayer.
+ * Layers cannot be nested.
+ * 
+ * @param layer The render layer.
+ * @return CG_BOOL CG_TRUE if the layer is begun.
+ */
+CG_BOOL CGBeginRenderLayer(CGRenderLayer* layer);
+
+/**
+ * @brief Draw the objects into the render layer, and continue drawing into the window.
+ * The layer is valid after this.
+ * 
+ * @param layer The render layer.
+ */
+void CGEndRenderLayer(CGRenderLayer* layer);
+
+/**
+ * @brief Mark a render layer as invalid, so that it will be drawn again.
+ * 
+ * @param layer The render layer.
+ */
+void CGInvalidateRenderLayer(CGRenderLayer* layer);
+
+/**
+ * @brief Check if a render layer is drawn and not invalidated since.
+ * 
+ * @param layer The render layer.
+ * @return CG_BOOL CG_TRUE if the layer doesn't need to be drawn again.
+ */
+CG_BOOL CGIsRenderLayerValid(const CGRenderLayer* layer);
+
 /**
  * @brief A vertex node of a polygon.
  * @warning For this node, you should NOT use CGFree to free it.
@@ -894,6 +1647,11 @@ typedef struct CGPolygonVertex{
      * @brief The position of the vertex
      */
     CGVector2 position;
+    /**
+     * @brief The color of the vertex. This is only used when the polygon is drawn
+     * as a colored polygon, and it is set to white by default.
+     */
+    CGColor color;
     /**
      * @brief The previous vertex
      */
@@ -935,6 +1693,17 @@ typedef struct{
 
 CGPolygon* CGCreatePolygon(CGVector2* vertices, unsigned int vertex_count, CG_BOOL is_temp);
 
+/**
+ * @brief Create a polygon with a color for each vertex. The polygon should be drawn with
+ * @ref CGDrawColoredPolygon for the colors to be used.
+ * 
+ * @param vertices The vertices of the polygon.
+ * @param colors The colors of the vertices. The count must be the same as the vertex count.
+ * @param vertex_count The count of the vertices.
+ * @return CGPolygon* The created polygon.
+ */
+CGPolygon* CGCreateColoredPolygon(CGVector2* vertices, CGColor* colors, unsigned int vertex_count, CG_BOOL is_temp);
+
 /**
  * @brief A list node for triangles.
  */
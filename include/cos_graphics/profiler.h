@@ -0,0 +1,82 @@
+#ifndef _CG_PROFILER_H_
+#define _CG_PROFILER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+
+/**
+ * @brief The count of zones that each thread can record in a profiler session. The zones
+ * after it are dropped.
+ */
+#define CG_PROFILER_THREAD_BUFFER_SIZE 16384
+
+#ifdef CG_ENABLE_PROFILER
+/**
+ * @brief Start measuring a zone. The zone is a name that is unique in its scope, and must be
+ * ended with @ref CG_PROFILE_END in the same scope.
+ */
+#define CG_PROFILE_BEGIN(zone) double cg_profile_zone_##zone = CGProfilerBeginZone()
+/**
+ * @brief Finish measuring a zone started with @ref CG_PROFILE_BEGIN, and record it into the
+ * buffer of the calling thread.
+ */
+#define CG_PROFILE_END(zone) CGProfilerEndZone(#zone, cg_profile_zone_##zone)
+#else
+#define CG_PROFILE_BEGIN(zone) ((void)0)
+#define CG_PROFILE_END(zone) ((void)0)
+#endif
+
+/**
+ * @brief Start a profiler session. The zones measured on any thread are recorded until the
+ * session ends. A session that is already started is started again.
+ * @note The zones are only measured if the library is built with CG_ENABLE_PROFILER.
+ */
+void CGBeginProfilerSession();
+
+/**
+ * @brief End the profiler session, and write the recorded zones into a Chrome trace_event
+ * JSON file, which can be opened in Perfetto or chrome://tracing.
+ * @note Zones that are still being recorded on other threads may be missing from the file.
+ *
+ * @param path The path of the file. NULL to end the session without writing it.
+ * @return CG_BOOL CG_TRUE if the file is written, or path is NULL.
+ */
+CG_BOOL CGEndProfilerSession(const CGChar* path);
+
+/**
+ * @brief Is a profiler session started.
+ *
+ * @return CG_BOOL CG_TRUE if a session is started.
+ */
+CG_BOOL CGIsProfilerSessionActive();
+
+/**
+ * @brief Get the count of zones dropped in the current session because the buffer of a thread is full.
+ *
+ * @return unsigned int The count of zones dropped.
+ */
+unsigned int CGGetProfilerDroppedCount();
+
+/**
+ * @brief Start measuring a zone. Use @ref CG_PROFILE_BEGIN instead.
+ *
+ * @return double The time that the zone starts at. Negative if no session is started.
+ */
+double CGProfilerBeginZone();
+
+/**
+ * @brief Finish measuring a zone. Use @ref CG_PROFILE_END instead.
+ *
+ * @param name The name of the zone. It must live until the session ends, like a string literal.
+ * @param start_time The time returned by @ref CGProfilerBeginZone.
+ */
+void CGProfilerEndZone(const char* name, double start_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_PROFILER_H_
@@ -116,6 +116,14 @@ typedef struct{
  */
 CGImage* CGCreateImage(int width, int height, int channels, unsigned char* data);
 
+/**
+ * @brief Does the image have any pixel that is not fully opaque.
+ * 
+ * @param image The image to be checked.
+ * @return CG_BOOL CG_TRUE if the image has an alpha channel and any alpha value is less than 255.
+ */
+CG_BOOL CGIsImageTransparent(const CGImage* image);
+
 /**
  * @brief Load image from path.
  * 
@@ -147,6 +155,8 @@ void CGDeleteImage(CGImage* image);
  * @param count count of values of the array
  * @param array the array to be set
  * @param ... the values to be set to the array
+ * @deprecated The values are promoted to double when passed through the variadic arguments.
+ * Use @ref CGVertexStream to build vertex data instead.
  */
 void CGSetFloatArrayValue(unsigned int count, float* array, ...);
 
@@ -200,6 +210,31 @@ void CGResourceSystemUpdate();
  */
 CGByte* CGLoadResource(const CGChar* resource_key, int* size, CGChar* type);
 
+/**
+ * @brief Statistics of the files, images and resources loaded since the program started.
+ */
+typedef struct{
+    /**
+     * @brief The count of loads.
+     */
+    unsigned int load_count;
+    /**
+     * @brief The count of bytes loaded. The size of the pixels for images.
+     */
+    unsigned long long bytes_loaded;
+    /**
+     * @brief The time spent loading, in seconds.
+     */
+    double load_time;
+}CGResourceLoadStats;
+
+/**
+ * @brief Get the statistics of the files, images and resources loaded since the program started.
+ * 
+ * @return CGResourceLoadStats The statistics.
+ */
+CGResourceLoadStats CGGetResourceLoadStats();
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,161 @@
+#ifndef _CG_SPATIAL_INDEX_H_
+#define _CG_SPATIAL_INDEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+#include "graphics.h"
+
+/**
+ * @brief The default size of the cells of a spatial index.
+ */
+#define CG_SPATIAL_INDEX_DEFAULT_CELL_SIZE 128.0f
+
+/**
+ * @brief Items that cover more cells than this are not stored in the cells, but
+ * tested in every query instead.
+ */
+#define CG_SPATIAL_INDEX_MAX_ITEM_CELLS 64
+
+/**
+ * @brief The id of an item that is not in a spatial index.
+ */
+#define CG_SPATIAL_INDEX_INVALID_ID 0
+
+/**
+ * @brief A render object in a spatial index.
+ */
+typedef struct{
+    /**
+     * @brief The id of the item in the spatial index.
+     */
+    unsigned int id;
+    /**
+     * @brief The render object.
+     */
+    void* object;
+    /**
+     * @brief The type of the render object (CG_RD_TYPE_XXX).
+     */
+    int object_type;
+    /**
+     * @brief The property of the render object. NULL for the default property.
+     */
+    CGRenderObjectProperty* property;
+    /**
+     * @brief The bounding box of the object when it was added or last updated.
+     */
+    CGAABB bounds;
+    /**
+     * @brief The order that the item is added in. Items with the same z are drawn in this order.
+     */
+    unsigned int sequence;
+}CGSpatialIndexItem;
+
+/**
+ * @brief Callback of @ref CGQuerySpatialIndex for each item found.
+ */
+typedef void (*CGSpatialIndexQueryCallback)(const CGSpatialIndexItem* item, void* user_data);
+
+/**
+ * @brief Create a spatial index. The index is a uniform grid of square cells stored in a
+ * hash table, so that only the cells that are used take memory.
+ * @details Cells that are about the size of the objects in the index work best.
+ *
+ * @param cell_size The size of the cells. Must be larger than 0.
+ * @return CGSpatialIndex* The spatial index. Returns NULL if failed.
+ */
+CGSpatialIndex* CGCreateSpatialIndex(float cell_size);
+
+/**
+ * @brief Add a render object to a spatial index. The object and its property must not be
+ * freed while they are in the index, so temporary objects must not be added.
+ *
+ * @param index The spatial index.
+ * @param object The render object.
+ * @param object_type The type of the render object (CG_RD_TYPE_XXX).
+ * @param property The property of the render object. NULL for the default property.
+ * @return unsigned int The id of the item. Returns CG_SPATIAL_INDEX_INVALID_ID if failed.
+ */
+unsigned int CGAddSpatialIndexItem(CGSpatialIndex* index, void* object, int object_type, CGRenderObjectProperty* property);
+
+/**
+ * @brief Update the bounds of an item after its object or property is changed. The item is
+ * only moved in the index if it moved to different cells.
+ *
+ * @param index The spatial index.
+ * @param id The id of the item.
+ * @return CG_BOOL CG_TRUE if the item is updated.
+ */
+CG_BOOL CGUpdateSpatialIndexItem(CGSpatialIndex* index, unsigned int id);
+
+/**
+ * @brief Remove an item from a spatial index.
+ *
+ * @param index The spatial index.
+ * @param id The id of the item.
+ */
+void CGRemoveSpatialIndexItem(CGSpatialIndex* index, unsigned int id);
+
+/**
+ * @brief Get an item of a spatial index.
+ *
+ * @param index The spatial index.
+ * @param id The id of the item.
+ * @return const CGSpatialIndexItem* The item. Returns NULL if the item is not in the index.
+ * The pointer is valid until another item is added to the index.
+ */
+const CGSpatialIndexItem* CGGetSpatialIndexItem(const CGSpatialIndex* index, unsigned int id);
+
+/**
+ * @brief Get the count of items in a spatial index.
+ *
+ * @param index The spatial index.
+ * @return unsigned int The count of items.
+ */
+unsigned int CGGetSpatialIndexItemCount(const CGSpatialIndex* index);
+
+/**
+ * @brief Find the items whose bounding boxes overlap a rectangle. Each item is found once.
+ *
+ * @param index The spatial index.
+ * @param rect The rectangle.
+ * @param callback Called for each item found. Can be NULL if only the count is needed.
+ * The index must not be modified in the callback.
+ * @param user_data Passed to the callback.
+ * @return unsigned int The count of items found.
+ */
+unsigned int CGQuerySpatialIndex(CGSpatialIndex* index, const CGAABB* rect, CGSpatialIndexQueryCallback callback, void* user_data);
+
+/**
+ * @brief Find the objects in the spatial index of a window whose drawn shapes overlap a rectangle.
+ * The objects are tested with the same transformations and triangles as they are drawn.
+ *
+ * @param window The window. Its spatial index is set with @ref CGSetWindowSpatialIndex.
+ * @param rect The rectangle.
+ * @param results The objects found, from the topmost one to the bottommost one. Can be NULL
+ * if only the count is needed.
+ * @param max_count The max count of objects written into results.
+ * @return unsigned int The count of all the objects found, which can be larger than max_count.
+ */
+unsigned int CGQueryRect(CGWindow* window, const CGAABB* rect, CGSpatialIndexItem* results, unsigned int max_count);
+
+/**
+ * @brief Find the objects in the spatial index of a window that are drawn on a point.
+ *
+ * @param window The window. Its spatial index is set with @ref CGSetWindowSpatialIndex.
+ * @param point The point, in the same coordinates as @ref CGGetCursorPosition.
+ * @param results The objects found, from the topmost one to the bottommost one. Can be NULL
+ * if only the count is needed.
+ * @param max_count The max count of objects written into results.
+ * @return unsigned int The count of all the objects found, which can be larger than max_count.
+ */
+unsigned int CGPick(CGWindow* window, CGVector2 point, CGSpatialIndexItem* results, unsigned int max_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_SPATIAL_INDEX_H_
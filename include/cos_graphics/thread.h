@@ -0,0 +1,131 @@
+#ifndef _CG_THREAD_H_
+#define _CG_THREAD_H_
+#include "cos_graphics/defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A thread. Threads, mutexes and conditions are not managed by the resource system,
+ * because the resource system can only be used on the main thread.
+ */
+typedef struct CGThread CGThread;
+
+/**
+ * @brief A mutex.
+ */
+typedef struct CGMutex CGMutex;
+
+/**
+ * @brief A condition variable.
+ */
+typedef struct CGCondition CGCondition;
+
+/**
+ * @brief The function that a thread runs.
+ */
+typedef void (*CGThreadFunction)(void* user_data);
+
+/**
+ * @brief Create a thread and start running it.
+ * 
+ * @param function The function that the thread runs.
+ * @param user_data Passed to the function.
+ * @return CGThread* The thread. Returns NULL if failed. Join it with @ref CGJoinThread.
+ */
+CGThread* CGCreateThread(CGThreadFunction function, void* user_data);
+
+/**
+ * @brief Wait for a thread to finish, and delete it.
+ * 
+ * @param thread The thread.
+ */
+void CGJoinThread(CGThread* thread);
+
+/**
+ * @brief Get the count of logical processors.
+ * 
+ * @return unsigned int The count of logical processors. At least 1.
+ */
+unsigned int CGGetProcessorCount();
+
+/**
+ * @brief Suspend the calling thread for a time. The thread may sleep longer than the time,
+ * by up to the scheduling granularity of the system.
+ * 
+ * @param seconds The time in seconds.
+ */
+void CGSleepThread(double seconds);
+
+/**
+ * @brief Create a mutex.
+ * 
+ * @return CGMutex* The mutex. Returns NULL if failed.
+ */
+CGMutex* CGCreateMutex();
+
+/**
+ * @brief Delete a mutex.
+ * 
+ * @param mutex The mutex.
+ */
+void CGDeleteMutex(CGMutex* mutex);
+
+/**
+ * @brief Lock a mutex.
+ * 
+ * @param mutex The mutex.
+ */
+void CGLockMutex(CGMutex* mutex);
+
+/**
+ * @brief Unlock a mutex.
+ * 
+ * @param mutex The mutex.
+ */
+void CGUnlockMutex(CGMutex* mutex);
+
+/**
+ * @brief Create a condition variable.
+ * 
+ * @return CGCondition* The condition variable. Returns NULL if failed.
+ */
+CGCondition* CGCreateCondition();
+
+/**
+ * @brief Delete a condition variable.
+ * 
+ * @param condition The condition variable.
+ */
+void CGDeleteCondition(CGCondition* condition);
+
+/**
+ * @brief Unlock the mutex and wait for the condition to be signaled. The mutex is locked again
+ * before the function returns. The wait can end without a signal, so the condition should be
+ * checked in a loop.
+ * 
+ * @param condition The condition variable.
+ * @param mutex The mutex that is locked by the current thread.
+ */
+void CGWaitCondition(CGCondition* condition, CGMutex* mutex);
+
+/**
+ * @brief Wake up one thread waiting for the condition.
+ * 
+ * @param condition The condition variable.
+ */
+void CGSignalCondition(CGCondition* condition);
+
+/**
+ * @brief Wake up all the threads waiting for the condition.
+ * 
+ * @param condition The condition variable.
+ */
+void CGBroadcastCondition(CGCondition* condition);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef _CG_UTILS_H_
 #define _CG_UTILS_H_
 #include "cos_graphics/defs.h"
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +25,50 @@ void CGCharToChar(const CGChar* str, char* buffer, unsigned int buffer_size);
  */
 void CharToCGChar(const char* str, CGChar* buffer, unsigned int buffer_size);
 
+/**
+ * @brief Allocate memory like malloc, and count the allocation. The library allocates memory on the
+ * main thread with this, so that the allocations can be counted in the frame statistics. Free the
+ * memory with free.
+ * 
+ * @param size The size of the memory in bytes.
+ * @return void* The memory. Returns NULL if failed.
+ */
+void* CGMalloc(size_t size);
+
+/**
+ * @brief Allocate memory filled with 0 like calloc, and count the allocation.
+ * 
+ * @param count The count of elements.
+ * @param size The size of each element in bytes.
+ * @return void* The memory. Returns NULL if failed.
+ */
+void* CGCalloc(size_t count, size_t size);
+
+/**
+ * @brief Resize memory like realloc, and count the allocation.
+ * 
+ * @param data The memory to be resized. NULL to allocate new memory.
+ * @param size The new size of the memory in bytes.
+ * @return void* The resized memory. Returns NULL if failed, and the memory is not freed.
+ */
+void* CGRealloc(void* data, size_t size);
+
+/**
+ * @brief Get the count of allocations done with @ref CGMalloc, @ref CGCalloc and @ref CGRealloc
+ * since the program started. Only allocations on the main thread are counted reliably.
+ * 
+ * @return unsigned long long The count of allocations.
+ */
+unsigned long long CGGetAllocationCount();
+
+/**
+ * @brief Get the time of a monotonic clock in seconds. Unlike @ref CGGetRealTime, it does not
+ * need the graphics to be initialized, and it can be called on any thread.
+ * 
+ * @return double The time in seconds. Only the difference between two times is meaningful.
+ */
+double CGGetMonotonicTime();
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,265 @@
+#ifndef _CG_VERTEX_H_
+#define _CG_VERTEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "defs.h"
+#include "graphics.h"
+
+/**
+ * @brief The largest value of an unsigned normalized 16 bit integer.
+ */
+#define CG_UNORM16_MAX 65535
+
+/**
+ * @brief The largest value of an unsigned normalized 32 bit integer.
+ */
+#define CG_UNORM32_MAX 4294967295u
+
+/**
+ * @brief The bounds that the compact vertex positions are quantized in.
+ * @details Compact vertices store their positions as unsigned normalized 16 bit integers,
+ * where 0 is the minimum and 65535 is the maximum of the bounds. The bounds are passed
+ * to the shader with the "position_bounds" uniform as (min_x, min_y, max_x, max_y).
+ */
+typedef struct{
+    /**
+     * @brief The minimum x value of the positions
+     */
+    float min_x;
+    /**
+     * @brief The minimum y value of the positions
+     */
+    float min_y;
+    /**
+     * @brief The maximum x value of the positions
+     */
+    float max_x;
+    /**
+     * @brief The maximum y value of the positions
+     */
+    float max_y;
+}CGVertexBounds;
+
+/**
+ * @brief Vertex of triangles and quadrangles. The depth is a per-draw uniform.
+ */
+typedef struct{
+    /**
+     * @brief The quantized position of the vertex.
+     */
+    unsigned short position[2];
+}CGCompactVertex;
+
+/**
+ * @brief Vertex of visual images and glyphs. The depth is a per-draw uniform.
+ */
+typedef struct{
+    /**
+     * @brief The quantized position of the vertex.
+     */
+    unsigned short position[2];
+    /**
+     * @brief The texture coordinate of the vertex as unsigned normalized integers.
+     */
+    unsigned short tex_coord[2];
+}CGCompactImageVertex;
+
+/**
+ * @brief Vertex of batched colored geometries. Different objects in one batch have different
+ * depths, so the depth is stored in each vertex.
+ */
+typedef struct{
+    /**
+     * @brief The quantized position of the vertex.
+     */
+    unsigned short position[2];
+    /**
+     * @brief The color of the vertex as unsigned normalized bytes (r, g, b, alpha).
+     */
+    CGUByte color[4];
+    /**
+     * @brief The depth of the vertex as an unsigned normalized 32 bit integer. The shaders
+     * write it as the clip space z, so the range [0, 1] is mapped to the window depths [0.5, 1],
+     * which is half of the 24 bit depth buffer. That still gives each of about 8.4 million
+     * objects in a frame its own depth, while 16 bits would make objects share a depth once a
+     * frame has more than 65535.
+     */
+    unsigned int depth;
+}CGCompactColoredVertex;
+
+/**
+ * @brief Convert a value in the range [0, 1] to an unsigned normalized 16 bit integer.
+ * Values out of the range are clamped.
+ *
+ * @param value The value to be converted.
+ * @return unsigned short The converted value.
+ */
+unsigned short CGQuantizeUnorm16(float value);
+
+/**
+ * @brief Convert a value in the range [0, 1] to an unsigned normalized 32 bit integer.
+ * Values out of the range are clamped.
+ *
+ * @param value The value to be converted.
+ * @return unsigned int The converted value.
+ */
+unsigned int CGQuantizeUnorm32(float value);
+
+/**
+ * @brief Convert an unsigned normalized 16 bit integer back to a value in the range [0, 1].
+ *
+ * @param value The value to be converted.
+ * @return float The converted value.
+ */
+float CGDequantizeUnorm16(unsigned short value);
+
+/**
+ * @brief Construct the bounds of a group of positions.
+ *
+ * @param positions The positions.
+ * @param count The count of the positions.
+ * @return CGVertexBounds The bounds that contains all the positions.
+ */
+CGVertexBounds CGConstructVertexBounds(const CGVector2* positions, unsigned int count);
+
+/**
+ * @brief Expand the bounds so that it contains a position.
+ *
+ * @param bounds The bounds to be expanded.
+ * @param position The position that the bounds should contain.
+ */
+void CGExpandVertexBounds(CGVertexBounds* bounds, CGVector2 position);
+
+/**
+ * @brief Quantize a position relative to the bounds.
+ *
+ * @param bounds The bounds that the position is in.
+ * @param position The position to be quantized.
+ * @param result The 2 quantized components of the position.
+ */
+void CGQuantizePosition(const CGVertexBounds* bounds, CGVector2 position, unsigned short* result);
+
+/**
+ * @brief Get a position back from its quantized value.
+ *
+ * @param bounds The bounds that the position is quantized in.
+ * @param quantized The 2 quantized components of the position.
+ * @return CGVector2 The position.
+ */
+CGVector2 CGDequantizePosition(const CGVertexBounds* bounds, const unsigned short* quantized);
+
+/**
+ * @brief A stream that vertices are written into.
+ * @details The stream either writes into a fixed buffer owned by the caller, or into a buffer
+ * owned by the stream that grows when it is full. Streams don't share any global state, so
+ * different streams can be filled on different threads at the same time.
+ */
+typedef struct{
+    /**
+     * @brief The vertex data.
+     */
+    void* data;
+    /**
+     * @brief The size of one vertex in bytes.
+     */
+    unsigned int stride;
+    /**
+     * @brief The count of vertices written into the stream.
+     */
+    unsigned int size;
+    /**
+     * @brief The count of vertices that the buffer can hold.
+     */
+    unsigned int capacity;
+    /**
+     * @brief Is the buffer owned by the stream. Only owned buffers grow.
+     */
+    CG_BOOL is_owner;
+}CGVertexStream;
+
+/**
+ * @brief Construct a vertex stream that writes into a buffer owned by the caller.
+ * The buffer won't grow, and writing more vertices than its capacity fails.
+ *
+ * @param buffer The buffer the vertices are written into.
+ * @param stride The size of one vertex in bytes.
+ * @param capacity The count of vertices that the buffer can hold.
+ * @return CGVertexStream The vertex stream.
+ */
+CGVertexStream CGConstructVertexStream(void* buffer, unsigned int stride, unsigned int capacity);
+
+/**
+ * @brief Initialize a vertex stream that owns its buffer. The buffer grows when it is full.
+ * The stream should be released with @ref CGReleaseVertexStream.
+ *
+ * @param stream The stream to be initialized.
+ * @param stride The size of one vertex in bytes.
+ * @param initial_capacity The count of vertices that the buffer can hold at the beginning.
+ * @return CG_BOOL CG_TRUE if the stream is initialized successfully.
+ */
+CG_BOOL CGInitVertexStream(CGVertexStream* stream, unsigned int stride, unsigned int initial_capacity);
+
+/**
+ * @brief Release the buffer of a vertex stream if the stream owns it.
+ *
+ * @param stream The stream to be released.
+ */
+void CGReleaseVertexStream(CGVertexStream* stream);
+
+/**
+ * @brief Remove all the vertices in the stream. The buffer is kept for reuse.
+ *
+ * @param stream The stream to be reset.
+ */
+void CGResetVertexStream(CGVertexStream* stream);
+
+/**
+ * @brief Reserve space for vertices at the end of the stream.
+ *
+ * @param stream The stream.
+ * @param count The count of vertices to be reserved.
+ * @return void* The first reserved vertex, or NULL if the stream is full and cannot grow.
+ */
+void* CGReserveVertexStream(CGVertexStream* stream, unsigned int count);
+
+/**
+ * @brief Write a @ref CGCompactVertex into the stream.
+ *
+ * @param stream The stream.
+ * @param bounds The bounds that the position is quantized in.
+ * @param position The position of the vertex.
+ * @return CG_BOOL CG_TRUE if the vertex is written.
+ */
+CG_BOOL CGPushCompactVertex(CGVertexStream* stream, const CGVertexBounds* bounds, CGVector2 position);
+
+/**
+ * @brief Write a @ref CGCompactImageVertex into the stream.
+ *
+ * @param stream The stream.
+ * @param bounds The bounds that the position is quantized in.
+ * @param position The position of the vertex.
+ * @param tex_coord The texture coordinate of the vertex, in the range [0, 1].
+ * @return CG_BOOL CG_TRUE if the vertex is written.
+ */
+CG_BOOL CGPushCompactImageVertex(CGVertexStream* stream, const CGVertexBounds* bounds, CGVector2 position, CGVector2 tex_coord);
+
+/**
+ * @brief Write a @ref CGCompactColoredVertex into the stream.
+ *
+ * @param stream The stream.
+ * @param bounds The bounds that the position is quantized in.
+ * @param position The position of the vertex.
+ * @param color The color of the vertex as unsigned normalized bytes (r, g, b, alpha).
+ * @param depth The depth of the vertex, in the range [0, 1].
+ * @return CG_BOOL CG_TRUE if the vertex is written.
+ */
+CG_BOOL CGPushCompactColoredVertex(CGVertexStream* stream, const CGVertexBounds* bounds, CGVector2 position, const CGUByte* color, float depth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //_CG_VERTEX_H_
@@ -0,0 +1,19 @@
+#version 330 core
+
+layout(location = 0) in vec2 vert_pos;
+layout(location = 1) in vec4 vert_color;
+layout(location = 2) in float vert_depth;
+
+uniform vec4 position_bounds;
+
+uniform float render_width;
+uniform float render_height;
+
+out vec4 color;
+
+void main()
+{
+    color = vert_color;
+    vec2 global_pos = mix(position_bounds.xy, position_bounds.zw, vert_pos);
+    gl_Position = vec4(global_pos.x / render_width, global_pos.y / render_height, vert_depth, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,905 @@
+#include "cos_graphics/command_recorder.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/utils.h"
+#include "cos_graphics/log.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/**
+ * @brief The commands of a command stream. Each command is a byte of its type, followed by its data.
+ * The stream starts with a @ref CGCommandStreamHeader.
+ */
+enum {
+    /**
+     * @brief A frame starts. Followed by the time of the frame in seconds from the first frame, as a double.
+     */
+    CG_COMMAND_FRAME = 1,
+    /**
+     * @brief A texture is created. Followed by the recorded texture id, width, height and channels
+     * as uint32_t, and the pixels.
+     */
+    CG_COMMAND_TEXTURE,
+    /**
+     * @brief An object is passed to CGDraw. Followed by the object type as int32_t, the render property
+     * and the object.
+     */
+    CG_COMMAND_DRAW,
+    /**
+     * @brief A text is drawn. Followed by the text and the font resource key, the text property as
+     * 4 uint32_t, and the render property.
+     */
+    CG_COMMAND_DRAW_TEXT,
+    /**
+     * @brief The render list of the window is drawn.
+     */
+    CG_COMMAND_WINDOW_DRAW
+};
+
+/**
+ * @brief The length that is written instead of the length of a NULL string.
+ */
+#define CG_COMMAND_NULL_STRING 0xFFFFFFFFu
+
+typedef struct{
+    char magic[4];
+    uint32_t version;
+    /**
+     * @brief The size of CGChar that the text in the stream is written with.
+     */
+    uint32_t char_size;
+    int32_t window_width;
+    int32_t window_height;
+}CGCommandStreamHeader;
+
+static const char cg_command_stream_magic[4] = {'C', 'G', 'C', 'S'};
+
+/************RECORDER************/
+
+struct CGCommandRecorder{
+    CGWindow* window;
+    FILE* file;
+    /**
+     * @brief The count of frames to be recorded. 0 if unlimited.
+     */
+    unsigned int frame_limit;
+    unsigned int frame_count;
+    double start_time;
+    CG_BOOL is_finished;
+    /**
+     * @brief The ids of the textures that are in the stream.
+     */
+    unsigned int* texture_ids;
+    unsigned int texture_count;
+    unsigned int texture_capacity;
+};
+
+/**
+ * @brief The command recorder that the created textures are recorded into. NULL if there is none.
+ */
+static CGCommandRecorder* cg_command_recorder = NULL;
+
+static void CGFinishCommandRecorder(CGCommandRecorder* recorder)
+{
+    if (recorder->is_finished)
+        return;
+    recorder->is_finished = CG_TRUE;
+    if (recorder->file != NULL)
+    {
+        fclose(recorder->file);
+        recorder->file = NULL;
+    }
+    if (recorder->window != NULL && recorder->window->command_recorder == recorder)
+        recorder->window->command_recorder = NULL;
+}
+
+static void CGDeleteCommandRecorder(CGCommandRecorder* recorder)
+{
+    if (recorder == NULL)
+        return;
+    CGFinishCommandRecorder(recorder);
+    if (cg_command_recorder == recorder)
+        cg_command_recorder = NULL;
+    free(recorder->texture_ids);
+    free(recorder);
+}
+
+static void CGWriteCommandData(CGCommandRecorder* recorder, const void* data, size_t size)
+{
+    if (recorder->is_finished || size == 0)
+        return;
+    if (fwrite(data, size, 1, recorder->file) != 1)
+    {
+        CG_ERROR(CGSTR("Failed to write command stream. The recording is stopped."));
+        CGFinishCommandRecorder(recorder);
+    }
+}
+
+static void CGWriteCommandType(CGCommandRecorder* recorder, int type)
+{
+    unsigned char command = (unsigned char)type;
+    CGWriteCommandData(recorder, &command, sizeof(command));
+}
+
+static void CGWriteCommandUInt(CGCommandRecorder* recorder, unsigned int value)
+{
+    uint32_t data = (uint32_t)value;
+    CGWriteCommandData(recorder, &data, sizeof(data));
+}
+
+static void CGWriteCommandString(CGCommandRecorder* recorder, const CGChar* string)
+{
+    if (string == NULL)
+    {
+        CGWriteCommandUInt(recorder, CG_COMMAND_NULL_STRING);
+        return;
+    }
+    unsigned int length = (unsigned int)CG_STRLEN(string);
+    CGWriteCommandUInt(recorder, length);
+    CGWriteCommandData(recorder, string, sizeof(CGChar) * length);
+}
+
+static void CGWriteCommandProperty(CGCommandRecorder* recorder, const CGRenderObjectProperty* property)
+{
+    unsigned char flags = 0;
+    if (property != NULL)
+        flags = (property->modify_matrix != NULL ? 3 : 1) | (property->is_opaque ? 4 : 0);
+    CGWriteCommandData(recorder, &flags, sizeof(flags));
+    if (property == NULL)
+        return;
+    CGWriteCommandData(recorder, &property->rotation, sizeof(float));
+    CGWriteCommandData(recorder, &property->z, sizeof(float));
+    CGWriteCommandData(recorder, &property->color, sizeof(CGColor));
+    CGWriteCommandData(recorder, &property->transform, sizeof(CGVector2));
+    CGWriteCommandData(recorder, &property->scale, sizeof(CGVector2));
+    if (property->modify_matrix != NULL)
+        CGWriteCommandData(recorder, property->modify_matrix, sizeof(float) * 16);
+}
+
+static CG_BOOL CGIsTextureRecorded(const CGCommandRecorder* recorder, unsigned int texture_id)
+{
+    for (unsigned int i = 0; i < recorder->texture_count; ++i)
+    {
+        if (recorder->texture_ids[i] == texture_id)
+            return CG_TRUE;
+    }
+    return CG_FALSE;
+}
+
+static void CGWriteCommandTexture(CGCommandRecorder* recorder, unsigned int texture_id, unsigned int width,
+    unsigned int height, unsigned int channels, const CGUByte* data)
+{
+    if (!CGIsTextureRecorded(recorder, texture_id))
+    {
+        if (recorder->texture_count == recorder->texture_capacity)
+        {
+            unsigned int capacity = recorder->texture_capacity == 0 ? 16 : recorder->texture_capacity * 2;
+            unsigned int* texture_ids = (unsigned int*)realloc(recorder->texture_ids, sizeof(unsigned int) * capacity);
+            CG_ERROR_CONDITION(texture_ids == NULL, CGSTR("Failed to allocate memory for recorded textures."));
+            recorder->texture_ids = texture_ids;
+            recorder->texture_capacity = capacity;
+        }
+        recorder->texture_ids[recorder->texture_count++] = texture_id;
+    }
+    // a recorded id that is written again belongs to a new texture, which replaces the old one
+    CGWriteCommandType(recorder, CG_COMMAND_TEXTURE);
+    CGWriteCommandUInt(recorder, texture_id);
+    CGWriteCommandUInt(recorder, width);
+    CGWriteCommandUInt(recorder, height);
+    CGWriteCommandUInt(recorder, channels);
+    CGWriteCommandData(recorder, data, (size_t)width * height * channels);
+}
+
+// textures created before the recording started are read back from OpenGL when they are first drawn
+static void CGReadBackTexture(CGCommandRecorder* recorder, unsigned int texture_id)
+{
+    if (glfwGetCurrentContext() != recorder->window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)recorder->window->glfw_window_instance);
+    GLint width = 0, height = 0;
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    CGUByte* pixels = NULL;
+    if (width > 0 && height > 0)
+        pixels = (CGUByte*)malloc((size_t)width * height * 4);
+    if (pixels != NULL)
+    {
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    CG_ERROR_CONDITION(pixels == NULL, CGSTR("Failed to read back texture %u to be recorded."), texture_id);
+    CGWriteCommandTexture(recorder, texture_id, (unsigned int)width, (unsigned int)height, 4, pixels);
+    free(pixels);
+}
+
+CGCommandRecorder* CGCreateCommandRecorder(CGWindow* window, const CGChar* path, unsigned int frame_count)
+{
+    CG_ERROR_COND_RETURN(window == NULL || path == NULL, NULL, CGSTR("Failed to create command recorder: Window and path cannot be NULL."));
+    CG_ERROR_COND_RETURN(cg_command_recorder != NULL, NULL, CGSTR("Failed to create command recorder: There is already a command recorder."));
+    CGCommandRecorder* recorder = (CGCommandRecorder*)calloc(1, sizeof(CGCommandRecorder));
+    CG_ERROR_COND_RETURN(recorder == NULL, NULL, CGSTR("Failed to allocate memory for command recorder."));
+    char path_c[512];
+    CGCharToChar(path, path_c, sizeof(path_c));
+    recorder->file = fopen(path_c, "wb");
+    if (recorder->file == NULL)
+    {
+        free(recorder);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to open command stream file."));
+    }
+    recorder->window = window;
+    recorder->frame_limit = frame_count;
+
+    CGCommandStreamHeader header;
+    memcpy(header.magic, cg_command_stream_magic, sizeof(header.magic));
+    header.version = CG_COMMAND_STREAM_VERSION;
+    header.char_size = sizeof(CGChar);
+    header.window_width = window->width;
+    header.window_height = window->height;
+    CGWriteCommandData(recorder, &header, sizeof(header));
+    if (recorder->is_finished)
+    {
+        free(recorder);
+        return NULL;
+    }
+
+    window->command_recorder = recorder;
+    cg_command_recorder = recorder;
+    CGRegisterResource(recorder, CG_DELETER(CGDeleteCommandRecorder));
+    return recorder;
+}
+
+unsigned int CGGetCommandRecorderFrameCount(const CGCommandRecorder* recorder)
+{
+    CG_ERROR_COND_RETURN(recorder == NULL, 0, CGSTR("Cannot get frame count of NULL command recorder."));
+    return recorder->frame_count;
+}
+
+CG_BOOL CGIsCommandRecorderFinished(const CGCommandRecorder* recorder)
+{
+    CG_ERROR_COND_RETURN(recorder == NULL, CG_TRUE, CGSTR("Cannot get state of NULL command recorder."));
+    return recorder->is_finished;
+}
+
+void CGCommandRecorderNextFrame(CGCommandRecorder* recorder)
+{
+    if (recorder->is_finished)
+        return;
+    if (recorder->frame_limit != 0 && recorder->frame_count == recorder->frame_limit)
+    {
+        CGFinishCommandRecorder(recorder);
+        return;
+    }
+    if (recorder->frame_count == 0)
+        recorder->start_time = CGGetCurrentTime();
+    double time = CGGetCurrentTime() - recorder->start_time;
+    CGWriteCommandType(recorder, CG_COMMAND_FRAME);
+    CGWriteCommandData(recorder, &time, sizeof(time));
+    ++recorder->frame_count;
+}
+
+void CGCommandRecorderDraw(CGCommandRecorder* recorder, const void* object, const CGRenderObjectProperty* property, int object_type)
+{
+    // the objects drawn before the first frame are not in any frame
+    if (recorder->is_finished || recorder->frame_count == 0 || object == NULL)
+        return;
+    if (object_type == CG_RD_TYPE_VISUAL_IMAGE)
+    {
+        unsigned int texture_id = ((const CGVisualImage*)object)->texture_id;
+        if (!CGIsTextureRecorded(recorder, texture_id))
+            CGReadBackTexture(recorder, texture_id);
+    }
+    CGWriteCommandType(recorder, CG_COMMAND_DRAW);
+    int32_t type = (int32_t)object_type;
+    CGWriteCommandData(recorder, &type, sizeof(type));
+    CGWriteCommandProperty(recorder, property);
+    switch (object_type)
+    {
+    case CG_RD_TYPE_TRIANGLE:
+        CGWriteCommandData(recorder, ((const CGTriangle*)object)->vertices, sizeof(CGVector2) * 3);
+        break;
+    case CG_RD_TYPE_QUADRANGLE:
+        CGWriteCommandData(recorder, ((const CGQuadrangle*)object)->vertices, sizeof(CGVector2) * 4);
+        break;
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+        CGWriteCommandData(recorder, ((const CGColoredTriangle*)object)->vertices, sizeof(CGVector2) * 3);
+        CGWriteCommandData(recorder, ((const CGColoredTriangle*)object)->colors, sizeof(CGColor) * 3);
+        break;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        CGWriteCommandData(recorder, ((const CGColoredQuadrangle*)object)->vertices, sizeof(CGVector2) * 4);
+        CGWriteCommandData(recorder, ((const CGColoredQuadrangle*)object)->colors, sizeof(CGColor) * 4);
+        break;
+    case CG_RD_TYPE_POLYGON:
+    case CG_RD_TYPE_COLORED_POLYGON:
+    {
+        const CGPolygonVertex* head = ((const CGPolygon*)object)->vertex_head;
+        unsigned int vertex_count = 0;
+        const CGPolygonVertex* p = head;
+        do
+        {
+            ++vertex_count;
+            p = p->next;
+        } while (p != head);
+        CGWriteCommandUInt(recorder, vertex_count);
+        p = head;
+        do
+        {
+            CGWriteCommandData(recorder, &p->position, sizeof(CGVector2));
+            CGWriteCommandData(recorder, &p->color, sizeof(CGColor));
+            p = p->next;
+        } while (p != head);
+        break;
+    }
+    case CG_RD_TYPE_VISUAL_IMAGE:
+    {
+        const CGVisualImage* visual_image = (const CGVisualImage*)object;
+        CGWriteCommandUInt(recorder, visual_image->texture_id);
+        CGWriteCommandUInt(recorder, visual_image->img_width);
+        CGWriteCommandUInt(recorder, visual_image->img_height);
+        CGWriteCommandUInt(recorder, visual_image->img_channels);
+        unsigned char flags[3] = {(unsigned char)visual_image->is_clamped, (unsigned char)visual_image->has_transparency,
+            (unsigned char)visual_image->is_premultiplied};
+        CGWriteCommandData(recorder, flags, sizeof(flags));
+        CGWriteCommandData(recorder, &visual_image->clamp_top_left, sizeof(CGVector2));
+        CGWriteCommandData(recorder, &visual_image->clamp_bottom_right, sizeof(CGVector2));
+        break;
+    }
+    default:
+        CG_ERROR(CGSTR("Failed to record draw command: Unknown object type %d."), object_type);
+        CGFinishCommandRecorder(recorder);
+    }
+}
+
+void CGCommandRecorderDrawText(CGCommandRecorder* recorder, const CGChar* text, const CGChar* font_rk,
+    const CGTextProperty* text_property, CGVector2 position, const CGRenderObjectProperty* render_property)
+{
+    if (recorder->is_finished || recorder->frame_count == 0 || text == NULL)
+        return;
+    CGWriteCommandType(recorder, CG_COMMAND_DRAW_TEXT);
+    CGWriteCommandString(recorder, text);
+    CGWriteCommandString(recorder, font_rk);
+    CGWriteCommandUInt(recorder, text_property->text_width);
+    CGWriteCommandUInt(recorder, text_property->text_height);
+    CGWriteCommandUInt(recorder, text_property->space_width);
+    CGWriteCommandUInt(recorder, text_property->kerning);
+    CGWriteCommandData(recorder, &position, sizeof(CGVector2));
+    CGWriteCommandProperty(recorder, render_property);
+}
+
+void CGCommandRecorderWindowDraw(CGCommandRecorder* recorder)
+{
+    if (recorder->is_finished || recorder->frame_count == 0)
+        return;
+    CGWriteCommandType(recorder, CG_COMMAND_WINDOW_DRAW);
+}
+
+void CGCommandRecorderTexture(unsigned int texture_id, unsigned int width, unsigned int height, unsigned int channels, const CGUByte* data)
+{
+    if (cg_command_recorder == NULL || cg_command_recorder->is_finished || data == NULL)
+        return;
+    CGWriteCommandTexture(cg_command_recorder, texture_id, width, height, channels, data);
+}
+
+/************REPLAY************/
+
+/**
+ * @brief The texture created for a recorded texture id.
+ */
+typedef struct{
+    unsigned int recorded_id;
+    unsigned int texture_id;
+}CGReplayTexture;
+
+/**
+ * @brief The storage of an object drawn in a frame. The render list refers to the object and
+ * its property until the window is drawn, so they are kept until the next frame.
+ */
+typedef struct{
+    CGRenderObjectProperty property;
+    float modify_matrix[16];
+    union{
+        CGTriangle triangle;
+        CGQuadrangle quadrangle;
+        CGColoredTriangle colored_triangle;
+        CGColoredQuadrangle colored_quadrangle;
+        CGVisualImage visual_image;
+    };
+}CGReplayDrawSlot;
+
+struct CGCommandReplay{
+    CGUByte* data;
+    size_t size;
+    /**
+     * @brief The position of the next command in the data.
+     */
+    size_t position;
+    int window_width;
+    int window_height;
+    unsigned int frame_count;
+    double* frame_times;
+    CGReplayDrawSlot* draw_slots;
+    /**
+     * @brief The most objects that are drawn in a frame.
+     */
+    unsigned int draw_slot_count;
+    CGReplayTexture* textures;
+    unsigned int texture_count;
+    unsigned int texture_capacity;
+    /**
+     * @brief The buffers that the texts and polygons of the commands are read into.
+     */
+    CGChar* text;
+    CGChar* font_rk;
+    size_t text_capacity;
+    size_t font_rk_capacity;
+    CGVector2* polygon_vertices;
+    CGColor* polygon_colors;
+    unsigned int polygon_capacity;
+};
+
+static void CGDeleteCommandReplay(CGCommandReplay* replay)
+{
+    if (replay == NULL)
+        return;
+    // without a current context the graphics is terminated, and the textures are deleted with the contexts
+    if (glfwGetCurrentContext() != NULL)
+    {
+        for (unsigned int i = 0; i < replay->texture_count; ++i)
+            CGDeleteTexture(replay->textures[i].texture_id);
+    }
+    free(replay->data);
+    free(replay->frame_times);
+    free(replay->draw_slots);
+    free(replay->textures);
+    free(replay->text);
+    free(replay->font_rk);
+    free(replay->polygon_vertices);
+    free(replay->polygon_colors);
+    free(replay);
+}
+
+static CG_BOOL CGReadCommandData(CGCommandReplay* replay, void* result, size_t size)
+{
+    if (size > replay->size - replay->position)
+        return CG_FALSE;
+    if (result != NULL)
+        memcpy(result, replay->data + replay->position, size);
+    replay->position += size;
+    return CG_TRUE;
+}
+
+static CG_BOOL CGReadCommandUInt(CGCommandReplay* replay, unsigned int* result)
+{
+    uint32_t data;
+    if (!CGReadCommandData(replay, &data, sizeof(data)))
+        return CG_FALSE;
+    *result = (unsigned int)data;
+    return CG_TRUE;
+}
+
+// reads a string into the buffer, which is grown when needed. The buffer is NULL if the string is NULL.
+static CG_BOOL CGReadCommandString(CGCommandReplay* replay, CGChar** buffer, size_t* capacity, CG_BOOL* is_null)
+{
+    unsigned int length;
+    if (!CGReadCommandUInt(replay, &length))
+        return CG_FALSE;
+    *is_null = length == CG_COMMAND_NULL_STRING;
+    if (*is_null)
+        return CG_TRUE;
+    if (buffer == NULL)
+        return CGReadCommandData(replay, NULL, sizeof(CGChar) * length);
+    if (*capacity < (size_t)length + 1)
+    {
+        CGChar* new_buffer = (CGChar*)realloc(*buffer, sizeof(CGChar) * ((size_t)length + 1));
+        if (new_buffer == NULL)
+            return CG_FALSE;
+        *buffer = new_buffer;
+        *capacity = (size_t)length + 1;
+    }
+    if (!CGReadCommandData(replay, *buffer, sizeof(CGChar) * length))
+        return CG_FALSE;
+    (*buffer)[length] = 0;
+    return CG_TRUE;
+}
+
+// reads a render property. The result is NULL if the property is NULL.
+static CG_BOOL CGReadCommandProperty(CGCommandReplay* replay, CGRenderObjectProperty* property, float* modify_matrix,
+    CGRenderObjectProperty** result)
+{
+    unsigned char flags;
+    if (!CGReadCommandData(replay, &flags, sizeof(flags)))
+        return CG_FALSE;
+    *result = NULL;
+    if (flags == 0)
+        return CG_TRUE;
+    if (!CGReadCommandData(replay, &property->rotation, sizeof(float)) ||
+        !CGReadCommandData(replay, &property->z, sizeof(float)) ||
+        !CGReadCommandData(replay, &property->color, sizeof(CGColor)) ||
+        !CGReadCommandData(replay, &property->transform, sizeof(CGVector2)) ||
+        !CGReadCommandData(replay, &property->scale, sizeof(CGVector2)))
+        return CG_FALSE;
+    property->modify_matrix = NULL;
+    property->is_opaque = (flags & 4) ? CG_TRUE : CG_FALSE;
+    if (flags & 2)
+    {
+        if (!CGReadCommandData(replay, modify_matrix, sizeof(float) * 16))
+            return CG_FALSE;
+        property->modify_matrix = modify_matrix;
+    }
+    *result = property;
+    return CG_TRUE;
+}
+
+static unsigned int CGFindReplayTexture(const CGCommandReplay* replay, unsigned int recorded_id)
+{
+    for (unsigned int i = 0; i < replay->texture_count; ++i)
+    {
+        if (replay->textures[i].recorded_id == recorded_id)
+            return i;
+    }
+    return replay->texture_count;
+}
+
+static CG_BOOL CGReplayTextureCommand(CGCommandReplay* replay, CG_BOOL is_executed)
+{
+    unsigned int recorded_id, width, height, channels;
+    if (!CGReadCommandUInt(replay, &recorded_id) || !CGReadCommandUInt(replay, &width) ||
+        !CGReadCommandUInt(replay, &height) || !CGReadCommandUInt(replay, &channels))
+        return CG_FALSE;
+    CGImage image = {(int)width, (int)height, (int)channels, replay->data + replay->position};
+    if (!CGReadCommandData(replay, NULL, (size_t)width * height * channels))
+        return CG_FALSE;
+    if (!is_executed)
+        return CG_TRUE;
+    unsigned int texture_id = CGCreateTexture(&image);
+    CG_ERROR_COND_RETURN(texture_id == 0, CG_FALSE, CGSTR("Failed to create replayed texture."));
+    unsigned int index = CGFindReplayTexture(replay, recorded_id);
+    if (index < replay->texture_count)
+    {
+        CGDeleteTexture(replay->textures[index].texture_id);
+        replay->textures[index].texture_id = texture_id;
+        return CG_TRUE;
+    }
+    if (replay->texture_count == replay->texture_capacity)
+    {
+        unsigned int capacity = replay->texture_capacity == 0 ? 16 : replay->texture_capacity * 2;
+        CGReplayTexture* textures = (CGReplayTexture*)realloc(replay->textures, sizeof(CGReplayTexture) * capacity);
+        if (textures == NULL)
+        {
+            CGDeleteTexture(texture_id);
+            CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to allocate memory for replayed textures."));
+        }
+        replay->textures = textures;
+        replay->texture_capacity = capacity;
+    }
+    replay->textures[replay->texture_count].recorded_id = recorded_id;
+    replay->textures[replay->texture_count].texture_id = texture_id;
+    ++replay->texture_count;
+    return CG_TRUE;
+}
+
+static CG_BOOL CGReadReplayPolygon(CGCommandReplay* replay, CG_BOOL is_executed, unsigned int* vertex_count)
+{
+    if (!CGReadCommandUInt(replay, vertex_count) || *vertex_count < 3)
+        return CG_FALSE;
+    if (!is_executed)
+        return CGReadCommandData(replay, NULL, (sizeof(CGVector2) + sizeof(CGColor)) * (*vertex_count));
+    if (replay->polygon_capacity < *vertex_count)
+    {
+        CGVector2* vertices = (CGVector2*)realloc(replay->polygon_vertices, sizeof(CGVector2) * (*vertex_count));
+        if (vertices != NULL)
+            replay->polygon_vertices = vertices;
+        CGColor* colors = (CGColor*)realloc(replay->polygon_colors, sizeof(CGColor) * (*vertex_count));
+        if (colors != NULL)
+            replay->polygon_colors = colors;
+        CG_ERROR_COND_RETURN(vertices == NULL || colors == NULL, CG_FALSE, CGSTR("Failed to allocate memory for replayed polygon."));
+        replay->polygon_capacity = *vertex_count;
+    }
+    for (unsigned int i = 0; i < *vertex_count; ++i)
+    {
+        if (!CGReadCommandData(replay, &replay->polygon_vertices[i], sizeof(CGVector2)) ||
+            !CGReadCommandData(replay, &replay->polygon_colors[i], sizeof(CGColor)))
+            return CG_FALSE;
+    }
+    return CG_TRUE;
+}
+
+// reads a draw command, and draws it into the window if it is not NULL
+static CG_BOOL CGReplayDrawCommand(CGCommandReplay* replay, CGReplayDrawSlot* slot, CGWindow* window)
+{
+    int32_t object_type;
+    if (!CGReadCommandData(replay, &object_type, sizeof(object_type)))
+        return CG_FALSE;
+    CGRenderObjectProperty* property;
+    if (!CGReadCommandProperty(replay, &slot->property, slot->modify_matrix, &property))
+        return CG_FALSE;
+    void* object = slot;
+    switch (object_type)
+    {
+    case CG_RD_TYPE_TRIANGLE:
+        object = &slot->triangle;
+        slot->triangle.is_temp = CG_FALSE;
+        if (!CGReadCommandData(replay, slot->triangle.vertices, sizeof(CGVector2) * 3))
+            return CG_FALSE;
+        break;
+    case CG_RD_TYPE_QUADRANGLE:
+        object = &slot->quadrangle;
+        slot->quadrangle.is_temp = CG_FALSE;
+        if (!CGReadCommandData(replay, slot->quadrangle.vertices, sizeof(CGVector2) * 4))
+            return CG_FALSE;
+        break;
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+        object = &slot->colored_triangle;
+        slot->colored_triangle.is_temp = CG_FALSE;
+        if (!CGReadCommandData(replay, slot->colored_triangle.vertices, sizeof(CGVector2) * 3) ||
+            !CGReadCommandData(replay, slot->colored_triangle.colors, sizeof(CGColor) * 3))
+            return CG_FALSE;
+        break;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        object = &slot->colored_quadrangle;
+        slot->colored_quadrangle.is_temp = CG_FALSE;
+        if (!CGReadCommandData(replay, slot->colored_quadrangle.vertices, sizeof(CGVector2) * 4) ||
+            !CGReadCommandData(replay, slot->colored_quadrangle.colors, sizeof(CGColor) * 4))
+            return CG_FALSE;
+        break;
+    case CG_RD_TYPE_POLYGON:
+    case CG_RD_TYPE_COLORED_POLYGON:
+    {
+        unsigned int vertex_count;
+        if (!CGReadReplayPolygon(replay, window != NULL, &vertex_count))
+            return CG_FALSE;
+        if (window == NULL)
+            return CG_TRUE;
+        // the polygon is deleted after the window is drawn
+        object = CGCreateColoredPolygon(replay->polygon_vertices, replay->polygon_colors, vertex_count, CG_TRUE);
+        CG_ERROR_COND_RETURN(object == NULL, CG_FALSE, CGSTR("Failed to create replayed polygon."));
+        break;
+    }
+    case CG_RD_TYPE_VISUAL_IMAGE:
+    {
+        CGVisualImage* visual_image = &slot->visual_image;
+        object = visual_image;
+        unsigned int recorded_id;
+        unsigned char flags[3];
+        if (!CGReadCommandUInt(replay, &recorded_id) ||
+            !CGReadCommandUInt(replay, &visual_image->img_width) ||
+            !CGReadCommandUInt(replay, &visual_image->img_height) ||
+            !CGReadCommandUInt(replay, &visual_image->img_channels) ||
+            !CGReadCommandData(replay, flags, sizeof(flags)) ||
+            !CGReadCommandData(replay, &visual_image->clamp_top_left, sizeof(CGVector2)) ||
+            !CGReadCommandData(replay, &visual_image->clamp_bottom_right, sizeof(CGVector2)))
+            return CG_FALSE;
+        visual_image->is_clamped = (CG_BOOL)flags[0];
+        visual_image->has_transparency = (CG_BOOL)flags[1];
+        visual_image->is_premultiplied = (CG_BOOL)flags[2];
+        visual_image->is_temp = CG_FALSE;
+        visual_image->in_window = window;
+        if (window == NULL)
+            break;
+        unsigned int index = CGFindReplayTexture(replay, recorded_id);
+        CG_ERROR_COND_RETURN(index == replay->texture_count, CG_FALSE, CGSTR("Replayed visual image has an unknown texture %u."), recorded_id);
+        visual_image->texture_id = replay->textures[index].texture_id;
+        break;
+    }
+    default:
+        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Unknown object type %d in command stream."), (int)object_type);
+    }
+    if (window != NULL)
+        CGDraw(object, property, window, object_type);
+    return CG_TRUE;
+}
+
+static CG_BOOL CGReplayDrawTextCommand(CGCommandReplay* replay, CGWindow* window)
+{
+    CG_BOOL is_text_null, is_font_null;
+    if (!CGReadCommandString(replay, window != NULL ? &replay->text : NULL, &replay->text_capacity, &is_text_null) ||
+        !CGReadCommandString(replay, window != NULL ? &replay->font_rk : NULL, &replay->font_rk_capacity, &is_font_null) ||
+        is_text_null)
+        return CG_FALSE;
+    unsigned int text_property[4];
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        if (!CGReadCommandUInt(replay, &text_property[i]))
+            return CG_FALSE;
+    }
+    CGVector2 position;
+    if (!CGReadCommandData(replay, &position, sizeof(CGVector2)))
+        return CG_FALSE;
+    // text is drawn immediately, so the property is only needed in this call
+    CGRenderObjectProperty property_data;
+    float modify_matrix[16];
+    CGRenderObjectProperty* property;
+    if (!CGReadCommandProperty(replay, &property_data, modify_matrix, &property))
+        return CG_FALSE;
+    if (window == NULL)
+        return CG_TRUE;
+    const CGChar* font_rk = is_font_null ? NULL : replay->font_rk;
+    CGTextProperty replayed_text_property = CGConstructTextProperty(text_property[0], text_property[1], text_property[2], text_property[3]);
+    if (position.x == 0.0f && position.y == 0.0f)
+    {
+        CGDrawTextRaw(replay->text, font_rk, replayed_text_property, property, window);
+        return CG_TRUE;
+    }
+    // only a batch can move a text, so the text of a batch is replayed in a batch of its own
+    CGTextBatch* batch = CGCreateTextBatch();
+    if (batch == NULL)
+        return CG_TRUE;
+    if (CGAddTextToBatch(batch, replay->text, font_rk, replayed_text_property, position))
+        CGDrawTextBatch(batch, property, window);
+    CGFree(batch);
+    return CG_TRUE;
+}
+
+// check every command of the stream, and count its frames and the objects drawn in them
+static CG_BOOL CGScanCommandReplay(CGCommandReplay* replay, size_t start)
+{
+    unsigned int draw_count = 0;
+    unsigned int frame_capacity = 0;
+    CGReplayDrawSlot slot;
+    replay->position = start;
+    while (replay->position < replay->size)
+    {
+        unsigned char command = replay->data[replay->position++];
+        CG_BOOL is_valid = CG_TRUE;
+        switch (command)
+        {
+        case CG_COMMAND_FRAME:
+        {
+            if (replay->frame_count == frame_capacity)
+            {
+                frame_capacity = frame_capacity == 0 ? 64 : frame_capacity * 2;
+                double* frame_times = (double*)realloc(replay->frame_times, sizeof(double) * frame_capacity);
+                CG_ERROR_COND_RETURN(frame_times == NULL, CG_FALSE, CGSTR("Failed to allocate memory for replay frames."));
+                replay->frame_times = frame_times;
+            }
+            is_valid = CGReadCommandData(replay, &replay->frame_times[replay->frame_count], sizeof(double));
+            ++replay->frame_count;
+            draw_count = 0;
+            break;
+        }
+        case CG_COMMAND_TEXTURE:
+            is_valid = CGReplayTextureCommand(replay, CG_FALSE);
+            break;
+        case CG_COMMAND_DRAW:
+            is_valid = CGReplayDrawCommand(replay, &slot, NULL);
+            ++draw_count;
+            if (draw_count > replay->draw_slot_count)
+                replay->draw_slot_count = draw_count;
+            break;
+        case CG_COMMAND_DRAW_TEXT:
+            is_valid = CGReplayDrawTextCommand(replay, NULL);
+            break;
+        case CG_COMMAND_WINDOW_DRAW:
+            break;
+        default:
+            is_valid = CG_FALSE;
+        }
+        CG_ERROR_COND_RETURN(!is_valid, CG_FALSE, CGSTR("Invalid command stream: The command at byte %u is corrupted."),
+            (unsigned int)replay->position);
+    }
+    return CG_TRUE;
+}
+
+CGCommandReplay* CGLoadCommandReplay(const CGChar* path)
+{
+    CG_ERROR_COND_RETURN(path == NULL, NULL, CGSTR("Cannot load command replay with NULL path."));
+    CGCommandReplay* replay = (CGCommandReplay*)calloc(1, sizeof(CGCommandReplay));
+    CG_ERROR_COND_RETURN(replay == NULL, NULL, CGSTR("Failed to allocate memory for command replay."));
+    char path_c[512];
+    CGCharToChar(path, path_c, sizeof(path_c));
+    FILE* file = fopen(path_c, "rb");
+    if (file == NULL)
+    {
+        free(replay);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to open command stream file."));
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0)
+        replay->data = (CGUByte*)malloc((size_t)size);
+    if (replay->data == NULL || fread(replay->data, (size_t)size, 1, file) != 1)
+    {
+        fclose(file);
+        CGDeleteCommandReplay(replay);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to read command stream file."));
+    }
+    fclose(file);
+    replay->size = (size_t)size;
+
+    CGCommandStreamHeader header;
+    if (!CGReadCommandData(replay, &header, sizeof(header)) ||
+        memcmp(header.magic, cg_command_stream_magic, sizeof(header.magic)) != 0 ||
+        header.version != CG_COMMAND_STREAM_VERSION || header.char_size != sizeof(CGChar))
+    {
+        CGDeleteCommandReplay(replay);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Invalid command stream: The file is not a command stream of this version."));
+    }
+    replay->window_width = header.window_width;
+    replay->window_height = header.window_height;
+    if (!CGScanCommandReplay(replay, sizeof(header)))
+    {
+        CGDeleteCommandReplay(replay);
+        return NULL;
+    }
+    replay->draw_slots = (CGReplayDrawSlot*)malloc(sizeof(CGReplayDrawSlot) * (replay->draw_slot_count + 1));
+    if (replay->draw_slots == NULL)
+    {
+        CGDeleteCommandReplay(replay);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to allocate memory for command replay."));
+    }
+    replay->position = sizeof(header);
+    CGRegisterResource(replay, CG_DELETER(CGDeleteCommandReplay));
+    return replay;
+}
+
+void CGGetCommandReplayWindowSize(const CGCommandReplay* replay, int* width, int* height)
+{
+    CG_ERROR_CONDITION(replay == NULL, CGSTR("Cannot get window size of NULL command replay."));
+    if (width != NULL)
+        *width = replay->window_width;
+    if (height != NULL)
+        *height = replay->window_height;
+}
+
+unsigned int CGGetCommandReplayFrameCount(const CGCommandReplay* replay)
+{
+    CG_ERROR_COND_RETURN(replay == NULL, 0, CGSTR("Cannot get frame count of NULL command replay."));
+    return replay->frame_count;
+}
+
+double CGGetCommandReplayFrameTime(const CGCommandReplay* replay, unsigned int frame)
+{
+    CG_ERROR_COND_RETURN(replay == NULL, 0.0, CGSTR("Cannot get frame time of NULL command replay."));
+    if (frame >= replay->frame_count)
+        return 0.0;
+    return replay->frame_times[frame];
+}
+
+CG_BOOL CGReplayCommandFrame(CGCommandReplay* replay, CGWindow* window)
+{
+    CG_ERROR_COND_RETURN(replay == NULL || window == NULL, CG_FALSE, CGSTR("Failed to replay frame: Replay and window cannot be NULL."));
+    CG_BOOL is_frame_started = CG_FALSE;
+    unsigned int draw_count = 0;
+    // the stream is checked when it is loaded, so the commands can only fail to be executed
+    while (replay->position < replay->size)
+    {
+        unsigned char command = replay->data[replay->position];
+        if (command == CG_COMMAND_FRAME)
+        {
+            if (is_frame_started)
+                break;
+            replay->position += 1 + sizeof(double);
+            CGTickRenderStart(window);
+            is_frame_started = CG_TRUE;
+            continue;
+        }
+        ++replay->position;
+        switch (command)
+        {
+        case CG_COMMAND_TEXTURE:
+            CGReplayTextureCommand(replay, CG_TRUE);
+            break;
+        case CG_COMMAND_DRAW:
+            CGReplayDrawCommand(replay, &replay->draw_slots[draw_count++], window);
+            break;
+        case CG_COMMAND_DRAW_TEXT:
+            CGReplayDrawTextCommand(replay, window);
+            break;
+        case CG_COMMAND_WINDOW_DRAW:
+            CGWindowDraw(window);
+            break;
+        }
+    }
+    return is_frame_started;
+}
+
+void CGRewindCommandReplay(CGCommandReplay* replay)
+{
+    CG_ERROR_CONDITION(replay == NULL, CGSTR("Cannot rewind NULL command replay."));
+    replay->position = sizeof(CGCommandStreamHeader);
+}
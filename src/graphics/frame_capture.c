@@ -0,0 +1,173 @@
+#include "cos_graphics/frame_capture.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/log.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdlib.h>
+
+/**
+ * @brief A pixel buffer of the ring, and the frame that is being read into it.
+ */
+typedef struct{
+    unsigned int pixel_buffer;
+    /**
+     * @brief The size of the pixel buffer in bytes.
+     */
+    size_t size;
+    /**
+     * @brief Signaled when the frame is copied into the pixel buffer. NULL if the buffer is not in use.
+     */
+    GLsync fence;
+    int width;
+    int height;
+    unsigned int index;
+}CGFrameCaptureBuffer;
+
+struct CGFrameCapture{
+    CGWindow* window;
+    CGFrameCaptureBuffer* buffers;
+    unsigned int buffer_count;
+    /**
+     * @brief The buffer that the next frame is captured into.
+     */
+    unsigned int next_buffer;
+    /**
+     * @brief The count of buffers in use. The oldest one is pending_count buffers before next_buffer.
+     */
+    unsigned int pending_count;
+    unsigned int frame_count;
+    CGFrameCaptureCallback callback;
+    void* user_data;
+};
+
+static void CGMakeFrameCaptureContextCurrent(CGFrameCapture* capture)
+{
+    if (glfwGetCurrentContext() != capture->window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)capture->window->glfw_window_instance);
+}
+
+static void CGDeleteFrameCapture(CGFrameCapture* capture)
+{
+    if (capture == NULL)
+        return;
+    // the contexts share their buffers, so any current context can delete them. Without a current
+    // context the graphics is terminated, and the buffers are deleted with the contexts.
+    if (glfwGetCurrentContext() != NULL)
+    {
+        for (unsigned int i = 0; i < capture->buffer_count; ++i)
+        {
+            if (capture->buffers[i].fence != NULL)
+                glDeleteSync(capture->buffers[i].fence);
+            glDeleteBuffers(1, &capture->buffers[i].pixel_buffer);
+        }
+    }
+    free(capture->buffers);
+    free(capture);
+}
+
+CGFrameCapture* CGCreateFrameCapture(CGWindow* window, unsigned int buffer_count, CGFrameCaptureCallback callback, void* user_data)
+{
+    CG_ERROR_COND_RETURN(window == NULL || callback == NULL, NULL, CGSTR("Failed to create frame capture: Window and callback cannot be NULL."));
+    CG_ERROR_COND_RETURN(buffer_count == 0, NULL, CGSTR("Failed to create frame capture: Buffer count cannot be 0."));
+    CGFrameCapture* capture = (CGFrameCapture*)malloc(sizeof(CGFrameCapture));
+    CG_ERROR_COND_RETURN(capture == NULL, NULL, CGSTR("Failed to allocate memory for frame capture."));
+    capture->buffers = (CGFrameCaptureBuffer*)calloc(buffer_count, sizeof(CGFrameCaptureBuffer));
+    if (capture->buffers == NULL)
+    {
+        free(capture);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to allocate memory for frame capture."));
+    }
+    capture->window = window;
+    capture->buffer_count = buffer_count;
+    capture->next_buffer = 0;
+    capture->pending_count = 0;
+    capture->frame_count = 0;
+    capture->callback = callback;
+    capture->user_data = user_data;
+    CGMakeFrameCaptureContextCurrent(capture);
+    for (unsigned int i = 0; i < buffer_count; ++i)
+        glGenBuffers(1, &capture->buffers[i].pixel_buffer);
+    CGRegisterResource(capture, CG_DELETER(CGDeleteFrameCapture));
+    return capture;
+}
+
+// hand the oldest captured frame to the callback. Returns CG_FALSE if it is not finished and wait is CG_FALSE.
+static CG_BOOL CGDeliverOldestFrame(CGFrameCapture* capture, CG_BOOL wait)
+{
+    CGFrameCaptureBuffer* buffer = &capture->buffers[
+        (capture->next_buffer + capture->buffer_count - capture->pending_count) % capture->buffer_count];
+    GLenum status = glClientWaitSync(buffer->fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return CG_FALSE;
+    glDeleteSync(buffer->fence);
+    buffer->fence = NULL;
+    --capture->pending_count;
+    CG_ERROR_COND_RETURN(status == GL_WAIT_FAILED, CG_FALSE, CGSTR("Failed to wait for frame capture."));
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer->pixel_buffer);
+    const CGUByte* pixels = (const CGUByte*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)buffer->size, GL_MAP_READ_BIT);
+    if (pixels != NULL)
+    {
+        CGCapturedFrame frame = {pixels, buffer->width, buffer->height, buffer->index};
+        capture->callback(&frame, capture->user_data);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    CG_ERROR_COND_RETURN(pixels == NULL, CG_FALSE, CGSTR("Failed to map frame capture buffer."));
+    return CG_TRUE;
+}
+
+CG_BOOL CGCaptureFrame(CGFrameCapture* capture)
+{
+    CG_ERROR_COND_RETURN(capture == NULL, CG_FALSE, CGSTR("Cannot capture frame with NULL frame capture."));
+    CGMakeFrameCaptureContextCurrent(capture);
+    if (capture->pending_count == capture->buffer_count)
+        CGDeliverOldestFrame(capture, CG_TRUE);
+
+    CGFrameCaptureBuffer* buffer = &capture->buffers[capture->next_buffer];
+    int width, height;
+    CGGetWindowFrameBufferSize(capture->window, &width, &height);
+    size_t size = (size_t)width * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer->pixel_buffer);
+    // the buffer is only reallocated when the size of the window changes
+    if (buffer->size != size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_READ);
+        buffer->size = size;
+    }
+    CGBindWindowReadFrameBuffer(capture->window);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // with a pixel pack buffer bound, glReadPixels returns without waiting for the copy
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    buffer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    buffer->width = width;
+    buffer->height = height;
+    buffer->index = capture->frame_count++;
+    capture->next_buffer = (capture->next_buffer + 1) % capture->buffer_count;
+    ++capture->pending_count;
+    return CG_TRUE;
+}
+
+unsigned int CGPollFrameCapture(CGFrameCapture* capture)
+{
+    CG_ERROR_COND_RETURN(capture == NULL, 0, CGSTR("Cannot poll NULL frame capture."));
+    CGMakeFrameCaptureContextCurrent(capture);
+    unsigned int result = 0;
+    while (capture->pending_count != 0 && CGDeliverOldestFrame(capture, CG_FALSE))
+        ++result;
+    return result;
+}
+
+unsigned int CGFinishFrameCapture(CGFrameCapture* capture)
+{
+    CG_ERROR_COND_RETURN(capture == NULL, 0, CGSTR("Cannot finish NULL frame capture."));
+    CGMakeFrameCaptureContextCurrent(capture);
+    unsigned int result = 0;
+    while (capture->pending_count != 0)
+    {
+        if (CGDeliverOldestFrame(capture, CG_TRUE))
+            ++result;
+    }
+    return result;
+}
@@ -0,0 +1,401 @@
+#include "cos_graphics/frame_encoder.h"
+#include "cos_graphics/profiler.h"
+#include "cos_graphics/thread.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/utils.h"
+#include "cos_graphics/log.h"
+#include <png.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A frame in the queue of the encoder. The frames are allocated once and reused.
+ */
+typedef struct{
+    CGUByte* pixels;
+    size_t capacity;
+    int width;
+    int height;
+    unsigned int index;
+    /**
+     * @brief The frame converted for the stream. Only used by Y4M encoders.
+     */
+    CGUByte* converted;
+    size_t converted_capacity;
+}CGEncoderFrame;
+
+struct CGFrameEncoder{
+    int format;
+    char path[256];
+    unsigned int frame_rate;
+    /**
+     * @brief The stream that Y4M frames are written into.
+     */
+    FILE* stream;
+    int stream_width;
+    int stream_height;
+    /**
+     * @brief The index of the next frame to be written into the stream, so that frames
+     * encoded by different workers are written in order.
+     */
+    unsigned int next_write_index;
+
+    CGEncoderFrame* frames;
+    unsigned int queue_size;
+    /**
+     * @brief The frames that are not in use.
+     */
+    unsigned int* free_frames;
+    unsigned int free_count;
+    /**
+     * @brief The frames that wait to be encoded, as a ring from queue_head.
+     */
+    unsigned int* queue;
+    unsigned int queue_head;
+    unsigned int queue_count;
+    /**
+     * @brief The count of frames that are being encoded.
+     */
+    unsigned int encoding_count;
+    unsigned int frame_count;
+    unsigned int dropped_count;
+    unsigned int failed_count;
+    CG_BOOL is_stopping;
+
+    CGMutex* mutex;
+    /**
+     * @brief Signaled when a frame is added to the queue, or the encoder is stopping.
+     */
+    CGCondition* frame_queued;
+    /**
+     * @brief Signaled when a frame is encoded, or a frame is written into the stream.
+     */
+    CGCondition* frame_done;
+    CGThread** threads;
+    unsigned int thread_count;
+};
+
+// check that a PNG path has exactly one conversion of the frame index, such as %u or %05d, and no
+// other conversion than %%, so that the path of the user can be passed to snprintf as the format
+static CG_BOOL CGIsFramePathFormatValid(const char* path)
+{
+    unsigned int conversion_count = 0;
+    for (const char* p = path; *p != 0; ++p)
+    {
+        if (*p != '%')
+            continue;
+        ++p;
+        if (*p == '%')
+            continue;
+        while (*p == '0' || *p == '-' || *p == '+' || *p == ' ')
+            ++p;
+        while (*p >= '0' && *p <= '9')
+            ++p;
+        if (*p != 'u' && *p != 'd' && *p != 'i')
+            return CG_FALSE;
+        ++conversion_count;
+    }
+    return conversion_count == 1;
+}
+
+static CG_BOOL CGWritePNGFrame(const CGFrameEncoder* encoder, const CGEncoderFrame* frame)
+{
+    char path[512];
+    snprintf(path, sizeof(path), encoder->path, frame->index);
+    png_bytep* rows = (png_bytep*)malloc(sizeof(png_bytep) * frame->height);
+    if (rows == NULL)
+        return CG_FALSE;
+    // the rows of captured frames start from the bottom
+    size_t row_size = (size_t)frame->width * 4;
+    for (int i = 0; i < frame->height; ++i)
+        rows[i] = frame->pixels + row_size * (frame->height - 1 - i);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        free(rows);
+        return CG_FALSE;
+    }
+    CG_BOOL is_success = CG_FALSE;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png == NULL ? NULL : png_create_info_struct(png);
+    if (info != NULL && setjmp(png_jmpbuf(png)) == 0)
+    {
+        png_init_io(png, file);
+        // the fastest compression keeps up with the frame rate, at the cost of larger files
+        png_set_compression_level(png, 1);
+        png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+        png_set_IHDR(png, info, (png_uint_32)frame->width, (png_uint_32)frame->height, 8, PNG_COLOR_TYPE_RGBA,
+            PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(png, info);
+        png_write_image(png, rows);
+        png_write_end(png, NULL);
+        is_success = CG_TRUE;
+    }
+    png_destroy_write_struct(&png, &info);
+    fclose(file);
+    free(rows);
+    return is_success;
+}
+
+static CG_BOOL CGConvertY4MFrame(CGEncoderFrame* frame)
+{
+    size_t plane_size = (size_t)frame->width * frame->height;
+    if (frame->converted_capacity < plane_size * 3)
+    {
+        CGUByte* converted = (CGUByte*)realloc(frame->converted, plane_size * 3);
+        if (converted == NULL)
+            return CG_FALSE;
+        frame->converted = converted;
+        frame->converted_capacity = plane_size * 3;
+    }
+    CGUByte* y_plane = frame->converted;
+    CGUByte* cb_plane = y_plane + plane_size;
+    CGUByte* cr_plane = cb_plane + plane_size;
+    for (int row = 0; row < frame->height; ++row)
+    {
+        // the rows of captured frames start from the bottom
+        const CGUByte* pixel = frame->pixels + (size_t)frame->width * 4 * (frame->height - 1 - row);
+        size_t offset = (size_t)frame->width * row;
+        for (int column = 0; column < frame->width; ++column, pixel += 4, ++offset)
+        {
+            // BT.601 in the limited range, which is what players expect from Y4M
+            int r = pixel[0], g = pixel[1], b = pixel[2];
+            y_plane[offset] = (CGUByte)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            cb_plane[offset] = (CGUByte)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            cr_plane[offset] = (CGUByte)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+    return CG_TRUE;
+}
+
+// write a converted frame into the stream after the frames before it. The mutex must be locked.
+static CG_BOOL CGWriteY4MFrame(CGFrameEncoder* encoder, const CGEncoderFrame* frame, CG_BOOL is_converted)
+{
+    while (encoder->next_write_index != frame->index)
+        CGWaitCondition(encoder->frame_done, encoder->mutex);
+    CG_BOOL is_success = is_converted && encoder->stream != NULL;
+    if (is_success)
+    {
+        size_t frame_size = (size_t)frame->width * frame->height * 3;
+        is_success = fputs("FRAME\n", encoder->stream) >= 0
+            && fwrite(frame->converted, 1, frame_size, encoder->stream) == frame_size;
+    }
+    ++encoder->next_write_index;
+    CGBroadcastCondition(encoder->frame_done);
+    return is_success;
+}
+
+static void CGFrameEncoderWorker(void* user_data)
+{
+    CGFrameEncoder* encoder = (CGFrameEncoder*)user_data;
+    CGLockMutex(encoder->mutex);
+    while (CG_TRUE)
+    {
+        while (encoder->queue_count == 0 && !encoder->is_stopping)
+            CGWaitCondition(encoder->frame_queued, encoder->mutex);
+        if (encoder->queue_count == 0)
+            break;
+        unsigned int frame_id = encoder->queue[encoder->queue_head];
+        encoder->queue_head = (encoder->queue_head + 1) % encoder->queue_size;
+        --encoder->queue_count;
+        ++encoder->encoding_count;
+        CGEncoderFrame* frame = &encoder->frames[frame_id];
+        CGUnlockMutex(encoder->mutex);
+
+        CG_PROFILE_BEGIN(EncodeFrame);
+        CG_BOOL is_success;
+        if (encoder->format == CG_FRAME_FORMAT_PNG)
+            is_success = CGWritePNGFrame(encoder, frame);
+        else
+            is_success = CGConvertY4MFrame(frame);
+        CG_PROFILE_END(EncodeFrame);
+
+        CGLockMutex(encoder->mutex);
+        if (encoder->format == CG_FRAME_FORMAT_Y4M)
+            is_success = CGWriteY4MFrame(encoder, frame, is_success);
+        if (!is_success)
+            ++encoder->failed_count;
+        --encoder->encoding_count;
+        encoder->free_frames[encoder->free_count++] = frame_id;
+        CGBroadcastCondition(encoder->frame_done);
+    }
+    CGUnlockMutex(encoder->mutex);
+}
+
+static void CGDeleteFrameEncoder(CGFrameEncoder* encoder)
+{
+    if (encoder == NULL)
+        return;
+    if (encoder->mutex != NULL)
+    {
+        CGLockMutex(encoder->mutex);
+        encoder->is_stopping = CG_TRUE;
+        CGBroadcastCondition(encoder->frame_queued);
+        CGUnlockMutex(encoder->mutex);
+    }
+    // the workers encode the frames left in the queue before they stop
+    for (unsigned int i = 0; i < encoder->thread_count; ++i)
+        CGJoinThread(encoder->threads[i]);
+    if (encoder->stream != NULL)
+        fclose(encoder->stream);
+    for (unsigned int i = 0; i < encoder->queue_size && encoder->frames != NULL; ++i)
+    {
+        free(encoder->frames[i].pixels);
+        free(encoder->frames[i].converted);
+    }
+    free(encoder->frames);
+    free(encoder->free_frames);
+    free(encoder->queue);
+    free(encoder->threads);
+    CGDeleteCondition(encoder->frame_queued);
+    CGDeleteCondition(encoder->frame_done);
+    CGDeleteMutex(encoder->mutex);
+    free(encoder);
+}
+
+CGFrameEncoder* CGCreateFrameEncoder(int format, const CGChar* path, unsigned int frame_rate, unsigned int thread_count, unsigned int queue_size)
+{
+    CG_ERROR_COND_RETURN(format != CG_FRAME_FORMAT_PNG && format != CG_FRAME_FORMAT_Y4M, NULL,
+        CGSTR("Failed to create frame encoder: Unknown format: %d."), format);
+    CG_ERROR_COND_RETURN(path == NULL || queue_size == 0, NULL, CGSTR("Failed to create frame encoder: Path cannot be NULL and queue size cannot be 0."));
+    if (thread_count == 0)
+    {
+        // leave one processor for the render loop
+        thread_count = CGGetProcessorCount() > 1 ? CGGetProcessorCount() - 1 : 1;
+    }
+    CGFrameEncoder* encoder = (CGFrameEncoder*)calloc(1, sizeof(CGFrameEncoder));
+    CG_ERROR_COND_RETURN(encoder == NULL, NULL, CGSTR("Failed to allocate memory for frame encoder."));
+    encoder->format = format;
+    CGCharToChar(path, encoder->path, sizeof(encoder->path));
+    if (format == CG_FRAME_FORMAT_PNG && !CGIsFramePathFormatValid(encoder->path))
+    {
+        free(encoder);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL,
+            CGSTR("Failed to create frame encoder: The path must have exactly one conversion of the frame index, such as %%u, and no other %% than %%%%."));
+    }
+    encoder->frame_rate = frame_rate == 0 ? 60 : frame_rate;
+    encoder->queue_size = queue_size;
+    encoder->frames = (CGEncoderFrame*)calloc(queue_size, sizeof(CGEncoderFrame));
+    encoder->free_frames = (unsigned int*)malloc(sizeof(unsigned int) * queue_size);
+    encoder->queue = (unsigned int*)malloc(sizeof(unsigned int) * queue_size);
+    encoder->threads = (CGThread**)calloc(thread_count, sizeof(CGThread*));
+    encoder->mutex = CGCreateMutex();
+    encoder->frame_queued = CGCreateCondition();
+    encoder->frame_done = CGCreateCondition();
+    if (encoder->frames == NULL || encoder->free_frames == NULL || encoder->queue == NULL || encoder->threads == NULL
+        || encoder->mutex == NULL || encoder->frame_queued == NULL || encoder->frame_done == NULL)
+    {
+        CGDeleteFrameEncoder(encoder);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to allocate memory for frame encoder."));
+    }
+    for (unsigned int i = 0; i < queue_size; ++i)
+        encoder->free_frames[i] = i;
+    encoder->free_count = queue_size;
+    if (format == CG_FRAME_FORMAT_Y4M)
+    {
+        encoder->stream = fopen(encoder->path, "wb");
+        if (encoder->stream == NULL)
+        {
+            CGDeleteFrameEncoder(encoder);
+            CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to create frame encoder: Cannot open the stream file."));
+        }
+    }
+    for (; encoder->thread_count < thread_count; ++encoder->thread_count)
+    {
+        encoder->threads[encoder->thread_count] = CGCreateThread(CGFrameEncoderWorker, encoder);
+        if (encoder->threads[encoder->thread_count] == NULL)
+        {
+            CGDeleteFrameEncoder(encoder);
+            return NULL;
+        }
+    }
+    CGRegisterResource(encoder, CG_DELETER(CGDeleteFrameEncoder));
+    return encoder;
+}
+
+CG_BOOL CGEncodeFrame(CGFrameEncoder* encoder, const CGCapturedFrame* frame, CG_BOOL wait)
+{
+    CG_ERROR_COND_RETURN(encoder == NULL || frame == NULL || frame->pixels == NULL, CG_FALSE, CGSTR("Cannot encode NULL frame."));
+    CG_ERROR_COND_RETURN(frame->width <= 0 || frame->height <= 0, CG_FALSE, CGSTR("Cannot encode frame without pixels."));
+    if (encoder->format == CG_FRAME_FORMAT_Y4M)
+    {
+        // the size of a stream is written in its header, so it cannot be changed
+        if (encoder->stream_width == 0)
+        {
+            encoder->stream_width = frame->width;
+            encoder->stream_height = frame->height;
+            fprintf(encoder->stream, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n", frame->width, frame->height, encoder->frame_rate);
+        }
+        CG_ERROR_COND_RETURN(frame->width != encoder->stream_width || frame->height != encoder->stream_height, CG_FALSE,
+            CGSTR("Cannot encode frame of a different size into the stream."));
+    }
+    CGLockMutex(encoder->mutex);
+    while (encoder->free_count == 0 && wait)
+        CGWaitCondition(encoder->frame_done, encoder->mutex);
+    if (encoder->free_count == 0)
+    {
+        ++encoder->dropped_count;
+        CGUnlockMutex(encoder->mutex);
+        return CG_FALSE;
+    }
+    unsigned int frame_id = encoder->free_frames[--encoder->free_count];
+    CGUnlockMutex(encoder->mutex);
+
+    // the frame is not in the queue yet, so the workers don't touch it while it is copied
+    CGEncoderFrame* encoder_frame = &encoder->frames[frame_id];
+    size_t size = (size_t)frame->width * frame->height * 4;
+    if (encoder_frame->capacity < size)
+    {
+        CGUByte* pixels = (CGUByte*)realloc(encoder_frame->pixels, size);
+        if (pixels == NULL)
+        {
+            CGLockMutex(encoder->mutex);
+            encoder->free_frames[encoder->free_count++] = frame_id;
+            CGUnlockMutex(encoder->mutex);
+            CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to allocate memory for encoding frame."));
+        }
+        encoder_frame->pixels = pixels;
+        encoder_frame->capacity = size;
+    }
+    memcpy(encoder_frame->pixels, frame->pixels, size);
+    encoder_frame->width = frame->width;
+    encoder_frame->height = frame->height;
+
+    CGLockMutex(encoder->mutex);
+    encoder_frame->index = encoder->frame_count++;
+    encoder->queue[(encoder->queue_head + encoder->queue_count) % encoder->queue_size] = frame_id;
+    ++encoder->queue_count;
+    CGSignalCondition(encoder->frame_queued);
+    CGUnlockMutex(encoder->mutex);
+    return CG_TRUE;
+}
+
+void CGFinishFrameEncoder(CGFrameEncoder* encoder)
+{
+    CG_ERROR_CONDITION(encoder == NULL, CGSTR("Cannot finish NULL frame encoder."));
+    CGLockMutex(encoder->mutex);
+    while (encoder->queue_count != 0 || encoder->encoding_count != 0)
+        CGWaitCondition(encoder->frame_done, encoder->mutex);
+    if (encoder->stream != NULL)
+        fflush(encoder->stream);
+    CGUnlockMutex(encoder->mutex);
+}
+
+unsigned int CGGetFrameEncoderDroppedCount(CGFrameEncoder* encoder)
+{
+    CG_ERROR_COND_RETURN(encoder == NULL, 0, CGSTR("Cannot get dropped count of NULL frame encoder."));
+    CGLockMutex(encoder->mutex);
+    unsigned int result = encoder->dropped_count;
+    CGUnlockMutex(encoder->mutex);
+    return result;
+}
+
+unsigned int CGGetFrameEncoderFailedCount(CGFrameEncoder* encoder)
+{
+    CG_ERROR_COND_RETURN(encoder == NULL, 0, CGSTR("Cannot get failed count of NULL frame encoder."));
+    CGLockMutex(encoder->mutex);
+    unsigned int result = encoder->failed_count;
+    CGUnlockMutex(encoder->mutex);
+    return result;
+}
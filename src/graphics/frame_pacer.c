@@ -0,0 +1,129 @@
+#include "cos_graphics/frame_pacer.h"
+#include "cos_graphics/graphics.h"
+#include "cos_graphics/thread.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/log.h"
+#include <stdlib.h>
+
+struct CGFramePacer{
+    /**
+     * @brief The time of a frame in seconds. 0 if the frames are not limited.
+     */
+    double target_frame_time;
+    double spin_time;
+    /**
+     * @brief The time that the current frame should end at.
+     */
+    double deadline;
+    /**
+     * @brief The time that the last frame ended at. Negative before the first frame.
+     */
+    double last_frame_end;
+    /**
+     * @brief The frame times of the recent frames, as a ring.
+     */
+    double history[CG_FRAME_PACER_HISTORY_SIZE];
+    unsigned int history_count;
+    unsigned int history_next;
+    CGFrameTiming timing;
+};
+
+CGFramePacer* CGCreateFramePacer(double target_fps)
+{
+    CG_ERROR_COND_RETURN(target_fps < 0.0, NULL, CGSTR("Failed to create frame pacer: Target FPS cannot be negative."));
+    CGFramePacer* pacer = (CGFramePacer*)calloc(1, sizeof(CGFramePacer));
+    CG_ERROR_COND_RETURN(pacer == NULL, NULL, CGSTR("Failed to allocate memory for frame pacer."));
+    pacer->target_frame_time = target_fps > 0.0 ? 1.0 / target_fps : 0.0;
+    pacer->spin_time = CG_FRAME_PACER_DEFAULT_SPIN_TIME;
+    pacer->last_frame_end = -1.0;
+    CGRegisterResource(pacer, CG_DELETER(free));
+    return pacer;
+}
+
+void CGSetFramePacerTargetFPS(CGFramePacer* pacer, double target_fps)
+{
+    CG_ERROR_CONDITION(pacer == NULL, CGSTR("Cannot set target FPS of NULL frame pacer."));
+    CG_ERROR_CONDITION(target_fps < 0.0, CGSTR("Target FPS cannot be negative."));
+    pacer->target_frame_time = target_fps > 0.0 ? 1.0 / target_fps : 0.0;
+    // the next deadline is counted from the end of the last frame
+    pacer->deadline = pacer->last_frame_end + pacer->target_frame_time;
+}
+
+void CGSetFramePacerSpinTime(CGFramePacer* pacer, double spin_time)
+{
+    CG_ERROR_CONDITION(pacer == NULL, CGSTR("Cannot set spin time of NULL frame pacer."));
+    pacer->spin_time = spin_time > 0.0 ? spin_time : 0.0;
+}
+
+// wait until the deadline, sleeping until the spin time before it
+static void CGWaitFrameDeadline(const CGFramePacer* pacer, double now)
+{
+    // a simulated time doesn't advance while waiting
+    if (CGGetTimeSource() != CG_TIME_SOURCE_REAL)
+        return;
+    double sleep_time = pacer->deadline - now - pacer->spin_time;
+    if (sleep_time > 0.0)
+        CGSleepThread(sleep_time);
+    while (CGGetCurrentTime() < pacer->deadline);
+}
+
+void CGPaceFrame(CGFramePacer* pacer)
+{
+    CG_ERROR_CONDITION(pacer == NULL, CGSTR("Cannot pace frame with NULL frame pacer."));
+    double now = CGGetCurrentTime();
+    if (pacer->last_frame_end < 0.0)
+    {
+        // the first frame only starts the schedule
+        pacer->last_frame_end = now;
+        pacer->deadline = now + pacer->target_frame_time;
+        return;
+    }
+    double work_time = now - pacer->last_frame_end;
+    if (pacer->target_frame_time > 0.0)
+    {
+        if (now <= pacer->deadline)
+            CGWaitFrameDeadline(pacer, now);
+        else
+        {
+            ++pacer->timing.missed_count;
+            // start a new schedule instead of hurrying the following frames
+            if (now - pacer->deadline > pacer->target_frame_time)
+                pacer->deadline = now;
+        }
+        pacer->deadline += pacer->target_frame_time;
+    }
+    double frame_end = CGGetCurrentTime();
+    CGFrameTiming* timing = &pacer->timing;
+    timing->frame_time = frame_end - pacer->last_frame_end;
+    timing->work_time = work_time;
+    timing->wait_time = frame_end - now;
+    ++timing->frame_count;
+    pacer->last_frame_end = frame_end;
+
+    pacer->history[pacer->history_next] = timing->frame_time;
+    pacer->history_next = (pacer->history_next + 1) % CG_FRAME_PACER_HISTORY_SIZE;
+    if (pacer->history_count < CG_FRAME_PACER_HISTORY_SIZE)
+        ++pacer->history_count;
+}
+
+CGFrameTiming CGGetFrameTiming(const CGFramePacer* pacer)
+{
+    CGFrameTiming result = {0};
+    CG_ERROR_COND_RETURN(pacer == NULL, result, CGSTR("Cannot get frame timing of NULL frame pacer."));
+    result = pacer->timing;
+    if (pacer->history_count == 0)
+        return result;
+    double sum = 0.0;
+    result.min_frame_time = pacer->history[0];
+    result.max_frame_time = pacer->history[0];
+    for (unsigned int i = 0; i < pacer->history_count; ++i)
+    {
+        sum += pacer->history[i];
+        if (pacer->history[i] < result.min_frame_time)
+            result.min_frame_time = pacer->history[i];
+        if (pacer->history[i] > result.max_frame_time)
+            result.max_frame_time = pacer->history[i];
+    }
+    result.average_frame_time = sum / pacer->history_count;
+    return result;
+}
@@ -0,0 +1,299 @@
+#include "cos_graphics/glyph_atlas.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/utils.h"
+#include "cos_graphics/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A row of a page that glyphs are put in from left to right.
+ */
+typedef struct{
+    unsigned int y;
+    unsigned int height;
+    /**
+     * @brief The left of the space that is not used yet.
+     */
+    unsigned int x;
+}CGGlyphAtlasShelf;
+
+typedef struct{
+    CGGlyphAtlasShelf* shelves;
+    unsigned int shelf_count;
+    unsigned int shelf_capacity;
+    /**
+     * @brief The top of the space below the last shelf.
+     */
+    unsigned int bottom;
+    /**
+     * @brief The use tick of the atlas when a glyph in the page is last used.
+     */
+    unsigned long long last_used;
+}CGGlyphAtlasPage;
+
+typedef struct{
+    CGGlyphKey key;
+    CGAtlasGlyph glyph;
+}CGGlyphAtlasEntry;
+
+struct CGGlyphAtlas{
+    unsigned int page_size;
+    CGGlyphAtlasPage* pages;
+    unsigned int page_count;
+    unsigned int max_page_count;
+    /**
+     * @brief The glyphs, in no order.
+     */
+    CGGlyphAtlasEntry* entries;
+    unsigned int entry_count;
+    unsigned int entry_capacity;
+    /**
+     * @brief Open addressing hash table of entry index + 1, or 0 for an empty slot.
+     */
+    unsigned int* entry_table;
+    unsigned int entry_table_size;
+    unsigned long long use_tick;
+};
+
+static void CGDeleteGlyphAtlas(CGGlyphAtlas* atlas)
+{
+    if (atlas == NULL)
+        return;
+    for (unsigned int i = 0; i < atlas->page_count; ++i)
+        free(atlas->pages[i].shelves);
+    free(atlas->pages);
+    free(atlas->entries);
+    free(atlas->entry_table);
+    free(atlas);
+}
+
+CGGlyphAtlas* CGCreateGlyphAtlas(unsigned int page_size, unsigned int max_page_count)
+{
+    CG_ERROR_COND_RETURN(page_size == 0, NULL, CGSTR("Failed to create glyph atlas: Page size must be larger than 0."));
+    CG_ERROR_COND_RETURN(max_page_count == 0, NULL, CGSTR("Failed to create glyph atlas: Max page count must be larger than 0."));
+    CGGlyphAtlas* atlas = (CGGlyphAtlas*)CGCalloc(1, sizeof(CGGlyphAtlas));
+    CG_ERROR_COND_RETURN(atlas == NULL, NULL, CGSTR("Failed to allocate memory for glyph atlas."));
+    atlas->pages = (CGGlyphAtlasPage*)CGCalloc(max_page_count, sizeof(CGGlyphAtlasPage));
+    if (atlas->pages == NULL)
+    {
+        free(atlas);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to allocate memory for glyph atlas."));
+    }
+    atlas->page_size = page_size;
+    atlas->max_page_count = max_page_count;
+    CGRegisterResource(atlas, CG_DELETER(CGDeleteGlyphAtlas));
+    return atlas;
+}
+
+unsigned int CGGetGlyphAtlasPageSize(const CGGlyphAtlas* atlas)
+{
+    CG_ERROR_COND_RETURN(atlas == NULL, 0, CGSTR("Cannot get the page size of a NULL glyph atlas."));
+    return atlas->page_size;
+}
+
+unsigned int CGGetGlyphAtlasPageCount(const CGGlyphAtlas* atlas)
+{
+    CG_ERROR_COND_RETURN(atlas == NULL, 0, CGSTR("Cannot get the page count of a NULL glyph atlas."));
+    return atlas->page_count;
+}
+
+unsigned int CGGetGlyphAtlasGlyphCount(const CGGlyphAtlas* atlas)
+{
+    CG_ERROR_COND_RETURN(atlas == NULL, 0, CGSTR("Cannot get the glyph count of a NULL glyph atlas."));
+    return atlas->entry_count;
+}
+
+static unsigned int CGHashGlyphKey(const CGGlyphKey* key)
+{
+    unsigned long long hash = key->font ^ ((unsigned long long)key->codepoint * 0x9e3779b97f4a7c15ULL);
+    hash ^= ((unsigned long long)key->pixel_width << 32 | key->pixel_height) * 0xc2b2ae3d27d4eb4fULL;
+    hash ^= hash >> 29;
+    return (unsigned int)(hash ^ (hash >> 32));
+}
+
+static CG_BOOL CGIsGlyphKeyEqual(const CGGlyphKey* key_1, const CGGlyphKey* key_2)
+{
+    return key_1->font == key_2->font && key_1->codepoint == key_2->codepoint
+        && key_1->pixel_width == key_2->pixel_width && key_1->pixel_height == key_2->pixel_height;
+}
+
+static void CGInsertGlyphAtlasSlot(CGGlyphAtlas* atlas, unsigned int entry_index)
+{
+    unsigned int mask = atlas->entry_table_size - 1;
+    unsigned int slot = CGHashGlyphKey(&atlas->entries[entry_index].key) & mask;
+    while (atlas->entry_table[slot] != 0)
+        slot = (slot + 1) & mask;
+    atlas->entry_table[slot] = entry_index + 1;
+}
+
+// rebuild the hash table of the entries, with at least the given size
+static CG_BOOL CGRebuildGlyphAtlasTable(CGGlyphAtlas* atlas, unsigned int size)
+{
+    if (size != atlas->entry_table_size)
+    {
+        unsigned int* new_table = (unsigned int*)CGCalloc(size, sizeof(unsigned int));
+        CG_ERROR_COND_RETURN(new_table == NULL, CG_FALSE, CGSTR("Failed to allocate memory for glyph atlas."));
+        free(atlas->entry_table);
+        atlas->entry_table = new_table;
+        atlas->entry_table_size = size;
+    }
+    else
+        memset(atlas->entry_table, 0, sizeof(unsigned int) * size);
+    for (unsigned int i = 0; i < atlas->entry_count; ++i)
+        CGInsertGlyphAtlasSlot(atlas, i);
+    return CG_TRUE;
+}
+
+const CGAtlasGlyph* CGFindAtlasGlyph(CGGlyphAtlas* atlas, const CGGlyphKey* key)
+{
+    CG_ERROR_COND_RETURN(atlas == NULL || key == NULL, NULL, CGSTR("Cannot find glyph with NULL glyph atlas or key."));
+    if (atlas->entry_table_size == 0)
+        return NULL;
+    unsigned int mask = atlas->entry_table_size - 1;
+    for (unsigned int slot = CGHashGlyphKey(key) & mask; atlas->entry_table[slot] != 0; slot = (slot + 1) & mask)
+    {
+        CGGlyphAtlasEntry* entry = &atlas->entries[atlas->entry_table[slot] - 1];
+        if (CGIsGlyphKeyEqual(&entry->key, key))
+        {
+            if (entry->glyph.page != CG_GLYPH_ATLAS_NO_PAGE)
+                atlas->pages[entry->glyph.page].last_used = ++atlas->use_tick;
+            return &entry->glyph;
+        }
+    }
+    return NULL;
+}
+
+// allocate a space in a page. Returns CG_FALSE if the page doesn't have enough space.
+static CG_BOOL CGAllocateGlyphAtlasSpace(CGGlyphAtlas* atlas, CGGlyphAtlasPage* page, unsigned int width, unsigned int height,
+    unsigned int* x, unsigned int* y)
+{
+    CGGlyphAtlasShelf* best_shelf = NULL;
+    for (unsigned int i = 0; i < page->shelf_count; ++i)
+    {
+        CGGlyphAtlasShelf* shelf = &page->shelves[i];
+        if (shelf->height < height || shelf->x + width > atlas->page_size)
+            continue;
+        if (best_shelf == NULL || shelf->height < best_shelf->height)
+            best_shelf = shelf;
+    }
+    // a glyph much lower than the shelf wastes the space above it, so a new shelf is started instead if there is space
+    CG_BOOL can_add_shelf = page->bottom + height <= atlas->page_size;
+    if (best_shelf == NULL || (best_shelf->height > height * 2 && can_add_shelf))
+    {
+        if (!can_add_shelf)
+            return CG_FALSE;
+        if (page->shelf_count == page->shelf_capacity)
+        {
+            unsigned int new_capacity = page->shelf_capacity == 0 ? 8 : page->shelf_capacity * 2;
+            CGGlyphAtlasShelf* new_shelves = (CGGlyphAtlasShelf*)CGRealloc(page->shelves, sizeof(CGGlyphAtlasShelf) * new_capacity);
+            CG_ERROR_COND_RETURN(new_shelves == NULL, CG_FALSE, CGSTR("Failed to allocate memory for glyph atlas."));
+            page->shelves = new_shelves;
+            page->shelf_capacity = new_capacity;
+        }
+        best_shelf = &page->shelves[page->shelf_count++];
+        best_shelf->y = page->bottom;
+        best_shelf->height = height;
+        best_shelf->x = 0;
+        page->bottom += height;
+    }
+    *x = best_shelf->x;
+    *y = best_shelf->y;
+    best_shelf->x += width;
+    return CG_TRUE;
+}
+
+// remove all the glyphs in a page, and clear its shelves
+static void CGEvictGlyphAtlasPage(CGGlyphAtlas* atlas, unsigned int page_index)
+{
+    for (unsigned int i = 0; i < atlas->entry_count;)
+    {
+        if (atlas->entries[i].glyph.page == page_index)
+            atlas->entries[i] = atlas->entries[--atlas->entry_count];
+        else
+            ++i;
+    }
+    atlas->pages[page_index].shelf_count = 0;
+    atlas->pages[page_index].bottom = 0;
+    CGRebuildGlyphAtlasTable(atlas, atlas->entry_table_size);
+}
+
+const CGAtlasGlyph* CGAddAtlasGlyph(CGGlyphAtlas* atlas, const CGGlyphKey* key, unsigned int width, unsigned int height,
+    int left, int top, unsigned int* evicted_page)
+{
+    CG_ERROR_COND_RETURN(atlas == NULL || key == NULL, NULL, CGSTR("Cannot add glyph with NULL glyph atlas or key."));
+    if (evicted_page != NULL)
+        *evicted_page = CG_GLYPH_ATLAS_NO_PAGE;
+    CGAtlasGlyph glyph = {CG_GLYPH_ATLAS_NO_PAGE, 0, 0, width, height, left, top};
+    if (width != 0 && height != 0)
+    {
+        unsigned int padded_width = width + 2 * CG_GLYPH_ATLAS_PADDING;
+        unsigned int padded_height = height + 2 * CG_GLYPH_ATLAS_PADDING;
+        if (padded_width > atlas->page_size || padded_height > atlas->page_size)
+            return NULL;
+        unsigned int x, y;
+        for (unsigned int i = 0; i < atlas->page_count && glyph.page == CG_GLYPH_ATLAS_NO_PAGE; ++i)
+        {
+            if (CGAllocateGlyphAtlasSpace(atlas, &atlas->pages[i], padded_width, padded_height, &x, &y))
+                glyph.page = i;
+        }
+        if (glyph.page == CG_GLYPH_ATLAS_NO_PAGE)
+        {
+            if (atlas->page_count < atlas->max_page_count)
+                glyph.page = atlas->page_count++;
+            else
+            {
+                glyph.page = 0;
+                for (unsigned int i = 1; i < atlas->page_count; ++i)
+                {
+                    if (atlas->pages[i].last_used < atlas->pages[glyph.page].last_used)
+                        glyph.page = i;
+                }
+                CGEvictGlyphAtlasPage(atlas, glyph.page);
+                if (evicted_page != NULL)
+                    *evicted_page = glyph.page;
+            }
+            if (!CGAllocateGlyphAtlasSpace(atlas, &atlas->pages[glyph.page], padded_width, padded_height, &x, &y))
+                return NULL;
+        }
+        glyph.x = x + CG_GLYPH_ATLAS_PADDING;
+        glyph.y = y + CG_GLYPH_ATLAS_PADDING;
+        atlas->pages[glyph.page].last_used = ++atlas->use_tick;
+    }
+
+    if (atlas->entry_count == atlas->entry_capacity)
+    {
+        unsigned int new_capacity = atlas->entry_capacity == 0 ? 128 : atlas->entry_capacity * 2;
+        CGGlyphAtlasEntry* new_entries = (CGGlyphAtlasEntry*)CGRealloc(atlas->entries, sizeof(CGGlyphAtlasEntry) * new_capacity);
+        CG_ERROR_COND_RETURN(new_entries == NULL, NULL, CGSTR("Failed to allocate memory for glyph atlas."));
+        atlas->entries = new_entries;
+        atlas->entry_capacity = new_capacity;
+    }
+    unsigned int entry_index = atlas->entry_count++;
+    atlas->entries[entry_index].key = *key;
+    atlas->entries[entry_index].glyph = glyph;
+    // keep the table at most half full
+    if (atlas->entry_count * 2 > atlas->entry_table_size)
+    {
+        if (!CGRebuildGlyphAtlasTable(atlas, atlas->entry_table_size == 0 ? 256 : atlas->entry_table_size * 2))
+        {
+            --atlas->entry_count;
+            return NULL;
+        }
+    }
+    else
+        CGInsertGlyphAtlasSlot(atlas, entry_index);
+    return &atlas->entries[entry_index].glyph;
+}
+
+void CGClearGlyphAtlas(CGGlyphAtlas* atlas)
+{
+    CG_ERROR_CONDITION(atlas == NULL, CGSTR("Cannot clear a NULL glyph atlas."));
+    for (unsigned int i = 0; i < atlas->page_count; ++i)
+    {
+        atlas->pages[i].shelf_count = 0;
+        atlas->pages[i].bottom = 0;
+    }
+    atlas->entry_count = 0;
+    if (atlas->entry_table != NULL)
+        memset(atlas->entry_table, 0, sizeof(unsigned int) * atlas->entry_table_size);
+}
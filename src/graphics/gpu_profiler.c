@@ -0,0 +1,216 @@
+#include "cos_graphics/gpu_profiler.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/log.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief The timestamps of a frame. Each timestamp starts a zone, which lasts until the next
+ * timestamp. The last timestamp ends the frame.
+ */
+typedef struct{
+    GLuint queries[CG_GPU_PROFILER_MAX_MARKERS];
+    /**
+     * @brief The zone that each timestamp starts.
+     */
+    unsigned char zones[CG_GPU_PROFILER_MAX_MARKERS];
+    unsigned int marker_count;
+    /**
+     * @brief Is the frame finished and waiting to be read.
+     */
+    CG_BOOL is_pending;
+}CGGPUProfilerFrame;
+
+struct CGGPUProfiler{
+    CGWindow* window;
+    CGGPUProfilerFrame frames[CG_GPU_PROFILER_FRAME_LATENCY];
+    /**
+     * @brief The frame that is being measured.
+     */
+    unsigned int current_frame;
+    int current_zone;
+    CG_BOOL is_frame_started;
+    /**
+     * @brief Does the system support timestamp queries.
+     */
+    CG_BOOL is_supported;
+    /**
+     * @brief The times of the zones of the recent frames in milliseconds, as rings.
+     */
+    double history[CG_GPU_ZONE_COUNT][CG_GPU_PROFILER_HISTORY_SIZE];
+    double last[CG_GPU_ZONE_COUNT];
+    unsigned int history_count;
+    unsigned int history_next;
+    unsigned int dropped_count;
+};
+
+// query objects are not shared between contexts, so they must be used in the context of the window
+static void CGMakeGPUProfilerContextCurrent(CGGPUProfiler* profiler)
+{
+    if (glfwGetCurrentContext() != profiler->window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)profiler->window->glfw_window_instance);
+}
+
+static void CGDeleteGPUProfiler(CGGPUProfiler* profiler)
+{
+    if (profiler == NULL)
+        return;
+    // without a current context the graphics is terminated, and the queries are deleted with the contexts
+    if (glfwGetCurrentContext() != NULL)
+    {
+        CGMakeGPUProfilerContextCurrent(profiler);
+        for (unsigned int i = 0; i < CG_GPU_PROFILER_FRAME_LATENCY; ++i)
+            glDeleteQueries(CG_GPU_PROFILER_MAX_MARKERS, profiler->frames[i].queries);
+    }
+    if (profiler->window->gpu_profiler == profiler)
+        profiler->window->gpu_profiler = NULL;
+    free(profiler);
+}
+
+CGGPUProfiler* CGCreateGPUProfiler(CGWindow* window)
+{
+    CG_ERROR_COND_RETURN(window == NULL, NULL, CGSTR("Failed to create GPU profiler: Window cannot be NULL."));
+    CG_ERROR_COND_RETURN(window->gpu_profiler != NULL, NULL, CGSTR("Failed to create GPU profiler: The window already has a GPU profiler."));
+    CGGPUProfiler* profiler = (CGGPUProfiler*)calloc(1, sizeof(CGGPUProfiler));
+    CG_ERROR_COND_RETURN(profiler == NULL, NULL, CGSTR("Failed to allocate memory for GPU profiler."));
+    profiler->window = window;
+    profiler->current_zone = CG_GPU_ZONE_OTHER;
+    CGMakeGPUProfilerContextCurrent(profiler);
+    GLint counter_bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counter_bits);
+    profiler->is_supported = counter_bits > 0;
+    if (!profiler->is_supported)
+        CG_WARNING(CGSTR("Timestamp queries are not supported. GPU profiler will not measure anything."));
+    for (unsigned int i = 0; i < CG_GPU_PROFILER_FRAME_LATENCY; ++i)
+        glGenQueries(CG_GPU_PROFILER_MAX_MARKERS, profiler->frames[i].queries);
+    window->gpu_profiler = profiler;
+    CGRegisterResource(profiler, CG_DELETER(CGDeleteGPUProfiler));
+    return profiler;
+}
+
+static void CGWriteGPUProfilerMarker(CGGPUProfilerFrame* frame, int zone)
+{
+    glQueryCounter(frame->queries[frame->marker_count], GL_TIMESTAMP);
+    frame->zones[frame->marker_count] = (unsigned char)zone;
+    ++frame->marker_count;
+}
+
+// read a finished frame into the history. Returns CG_FALSE if the GPU hasn't finished it yet.
+static CG_BOOL CGReadGPUProfilerFrame(CGGPUProfiler* profiler, CGGPUProfilerFrame* frame)
+{
+    // the timestamps finish in order, so the frame is finished if the last one is
+    GLint is_available = GL_FALSE;
+    glGetQueryObjectiv(frame->queries[frame->marker_count - 1], GL_QUERY_RESULT_AVAILABLE, &is_available);
+    if (!is_available)
+        return CG_FALSE;
+
+    double zone_times[CG_GPU_ZONE_COUNT] = {0};
+    GLuint64 first = 0, previous = 0;
+    glGetQueryObjectui64v(frame->queries[0], GL_QUERY_RESULT, &first);
+    previous = first;
+    for (unsigned int i = 1; i < frame->marker_count; ++i)
+    {
+        GLuint64 timestamp = 0;
+        glGetQueryObjectui64v(frame->queries[i], GL_QUERY_RESULT, &timestamp);
+        if (timestamp > previous)
+            zone_times[frame->zones[i - 1]] += (double)(timestamp - previous) / 1000000.0;
+        previous = timestamp;
+    }
+    zone_times[CG_GPU_ZONE_FRAME] = previous > first ? (double)(previous - first) / 1000000.0 : 0.0;
+
+    for (int i = 0; i < CG_GPU_ZONE_COUNT; ++i)
+    {
+        profiler->last[i] = zone_times[i];
+        profiler->history[i][profiler->history_next] = zone_times[i];
+    }
+    profiler->history_next = (profiler->history_next + 1) % CG_GPU_PROFILER_HISTORY_SIZE;
+    if (profiler->history_count < CG_GPU_PROFILER_HISTORY_SIZE)
+        ++profiler->history_count;
+    return CG_TRUE;
+}
+
+static void CGStartGPUProfilerFrame(CGGPUProfiler* profiler)
+{
+    CGGPUProfilerFrame* frame = &profiler->frames[profiler->current_frame];
+    frame->marker_count = 0;
+    profiler->current_zone = CG_GPU_ZONE_OTHER;
+    CGWriteGPUProfilerMarker(frame, CG_GPU_ZONE_OTHER);
+    profiler->is_frame_started = CG_TRUE;
+}
+
+void CGGPUProfilerNextFrame(CGGPUProfiler* profiler)
+{
+    CG_ERROR_CONDITION(profiler == NULL, CGSTR("Cannot start next frame of NULL GPU profiler."));
+    if (profiler->is_frame_started)
+    {
+        // the last marker is kept for the end of the frame
+        CGWriteGPUProfilerMarker(&profiler->frames[profiler->current_frame], CG_GPU_ZONE_OTHER);
+        profiler->frames[profiler->current_frame].is_pending = CG_TRUE;
+        profiler->current_frame = (profiler->current_frame + 1) % CG_GPU_PROFILER_FRAME_LATENCY;
+    }
+    // the oldest frame is read before its queries are reused. It is dropped instead of waited for.
+    CGGPUProfilerFrame* frame = &profiler->frames[profiler->current_frame];
+    if (frame->is_pending)
+    {
+        if (!profiler->is_supported || !CGReadGPUProfilerFrame(profiler, frame))
+            ++profiler->dropped_count;
+        frame->is_pending = CG_FALSE;
+    }
+    CGStartGPUProfilerFrame(profiler);
+}
+
+void CGGPUProfilerSkipFrame(CGGPUProfiler* profiler)
+{
+    CG_ERROR_CONDITION(profiler == NULL, CGSTR("Cannot skip frame of NULL GPU profiler."));
+    if (profiler->is_frame_started)
+        CGStartGPUProfilerFrame(profiler);
+}
+
+void CGGPUProfilerSetZone(CGGPUProfiler* profiler, int zone)
+{
+    CG_ERROR_CONDITION(profiler == NULL, CGSTR("Cannot set zone of NULL GPU profiler."));
+    CG_ERROR_CONDITION(zone < 0 || zone >= CG_GPU_ZONE_FRAME, CGSTR("Invalid GPU profiler zone: %d"), zone);
+    if (!profiler->is_frame_started || zone == profiler->current_zone)
+        return;
+    CGGPUProfilerFrame* frame = &profiler->frames[profiler->current_frame];
+    // the work after the last marker is counted for the last zone
+    if (frame->marker_count >= CG_GPU_PROFILER_MAX_MARKERS - 1)
+        return;
+    CGWriteGPUProfilerMarker(frame, zone);
+    profiler->current_zone = zone;
+}
+
+static int CGCompareDouble(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+CGGPUZoneStats CGGetGPUZoneStats(const CGGPUProfiler* profiler, int zone)
+{
+    CGGPUZoneStats result = {0};
+    CG_ERROR_COND_RETURN(profiler == NULL, result, CGSTR("Cannot get zone statistics of NULL GPU profiler."));
+    CG_ERROR_COND_RETURN(zone < 0 || zone >= CG_GPU_ZONE_COUNT, result, CGSTR("Invalid GPU profiler zone: %d"), zone);
+    if (profiler->history_count == 0)
+        return result;
+    double sorted[CG_GPU_PROFILER_HISTORY_SIZE];
+    memcpy(sorted, profiler->history[zone], sizeof(double) * profiler->history_count);
+    qsort(sorted, profiler->history_count, sizeof(double), CGCompareDouble);
+    double sum = 0.0;
+    for (unsigned int i = 0; i < profiler->history_count; ++i)
+        sum += sorted[i];
+    result.last = profiler->last[zone];
+    result.min = sorted[0];
+    result.average = sum / profiler->history_count;
+    result.p99 = sorted[(profiler->history_count * 99 - 1) / 100];
+    result.sample_count = profiler->history_count;
+    return result;
+}
+
+unsigned int CGGetGPUProfilerDroppedCount(const CGGPUProfiler* profiler)
+{
+    CG_ERROR_COND_RETURN(profiler == NULL, 0, CGSTR("Cannot get dropped count of NULL GPU profiler."));
+    return profiler->dropped_count;
+}
@@ -1,6 +1,12 @@
 #include "cos_graphics/graphics.h"
 #include "cos_graphics/log.h"
 #include "cos_graphics/utils.h"
+#include "cos_graphics/vertex.h"
+#include "cos_graphics/spatial_index.h"
+#include "cos_graphics/gpu_profiler.h"
+#include "cos_graphics/command_recorder.h"
+#include "cos_graphics/glyph_atlas.h"
+#include "cos_graphics/profiler.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -11,6 +17,7 @@
 #endif
 
 #include <math.h>
+#include <float.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -37,6 +44,7 @@ static FT_Face cg_ft_default_face;
 
 static CGRenderObjectProperty* cg_default_geo_property;
 static CGRenderObjectProperty* cg_default_visual_image_property;
+static CGRenderObjectProperty* cg_default_colored_geo_property;
 
 enum {
     CG_GL_BUFFERS_TRIANGLE_VBO = 0,
@@ -44,17 +52,97 @@ enum {
     CG_GL_BUFFERS_QUADRANGLE_EBO,
     CG_GL_BUFFERS_VISUAL_IMAGE_VBO,
     CG_GL_BUFFERS_VISUAL_IMAGE_EBO,
+    CG_GL_BUFFERS_COLORED_GEOMETRY_VBO,
+    CG_GL_BUFFERS_TEXT_VBO,
+    CG_GL_BUFFERS_TEXT_EBO,
 
     CG_GL_BUFFER_COUNT  // buffer counter
 };
 
 static unsigned int cg_gl_buffers[CG_GL_BUFFER_COUNT] = {0};
 
+/**
+ * @brief The glyphs of the text that is drawn, and the textures of its pages.
+ */
+static CGGlyphAtlas* cg_glyph_atlas = NULL;
+static unsigned int cg_glyph_atlas_textures[CG_GLYPH_ATLAS_DEFAULT_MAX_PAGE_COUNT] = {0};
+static unsigned int cg_glyph_atlas_texture_count = 0;
+
+/**
+ * @brief A glyph of the text that is going to be drawn.
+ */
+typedef struct{
+    CGVertexBounds rect;
+    CGVector2 tex_top_left;
+    CGVector2 tex_bottom_right;
+    unsigned int page;
+}CGTextQuad;
+
+/**
+ * @brief The glyphs laid out since the text was last drawn.
+ */
+static CGTextQuad* cg_text_quads = NULL;
+static unsigned int cg_text_quad_count = 0;
+static unsigned int cg_text_quad_capacity = 0;
+static CGVertexBounds cg_text_quad_bounds;
+/**
+ * @brief The largest width or height of the bounds of the text quads. The quads are quantized
+ * into 16 bits across the bounds like the colored geometry batch, so the quads are drawn before
+ * a glyph that would make them wider than this.
+ */
+#define CG_TEXT_QUADS_MAX_EXTENT 4096.0f
+static CGVertexStream cg_text_upload_stream;
+/**
+ * @brief The count of quads that the text element buffer has indices for.
+ */
+static unsigned int cg_text_index_quad_count = 0;
+
+static int cg_time_source = CG_TIME_SOURCE_REAL;
+/**
+ * @brief The current time and the step of the fixed step time source.
+ */
+static double cg_fixed_step_time = 0.0;
+static double cg_fixed_time_step = 0.0;
+static CGTimeSourceCallback cg_time_source_callback = NULL;
+static void* cg_time_source_user_data = NULL;
+
 static CGKeyCallbackFunction cg_key_callback = NULL;
 static CGMouseButtonCallbackFunction cg_mouse_button_callback = NULL;
 static CGCursorPositionCallbackFunction cg_cursor_position_callback = NULL;
 
-static float cg_global_buffer_f20[20];
+/**
+ * @brief Vertex of the colored geometry batch. The position is already transformed
+ * by the render property, so geometries with different properties can share one draw call.
+ * The vertices are quantized into @ref CGCompactColoredVertex when the batch is drawn.
+ */
+typedef struct
+{
+    CGVector2 position;
+    float depth;
+    CGUByte color[4];
+}CGColoredVertex;
+
+/**
+ * @brief The vertices of the colored geometries that are waiting to be drawn.
+ */
+static CGColoredVertex* cg_colored_geo_batch = NULL;
+static unsigned int cg_colored_geo_batch_size = 0;
+static unsigned int cg_colored_geo_batch_capacity = 0;
+/**
+ * @brief The bounds of the positions in the colored geometry batch.
+ */
+static CGVertexBounds cg_colored_geo_batch_bounds;
+/**
+ * @brief The largest width or height of the bounds of the colored geometry batch. The positions
+ * are quantized into 16 bits across the bounds, so a batch wider than this is split, so that
+ * one large object doesn't cost the other objects in the batch their sub-pixel precision.
+ * 4096 pixels keeps the positions within 1/16 pixel.
+ */
+#define CG_COLORED_GEOMETRY_BATCH_MAX_EXTENT 4096.0f
+/**
+ * @brief The quantized vertices that are uploaded when the colored geometry batch is drawn.
+ */
+static CGVertexStream cg_colored_geo_upload_stream;
 
 /**
  * @brief vertex shader resource key for a geometry
@@ -77,6 +165,15 @@ static const CGChar* cg_default_visual_image_fshader_rk = CGSTR("default_visual_
 
 static const CGChar* cg_default_bitmap_visual_image_fshader_rk = CGSTR("default_bitmap_visual_image_shader_fragment");
 
+/**
+ * @brief vertex shader resource key for colored geometries
+ */
+static const CGChar* cg_default_colored_geo_vshader_rk = CGSTR("default_colored_geometry_shader_vertex");
+/**
+ * @brief fragment shader resource key for colored geometries
+ */
+static const CGChar* cg_default_colored_geo_fshader_rk = CGSTR("default_colored_geometry_shader_fragment");
+
 /**
  * @brief default shader for geometry
  */
@@ -107,6 +204,11 @@ static CGShaderProgram cg_default_bitmap_visual_image_shader_program;
  */
 static CGShaderProgram cg_bitmap_visual_image_shader_program;
 
+/**
+ * @brief default shader for batched colored geometries
+ */
+static CGShaderProgram cg_default_colored_geo_shader_program;
+
 #define CG_EXTRACT_RENDER_NODE_DATA(node) ((CGRenderNodeData*)node->data)
 typedef struct
 {
@@ -114,6 +216,217 @@ typedef struct
     CGRenderObjectProperty* property;
 }CGRenderNodeData;
 
+/**
+ * @brief Statistics of the frame that is being rendered.
+ */
+static CGFrameStats cg_frame_stats = {0};
+
+/**
+ * @brief Statistics of the last finished frame.
+ */
+static CGFrameStats cg_last_frame_stats = {0};
+
+/**
+ * @brief The allocation count when the current frame started.
+ */
+static unsigned long long cg_frame_allocation_start = 0;
+
+/**
+ * @brief The estimated memory of a texture.
+ */
+typedef struct{
+    unsigned int texture_id;
+    unsigned long long size;
+}CGTextureMemory;
+
+/**
+ * @brief The memory of the textures that exist, so that it can be subtracted when they are deleted.
+ */
+static CGTextureMemory* cg_texture_memory = NULL;
+static unsigned int cg_texture_memory_count = 0;
+static unsigned int cg_texture_memory_capacity = 0;
+static unsigned long long cg_texture_memory_size = 0;
+
+/**
+ * @brief The texture bound to GL_TEXTURE_2D, which glTexImage2D writes into.
+ */
+static unsigned int cg_bound_texture = 0;
+
+// set the estimated memory of a texture. 0 to remove it.
+static void CGSetTextureMemory(unsigned int texture_id, unsigned long long size)
+{
+    for (unsigned int i = 0; i < cg_texture_memory_count; ++i)
+    {
+        if (cg_texture_memory[i].texture_id != texture_id)
+            continue;
+        cg_texture_memory_size -= cg_texture_memory[i].size;
+        cg_texture_memory_size += size;
+        if (size != 0)
+            cg_texture_memory[i].size = size;
+        else
+            cg_texture_memory[i] = cg_texture_memory[--cg_texture_memory_count];
+        return;
+    }
+    if (size == 0 || texture_id == 0)
+        return;
+    if (cg_texture_memory_count == cg_texture_memory_capacity)
+    {
+        unsigned int new_capacity = cg_texture_memory_capacity == 0 ? 64 : cg_texture_memory_capacity * 2;
+        CGTextureMemory* new_memory = (CGTextureMemory*)CGRealloc(cg_texture_memory, sizeof(CGTextureMemory) * new_capacity);
+        if (new_memory == NULL)
+            return;
+        cg_texture_memory = new_memory;
+        cg_texture_memory_capacity = new_capacity;
+    }
+    cg_texture_memory[cg_texture_memory_count].texture_id = texture_id;
+    cg_texture_memory[cg_texture_memory_count].size = size;
+    ++cg_texture_memory_count;
+    cg_texture_memory_size += size;
+}
+
+// the library only uses 8 bit channels
+static unsigned int CGGetFormatChannelCount(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RED:
+    case GL_R8:
+        return 1;
+    case GL_RG:
+    case GL_RG8:
+        return 2;
+    case GL_RGB:
+    case GL_RGB8:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+// the OpenGL calls below are counted in the frame statistics
+
+static void CGGLDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    ++cg_frame_stats.draw_calls;
+    cg_frame_stats.vertices_submitted += (unsigned int)count;
+    glDrawArrays(mode, first, count);
+}
+
+static void CGGLDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    ++cg_frame_stats.draw_calls;
+    cg_frame_stats.indices_submitted += (unsigned int)count;
+    glDrawElements(mode, count, type, indices);
+}
+
+static void CGGLBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    if (data != NULL)
+        cg_frame_stats.bytes_uploaded += (unsigned long long)size;
+    glBufferData(target, size, data, usage);
+}
+
+static void CGGLBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    cg_frame_stats.bytes_uploaded += (unsigned long long)size;
+    glBufferSubData(target, offset, size, data);
+}
+
+static void CGGLTexImage2D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+    GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    unsigned long long pixel_count = (unsigned long long)width * (unsigned long long)height;
+    if (pixels != NULL)
+        cg_frame_stats.bytes_uploaded += pixel_count * CGGetFormatChannelCount(format);
+    if (target == GL_TEXTURE_2D && level == 0)
+        CGSetTextureMemory(cg_bound_texture, pixel_count * CGGetFormatChannelCount((GLenum)internal_format));
+    glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+}
+
+static void CGGLTexSubImage2D(GLenum target, GLint level, GLint x_offset, GLint y_offset, GLsizei width, GLsizei height,
+    GLenum format, GLenum type, const void* pixels)
+{
+    cg_frame_stats.bytes_uploaded += (unsigned long long)width * (unsigned long long)height * CGGetFormatChannelCount(format);
+    glTexSubImage2D(target, level, x_offset, y_offset, width, height, format, type, pixels);
+}
+
+static void CGGLGenTextures(GLsizei n, GLuint* textures)
+{
+    cg_frame_stats.textures_created += (unsigned int)n;
+    glGenTextures(n, textures);
+}
+
+static void CGGLDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    cg_frame_stats.textures_destroyed += (unsigned int)n;
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        CGSetTextureMemory(textures[i], 0);
+        if (textures[i] == cg_bound_texture)
+            cg_bound_texture = 0;
+    }
+    glDeleteTextures(n, textures);
+}
+
+static void CGGLUseProgram(GLuint program)
+{
+    ++cg_frame_stats.program_binds;
+    glUseProgram(program);
+}
+
+static void CGGLBindVertexArray(GLuint vertex_array)
+{
+    ++cg_frame_stats.vertex_array_binds;
+    glBindVertexArray(vertex_array);
+}
+
+static void CGGLBindTexture(GLenum target, GLuint texture)
+{
+    ++cg_frame_stats.texture_binds;
+    if (target == GL_TEXTURE_2D)
+        cg_bound_texture = texture;
+    glBindTexture(target, texture);
+}
+
+/**
+ * @brief An object that is going to be drawn in the current frame.
+ */
+typedef struct
+{
+    int identifier;
+    void* object;
+    CGRenderObjectProperty* property;
+    /**
+     * @brief The z of the render property, which the queue is sorted by.
+     */
+    float z;
+    /**
+     * @brief The order that the object is drawn in. Objects with the same z keep this order.
+     */
+    unsigned int sequence;
+    /**
+     * @brief The depth of the object in the depth buffer, in the range (0, 1).
+     */
+    float depth;
+    CG_BOOL is_opaque;
+    /**
+     * @brief The bounding box of the object. Only valid if has_bounds is CG_TRUE.
+     */
+    CGAABB bounds;
+    CG_BOOL has_bounds;
+}CGRenderQueueItem;
+
+/**
+ * @brief The objects that are going to be drawn in the current frame, ordered from back to front.
+ */
+static CGRenderQueueItem* cg_render_queue = NULL;
+static unsigned int cg_render_queue_capacity = 0;
+
+/**
+ * @brief The render layer that is being drawn into. NULL if the objects are drawn into the window.
+ */
+static CGRenderLayer* cg_current_render_layer = NULL;
+
 static const float cg_normal_matrix[16] = {
     1, 0, 0, 0,
     0, 1, 0, 0,
@@ -138,20 +451,47 @@ static void CGInitGLFW(CGWindowSubProperty window_property);
 // initialize freetype
 static void CGInitFreeType();
 
+// create the offscreen frame buffer that a headless window is drawn into
+static void CGCreateOffscreenFrameBuffer(CGWindow* window);
+
+// delete the offscreen frame buffer of a headless window
+static void CGDeleteOffscreenFrameBuffer(CGWindow* window);
+
+// create the state of a window with partial redraw
+static void CGCreateRedrawState(CGWindow* window);
+
+// delete the state of a window with partial redraw
+static void CGDeleteRedrawState(CGWindow* window);
+
+// create the frame buffer that keeps the last frame of a window with partial redraw, in the size of the window frame buffer
+static void CGResizeRedrawFrameBuffer(CGWindow* window);
+
+// get the frame buffer that the objects of a window are drawn into
+static unsigned int CGGetWindowDrawFrameBuffer(const CGWindow* window);
+
 // compile one specific shader from source
 static CG_BOOL CGCompileShader(unsigned int shader_id, const char* shader_source);
 
 // initialize default shader
 static void CGInitDefaultShader(const CGChar* shader_v_rk, const CGChar* shader_f_rk, CGShaderProgram* shader_program);
 
-// make a vertices array out of triangle
-static float* CGMakeTriangleVertices(const CGTriangle* triangle, float assigned_z);
+// write the vertices of a triangle into a stream
+static CG_BOOL CGMakeTriangleVertices(const CGTriangle* triangle, CGVertexBounds* bounds, CGVertexStream* stream);
+
+// write the vertices of a quadrangle into a stream
+static CG_BOOL CGMakeQuadrangleVertices(const CGQuadrangle* quadrangle, CGVertexBounds* bounds, CGVertexStream* stream);
+
+// write the vertices of a visual_image into a stream
+static CG_BOOL CGMakeVisualImageVertices(const CGVisualImage* visual_image, CGVertexBounds* bounds, CGVertexStream* stream);
+
+// write the vertices of a rectangle of an image that fills the bounds into a stream
+static CG_BOOL CGMakeImageRectVertices(const CGVertexBounds* bounds, CGVertexStream* stream);
 
-// make a vertices array out of quadrangle
-static float* CGMakeQuadrangleVertices(const CGQuadrangle* quadrangle, float assigned_z);
+// set the uniforms that are needed to decode compact vertices
+static void CGSetCompactVertexUniforms(CGShaderProgram shader_program, const CGVertexBounds* bounds, float depth);
 
-// make a vertices array out of visual_image
-static float* CGMakeVisualImageVertices(const CGVisualImage* visual_image, float assigned_z);
+// set the uniforms that map positions of the window, or the render layer being drawn, into the clip space
+static void CGSetRenderSizeUniforms(CGShaderProgram shader_program, const CGWindow* window);
 
 // set buffer value
 static void CGBindBuffer(GLenum buffer_type, unsigned int buffer, unsigned int buffer_size, void* buffer_data, unsigned int usage);
@@ -165,23 +505,50 @@ static float* CGCreateScaleMatrix(CGVector2 scale);
 // create rotation matrix
 static float* CGCreateRotateMatrix(float rotate);
 
+// get the model matrix of a property
+static void CGGetPropertyMatrix(const CGRenderObjectProperty* property, float* result);
+
 // set geometry matrices uniform
 static void CGSetPropertyUniforms(CGShaderProgram shader_program, const CGRenderObjectProperty* property);
 
+// get the indices that splits a quadrangle into two triangles
+static void CGGetQuadrangleIndices(const CGVector2* vertices, unsigned int* indices);
+
 // render triangle
-static void CGRenderTriangle(const CGTriangle* triangle, const CGRenderObjectProperty* property, const CGWindow* window, float assigned_z);
+static void CGRenderTriangle(const CGTriangle* triangle, const CGRenderObjectProperty* property, const CGWindow* window, float depth);
 
 // render quadrangle
-static void CGRenderQuadrangle(const CGQuadrangle* quadrangle, const CGRenderObjectProperty* property, const CGWindow* window, float assigned_z);
+static void CGRenderQuadrangle(const CGQuadrangle* quadrangle, const CGRenderObjectProperty* property, const CGWindow* window, float depth);
 
 // render visual_image
-static void CGRenderVisualImage(CGVisualImage* visual_image, const CGRenderObjectProperty* property, CGWindow* window, float assigned_z);
+static void CGRenderVisualImage(CGVisualImage* visual_image, const CGRenderObjectProperty* property, CGWindow* window, float depth);
 
 // render polygon
-static void CGRenderPolygon(CGPolygon* polygon, const CGRenderObjectProperty* property, CGWindow* window, float assigned_z);
+static void CGRenderPolygon(CGPolygon* polygon, const CGRenderObjectProperty* property, CGWindow* window, float depth);
+
+// add a colored triangle to the colored geometry batch
+static void CGBatchColoredTriangle(const CGColoredTriangle* triangle, const CGRenderObjectProperty* property, float depth);
+
+// add a colored quadrangle to the colored geometry batch
+static void CGBatchColoredQuadrangle(const CGColoredQuadrangle* quadrangle, const CGRenderObjectProperty* property, float depth);
 
-// draw a glyph
-static void CGDrawGlyph(int offset, const FT_GlyphSlot glyph, const CGRenderObjectProperty* render_property, const CGWindow* window);
+// add a colored polygon to the colored geometry batch
+static void CGBatchColoredPolygon(CGPolygon* polygon, const CGRenderObjectProperty* property, float depth);
+
+// draw all the colored geometries in the batch
+static void CGFlushColoredGeometryBatch(const CGWindow* window);
+
+// draw the text quads, with one draw call for each page of the glyph atlas
+static void CGFlushTextQuads(const CGRenderObjectProperty* render_property, const CGWindow* window);
+
+// split the colored geometry batch before the vertices from the first vertex if they make it too large
+static void CGFitColoredGeometryBatch(const CGWindow* window, unsigned int first_vertex, const CGVertexBounds* previous_bounds);
+
+// draw the performance overlay of a window on top of the frame
+static void CGDrawPerformanceOverlay(CGWindow* window);
+
+// draw a glyph from a texture of its own, with the pen at the position
+static void CGDrawGlyph(CGVector2 pen, const FT_GlyphSlot glyph, const CGRenderObjectProperty* render_property, const CGWindow* window);
 
 // Set an image data to a texture. Note that if you have a texture that is binded, the texture will be unbinded after you call this function.
 static void CGSetTextureValue(unsigned int texture_id, CGImage* texture);
@@ -190,7 +557,20 @@ static void CGSetTextureValue(unsigned int texture_id, CGImage* texture);
 static void CGWriteSpace(unsigned current_x, unsigned int bitmap_width, unsigned int bitmap_height, unsigned int space_width, CGUByte* bitmap);
 
 /**
- * @brief Get the bitmap from a string of text.
+ * @brief Render a string of text into a RGBA bitmap. The color of the bitmap is white, and the alpha is the glyphs.
+ * 
+ * @param text The text to get bitmap from.
+ * @param face The face of the font.
+ * @param text_property The property of the text.
+ * @param bitmap_width This will be set to the width of the bitmap.
+ * @param bitmap_height This will be set to the height of the bitmap.
+ * @return CGUByte* The bitmap. You have to free it manually. NULL if the function fails.
+ */
+static CGUByte* CGGetTextBitmap(const CGChar* text, FT_Face face, const CGTextProperty* text_property,
+    unsigned int* bitmap_width, unsigned int* bitmap_height);
+
+/**
+ * @brief Get the texture from a string of text.
  * 
  * @param text The text to get bitmap from.
  * @param face The face of the font.
@@ -293,7 +673,7 @@ static void CGCreateRenderList(CGWindow* window);
  * @param list_head The head of the list. If this parameter is NULL, the program will not do anything.
  * @param node The node to be added into the list
  */
-static void CGAddRenderListNode(CGRenderNode* list_head, CGRenderNode* node);
+static void CGAddRenderListNode(CGWindow* window, CGRenderNode* node);
 
 
 /**
@@ -367,6 +747,13 @@ static void CGGLFWMouseButtonCallback(GLFWwindow* window, int button, int action
  */
 static void CGGLFWCursorPositionCallback(GLFWwindow* window, double x, double y);
 
+/**
+ * @brief Window refresh callback of glfw. The content of the window is lost, so it is drawn again.
+ * 
+ * @param window The glfw window.
+ */
+static void CGGLFWWindowRefreshCallback(GLFWwindow* window);
+
 /**
  * @brief Create a triangle list node. Move the triangle to the node.
  * 
@@ -375,6 +762,24 @@ static void CGGLFWCursorPositionCallback(GLFWwindow* window, double x, double y)
  */
 static CGTriangleListNode* CGCreateTriangleListNodeMove(CGTriangle* triangle);
 
+/**
+ * @brief Callback of @ref CGClipPolygonEars. It is called once for each triangle clipped from the polygon.
+ */
+typedef CG_BOOL (*CGPolygonEarCallback)(const CGPolygonVertex* vert_1, const CGPolygonVertex* vert_2, const CGPolygonVertex* vert_3, void* user_data);
+
+/**
+ * @brief Split a polygon into triangles with ear clipping.
+ * 
+ * @param polygon The polygon to be split. If the polygon is temporary, its vertices will be consumed
+ * unless is_copy_forced is CG_TRUE.
+ * @param is_copy_forced Split a copy of the vertices even if the polygon is temporary, so that the
+ * polygon can still be drawn afterwards.
+ * @param callback The callback that is called for each triangle. Returning CG_FALSE stops the clipping.
+ * @param user_data The data that is passed to the callback.
+ * @return CG_BOOL CG_TRUE if the function succeeds.
+ */
+static CG_BOOL CGClipPolygonEars(CGPolygon* polygon, CG_BOOL is_copy_forced, CGPolygonEarCallback callback, void* user_data);
+
 /**
  * @brief Is a vertex a ear.
  * 
@@ -426,6 +831,9 @@ static void CGFrameBufferSizeCallback(GLFWwindow* window, int width, int height)
     CGWindow* cg_window = (CGWindow*)p->data;
     if (cg_window->glfw_window_instance == window)
     {
+        cg_window->is_redraw_requested = CG_TRUE;
+        if (cg_window->redraw_state != NULL)
+            CGResizeRedrawFrameBuffer(cg_window);
         switch (cg_window->sub_property.viewport_scale_mode)
         {
         case CG_VIEWPORT_SCALE_EXPAND:
@@ -468,7 +876,6 @@ static void CGInitGLFW(CGWindowSubProperty window_sub_property)
     glfwWindowHint(GLFW_RESIZABLE, window_sub_property.resizable);
     if (window_sub_property.anti_aliasing)
         glfwWindowHint(GLFW_SAMPLES, 4);
-    glfwSwapInterval(0);
     cg_window_list = CGCreateLinkedListNode(NULL, 0);
     cg_is_glfw_initialized = CG_TRUE;
 }
@@ -490,14 +897,42 @@ void CGTerminateGraphics()
     if (cg_is_glad_initialized)
     {
         CGClearTextureResource();
+        CGGLDeleteTextures(cg_glyph_atlas_texture_count, cg_glyph_atlas_textures);
+        cg_glyph_atlas_texture_count = 0;
+        if (cg_glyph_atlas != NULL)
+            CGFree(cg_glyph_atlas);
+        cg_glyph_atlas = NULL;
+        free(cg_text_quads);
+        cg_text_quads = NULL;
+        cg_text_quad_count = 0;
+        cg_text_quad_capacity = 0;
+        cg_text_index_quad_count = 0;
+        CGReleaseVertexStream(&cg_text_upload_stream);
         glDeleteBuffers(CG_GL_BUFFER_COUNT, cg_gl_buffers);
         glDeleteProgram(cg_default_geo_shader_program);
         glDeleteProgram(cg_default_visual_image_shader_program);
         glDeleteProgram(cg_default_bitmap_visual_image_shader_program);
+        glDeleteProgram(cg_default_colored_geo_shader_program);
         CGFree(cg_default_geo_property);
         cg_default_geo_property = NULL;
         CGFree(cg_default_visual_image_property);
         cg_default_visual_image_property = NULL;
+        CGFree(cg_default_colored_geo_property);
+        cg_default_colored_geo_property = NULL;
+        free(cg_colored_geo_batch);
+        cg_colored_geo_batch = NULL;
+        CGReleaseVertexStream(&cg_colored_geo_upload_stream);
+        free(cg_render_queue);
+        free(cg_texture_memory);
+        cg_texture_memory = NULL;
+        cg_texture_memory_count = 0;
+        cg_texture_memory_capacity = 0;
+        cg_texture_memory_size = 0;
+        cg_bound_texture = 0;
+        cg_render_queue = NULL;
+        cg_render_queue_capacity = 0;
+        cg_colored_geo_batch_size = 0;
+        cg_colored_geo_batch_capacity = 0;
         cg_is_glad_initialized = CG_FALSE;
     }
     if (cg_is_glfw_initialized)
@@ -513,6 +948,7 @@ void CGTerminateGraphics()
     {
         FT_Done_Face(cg_ft_default_face);
         FT_Done_FreeType(cg_ft_library);
+        cg_is_freetype_initialized = CG_FALSE;
     }
     if (CGResourceSystemInitialized())
         CGTerminateResourceSystem();
@@ -555,6 +991,14 @@ static void CGInitGLAD()
         CGConstructVector2(0.0f, 0.0f),
         CGConstructVector2(1.0f, 1.0f),
         0.0f);
+
+    CGInitDefaultShader(cg_default_colored_geo_vshader_rk, cg_default_colored_geo_fshader_rk, &cg_default_colored_geo_shader_program);
+
+    cg_default_colored_geo_property = CGCreateRenderObjectProperty(
+        CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f), 
+        CGConstructVector2(0.0f, 0.0f),
+        CGConstructVector2(1.0f, 1.0f),
+        0.0f);
     
     glGenBuffers(CG_GL_BUFFER_COUNT, cg_gl_buffers);
     cg_is_glad_initialized = CG_TRUE;
@@ -570,26 +1014,40 @@ CGWindow* CGCreateWindow(int width, int height, const CGChar* title, CGWindowSub
 
     if (!cg_is_freetype_initialized)
         CGInitFreeType();
-    CGWindow* window = (CGWindow*)malloc(sizeof(CGWindow));
+    CGWindow* window = (CGWindow*)CGMalloc(sizeof(CGWindow));
     CG_ERROR_COND_RETURN(window == NULL, NULL, CGSTR("Failed to allocate memory for window."));
     window->width = width;
     window->height = height;
     window->aspect_ratio = (float)width / (float)height;
     CG_STRCPY(window->title, title);
     window->sub_property = sub_property;
+    // headless windows are hidden windows that are only used for their OpenGL context
+    glfwWindowHint(GLFW_VISIBLE, sub_property.headless ? GLFW_FALSE : GLFW_TRUE);
+    GLFWmonitor* monitor = sub_property.use_full_screen && !sub_property.headless ? glfwGetPrimaryMonitor() : NULL;
+    // the buffers, textures and shaders are created once, so every window shares them with the first window
+    GLFWwindow* share = cg_window_list->next != NULL ? (GLFWwindow*)((CGWindow*)cg_window_list->next->data)->glfw_window_instance : NULL;
 #ifdef CG_USE_WCHAR
     {
         char title_c[256];
         CGCharToChar(title, title_c, 256);
-        window->glfw_window_instance = glfwCreateWindow(width, height, title_c, 
-            sub_property.use_full_screen ? glfwGetPrimaryMonitor() : NULL, NULL);
+        window->glfw_window_instance = glfwCreateWindow(width, height, title_c, monitor, share);
     }
 #else
-    window->glfw_window_instance = glfwCreateWindow(width, height, title,
-        sub_property.use_full_screen ? glfwGetPrimaryMonitor() : NULL, NULL);
+    window->glfw_window_instance = glfwCreateWindow(width, height, title, monitor, share);
 #endif
-    glfwSetWindowAttrib((GLFWwindow*)window->glfw_window_instance, GLFW_FLOATING, sub_property.topmost);
     window->render_list = NULL;
+    window->spatial_index = NULL;
+    window->offscreen_frame_buffer = 0;
+    window->resolve_frame_buffer = 0;
+    window->redraw_state = NULL;
+    window->is_idle = CG_FALSE;
+    window->is_redraw_requested = CG_TRUE;
+    window->is_drawn = CG_FALSE;
+    window->frame_hash = 0;
+    window->idle_timeout = CG_IDLE_DEFAULT_TIMEOUT;
+    window->gpu_profiler = NULL;
+    window->performance_overlay = NULL;
+    window->command_recorder = NULL;
     CGCreateRenderList(window);
     if (window->glfw_window_instance == NULL)
     {
@@ -598,11 +1056,20 @@ CGWindow* CGCreateWindow(int width, int height, const CGChar* title, CGWindowSub
         free(window);
         return NULL;
     }
+    if (!sub_property.headless)
+        glfwSetWindowAttrib((GLFWwindow*)window->glfw_window_instance, GLFW_FLOATING, sub_property.topmost);
     glfwSetKeyCallback(window->glfw_window_instance, CGGLFWKeyCallback);
     glfwSetMouseButtonCallback(window->glfw_window_instance, CGGLFWMouseButtonCallback);
     glfwSetCursorPosCallback(window->glfw_window_instance, CGGLFWCursorPositionCallback);
+    glfwSetWindowRefreshCallback(window->glfw_window_instance, CGGLFWWindowRefreshCallback);
 
     CGCreateViewport(window);
+    if (sub_property.headless)
+        CGCreateOffscreenFrameBuffer(window);
+    if (sub_property.partial_redraw)
+        CGCreateRedrawState(window);
+    // the swap interval belongs to the context, so it can only be set after the context is current
+    CGSetWindowVSyncMode(window, sub_property.vsync_mode);
     CGAppendListNode(cg_window_list, CGCreateLinkedListNode(window, 1));
     CGRegisterResource(window, CG_DELETER(CGDestroyWindow));
     return window;
@@ -625,6 +1092,10 @@ CGWindowSubProperty CGConstructDefaultWindowSubProperty()
     property.topmost = CG_FALSE;
     property.anti_aliasing = CG_FALSE;
     property.viewport_scale_mode = CG_VIEWPORT_SCALE_KEEP_ASPECT_RATIO;
+    property.headless = CG_FALSE;
+    property.partial_redraw = CG_FALSE;
+    property.idle_mode = CG_FALSE;
+    property.vsync_mode = CG_VSYNC_OFF;
     return property;
 }
 
@@ -693,16 +1164,37 @@ static void CGGLFWCursorPositionCallback(GLFWwindow* window, double x, double y)
     cg_cursor_position_callback((CGWindow*)(p->data), (float)x, (float)y);
 }
 
+static void CGGLFWWindowRefreshCallback(GLFWwindow* window)
+{
+    CGWindowListNode* p = cg_window_list->next;
+    for (; p != NULL && ((CGWindow*)(p->data))->glfw_window_instance != window; p = p->next);
+    if (p != NULL)
+        CGInvalidateWindowRect((CGWindow*)(p->data), NULL);
+}
+
 static void CGDestroyWindow(CGWindow* window)
 {
     if (cg_is_glfw_initialized && !cg_is_terminating)
         CGRemoveLinkedListNodeByData(&cg_window_list, window);
     if (cg_is_glad_initialized)
     {
+        // vertex arrays and frame buffers belong to the context of the window
+        if (cg_is_glfw_initialized && !cg_is_terminating)
+            glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
+        CGDeleteOffscreenFrameBuffer(window);
+        CGDeleteRedrawState(window);
         glDeleteVertexArrays(1, &window->triangle_vao);
         glDeleteVertexArrays(1, &window->quadrangle_vao);
         glDeleteVertexArrays(1, &window->visual_image_vao);
+        glDeleteVertexArrays(1, &window->colored_geometry_vao);
+        glDeleteVertexArrays(1, &window->text_vao);
     }
+    free(window->performance_overlay);
+    // the profiler refers to the window, so it cannot outlive it
+    if (window->gpu_profiler != NULL)
+        CGFree(window->gpu_profiler);
+    if (window->command_recorder != NULL)
+        CGFree(window->command_recorder);
     if (cg_is_glfw_initialized && !cg_is_terminating)
         glfwDestroyWindow((GLFWwindow*)window->glfw_window_instance);
     CGDeleteList(window->render_list);
@@ -755,7 +1247,8 @@ void CGCreateViewport(CGWindow* window)
     if (!cg_is_glad_initialized)
         CGInitGLAD();
 
-    //glEnable(GL_DEPTH_TEST);
+    // depth test is only enabled while drawing the render list (see CGWindowDraw)
+    glDepthFunc(GL_LESS);
     if (window->sub_property.anti_aliasing)
         glEnable(GL_MULTISAMPLE);
 
@@ -767,35 +1260,59 @@ void CGCreateViewport(CGWindow* window)
 
     // set triangle vao properties
     glGenVertexArrays(1, &window->triangle_vao);
-    glBindVertexArray(window->triangle_vao);
-    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_TRIANGLE_VBO], 9 * sizeof(float), temp_vertices, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    CGGLBindVertexArray(window->triangle_vao);
+    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_TRIANGLE_VBO], 3 * sizeof(CGCompactVertex), temp_vertices, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CGCompactVertex), (void*)0);
     glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+    CGGLBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     // set quadrangle vao properties
     glGenVertexArrays(1, &window->quadrangle_vao);
-    glBindVertexArray(window->quadrangle_vao);
-    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_QUADRANGLE_VBO], 12 * sizeof(float), temp_vertices, GL_DYNAMIC_DRAW);
+    CGGLBindVertexArray(window->quadrangle_vao);
+    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_QUADRANGLE_VBO], 4 * sizeof(CGCompactVertex), temp_vertices, GL_DYNAMIC_DRAW);
     glGenBuffers(1, &cg_gl_buffers[CG_GL_BUFFERS_QUADRANGLE_EBO]);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CGCompactVertex), (void*)0);
     glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+    CGGLBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     unsigned int indices[6] = {0, 1, 2, 0, 2, 3};
     // set visual_image vao properties
     glGenVertexArrays(1, &window->visual_image_vao);
-    glBindVertexArray(window->visual_image_vao);
-    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_VISUAL_IMAGE_VBO], 20 * sizeof(float), temp_vertices, GL_DYNAMIC_DRAW);
+    CGGLBindVertexArray(window->visual_image_vao);
+    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_VISUAL_IMAGE_VBO], 4 * sizeof(CGCompactImageVertex), temp_vertices, GL_DYNAMIC_DRAW);
     CGBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_VISUAL_IMAGE_EBO], 6 * sizeof(unsigned int), indices, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CGCompactImageVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CGCompactImageVertex), (void*)(2 * sizeof(unsigned short)));
+    glEnableVertexAttribArray(1);
+    CGGLBindVertexArray(0);
+
+    // set colored geometry vao properties
+    glGenVertexArrays(1, &window->colored_geometry_vao);
+    CGGLBindVertexArray(window->colored_geometry_vao);
+    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_COLORED_GEOMETRY_VBO], 0, NULL, GL_STREAM_DRAW);
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CGCompactColoredVertex), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CGCompactColoredVertex), (void*)(2 * sizeof(unsigned short)));
     glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+    glVertexAttribPointer(2, 1, GL_UNSIGNED_INT, GL_TRUE, sizeof(CGCompactColoredVertex), (void*)(2 * sizeof(unsigned short) + 4));
+    glEnableVertexAttribArray(2);
+    CGGLBindVertexArray(0);
+
+    // set text vao properties. The buffers are filled when the text is drawn
+    glGenVertexArrays(1, &window->text_vao);
+    CGGLBindVertexArray(window->text_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_TEXT_VBO]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_TEXT_EBO]);
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CGCompactImageVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CGCompactImageVertex), (void*)(2 * sizeof(unsigned short)));
+    glEnableVertexAttribArray(1);
+    CGGLBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     glfwSetFramebufferSizeCallback(window->glfw_window_instance, CGFrameBufferSizeCallback);
 }
@@ -804,124 +1321,1157 @@ void CGSetClearScreenColor(const CGColor color)
 {
     if (cg_is_glad_initialized)
         glClearColor(color.r, color.g, color.b, color.alpha);
+    // the background of every kept frame changes
+    for (CGWindowListNode* p = cg_window_list != NULL ? cg_window_list->next : NULL; p != NULL; p = p->next)
+        CGInvalidateWindowRect((CGWindow*)p->data, NULL);
 }
 
 void CGTickRenderStart(CGWindow* window)
 {
     if (glfwGetCurrentContext() != window->glfw_window_instance)
         glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
-    glfwSwapBuffers(window->glfw_window_instance);
-    glfwPollEvents();
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-}
-
-void CGWindowDraw(CGWindow* window)
-{
-    if (glfwGetCurrentContext() != window->glfw_window_instance)
-        glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
-    CGRenderNode* draw_obj = window->render_list->next;
-    CGRenderNodeData *data;
-    float assign_z = CG_RENDER_FAR;
-    while (draw_obj != NULL)
+    if (window->command_recorder != NULL)
+        CGCommandRecorderNextFrame(window->command_recorder);
+    window->is_drawn = CG_FALSE;
+    if (window->sub_property.idle_mode && window->is_idle)
     {
-        assign_z -= 0.1f;
-        data = (CGRenderNodeData*)(draw_obj->data);
-        switch (draw_obj->identifier)
+        // the last frame is still on the screen, so there is nothing to swap until something changes
+        if (!window->is_redraw_requested)
         {
-        case CG_RD_TYPE_TRIANGLE:
-            CGRenderTriangle(data->object, data->property, window, assign_z);
-            if (((CGTriangle*)(data->object))->is_temp)
-                CGFree(data->object);
-            break;
-        case CG_RD_TYPE_QUADRANGLE:
-            CGRenderQuadrangle(data->object, data->property, window, assign_z);
-            if (((CGQuadrangle*)(data->object))->is_temp)
-                CGFree(data->object);
-            break;
-        case CG_RD_TYPE_VISUAL_IMAGE:
-            CGRenderVisualImage(data->object, data->property, window, assign_z);
-            if (((CGVisualImage*)(data->object))->is_temp)
-                CGFree(data->object);
-            break;
-        case CG_RD_TYPE_POLYGON:
-            CGRenderPolygon(data->object, data->property, window, assign_z);
-            if (((CGPolygon*)(data->object))->is_temp)
-                CGFree(data->object);
-            break;
-        default:
-            CG_ERROR_COND_EXIT(CG_TRUE, -1, CGSTR("Cannot find render object identifier: %d"), draw_obj->identifier);
+            CG_PROFILE_BEGIN(WaitEvents);
+            if (window->idle_timeout < 0.0)
+                glfwWaitEvents();
+            else
+                glfwWaitEventsTimeout(window->idle_timeout);
+            CG_PROFILE_END(WaitEvents);
         }
-        free(draw_obj->data);
-        CGRemoveLinkedListNode(&draw_obj);
+        else
+            glfwPollEvents();
+        if (window->gpu_profiler != NULL)
+            CGGPUProfilerSkipFrame(window->gpu_profiler);
+        return;
     }
-    window->render_list->next = NULL;
+    if (window->gpu_profiler != NULL)
+        CGGPUProfilerNextFrame(window->gpu_profiler);
+    // headless windows are drawn into their offscreen frame buffer, so there is nothing to swap
+    if (window->offscreen_frame_buffer == 0)
+    {
+        CG_PROFILE_BEGIN(SwapBuffers);
+        glfwSwapBuffers(window->glfw_window_instance);
+        CG_PROFILE_END(SwapBuffers);
+    }
+    glfwPollEvents();
+    // windows with partial redraw keep the last frame, and clear what is redrawn in CGWindowDraw.
+    // Windows in idle mode are cleared in CGWindowDraw if the frame is not skipped.
+    if (window->redraw_state == NULL && !window->sub_property.idle_mode)
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void CGTickRenderEnd()
+void CGRequestWindowRedraw(CGWindow* window)
 {
-    CGResourceSystemUpdate();
-    //check OpenGL error
-    int gl_error_code = glGetError();
-    CG_ERROR_COND_EXIT(gl_error_code != GL_NO_ERROR, -1, CGSTR("OpenGL Error: Error code: 0x%x."), gl_error_code);
+    CG_ERROR_CONDITION(window == NULL, CGSTR("Cannot request redraw of NULL window."));
+    window->is_redraw_requested = CG_TRUE;
+    // wake up the window if it is waiting for events
+    glfwPostEmptyEvent();
 }
 
-CG_BOOL CGShouldWindowClose(CGWindow* window)
+void CGSetWindowIdleTimeout(CGWindow* window, double timeout)
 {
-    return (CG_BOOL)glfwWindowShouldClose(window->glfw_window_instance);
+    CG_ERROR_CONDITION(window == NULL, CGSTR("Cannot set idle timeout of NULL window."));
+    window->idle_timeout = timeout;
 }
 
-double CGGetCurrentTime()
+CG_BOOL CGIsWindowIdle(const CGWindow* window)
 {
-    return glfwGetTime();
+    CG_ERROR_COND_RETURN(window == NULL, CG_FALSE, CGSTR("Cannot check if NULL window is idle."));
+    return window->is_idle;
 }
 
-CGShaderSource* CGCreateShaderSource(const char* vertex, const char* fragment, 
-    const char* geometry, CG_BOOL use_geometry)
+void CGSetWindowVSyncMode(CGWindow* window, int vsync_mode)
 {
-    CG_ERROR_COND_RETURN(vertex == NULL || fragment == NULL, NULL, CGSTR("Shader source cannot be NULL."));
-    CGShaderSource* result = (CGShaderSource*)malloc(sizeof(CGShaderSource));
-    if (result == NULL)
+    CG_ERROR_CONDITION(window == NULL, CGSTR("Cannot set vsync mode of NULL window."));
+    if (window->sub_property.headless)
+        return;
+    if (glfwGetCurrentContext() != window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
+    window->sub_property.vsync_mode = (CGByte)vsync_mode;
+    switch (vsync_mode)
     {
-        CG_ERROR(CGSTR("Construct shader source failed"));
-        return NULL;
+    case CG_VSYNC_OFF:
+        glfwSwapInterval(0);
+        break;
+    case CG_VSYNC_ON:
+        glfwSwapInterval(1);
+        break;
+    case CG_VSYNC_ADAPTIVE:
+        // a negative interval lets late frames tear instead of waiting for the next refresh
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+            glfwSwapInterval(-1);
+        else
+            glfwSwapInterval(1);
+        break;
+    default:
+        CG_ERROR_CONDITION(CG_TRUE, CGSTR("Unknown vsync mode: %d."), vsync_mode);
     }
-    strcpy(result->vertex, vertex);
-    strcpy(result->fragment, fragment);
-    if (use_geometry)
-        strcpy(result->geometry, geometry);
-    result->use_geometry = use_geometry;
-    CGRegisterResource(result, CG_DELETER(CGDeleteShaderSource));
-    return result;
 }
 
-CGShaderSource* CGCreateShaderSourceFromPath(const CGChar* vertex_rk, const CGChar* fragment_rk, 
-    const CGChar* geometry_rk, CG_BOOL use_geometry)
+static void CGCreateOffscreenFrameBuffer(CGWindow* window)
 {
-    CGShaderSource* result = (CGShaderSource*)malloc(sizeof(CGShaderSource));
-    if (result == NULL)
+    int samples = window->sub_property.anti_aliasing ? 4 : 0;
+    glGenFramebuffers(1, &window->offscreen_frame_buffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, window->offscreen_frame_buffer);
+    glGenRenderbuffers(2, window->offscreen_render_buffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, window->offscreen_render_buffers[0]);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, window->width, window->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, window->offscreen_render_buffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, window->offscreen_render_buffers[1]);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, window->width, window->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, window->offscreen_render_buffers[1]);
+    CG_ERROR_CONDITION(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE, CGSTR("Failed to create offscreen frame buffer."));
+    if (samples != 0)
     {
-        CG_ERROR(CGSTR("Construct shader source failed."));
-        return NULL;
+        // multisampled render buffers cannot be read directly
+        glGenFramebuffers(1, &window->resolve_frame_buffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, window->resolve_frame_buffer);
+        glGenRenderbuffers(1, &window->resolve_render_buffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, window->resolve_render_buffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, window->width, window->height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, window->resolve_render_buffer);
+        CG_ERROR_CONDITION(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE, CGSTR("Failed to create offscreen resolve frame buffer."));
     }
-    result->vertex = CGLoadResource(vertex_rk, NULL, NULL);
-    if (result->vertex == NULL)
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    // the offscreen frame buffer stays bound, so everything is drawn into it
+    glBindFramebuffer(GL_FRAMEBUFFER, window->offscreen_frame_buffer);
+}
+
+static void CGDeleteOffscreenFrameBuffer(CGWindow* window)
+{
+    if (window->offscreen_frame_buffer == 0)
+        return;
+    glDeleteFramebuffers(1, &window->offscreen_frame_buffer);
+    glDeleteRenderbuffers(2, window->offscreen_render_buffers);
+    if (window->resolve_frame_buffer != 0)
     {
-        CG_ERROR(CGSTR("Load vertex shader source failed."));
-        free(result);
-        return NULL;
+        glDeleteFramebuffers(1, &window->resolve_frame_buffer);
+        glDeleteRenderbuffers(1, &window->resolve_render_buffer);
     }
-    result->fragment = CGLoadResource(fragment_rk, NULL, NULL);
-    if (result->fragment == NULL)
+    window->offscreen_frame_buffer = 0;
+    window->resolve_frame_buffer = 0;
+}
+
+void CGGetWindowFrameBufferSize(CGWindow* window, int* width, int* height)
+{
+    CG_ERROR_CONDITION(window == NULL || width == NULL || height == NULL, CGSTR("Cannot get frame buffer size of NULL window."));
+    if (window->offscreen_frame_buffer != 0)
     {
-        CG_ERROR(CGSTR("Load fragment shader source failed."));
-        free(result->vertex);
-        free(result);
-        return NULL;
+        *width = window->width;
+        *height = window->height;
+        return;
     }
-    if (use_geometry)
-    {
-        result->geometry = CGLoadResource(geometry_rk, NULL, NULL);
-        if (result->geometry == NULL)
+    glfwGetFramebufferSize((GLFWwindow*)window->glfw_window_instance, width, height);
+}
+
+void CGBindWindowReadFrameBuffer(CGWindow* window)
+{
+    CG_ERROR_CONDITION(window == NULL, CGSTR("Cannot bind read frame buffer of NULL window."));
+    if (glfwGetCurrentContext() != window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
+    if (window->offscreen_frame_buffer == 0)
+    {
+        // the current frame is in the back buffer until it is swapped in the next CGTickRenderStart
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glReadBuffer(GL_BACK);
+        return;
+    }
+    if (window->resolve_frame_buffer == 0)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, window->offscreen_frame_buffer);
+        return;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, window->offscreen_frame_buffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, window->resolve_frame_buffer);
+    glBlitFramebuffer(0, 0, window->width, window->height, 0, 0, window->width, window->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, window->offscreen_frame_buffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, window->resolve_frame_buffer);
+}
+
+CG_BOOL CGReadPixels(CGWindow* window, int x, int y, int width, int height, CGUByte* result)
+{
+    CG_ERROR_COND_RETURN(window == NULL || result == NULL, CG_FALSE, CGSTR("Cannot read pixels of NULL window or into NULL result."));
+    int buffer_width, buffer_height;
+    CGGetWindowFrameBufferSize(window, &buffer_width, &buffer_height);
+    CG_ERROR_COND_RETURN(x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > buffer_width || y + height > buffer_height,
+        CG_FALSE, CGSTR("Cannot read pixels out of the frame buffer."));
+    CGBindWindowReadFrameBuffer(window);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // OpenGL rows start from the bottom
+    glReadPixels(x, buffer_height - y - height, width, height, GL_RGBA, GL_UNSIGNED_BYTE, result);
+    size_t row_size = (size_t)width * 4;
+    CGUByte* row = (CGUByte*)CGMalloc(row_size);
+    CG_ERROR_COND_RETURN(row == NULL, CG_FALSE, CGSTR("Failed to allocate memory for reading pixels."));
+    for (int i = 0; i < height / 2; ++i)
+    {
+        CGUByte* top = result + row_size * i;
+        CGUByte* bottom = result + row_size * (height - 1 - i);
+        memcpy(row, top, row_size);
+        memcpy(top, bottom, row_size);
+        memcpy(bottom, row, row_size);
+    }
+    free(row);
+    return CG_TRUE;
+}
+
+static CG_BOOL CGIsRenderObjectOpaque(int identifier, const void* object, const CGRenderObjectProperty* property)
+{
+    if (property != NULL && property->color.alpha < 1.0f)
+        return CG_FALSE;
+    // the modify matrix can change how the object is drawn, so only the caller knows if it is opaque
+    if (property != NULL && property->modify_matrix != NULL)
+        return property->is_opaque;
+    switch (identifier)
+    {
+    case CG_RD_TYPE_VISUAL_IMAGE:
+    {
+        const CGVisualImage* visual_image = (const CGVisualImage*)object;
+        // the clamped part of the image is transparent
+        return !visual_image->has_transparency && !visual_image->is_clamped;
+    }
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+        for (int i = 0; i < 3; ++i)
+        {
+            if (((const CGColoredTriangle*)object)->colors[i].alpha < 1.0f)
+                return CG_FALSE;
+        }
+        return CG_TRUE;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        for (int i = 0; i < 4; ++i)
+        {
+            if (((const CGColoredQuadrangle*)object)->colors[i].alpha < 1.0f)
+                return CG_FALSE;
+        }
+        return CG_TRUE;
+    case CG_RD_TYPE_COLORED_POLYGON:
+    {
+        const CGPolygonVertex* head = ((const CGPolygon*)object)->vertex_head;
+        if (head == NULL)
+            return CG_FALSE;
+        const CGPolygonVertex* p = head;
+        do
+        {
+            if (p->color.alpha < 1.0f)
+                return CG_FALSE;
+            p = p->next;
+        } while (p != head);
+        return CG_TRUE;
+    }
+    default:
+        return CG_TRUE;
+    }
+}
+
+static void CGRenderQueueItemObject(CGWindow* window, const CGRenderQueueItem* item)
+{
+    unsigned int first_colored_vertex = cg_colored_geo_batch_size;
+    CGVertexBounds previous_colored_bounds = cg_colored_geo_batch_bounds;
+    // colored geometries are drawn in batch, so the batch must be drawn before anything else is drawn
+    if (item->identifier != CG_RD_TYPE_COLORED_TRIANGLE 
+        && item->identifier != CG_RD_TYPE_COLORED_QUADRANGLE
+        && item->identifier != CG_RD_TYPE_COLORED_POLYGON)
+        CGFlushColoredGeometryBatch(window);
+    if (window->gpu_profiler != NULL)
+    {
+        if (item->identifier == CG_RD_TYPE_VISUAL_IMAGE)
+            CGGPUProfilerSetZone(window->gpu_profiler, CG_GPU_ZONE_VISUAL_IMAGE);
+        else if (item->identifier == CG_RD_TYPE_TRIANGLE || item->identifier == CG_RD_TYPE_QUADRANGLE
+            || item->identifier == CG_RD_TYPE_POLYGON)
+            CGGPUProfilerSetZone(window->gpu_profiler, CG_GPU_ZONE_GEOMETRY);
+    }
+    switch (item->identifier)
+    {
+    case CG_RD_TYPE_TRIANGLE:
+        CGRenderTriangle(item->object, item->property, window, item->depth);
+        break;
+    case CG_RD_TYPE_QUADRANGLE:
+        CGRenderQuadrangle(item->object, item->property, window, item->depth);
+        break;
+    case CG_RD_TYPE_VISUAL_IMAGE:
+        CGRenderVisualImage(item->object, item->property, window, item->depth);
+        break;
+    case CG_RD_TYPE_POLYGON:
+        CGRenderPolygon(item->object, item->property, window, item->depth);
+        break;
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+        CGBatchColoredTriangle(item->object, item->property, item->depth);
+        ++cg_frame_stats.objects_batched;
+        break;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        CGBatchColoredQuadrangle(item->object, item->property, item->depth);
+        ++cg_frame_stats.objects_batched;
+        break;
+    case CG_RD_TYPE_COLORED_POLYGON:
+        CGBatchColoredPolygon(item->object, item->property, item->depth);
+        ++cg_frame_stats.objects_batched;
+        break;
+    default:
+        CG_ERROR_COND_EXIT(CG_TRUE, -1, CGSTR("Cannot find render object identifier: %d"), item->identifier);
+    }
+    // a colored geometry that is far away from the others in the batch is drawn in a new batch
+    CGFitColoredGeometryBatch(window, first_colored_vertex, &previous_colored_bounds);
+}
+
+static CG_BOOL CGReserveRenderQueue(unsigned int count)
+{
+    if (count <= cg_render_queue_capacity)
+        return CG_TRUE;
+    unsigned int new_capacity = cg_render_queue_capacity == 0 ? 64 : cg_render_queue_capacity;
+    while (new_capacity < count)
+        new_capacity *= 2;
+    CGRenderQueueItem* new_queue = (CGRenderQueueItem*)CGRealloc(cg_render_queue, sizeof(CGRenderQueueItem) * new_capacity);
+    CG_ERROR_COND_RETURN(new_queue == NULL, CG_FALSE, CGSTR("Failed to allocate memory for render queue."));
+    cg_render_queue = new_queue;
+    cg_render_queue_capacity = new_capacity;
+    return CG_TRUE;
+}
+
+static void CGPushRenderQueueItem(unsigned int index, int identifier, void* object, CGRenderObjectProperty* property, 
+    const CGAABB* bounds, unsigned int sequence)
+{
+    CGRenderQueueItem* item = &cg_render_queue[index];
+    item->has_bounds = bounds != NULL;
+    if (bounds != NULL)
+        item->bounds = *bounds;
+    item->identifier = identifier;
+    item->object = object;
+    item->property = property;
+    item->z = property != NULL ? property->z : 0.0f;
+    item->sequence = sequence;
+    item->is_opaque = CGIsRenderObjectOpaque(identifier, object, property);
+}
+
+/**
+ * @brief Data used by @ref CGPushSpatialIndexRenderQueueItem to add the visible objects of a
+ * spatial index into the render queue.
+ */
+typedef struct{
+    unsigned int count;
+    /**
+     * @brief Added to the sequence of the items, so that they are drawn after the objects passed to CGDraw.
+     */
+    unsigned int sequence_offset;
+    CG_BOOL is_success;
+}CGRenderQueueBuilder;
+
+static void CGPushSpatialIndexRenderQueueItem(const CGSpatialIndexItem* item, void* user_data)
+{
+    CGRenderQueueBuilder* builder = (CGRenderQueueBuilder*)user_data;
+    if (!builder->is_success || !CGReserveRenderQueue(builder->count + 1))
+    {
+        builder->is_success = CG_FALSE;
+        return;
+    }
+    CGPushRenderQueueItem(builder->count, item->object_type, item->object, item->property, &item->bounds, builder->sequence_offset + item->sequence);
+    ++builder->count;
+}
+
+void CGSetWindowSpatialIndex(CGWindow* window, CGSpatialIndex* index)
+{
+    CG_ERROR_CONDITION(window == NULL, CGSTR("Cannot set spatial index of NULL window."));
+    window->spatial_index = index;
+}
+
+static int CGCompareRenderQueueItem(const void* item_1, const void* item_2)
+{
+    const CGRenderQueueItem* lhs = (const CGRenderQueueItem*)item_1;
+    const CGRenderQueueItem* rhs = (const CGRenderQueueItem*)item_2;
+    // objects with larger z are drawn first
+    if (lhs->z != rhs->z)
+        return lhs->z > rhs->z ? -1 : 1;
+    return lhs->sequence < rhs->sequence ? -1 : (lhs->sequence > rhs->sequence ? 1 : 0);
+}
+
+static void CGFreeTempRenderObject(int identifier, void* object)
+{
+    CG_BOOL is_temp = CG_FALSE;
+    switch (identifier)
+    {
+    case CG_RD_TYPE_TRIANGLE:
+        is_temp = ((CGTriangle*)object)->is_temp;
+        break;
+    case CG_RD_TYPE_QUADRANGLE:
+        is_temp = ((CGQuadrangle*)object)->is_temp;
+        break;
+    case CG_RD_TYPE_VISUAL_IMAGE:
+        is_temp = ((CGVisualImage*)object)->is_temp;
+        break;
+    case CG_RD_TYPE_POLYGON:
+    case CG_RD_TYPE_COLORED_POLYGON:
+        is_temp = ((CGPolygon*)object)->is_temp;
+        break;
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+        is_temp = ((CGColoredTriangle*)object)->is_temp;
+        break;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        is_temp = ((CGColoredQuadrangle*)object)->is_temp;
+        break;
+    default:
+        break;
+    }
+    if (is_temp)
+        CGFree(object);
+}
+
+/**
+ * @brief The signature of an object drawn in a frame. The signatures of two frames are compared
+ * to find the objects that are added, removed or changed.
+ */
+typedef struct{
+    unsigned long long hash;
+    CGAABB bounds;
+    CG_BOOL has_bounds;
+}CGDrawnObjectSignature;
+
+struct CGRedrawState{
+    /**
+     * @brief The frame buffer that keeps the last frame of a window that is not headless, which
+     * is copied into the back buffer every frame. Headless windows keep it in their offscreen frame buffer.
+     */
+    unsigned int frame_buffer;
+    /**
+     * @brief The color and depth render buffers of the frame buffer.
+     */
+    unsigned int render_buffers[2];
+    int frame_buffer_width;
+    int frame_buffer_height;
+    /**
+     * @brief The signatures of the objects drawn in the last frame, sorted by hash.
+     */
+    CGDrawnObjectSignature* signatures;
+    unsigned int signature_count;
+    /**
+     * @brief The signatures of the current frame. Swapped with signatures after they are compared.
+     */
+    CGDrawnObjectSignature* next_signatures;
+    unsigned int signature_capacity;
+    /**
+     * @brief The union of the areas that need to be redrawn. Only valid if has_dirty_rect is CG_TRUE.
+     */
+    CGAABB dirty_rect;
+    CG_BOOL has_dirty_rect;
+    CG_BOOL is_fully_dirty;
+};
+
+static void CGCreateRedrawState(CGWindow* window)
+{
+    CGRedrawState* state = (CGRedrawState*)CGCalloc(1, sizeof(CGRedrawState));
+    CG_ERROR_CONDITION(state == NULL, CGSTR("Failed to allocate memory for redraw state."));
+    state->is_fully_dirty = CG_TRUE;
+    window->redraw_state = state;
+    CGResizeRedrawFrameBuffer(window);
+}
+
+static void CGDeleteRedrawFrameBuffer(CGRedrawState* state)
+{
+    if (state->frame_buffer == 0)
+        return;
+    glDeleteFramebuffers(1, &state->frame_buffer);
+    glDeleteRenderbuffers(2, state->render_buffers);
+    state->frame_buffer = 0;
+}
+
+static void CGDeleteRedrawState(CGWindow* window)
+{
+    if (window->redraw_state == NULL)
+        return;
+    CGDeleteRedrawFrameBuffer(window->redraw_state);
+    free(window->redraw_state->signatures);
+    free(window->redraw_state->next_signatures);
+    free(window->redraw_state);
+    window->redraw_state = NULL;
+}
+
+static void CGResizeRedrawFrameBuffer(CGWindow* window)
+{
+    CGRedrawState* state = window->redraw_state;
+    state->is_fully_dirty = CG_TRUE;
+    CGDeleteRedrawFrameBuffer(state);
+    CGGetWindowFrameBufferSize(window, &state->frame_buffer_width, &state->frame_buffer_height);
+    if (state->frame_buffer_width <= 0 || state->frame_buffer_height <= 0)
+        return;
+    // the frame is copied into the back buffer, or the offscreen frame buffer of headless windows,
+    // which can only be done between buffers with the same samples
+    int samples = 0;
+    glBindFramebuffer(GL_FRAMEBUFFER, window->offscreen_frame_buffer);
+    glGetIntegerv(GL_SAMPLES, &samples);
+    glGenFramebuffers(1, &state->frame_buffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, state->frame_buffer);
+    glGenRenderbuffers(2, state->render_buffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, state->render_buffers[0]);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, state->frame_buffer_width, state->frame_buffer_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, state->render_buffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, state->render_buffers[1]);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, state->frame_buffer_width, state->frame_buffer_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, state->render_buffers[1]);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        CGDeleteRedrawFrameBuffer(state);
+        glBindFramebuffer(GL_FRAMEBUFFER, window->offscreen_frame_buffer);
+        CG_ERROR_CONDITION(CG_TRUE, CGSTR("Failed to create partial redraw frame buffer."));
+    }
+}
+
+static unsigned int CGGetWindowDrawFrameBuffer(const CGWindow* window)
+{
+    if (window->redraw_state != NULL && window->redraw_state->frame_buffer != 0)
+        return window->redraw_state->frame_buffer;
+    return window->offscreen_frame_buffer;
+}
+
+static void CGExpandDirtyRect(CGRedrawState* state, const CGAABB* rect)
+{
+    if (!state->has_dirty_rect)
+    {
+        state->dirty_rect = *rect;
+        state->has_dirty_rect = CG_TRUE;
+        return;
+    }
+    state->dirty_rect.min.x = rect->min.x < state->dirty_rect.min.x ? rect->min.x : state->dirty_rect.min.x;
+    state->dirty_rect.min.y = rect->min.y < state->dirty_rect.min.y ? rect->min.y : state->dirty_rect.min.y;
+    state->dirty_rect.max.x = rect->max.x > state->dirty_rect.max.x ? rect->max.x : state->dirty_rect.max.x;
+    state->dirty_rect.max.y = rect->max.y > state->dirty_rect.max.y ? rect->max.y : state->dirty_rect.max.y;
+}
+
+void CGInvalidateWindowRect(CGWindow* window, const CGAABB* rect)
+{
+    CG_ERROR_CONDITION(window == NULL, CGSTR("Cannot invalidate rect of NULL window."));
+    window->is_redraw_requested = CG_TRUE;
+    if (window->redraw_state == NULL)
+        return;
+    if (rect == NULL)
+        window->redraw_state->is_fully_dirty = CG_TRUE;
+    else
+        CGExpandDirtyRect(window->redraw_state, rect);
+}
+
+static unsigned long long CGHashBytes(unsigned long long hash, const void* data, size_t size)
+{
+    // FNV-1a
+    const CGUByte* bytes = (const CGUByte*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// hash what decides how an object looks, so that equal objects created again every frame have the same hash
+static unsigned long long CGHashRenderQueueItem(const CGRenderQueueItem* item)
+{
+    unsigned long long hash = CGHashBytes(14695981039346656037ULL, &item->identifier, sizeof(item->identifier));
+    switch (item->identifier)
+    {
+    case CG_RD_TYPE_TRIANGLE:
+        hash = CGHashBytes(hash, ((const CGTriangle*)item->object)->vertices, sizeof(CGVector2) * 3);
+        break;
+    case CG_RD_TYPE_QUADRANGLE:
+        hash = CGHashBytes(hash, ((const CGQuadrangle*)item->object)->vertices, sizeof(CGVector2) * 4);
+        break;
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+        hash = CGHashBytes(hash, ((const CGColoredTriangle*)item->object)->vertices, sizeof(CGVector2) * 3);
+        hash = CGHashBytes(hash, ((const CGColoredTriangle*)item->object)->colors, sizeof(CGColor) * 3);
+        break;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        hash = CGHashBytes(hash, ((const CGColoredQuadrangle*)item->object)->vertices, sizeof(CGVector2) * 4);
+        hash = CGHashBytes(hash, ((const CGColoredQuadrangle*)item->object)->colors, sizeof(CGColor) * 4);
+        break;
+    case CG_RD_TYPE_VISUAL_IMAGE:
+    {
+        const CGVisualImage* visual_image = (const CGVisualImage*)item->object;
+        hash = CGHashBytes(hash, &visual_image->texture_id, sizeof(visual_image->texture_id));
+        hash = CGHashBytes(hash, &visual_image->img_width, sizeof(visual_image->img_width));
+        hash = CGHashBytes(hash, &visual_image->img_height, sizeof(visual_image->img_height));
+        hash = CGHashBytes(hash, &visual_image->is_clamped, sizeof(visual_image->is_clamped));
+        hash = CGHashBytes(hash, &visual_image->clamp_top_left, sizeof(CGVector2));
+        hash = CGHashBytes(hash, &visual_image->clamp_bottom_right, sizeof(CGVector2));
+        break;
+    }
+    case CG_RD_TYPE_POLYGON:
+    case CG_RD_TYPE_COLORED_POLYGON:
+    {
+        const CGPolygonVertex* head = ((const CGPolygon*)item->object)->vertex_head;
+        const CGPolygonVertex* p = head;
+        do
+        {
+            if (p == NULL)
+                break;
+            hash = CGHashBytes(hash, &p->position, sizeof(CGVector2));
+            hash = CGHashBytes(hash, &p->color, sizeof(CGColor));
+            p = p->next;
+        } while (p != head);
+        break;
+    }
+    default:
+        break;
+    }
+    const CGRenderObjectProperty* property = item->property;
+    if (property != NULL)
+    {
+        hash = CGHashBytes(hash, &property->rotation, sizeof(property->rotation));
+        hash = CGHashBytes(hash, &property->z, sizeof(property->z));
+        hash = CGHashBytes(hash, &property->color, sizeof(property->color));
+        hash = CGHashBytes(hash, &property->transform, sizeof(property->transform));
+        hash = CGHashBytes(hash, &property->scale, sizeof(property->scale));
+        if (property->modify_matrix != NULL)
+        {
+            hash = CGHashBytes(hash, property->modify_matrix, sizeof(float) * 16);
+            hash = CGHashBytes(hash, &property->is_opaque, sizeof(property->is_opaque));
+        }
+    }
+    return hash;
+}
+
+static int CGCompareDrawnObjectSignature(const void* signature_1, const void* signature_2)
+{
+    unsigned long long lhs = ((const CGDrawnObjectSignature*)signature_1)->hash;
+    unsigned long long rhs = ((const CGDrawnObjectSignature*)signature_2)->hash;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+static void CGMarkSignatureDirty(CGRedrawState* state, const CGDrawnObjectSignature* signature)
+{
+    if (signature->has_bounds)
+        CGExpandDirtyRect(state, &signature->bounds);
+    else
+        state->is_fully_dirty = CG_TRUE;
+}
+
+// compare the objects in the render queue with the last frame, and mark the ones that are added, removed or changed
+static void CGDiffRenderQueue(CGRedrawState* state, unsigned int count)
+{
+    if (state->signature_capacity < count)
+    {
+        unsigned int new_capacity = state->signature_capacity == 0 ? 64 : state->signature_capacity;
+        while (new_capacity < count)
+            new_capacity *= 2;
+        CGDrawnObjectSignature* signatures = (CGDrawnObjectSignature*)CGRealloc(state->signatures, sizeof(CGDrawnObjectSignature) * new_capacity);
+        if (signatures != NULL)
+            state->signatures = signatures;
+        CGDrawnObjectSignature* next_signatures = (CGDrawnObjectSignature*)CGRealloc(state->next_signatures, sizeof(CGDrawnObjectSignature) * new_capacity);
+        if (next_signatures != NULL)
+            state->next_signatures = next_signatures;
+        if (signatures == NULL || next_signatures == NULL)
+        {
+            // without the signatures nothing can be compared, so the next frame is drawn fully as well
+            state->signature_count = 0;
+            state->is_fully_dirty = CG_TRUE;
+            CG_ERROR_CONDITION(CG_TRUE, CGSTR("Failed to allocate memory for redraw signatures."));
+        }
+        state->signature_capacity = new_capacity;
+    }
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        CGDrawnObjectSignature* signature = &state->next_signatures[i];
+        signature->has_bounds = cg_render_queue[i].has_bounds;
+        signature->bounds = cg_render_queue[i].bounds;
+        signature->hash = CGHashRenderQueueItem(&cg_render_queue[i]);
+        if (signature->has_bounds)
+            signature->hash = CGHashBytes(signature->hash, &signature->bounds, sizeof(CGAABB));
+    }
+    qsort(state->next_signatures, count, sizeof(CGDrawnObjectSignature), CGCompareDrawnObjectSignature);
+
+    // the signatures that are only in one of the frames are the objects that changed
+    unsigned int i = 0, j = 0;
+    while (i < state->signature_count || j < count)
+    {
+        if (j == count || (i < state->signature_count && state->signatures[i].hash < state->next_signatures[j].hash))
+            CGMarkSignatureDirty(state, &state->signatures[i++]);
+        else if (i == state->signature_count || state->next_signatures[j].hash < state->signatures[i].hash)
+            CGMarkSignatureDirty(state, &state->next_signatures[j++]);
+        else
+        {
+            ++i;
+            ++j;
+        }
+    }
+    CGDrawnObjectSignature* temp = state->signatures;
+    state->signatures = state->next_signatures;
+    state->next_signatures = temp;
+    state->signature_count = count;
+}
+
+/**
+ * @brief Prepare the frame buffer of a window with partial redraw, and remove the objects
+ * that don't need to be redrawn from the render queue.
+ * 
+ * @return unsigned int The count of objects left in the render queue.
+ */
+static unsigned int CGPrepareRedraw(CGWindow* window, const CGAABB* viewport, unsigned int count)
+{
+    CGRedrawState* state = window->redraw_state;
+    CGDiffRenderQueue(state, count);
+    CGAABB rect = state->dirty_rect;
+    CG_BOOL is_full = state->is_fully_dirty;
+    if (!is_full && state->has_dirty_rect)
+    {
+        rect.min.x = rect.min.x > viewport->min.x ? rect.min.x : viewport->min.x;
+        rect.min.y = rect.min.y > viewport->min.y ? rect.min.y : viewport->min.y;
+        rect.max.x = rect.max.x < viewport->max.x ? rect.max.x : viewport->max.x;
+        rect.max.y = rect.max.y < viewport->max.y ? rect.max.y : viewport->max.y;
+        float viewport_area = (viewport->max.x - viewport->min.x) * (viewport->max.y - viewport->min.y);
+        is_full = (rect.max.x - rect.min.x) * (rect.max.y - rect.min.y) > CG_PARTIAL_REDRAW_FULL_THRESHOLD * viewport_area;
+    }
+    CG_BOOL has_rect = state->has_dirty_rect && rect.min.x < rect.max.x && rect.min.y < rect.max.y;
+    state->is_fully_dirty = CG_FALSE;
+    state->has_dirty_rect = CG_FALSE;
+    if (is_full)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        return count;
+    }
+    if (!has_rect)
+        return 0;
+
+    // map the rect into the pixels of the viewport, with a margin for anti-aliased edges
+    int viewport_pixels[4];
+    glGetIntegerv(GL_VIEWPORT, viewport_pixels);
+    float scale_x = (float)viewport_pixels[2] / (viewport->max.x - viewport->min.x);
+    float scale_y = (float)viewport_pixels[3] / (viewport->max.y - viewport->min.y);
+    int min_x = viewport_pixels[0] + (int)floorf((rect.min.x - viewport->min.x) * scale_x) - 2;
+    int min_y = viewport_pixels[1] + (int)floorf((rect.min.y - viewport->min.y) * scale_y) - 2;
+    int max_x = viewport_pixels[0] + (int)ceilf((rect.max.x - viewport->min.x) * scale_x) + 2;
+    int max_y = viewport_pixels[1] + (int)ceilf((rect.max.y - viewport->min.y) * scale_y) + 2;
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(min_x, min_y, max_x - min_x, max_y - min_y);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // the objects out of the rect are kept from the last frame. The order of the queue is kept,
+    // so the objects left are drawn in the same order as in a full redraw.
+    rect.min = CGConstructVector2(rect.min.x - 2.0f / scale_x, rect.min.y - 2.0f / scale_y);
+    rect.max = CGConstructVector2(rect.max.x + 2.0f / scale_x, rect.max.y + 2.0f / scale_y);
+    unsigned int result = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!cg_render_queue[i].has_bounds || CGIsAABBOverlapping(&cg_render_queue[i].bounds, &rect))
+            cg_render_queue[result++] = cg_render_queue[i];
+    }
+    return result;
+}
+
+// copy the kept frame of a window with partial redraw into the back buffer, or the offscreen frame buffer of headless windows
+static void CGPresentRedrawFrameBuffer(CGWindow* window)
+{
+    CGRedrawState* state = window->redraw_state;
+    glDisable(GL_SCISSOR_TEST);
+    if (state->frame_buffer == 0)
+        return;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, state->frame_buffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, window->offscreen_frame_buffer);
+    glBlitFramebuffer(0, 0, state->frame_buffer_width, state->frame_buffer_height,
+        0, 0, state->frame_buffer_width, state->frame_buffer_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, state->frame_buffer);
+}
+
+/**
+ * @brief Compare the objects in the render queue of a window in idle mode with the last frame.
+ * If nothing changed, the frame is skipped. Otherwise the window is cleared, unless it uses partial redraw.
+ * 
+ * @return unsigned int The count of objects to be drawn.
+ */
+static unsigned int CGPrepareIdleFrame(CGWindow* window, unsigned int count)
+{
+    // the queue is sorted, so the hash also changes if the order that the objects are drawn in changes
+    unsigned long long hash = CGHashBytes(14695981039346656037ULL, &window->width, sizeof(window->width));
+    hash = CGHashBytes(hash, &window->height, sizeof(window->height));
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned long long item_hash = CGHashRenderQueueItem(&cg_render_queue[i]);
+        hash = CGHashBytes(hash, &item_hash, sizeof(item_hash));
+        if (cg_render_queue[i].has_bounds)
+            hash = CGHashBytes(hash, &cg_render_queue[i].bounds, sizeof(CGAABB));
+    }
+    window->is_idle = !window->is_redraw_requested && hash == window->frame_hash;
+    window->is_redraw_requested = CG_FALSE;
+    window->frame_hash = hash;
+    if (window->is_idle)
+        return 0;
+    if (window->redraw_state == NULL)
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return count;
+}
+
+// free the temporary objects in the render list of the window and empty the list
+static void CGClearRenderList(CGWindow* window)
+{
+    CGRenderNode* draw_obj = window->render_list->next;
+    while (draw_obj != NULL)
+    {
+        CGRenderNodeData* data = (CGRenderNodeData*)(draw_obj->data);
+        CGFreeTempRenderObject(draw_obj->identifier, data->object);
+        free(data);
+        CGRemoveLinkedListNode(&draw_obj);
+    }
+    window->render_list->next = NULL;
+    window->render_list_tail = window->render_list;
+    window->render_list_count = 0;
+}
+
+// draw the render list of the window, and the visible objects of the spatial index if it is not NULL
+static void CGDrawRenderList(CGWindow* window, const CGAABB* viewport, CGSpatialIndex* spatial_index)
+{
+    unsigned int count = window->render_list_count;
+    if (!CGReserveRenderQueue(count))
+    {
+        // the list is still emptied, so that it does not grow with every failed frame
+        CGClearRenderList(window);
+        return;
+    }
+    CG_PROFILE_BEGIN(BuildRenderQueue);
+    unsigned int index = 0;
+    for (CGRenderNode* p = window->render_list->next; p != NULL && index < count; p = p->next)
+    {
+        ++cg_frame_stats.objects_submitted;
+        CGRenderNodeData* data = (CGRenderNodeData*)p->data;
+        // the bounds are computed now, because the object and its property may change after CGDraw
+        CGAABB bounds;
+        CG_BOOL has_bounds = CGGetRenderObjectBounds(data->object, p->identifier, data->property, &bounds);
+        if (has_bounds && !CGIsAABBOverlapping(&bounds, viewport))
+        {
+            ++cg_frame_stats.objects_culled;
+            continue;
+        }
+        CGPushRenderQueueItem(index, p->identifier, data->object, data->property, has_bounds ? &bounds : NULL, index);
+        ++index;
+    }
+    count = index;
+    if (spatial_index != NULL)
+    {
+        // objects out of the viewport are never visited, so they are not counted as culled
+        CGRenderQueueBuilder builder = {count, window->render_list_count, CG_TRUE};
+        CGQuerySpatialIndex(spatial_index, viewport, CGPushSpatialIndexRenderQueueItem, &builder);
+        if (!builder.is_success)
+        {
+            CG_PROFILE_END(BuildRenderQueue);
+            CGClearRenderList(window);
+            return;
+        }
+        cg_frame_stats.objects_submitted += builder.count - count;
+        count = builder.count;
+    }
+    CG_PROFILE_END(BuildRenderQueue);
+    // sort from back to front, and give each object its own depth between 0 and 1
+    CG_PROFILE_BEGIN(SortRenderQueue);
+    qsort(cg_render_queue, count, sizeof(CGRenderQueueItem), CGCompareRenderQueueItem);
+    for (unsigned int i = 0; i < count; ++i)
+        cg_render_queue[i].depth = (float)(count - i) / (float)(count + 1);
+    CG_PROFILE_END(SortRenderQueue);
+    if (window->sub_property.idle_mode && cg_current_render_layer == NULL)
+        count = CGPrepareIdleFrame(window, count);
+    CG_BOOL is_redraw = window->redraw_state != NULL && cg_current_render_layer == NULL && !window->is_idle;
+    if (is_redraw)
+        count = CGPrepareRedraw(window, viewport, count);
+
+    CG_PROFILE_BEGIN(DrawRenderQueue);
+    glEnable(GL_DEPTH_TEST);
+    // opaque objects are drawn from front to back, so that the hidden fragments are rejected by the depth test
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    for (unsigned int i = count; i > 0; --i)
+    {
+        if (cg_render_queue[i - 1].is_opaque)
+            CGRenderQueueItemObject(window, &cg_render_queue[i - 1]);
+    }
+    CGFlushColoredGeometryBatch(window);
+
+    // translucent objects are blended from back to front on top of the opaque objects
+    glEnable(GL_BLEND);
+    glDepthMask(GL_FALSE);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!cg_render_queue[i].is_opaque)
+            CGRenderQueueItemObject(window, &cg_render_queue[i]);
+    }
+    CGFlushColoredGeometryBatch(window);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_DEPTH_TEST);
+    if (window->gpu_profiler != NULL)
+        CGGPUProfilerSetZone(window->gpu_profiler, CG_GPU_ZONE_OTHER);
+    if (is_redraw)
+        CGPresentRedrawFrameBuffer(window);
+    CG_PROFILE_END(DrawRenderQueue);
+    CGClearRenderList(window);
+}
+
+void CGWindowDraw(CGWindow* window)
+{
+    if (glfwGetCurrentContext() != window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
+    if (window->command_recorder != NULL)
+        CGCommandRecorderWindowDraw(window->command_recorder);
+    CGAABB viewport;
+    viewport.max = CGConstructVector2((float)window->width / 2.0f, (float)window->height / 2.0f);
+    viewport.min = CGConstructVector2(-viewport.max.x, -viewport.max.y);
+    CG_PROFILE_BEGIN(WindowDraw);
+    CGDrawRenderList(window, &viewport, window->spatial_index);
+    // skipped idle frames are still on the screen with their overlay
+    if (window->performance_overlay != NULL && cg_current_render_layer == NULL && !window->is_idle)
+        CGDrawPerformanceOverlay(window);
+    if (cg_current_render_layer == NULL)
+        window->is_drawn = CG_TRUE;
+    CG_PROFILE_END(WindowDraw);
+}
+
+static void CGDeleteRenderLayer(CGRenderLayer* layer)
+{
+    if (layer == NULL)
+        return;
+    // the contexts share their objects, so any current context can delete them
+    if (glfwGetCurrentContext() != NULL)
+    {
+        glDeleteFramebuffers(1, &layer->frame_buffer);
+        glDeleteRenderbuffers(1, &layer->depth_render_buffer);
+        CGGLDeleteTextures(1, &layer->visual_image.texture_id);
+    }
+    free(layer);
+}
+
+CGRenderLayer* CGCreateRenderLayer(int width, int height, CGWindow* window)
+{
+    CG_ERROR_COND_RETURN(window == NULL || window->glfw_window_instance == NULL, NULL, CGSTR("Cannot create render layer with NULL window."));
+    CG_ERROR_COND_RETURN(width <= 0 || height <= 0, NULL, CGSTR("Cannot create render layer of size: %dx%d."), width, height);
+    CGGladInitializeCheck();
+    CGRenderLayer* layer = (CGRenderLayer*)CGMalloc(sizeof(CGRenderLayer));
+    CG_ERROR_COND_RETURN(layer == NULL, NULL, CGSTR("Failed to allocate memory for render layer."));
+    if (glfwGetCurrentContext() != window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
+    CGVisualImage* visual_image = &layer->visual_image;
+    visual_image->in_window = window;
+    visual_image->is_temp = CG_FALSE;
+    visual_image->img_width = (unsigned int)width;
+    visual_image->img_height = (unsigned int)height;
+    visual_image->img_channels = 4;
+    visual_image->clamp_top_left = (CGVector2){0.0f, 0.0f};
+    visual_image->clamp_bottom_right = (CGVector2){(float)width, (float)height};
+    visual_image->is_clamped = CG_FALSE;
+    // the layer is cleared to transparent before it is drawn
+    visual_image->has_transparency = CG_TRUE;
+    // the objects are blended into the layer, so its colors are multiplied by the coverage
+    visual_image->is_premultiplied = CG_TRUE;
+    layer->is_valid = CG_FALSE;
+    layer->saved_render_list = NULL;
+    layer->saved_render_list_tail = NULL;
+    layer->saved_render_list_count = 0;
+
+    CGGLGenTextures(1, &visual_image->texture_id);
+    CGGLBindTexture(GL_TEXTURE_2D, visual_image->texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    CGGLTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    CGGLBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &layer->frame_buffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer->frame_buffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, visual_image->texture_id, 0);
+    // the render list is drawn with depth test, so the layer needs its own depth buffer
+    glGenRenderbuffers(1, &layer->depth_render_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, layer->depth_render_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, layer->depth_render_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, CGGetWindowDrawFrameBuffer(window));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        CGDeleteRenderLayer(layer);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to create render layer frame buffer."));
+    }
+    CGRegisterResource(layer, CG_DELETER(CGDeleteRenderLayer));
+    return layer;
+}
+
+CG_BOOL CGBeginRenderLayer(CGRenderLayer* layer)
+{
+    CG_ERROR_COND_RETURN(layer == NULL, CG_FALSE, CGSTR("Cannot begin NULL render layer."));
+    CG_ERROR_COND_RETURN(cg_current_render_layer != NULL, CG_FALSE, CGSTR("Cannot begin a render layer inside another render layer."));
+    CGWindow* window = layer->visual_image.in_window;
+    if (glfwGetCurrentContext() != window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
+    // the objects drawn into the window so far are set aside until the layer ends
+    layer->saved_render_list = window->render_list->next;
+    layer->saved_render_list_tail = window->render_list_tail;
+    layer->saved_render_list_count = window->render_list_count;
+    window->render_list->next = NULL;
+    window->render_list_tail = window->render_list;
+    window->render_list_count = 0;
+
+    glGetIntegerv(GL_VIEWPORT, layer->saved_viewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, layer->saved_clear_color);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer->frame_buffer);
+    glViewport(0, 0, (int)layer->visual_image.img_width, (int)layer->visual_image.img_height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // accumulate the coverage in the alpha channel, so that the layer can be blended into the window
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    cg_current_render_layer = layer;
+    return CG_TRUE;
+}
+
+void CGEndRenderLayer(CGRenderLayer* layer)
+{
+    CG_ERROR_CONDITION(layer == NULL || layer != cg_current_render_layer, CGSTR("Cannot end a render layer that is not begun."));
+    CGWindow* window = layer->visual_image.in_window;
+    if (glfwGetCurrentContext() != window->glfw_window_instance)
+        glfwMakeContextCurrent((GLFWwindow*)window->glfw_window_instance);
+    CGAABB viewport;
+    viewport.max = CGConstructVector2((float)layer->visual_image.img_width / 2.0f, (float)layer->visual_image.img_height / 2.0f);
+    viewport.min = CGConstructVector2(-viewport.max.x, -viewport.max.y);
+    CGDrawRenderList(window, &viewport, NULL);
+    cg_current_render_layer = NULL;
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindFramebuffer(GL_FRAMEBUFFER, CGGetWindowDrawFrameBuffer(window));
+    glViewport(layer->saved_viewport[0], layer->saved_viewport[1], layer->saved_viewport[2], layer->saved_viewport[3]);
+    glClearColor(layer->saved_clear_color[0], layer->saved_clear_color[1], layer->saved_clear_color[2], layer->saved_clear_color[3]);
+    window->render_list->next = layer->saved_render_list;
+    window->render_list_tail = layer->saved_render_list_tail;
+    window->render_list_count = layer->saved_render_list_count;
+    layer->saved_render_list = NULL;
+    layer->is_valid = CG_TRUE;
+    // the texture keeps its id, so partial redraw cannot tell where the layer is drawn with the new content
+    CGInvalidateWindowRect(window, NULL);
+}
+
+void CGInvalidateRenderLayer(CGRenderLayer* layer)
+{
+    CG_ERROR_CONDITION(layer == NULL, CGSTR("Cannot invalidate NULL render layer."));
+    layer->is_valid = CG_FALSE;
+}
+
+CG_BOOL CGIsRenderLayerValid(const CGRenderLayer* layer)
+{
+    CG_ERROR_COND_RETURN(layer == NULL, CG_FALSE, CGSTR("Cannot check NULL render layer."));
+    return layer->is_valid;
+}
+
+void CGTickRenderEnd()
+{
+    unsigned long long allocation_count = CGGetAllocationCount();
+    cg_frame_stats.allocations = (unsigned int)(allocation_count - cg_frame_allocation_start);
+    cg_frame_allocation_start = allocation_count;
+    cg_frame_stats.texture_memory = cg_texture_memory_size;
+    cg_last_frame_stats = cg_frame_stats;
+    memset(&cg_frame_stats, 0, sizeof(CGFrameStats));
+    if (cg_time_source == CG_TIME_SOURCE_FIXED_STEP)
+        cg_fixed_step_time += cg_fixed_time_step;
+    CGResourceSystemUpdate();
+    //check OpenGL error
+    int gl_error_code = glGetError();
+    CG_ERROR_COND_EXIT(gl_error_code != GL_NO_ERROR, -1, CGSTR("OpenGL Error: Error code: 0x%x."), gl_error_code);
+}
+
+CGFrameStats CGGetFrameStats()
+{
+    return cg_last_frame_stats;
+}
+
+CG_BOOL CGShouldWindowClose(CGWindow* window)
+{
+    return (CG_BOOL)glfwWindowShouldClose(window->glfw_window_instance);
+}
+
+void CGSetRealTimeSource()
+{
+    cg_time_source = CG_TIME_SOURCE_REAL;
+}
+
+void CGSetFixedStepTimeSource(double start_time, double step)
+{
+    CG_ERROR_CONDITION(step < 0.0, CGSTR("The step of the time source cannot be negative."));
+    cg_time_source = CG_TIME_SOURCE_FIXED_STEP;
+    cg_fixed_step_time = start_time;
+    cg_fixed_time_step = step;
+}
+
+void CGSetTimeSourceCallback(CGTimeSourceCallback callback, void* user_data)
+{
+    CG_ERROR_CONDITION(callback == NULL, CGSTR("Cannot set NULL time source callback."));
+    cg_time_source = CG_TIME_SOURCE_CALLBACK;
+    cg_time_source_callback = callback;
+    cg_time_source_user_data = user_data;
+}
+
+int CGGetTimeSource()
+{
+    return cg_time_source;
+}
+
+double CGGetCurrentTime()
+{
+    switch (cg_time_source)
+    {
+    case CG_TIME_SOURCE_FIXED_STEP:
+        return cg_fixed_step_time;
+    case CG_TIME_SOURCE_CALLBACK:
+        return cg_time_source_callback(cg_time_source_user_data);
+    default:
+        return glfwGetTime();
+    }
+}
+
+double CGGetRealTime()
+{
+    return glfwGetTime();
+}
+
+CGShaderSource* CGCreateShaderSource(const char* vertex, const char* fragment, 
+    const char* geometry, CG_BOOL use_geometry)
+{
+    CG_ERROR_COND_RETURN(vertex == NULL || fragment == NULL, NULL, CGSTR("Shader source cannot be NULL."));
+    CGShaderSource* result = (CGShaderSource*)CGMalloc(sizeof(CGShaderSource));
+    if (result == NULL)
+    {
+        CG_ERROR(CGSTR("Construct shader source failed"));
+        return NULL;
+    }
+    strcpy(result->vertex, vertex);
+    strcpy(result->fragment, fragment);
+    if (use_geometry)
+        strcpy(result->geometry, geometry);
+    result->use_geometry = use_geometry;
+    CGRegisterResource(result, CG_DELETER(CGDeleteShaderSource));
+    return result;
+}
+
+CGShaderSource* CGCreateShaderSourceFromPath(const CGChar* vertex_rk, const CGChar* fragment_rk, 
+    const CGChar* geometry_rk, CG_BOOL use_geometry)
+{
+    CGShaderSource* result = (CGShaderSource*)CGMalloc(sizeof(CGShaderSource));
+    if (result == NULL)
+    {
+        CG_ERROR(CGSTR("Construct shader source failed."));
+        return NULL;
+    }
+    result->vertex = CGLoadResource(vertex_rk, NULL, NULL);
+    if (result->vertex == NULL)
+    {
+        CG_ERROR(CGSTR("Load vertex shader source failed."));
+        free(result);
+        return NULL;
+    }
+    result->fragment = CGLoadResource(fragment_rk, NULL, NULL);
+    if (result->fragment == NULL)
+    {
+        CG_ERROR(CGSTR("Load fragment shader source failed."));
+        free(result->vertex);
+        free(result);
+        return NULL;
+    }
+    if (use_geometry)
+    {
+        result->geometry = CGLoadResource(geometry_rk, NULL, NULL);
+        if (result->geometry == NULL)
         {
             CG_ERROR(CGSTR("Load geometry shader source failed."));
             free(result->vertex);
@@ -972,7 +2522,7 @@ static CG_BOOL CGCompileShader(unsigned int shader_id, const char* shader_source
 CGShader* CGCreateShader(CGShaderSource* shader_source)
 {
     CG_ERROR_COND_RETURN(shader_source == NULL, NULL, CGSTR("Attempting to compile a NULL shader source."));
-    CGShader* shader = (CGShader*)malloc(sizeof(CGShader));
+    CGShader* shader = (CGShader*)CGMalloc(sizeof(CGShader));
     CG_ERROR_COND_RETURN(shader == NULL, NULL, CGSTR("Construct shader failed."));
     shader->vertex = glCreateShader(GL_VERTEX_SHADER);
     if (!CGCompileShader(shader->vertex, shader_source->vertex))
@@ -1046,6 +2596,7 @@ void CGSetShaderUniform1f(CGShaderProgram shader_program, const char* uniform_na
     CGGladInitializeCheck();
     GLint uniform_location = glGetUniformLocation(shader_program, uniform_name);
     glUniform1f(uniform_location, value);
+    ++cg_frame_stats.uniform_sets;
 }
 
 void CGSetShaderUniform1i(CGShaderProgram shader_program, const char* uniform_name, CG_BOOL value)
@@ -1054,6 +2605,7 @@ void CGSetShaderUniform1i(CGShaderProgram shader_program, const char* uniform_na
     CGGladInitializeCheck();
     GLint uniform_location = glGetUniformLocation(shader_program, uniform_name);
     glUniform1i(uniform_location, value);
+    ++cg_frame_stats.uniform_sets;
 }
 
 void CGSetShaderUniformVec2f(CGShaderProgram shader_program, const char* uniform_name, CGVector2 value)
@@ -1062,6 +2614,7 @@ void CGSetShaderUniformVec2f(CGShaderProgram shader_program, const char* uniform
     CGGladInitializeCheck();
     GLint uniform_location = glGetUniformLocation(shader_program, uniform_name);
     glUniform2f(uniform_location, value.x, value.y);
+    ++cg_frame_stats.uniform_sets;
 }
 
 void CGSetShaderUniformVec4f(
@@ -1072,6 +2625,7 @@ void CGSetShaderUniformVec4f(
     CG_ERROR_CONDITION(uniform_name == NULL, CGSTR("Attempting to set a uniform with a NULL name."));
     GLint uniform_location = glGetUniformLocation(shader_program, uniform_name);
     glUniform4f(uniform_location, val_1, val_2, val_3, val_4);
+    ++cg_frame_stats.uniform_sets;
 }
 
 void CGSetShaderUniformMat4f(CGShaderProgram shader_program, const char* uniform_name, const float* data)
@@ -1080,15 +2634,18 @@ void CGSetShaderUniformMat4f(CGShaderProgram shader_program, const char* uniform
     CG_ERROR_CONDITION(uniform_name == NULL, CGSTR("Attempting to set a uniform with a NULL name."));
     GLint uniform_location = glGetUniformLocation(shader_program, uniform_name);
     glUniformMatrix4fv(uniform_location, 1, GL_FALSE, data);
+    ++cg_frame_stats.uniform_sets;
 }
 
 void CGDraw(void* draw_object, CGRenderObjectProperty* draw_property, CGWindow* window, int object_type)
 {
-    CGRenderNodeData* data = (CGRenderNodeData*)malloc(sizeof(CGRenderNodeData));
+    CGRenderNodeData* data = (CGRenderNodeData*)CGMalloc(sizeof(CGRenderNodeData));
     CG_ERROR_CONDITION(data == NULL, CGSTR("Failed to allocate memory for draw object data."));
+    if (window->command_recorder != NULL)
+        CGCommandRecorderDraw(window->command_recorder, draw_object, draw_property, object_type);
     data->object = draw_object;
     data->property = draw_property;
-    CGAddRenderListNode(window->render_list, CGCreateLinkedListNode(data, object_type));
+    CGAddRenderListNode(window, CGCreateLinkedListNode(data, object_type));
 }
 
 static void CGCreateRenderList(CGWindow* window)
@@ -1097,39 +2654,24 @@ static void CGCreateRenderList(CGWindow* window)
     if (window->render_list != NULL)
         free(window->render_list);
     window->render_list = CGCreateLinkedListNode(NULL, CG_LIST_HEAD);
+    window->render_list_tail = window->render_list;
+    window->render_list_count = 0;
 }
 
-static void CGAddRenderListNode(CGRenderNode* list_head, CGRenderNode* node)
+static void CGAddRenderListNode(CGWindow* window, CGRenderNode* node)
 {
-    if (node == NULL || list_head == NULL)
+    if (node == NULL || window == NULL || window->render_list == NULL)
         return;
-    // using list_head as an temperary variable
-    while (list_head->next != NULL)
-    {
-        float current_z = 0;
-        if (CG_EXTRACT_RENDER_NODE_DATA(node)->property != NULL)
-            current_z = CG_EXTRACT_RENDER_NODE_DATA(node)->property->z;
-        float next_z = 0;
-        if (CG_EXTRACT_RENDER_NODE_DATA(list_head->next)->property != NULL)
-            next_z = CG_EXTRACT_RENDER_NODE_DATA(list_head->next)->property->z;
-        if (current_z > next_z)
-        {
-            CGRenderNode* temp = list_head->next;
-            list_head->next = node;
-            node->next = temp;
-            return;
-        }
-        list_head = list_head->next;
-    }
-    CGRenderNode* temp = list_head->next;
-    list_head->next = node;
-    node->next = temp;
-    
+    // the list is sorted when the window is drawn, so the node is just appended
+    window->render_list_tail->next = node;
+    node->next = NULL;
+    window->render_list_tail = node;
+    ++window->render_list_count;
 }
 
 CGRenderObjectProperty* CGCreateRenderObjectProperty(CGColor color, CGVector2 transform, CGVector2 scale, float rotation)
 {
-    CGRenderObjectProperty* property = (CGRenderObjectProperty*)malloc(sizeof(CGRenderObjectProperty));
+    CGRenderObjectProperty* property = (CGRenderObjectProperty*)CGMalloc(sizeof(CGRenderObjectProperty));
     CG_ERROR_COND_RETURN(property == NULL, NULL, CGSTR("Failed to allocate memory for CGRenderObjectProperty."));
     property->color = color;
     property->transform = transform;
@@ -1137,6 +2679,7 @@ CGRenderObjectProperty* CGCreateRenderObjectProperty(CGColor color, CGVector2 tr
     property->rotation = rotation;
     property->z = 0;
     property->modify_matrix = NULL;
+    property->is_opaque = CG_FALSE;
     CGRegisterResource(property, CG_DELETER(free));
     return property;
 }
@@ -1154,7 +2697,7 @@ void CGRotateRenderObject(CGRenderObjectProperty* property, float rotation, CGVe
 
 static float* CGCreateTransformMatrix(CGVector2 transform)
 {
-    float* result = (float*)malloc(sizeof(float) * 16);
+    float* result = (float*)CGMalloc(sizeof(float) * 16);
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for transform matrix."));
     memcpy(result, cg_normal_matrix, sizeof(float) * 16);
     result[12] = transform.x;
@@ -1165,7 +2708,7 @@ static float* CGCreateTransformMatrix(CGVector2 transform)
 
 static float* CGCreateScaleMatrix(CGVector2 scale)
 {
-    float* result = (float*)malloc(sizeof(float) * 16);
+    float* result = (float*)CGMalloc(sizeof(float) * 16);
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for scale matrix."));
     memcpy(result, cg_normal_matrix, sizeof(float) * 16);
     result[0] = scale.x;
@@ -1175,7 +2718,7 @@ static float* CGCreateScaleMatrix(CGVector2 scale)
 
 static float* CGCreateRotateMatrix(float rotate)
 {
-    float* result = (float*)malloc(sizeof(float) * 16);
+    float* result = (float*)CGMalloc(sizeof(float) * 16);
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for rotation matrix."));
     memcpy(result, cg_normal_matrix, sizeof(float) * 16);
     if (rotate == 0)
@@ -1194,14 +2737,14 @@ static void CGMatMultiply(float* result, const float* mat_1, const float* mat_2,
     float *temp1 = NULL, *temp2 = NULL;
     if (mat_1 == result)
     {
-        temp1 = (float*)malloc(sizeof(float) * dimension_x * dimension_y);
+        temp1 = (float*)CGMalloc(sizeof(float) * dimension_x * dimension_y);
         CG_ERROR_CONDITION(temp1 == NULL, CGSTR("Failed to allocate memory for temp matrix."));
         memcpy(temp1, mat_1, sizeof(float) * dimension_x * dimension_y);
         mat_1 = temp1;
     }
     if (mat_2 == result)
     {
-        temp2 = (float*)malloc(sizeof(float) * dimension_x * dimension_y);
+        temp2 = (float*)CGMalloc(sizeof(float) * dimension_x * dimension_y);
         if (temp2 == NULL)
         {
             if (temp1 != NULL)
@@ -1235,12 +2778,9 @@ static void CGMatMultiply(float* result, const float* mat_1, const float* mat_2,
     }
 }
 
-static void CGSetPropertyUniforms(CGShaderProgram shader_program, const CGRenderObjectProperty* property)
+static void CGGetPropertyMatrix(const CGRenderObjectProperty* property, float* result)
 {
-    CG_ERROR_CONDITION(property == NULL, CGSTR("Attempting to set uniforms out of a NULL property"));
-    CGSetShaderUniformVec4f(shader_program, "color", 
-        property->color.r, property->color.g, property->color.b, property->color.alpha);
-    float result[16] = {0};
+    CG_ERROR_CONDITION(property == NULL || result == NULL, CGSTR("Attempting to get matrix out of a NULL property"));
     if (property->modify_matrix != NULL)
     {
         memcpy(result, property->modify_matrix, sizeof(float) * 16);
@@ -1270,6 +2810,240 @@ static void CGSetPropertyUniforms(CGShaderProgram shader_program, const CGRender
         CGMatMultiply(result, tmp_mat, result, 4, 4);
         free(tmp_mat);
     }
+}
+
+CG_BOOL CGIsAABBOverlapping(const CGAABB* aabb_1, const CGAABB* aabb_2)
+{
+    CG_ERROR_COND_RETURN(aabb_1 == NULL || aabb_2 == NULL, CG_FALSE, CGSTR("Cannot check overlapping of NULL bounding boxes."));
+    return aabb_1->min.x <= aabb_2->max.x && aabb_1->max.x >= aabb_2->min.x
+        && aabb_1->min.y <= aabb_2->max.y && aabb_1->max.y >= aabb_2->min.y;
+}
+
+// apply a model matrix to a position the same way as the shaders do
+static CGVector2 CGApplyModelMatrix(const float* model_mat, CGVector2 position)
+{
+    return CGConstructVector2(
+        model_mat[0] * position.x + model_mat[4] * position.y + model_mat[12],
+        model_mat[1] * position.x + model_mat[5] * position.y + model_mat[13]);
+}
+
+static void CGGetRenderObjectMatrix(const CGRenderObjectProperty* property, float* model_mat)
+{
+    // every default property has no transformation
+    if (property != NULL)
+        CGGetPropertyMatrix(property, model_mat);
+    else
+        memcpy(model_mat, cg_normal_matrix, sizeof(float) * 16);
+}
+
+static void CGExpandAABB(CGAABB* aabb, const float* model_mat, CGVector2 position)
+{
+    CGVector2 world_position = CGApplyModelMatrix(model_mat, position);
+    if (world_position.x < aabb->min.x)
+        aabb->min.x = world_position.x;
+    if (world_position.y < aabb->min.y)
+        aabb->min.y = world_position.y;
+    if (world_position.x > aabb->max.x)
+        aabb->max.x = world_position.x;
+    if (world_position.y > aabb->max.y)
+        aabb->max.y = world_position.y;
+}
+
+CG_BOOL CGGetRenderObjectBounds(const void* object, int object_type, const CGRenderObjectProperty* property, CGAABB* result)
+{
+    CG_ERROR_COND_RETURN(object == NULL || result == NULL, CG_FALSE, CGSTR("Cannot get bounds of a NULL render object."));
+    float model_mat[16];
+    CGGetRenderObjectMatrix(property, model_mat);
+    result->min = CGConstructVector2(FLT_MAX, FLT_MAX);
+    result->max = CGConstructVector2(-FLT_MAX, -FLT_MAX);
+    switch (object_type)
+    {
+    case CG_RD_TYPE_TRIANGLE:
+        for (int i = 0; i < 3; ++i)
+            CGExpandAABB(result, model_mat, ((const CGTriangle*)object)->vertices[i]);
+        return CG_TRUE;
+    case CG_RD_TYPE_QUADRANGLE:
+        for (int i = 0; i < 4; ++i)
+            CGExpandAABB(result, model_mat, ((const CGQuadrangle*)object)->vertices[i]);
+        return CG_TRUE;
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+        for (int i = 0; i < 3; ++i)
+            CGExpandAABB(result, model_mat, ((const CGColoredTriangle*)object)->vertices[i]);
+        return CG_TRUE;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        for (int i = 0; i < 4; ++i)
+            CGExpandAABB(result, model_mat, ((const CGColoredQuadrangle*)object)->vertices[i]);
+        return CG_TRUE;
+    case CG_RD_TYPE_VISUAL_IMAGE:
+    {
+        const CGVisualImage* visual_image = (const CGVisualImage*)object;
+        float half_width = (float)visual_image->img_width / 2.0f;
+        float half_height = (float)visual_image->img_height / 2.0f;
+        CGExpandAABB(result, model_mat, CGConstructVector2(-half_width, -half_height));
+        CGExpandAABB(result, model_mat, CGConstructVector2(half_width, -half_height));
+        CGExpandAABB(result, model_mat, CGConstructVector2(half_width, half_height));
+        CGExpandAABB(result, model_mat, CGConstructVector2(-half_width, half_height));
+        return CG_TRUE;
+    }
+    case CG_RD_TYPE_POLYGON:
+    case CG_RD_TYPE_COLORED_POLYGON:
+    {
+        const CGPolygonVertex* head = ((const CGPolygon*)object)->vertex_head;
+        CG_ERROR_COND_RETURN(head == NULL, CG_FALSE, CGSTR("Cannot get bounds of a polygon without vertices."));
+        const CGPolygonVertex* p = head;
+        do
+        {
+            CGExpandAABB(result, model_mat, p->position);
+            p = p->next;
+        } while (p != head);
+        return CG_TRUE;
+    }
+    default:
+        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Cannot get bounds of render object type: %d"), object_type);
+    }
+    return CG_FALSE;
+}
+
+static CG_BOOL CGIsTriangleOverlappingAABB(const CGVector2* vertices, const CGAABB* rect)
+{
+    CGAABB bounds = {vertices[0], vertices[0]};
+    for (int i = 1; i < 3; ++i)
+    {
+        bounds.min.x = vertices[i].x < bounds.min.x ? vertices[i].x : bounds.min.x;
+        bounds.min.y = vertices[i].y < bounds.min.y ? vertices[i].y : bounds.min.y;
+        bounds.max.x = vertices[i].x > bounds.max.x ? vertices[i].x : bounds.max.x;
+        bounds.max.y = vertices[i].y > bounds.max.y ? vertices[i].y : bounds.max.y;
+    }
+    if (!CGIsAABBOverlapping(&bounds, rect))
+        return CG_FALSE;
+    // separating axis test against the normals of the edges of the triangle
+    CGVector2 corners[4] = {rect->min, {rect->max.x, rect->min.y}, rect->max, {rect->min.x, rect->max.y}};
+    for (int i = 0; i < 3; ++i)
+    {
+        CGVector2 edge = CGVector2Sub(vertices[(i + 1) % 3], vertices[i]);
+        CGVector2 normal = CGConstructVector2(-edge.y, edge.x);
+        float triangle_min = FLT_MAX, triangle_max = -FLT_MAX;
+        for (int j = 0; j < 3; ++j)
+        {
+            float projection = normal.x * vertices[j].x + normal.y * vertices[j].y;
+            triangle_min = projection < triangle_min ? projection : triangle_min;
+            triangle_max = projection > triangle_max ? projection : triangle_max;
+        }
+        float rect_min = FLT_MAX, rect_max = -FLT_MAX;
+        for (int j = 0; j < 4; ++j)
+        {
+            float projection = normal.x * corners[j].x + normal.y * corners[j].y;
+            rect_min = projection < rect_min ? projection : rect_min;
+            rect_max = projection > rect_max ? projection : rect_max;
+        }
+        if (triangle_max < rect_min || rect_max < triangle_min)
+            return CG_FALSE;
+    }
+    return CG_TRUE;
+}
+
+/**
+ * @brief Data used by the hit test of the triangles of a render object.
+ */
+typedef struct{
+    const float* model_mat;
+    const CGAABB* rect;
+    CG_BOOL is_hit;
+}CGHitTestData;
+
+static CG_BOOL CGHitTestTriangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 vert_3, CGHitTestData* data)
+{
+    CGVector2 vertices[3] = {
+        CGApplyModelMatrix(data->model_mat, vert_1),
+        CGApplyModelMatrix(data->model_mat, vert_2),
+        CGApplyModelMatrix(data->model_mat, vert_3)
+    };
+    data->is_hit = CGIsTriangleOverlappingAABB(vertices, data->rect);
+    return data->is_hit;
+}
+
+static void CGHitTestQuadrangle(const CGVector2* vertices, CGHitTestData* data)
+{
+    // split the quadrangle the same way as it is drawn
+    unsigned int indices[6];
+    CGGetQuadrangleIndices(vertices, indices);
+    if (!CGHitTestTriangle(vertices[indices[0]], vertices[indices[1]], vertices[indices[2]], data))
+        CGHitTestTriangle(vertices[indices[3]], vertices[indices[4]], vertices[indices[5]], data);
+}
+
+static CG_BOOL CGHitTestPolygonEar(const CGPolygonVertex* vert_1, const CGPolygonVertex* vert_2, const CGPolygonVertex* vert_3, void* user_data)
+{
+    // stop clipping once a triangle is hit
+    return !CGHitTestTriangle(vert_1->position, vert_2->position, vert_3->position, (CGHitTestData*)user_data);
+}
+
+CG_BOOL CGIsRenderObjectOverlappingRect(const void* object, int object_type, const CGRenderObjectProperty* property, const CGAABB* rect)
+{
+    CG_ERROR_COND_RETURN(object == NULL || rect == NULL, CG_FALSE, CGSTR("Cannot hit test a NULL render object or rectangle."));
+    float model_mat[16];
+    CGGetRenderObjectMatrix(property, model_mat);
+    CGHitTestData data = {model_mat, rect, CG_FALSE};
+    switch (object_type)
+    {
+    case CG_RD_TYPE_TRIANGLE:
+    {
+        const CGVector2* vertices = ((const CGTriangle*)object)->vertices;
+        CGHitTestTriangle(vertices[0], vertices[1], vertices[2], &data);
+        break;
+    }
+    case CG_RD_TYPE_COLORED_TRIANGLE:
+    {
+        const CGVector2* vertices = ((const CGColoredTriangle*)object)->vertices;
+        CGHitTestTriangle(vertices[0], vertices[1], vertices[2], &data);
+        break;
+    }
+    case CG_RD_TYPE_QUADRANGLE:
+        CGHitTestQuadrangle(((const CGQuadrangle*)object)->vertices, &data);
+        break;
+    case CG_RD_TYPE_COLORED_QUADRANGLE:
+        CGHitTestQuadrangle(((const CGColoredQuadrangle*)object)->vertices, &data);
+        break;
+    case CG_RD_TYPE_VISUAL_IMAGE:
+    {
+        // only the part of the image inside the clamp rectangle is visible
+        const CGVisualImage* visual_image = (const CGVisualImage*)object;
+        float half_width = (float)visual_image->img_width / 2.0f;
+        float half_height = (float)visual_image->img_height / 2.0f;
+        CGVector2 min = CGConstructVector2(-half_width, -half_height);
+        CGVector2 max = CGConstructVector2(half_width, half_height);
+        if (visual_image->is_clamped)
+        {
+            // the clamp rectangle is in pixels from the top left corner of the image
+            min.x = fmaxf(min.x, -half_width + visual_image->clamp_top_left.x);
+            max.x = fminf(max.x, -half_width + visual_image->clamp_bottom_right.x);
+            min.y = fmaxf(min.y, half_height - visual_image->clamp_bottom_right.y);
+            max.y = fminf(max.y, half_height - visual_image->clamp_top_left.y);
+            if (min.x > max.x || min.y > max.y)
+                break;
+        }
+        CGVector2 vertices[4] = {min, {max.x, min.y}, max, {min.x, max.y}};
+        if (!CGHitTestTriangle(vertices[0], vertices[1], vertices[2], &data))
+            CGHitTestTriangle(vertices[0], vertices[2], vertices[3], &data);
+        break;
+    }
+    case CG_RD_TYPE_POLYGON:
+    case CG_RD_TYPE_COLORED_POLYGON:
+        // hit tests must not consume the vertices of temporary polygons that are still going to be drawn
+        CGClipPolygonEars((CGPolygon*)object, CG_TRUE, CGHitTestPolygonEar, &data);
+        break;
+    default:
+        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Cannot hit test render object type: %d"), object_type);
+    }
+    return data.is_hit;
+}
+
+static void CGSetPropertyUniforms(CGShaderProgram shader_program, const CGRenderObjectProperty* property)
+{
+    CG_ERROR_CONDITION(property == NULL, CGSTR("Attempting to set uniforms out of a NULL property"));
+    CGSetShaderUniformVec4f(shader_program, "color", 
+        property->color.r, property->color.g, property->color.b, property->color.alpha);
+    float result[16] = {0};
+    CGGetPropertyMatrix(property, result);
     CGSetShaderUniformMat4f(shader_program, "model_mat", result);
 }
 
@@ -1285,7 +3059,7 @@ CGTriangle CGConstructTriangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 ver
 
 CGTriangle* CGCreateTriangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 vert_3, CG_BOOL is_temp)
 {
-    CGTriangle* result = (CGTriangle*)malloc(sizeof(CGTriangle));
+    CGTriangle* result = (CGTriangle*)CGMalloc(sizeof(CGTriangle));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for triangle."));
     result->vert_1 = vert_1;
     result->vert_2 = vert_2;
@@ -1295,32 +3069,53 @@ CGTriangle* CGCreateTriangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 vert_
     return result;
 }
 
-static float* CGMakeTriangleVertices(const CGTriangle* triangle, float assigned_z)
+static CG_BOOL CGMakeTriangleVertices(const CGTriangle* triangle, CGVertexBounds* bounds, CGVertexStream* stream)
+{
+    CG_ERROR_COND_RETURN(triangle == NULL, CG_FALSE, CGSTR("Cannot make vertices array out of a triangle of value NULL."));
+    *bounds = CGConstructVertexBounds(triangle->vertices, 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (!CGPushCompactVertex(stream, bounds, triangle->vertices[i]))
+            return CG_FALSE;
+    }
+    return CG_TRUE;
+}
+
+static void CGSetCompactVertexUniforms(CGShaderProgram shader_program, const CGVertexBounds* bounds, float depth)
 {
-    CG_ERROR_COND_RETURN(triangle == NULL, NULL, CGSTR("Cannot make vertices array out of a triangle of value NULL."));
-    static const float denom = (CG_RENDER_FAR - CG_RENDER_NEAR);
-    float depth = (assigned_z - CG_RENDER_NEAR) / denom;
-    CGSetFloatArrayValue(9, cg_global_buffer_f20,
-        triangle->vert_1.x, triangle->vert_1.y, depth,
-        triangle->vert_2.x, triangle->vert_2.y, depth,
-        triangle->vert_3.x, triangle->vert_3.y, depth
-    );
-    return cg_global_buffer_f20;
+    CGSetShaderUniformVec4f(shader_program, "position_bounds", bounds->min_x, bounds->min_y, bounds->max_x, bounds->max_y);
+    CGSetShaderUniform1f(shader_program, "depth", depth);
+}
+
+static void CGSetRenderSizeUniforms(CGShaderProgram shader_program, const CGWindow* window)
+{
+    if (cg_current_render_layer != NULL)
+    {
+        // the rows of a texture start from the bottom, while images are sampled from the top,
+        // so render layers are drawn upside down
+        CGSetShaderUniform1f(shader_program, "render_width", (float)cg_current_render_layer->visual_image.img_width / 2.0f);
+        CGSetShaderUniform1f(shader_program, "render_height", -(float)cg_current_render_layer->visual_image.img_height / 2.0f);
+        return;
+    }
+    CGSetShaderUniform1f(shader_program, "render_width", (float)window->width / 2.0f);
+    CGSetShaderUniform1f(shader_program, "render_height", (float)window->height / 2.0f);
 }
 
 static void CGBindBuffer(GLenum buffer_type, unsigned int buffer, unsigned int buffer_size, void* buffer_data, unsigned int usage)
 {
     CGGladInitializeCheck();
     glBindBuffer(buffer_type, buffer);
-    glBufferData(buffer_type, buffer_size, buffer_data, usage);
+    CGGLBufferData(buffer_type, buffer_size, buffer_data, usage);
 }
 
-static void CGRenderTriangle(const CGTriangle* triangle, const CGRenderObjectProperty* property, const CGWindow* window, float assigned_z)
+static void CGRenderTriangle(const CGTriangle* triangle, const CGRenderObjectProperty* property, const CGWindow* window, float depth)
 {
     CG_ERROR_CONDITION(window == NULL || window->glfw_window_instance == NULL, CGSTR("Attempting to draw triangle on a NULL window."));
     CG_ERROR_CONDITION(triangle == NULL, CGSTR("Attempting to draw a NULL triangle object."));
-    float* triangle_vertices = CGMakeTriangleVertices(triangle, assigned_z);
-    CG_ERROR_CONDITION(triangle_vertices == NULL, CGSTR("Failed to draw triangle."));
+    CGVertexBounds bounds;
+    CGCompactVertex triangle_vertices[3];
+    CGVertexStream stream = CGConstructVertexStream(triangle_vertices, sizeof(CGCompactVertex), 3);
+    CG_ERROR_CONDITION(!CGMakeTriangleVertices(triangle, &bounds, &stream), CGSTR("Failed to draw triangle."));
     CGGladInitializeCheck();
     if (glfwGetCurrentContext() != window->glfw_window_instance)
         glfwMakeContextCurrent(window->glfw_window_instance);
@@ -1328,47 +3123,61 @@ static void CGRenderTriangle(const CGTriangle* triangle, const CGRenderObjectPro
         property = cg_default_geo_property;
 
     //draw
-    glBindVertexArray(window->triangle_vao);
-    glUseProgram(cg_geo_shader_program);
+    CGGLBindVertexArray(window->triangle_vao);
+    CGGLUseProgram(cg_geo_shader_program);
     glBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_TRIANGLE_VBO]);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 9 * sizeof(float), triangle_vertices);
+    CGGLBufferSubData(GL_ARRAY_BUFFER, 0, 3 * sizeof(CGCompactVertex), triangle_vertices);
 
     CGSetPropertyUniforms(cg_geo_shader_program, property);
-    CGSetShaderUniform1f(cg_geo_shader_program, "render_width", (float)window->width / 2.0f);
-    CGSetShaderUniform1f(cg_geo_shader_program, "render_height", (float)window->height / 2.0f);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    CGSetCompactVertexUniforms(cg_geo_shader_program, &bounds, depth);
+    CGSetRenderSizeUniforms(cg_geo_shader_program, window);
+    CGGLDrawArrays(GL_TRIANGLES, 0, 3);
 
-    glBindVertexArray(0);
+    CGGLBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-static float* CGMakeQuadrangleVertices(const CGQuadrangle* quadrangle, float assigned_z)
+static CG_BOOL CGMakeQuadrangleVertices(const CGQuadrangle* quadrangle, CGVertexBounds* bounds, CGVertexStream* stream)
+{
+    CG_ERROR_COND_RETURN(quadrangle == NULL, CG_FALSE, CGSTR("Cannot make vertices array out of a quadrangle of value NULL."));
+    *bounds = CGConstructVertexBounds(quadrangle->vertices, 4);
+    for (int i = 0; i < 4; ++i)
+    {
+        if (!CGPushCompactVertex(stream, bounds, quadrangle->vertices[i]))
+            return CG_FALSE;
+    }
+    return CG_TRUE;
+}
+
+// make the vertices of a rect that shows the part of a texture between the texture coordinates
+static CG_BOOL CGMakeImageRectVerticesWithTexCoords(const CGVertexBounds* bounds, const CGVertexBounds* rect,
+    CGVector2 tex_top_left, CGVector2 tex_bottom_right, CGVertexStream* stream)
+{
+    CGVector2 top_left = CGConstructVector2(rect->min_x, rect->max_y);
+    CGVector2 top_right = CGConstructVector2(rect->max_x, rect->max_y);
+    CGVector2 bottom_right = CGConstructVector2(rect->max_x, rect->min_y);
+    CGVector2 bottom_left = CGConstructVector2(rect->min_x, rect->min_y);
+    return CGPushCompactImageVertex(stream, bounds, top_left, tex_top_left)
+        && CGPushCompactImageVertex(stream, bounds, top_right, CGConstructVector2(tex_bottom_right.x, tex_top_left.y))
+        && CGPushCompactImageVertex(stream, bounds, bottom_right, tex_bottom_right)
+        && CGPushCompactImageVertex(stream, bounds, bottom_left, CGConstructVector2(tex_top_left.x, tex_bottom_right.y));
+}
+
+static CG_BOOL CGMakeImageRectVertices(const CGVertexBounds* bounds, CGVertexStream* stream)
 {
-    CG_ERROR_COND_RETURN(quadrangle == NULL, NULL, CGSTR("Cannot make vertices array out of a quadrangle of value NULL."));
-    float* vertices = cg_global_buffer_f20;
-    float depth = (assigned_z - CG_RENDER_NEAR) / (CG_RENDER_FAR - CG_RENDER_NEAR);
-    CGSetFloatArrayValue(12, vertices, 
-        quadrangle->vert_1.x, quadrangle->vert_1.y, depth,
-        quadrangle->vert_2.x, quadrangle->vert_2.y, depth,
-        quadrangle->vert_3.x, quadrangle->vert_3.y, depth,
-        quadrangle->vert_4.x, quadrangle->vert_4.y, depth
-    );
-    return vertices;
+    return CGMakeImageRectVerticesWithTexCoords(bounds, bounds, CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), stream);
 }
 
-static float* CGMakeVisualImageVertices(const CGVisualImage* visual_image, float assigned_z)
+static CG_BOOL CGMakeVisualImageVertices(const CGVisualImage* visual_image, CGVertexBounds* bounds, CGVertexStream* stream)
 {
-    CG_ERROR_COND_RETURN(visual_image == NULL, NULL, CGSTR("Cannot make vertices array out of a visual_image of value NULL"));
-    float depth = (assigned_z - CG_RENDER_NEAR) / (CG_RENDER_FAR - CG_RENDER_NEAR);
-    double temp_half_width = (double)visual_image->img_width / 2;
-    double temp_half_height = (double)visual_image->img_height / 2;
-    CGSetFloatArrayValue(20, cg_global_buffer_f20,
-        -1 * temp_half_width,      temp_half_height, depth, 0.0, 0.0,
-             temp_half_width,      temp_half_height, depth, 1.0, 0.0,
-             temp_half_width, -1 * temp_half_height, depth, 1.0, 1.0,
-        -1 * temp_half_width, -1 * temp_half_height, depth, 0.0, 1.0
-    );
-    return cg_global_buffer_f20;
+    CG_ERROR_COND_RETURN(visual_image == NULL, CG_FALSE, CGSTR("Cannot make vertices array out of a visual_image of value NULL"));
+    float temp_half_width = (float)visual_image->img_width / 2;
+    float temp_half_height = (float)visual_image->img_height / 2;
+    bounds->min_x = -temp_half_width;
+    bounds->min_y = -temp_half_height;
+    bounds->max_x = temp_half_width;
+    bounds->max_y = temp_half_height;
+    return CGMakeImageRectVertices(bounds, stream);
 }
 
 CGQuadrangle CGConstructQuadrangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 vert_3, CGVector2 vert_4)
@@ -1384,7 +3193,7 @@ CGQuadrangle CGConstructQuadrangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2
 
 CGQuadrangle* CGCreateQuadrangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 vert_3, CGVector2 vert_4, CG_BOOL is_temp)
 {
-    CGQuadrangle* result = (CGQuadrangle*)malloc(sizeof(CGQuadrangle));
+    CGQuadrangle* result = (CGQuadrangle*)CGMalloc(sizeof(CGQuadrangle));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for CGQuadrangle object"));
     result->vert_1 = vert_1;
     result->vert_2 = vert_2;
@@ -1395,78 +3204,491 @@ CGQuadrangle* CGCreateQuadrangle(CGVector2 vert_1, CGVector2 vert_2, CGVector2 v
     return result;
 }
 
-static void CGRenderQuadrangle(const CGQuadrangle* quadrangle, const CGRenderObjectProperty* property, const CGWindow* window, float assigned_z)
+static void CGRenderQuadrangle(const CGQuadrangle* quadrangle, const CGRenderObjectProperty* property, const CGWindow* window, float depth)
 {
     CG_ERROR_CONDITION(window == NULL || window->glfw_window_instance == NULL, CGSTR("Cannot draw quadrangle on a NULL window."));
     CG_ERROR_CONDITION(quadrangle == NULL, CGSTR("Attempting to draw a NULL quadrangle."));
     CGGladInitializeCheck();
-    float* vertices = CGMakeQuadrangleVertices(quadrangle, assigned_z);
-    CG_ERROR_CONDITION(vertices == NULL, CGSTR("Failed to draw quadrangle."));
+    CGVertexBounds bounds;
+    CGCompactVertex vertices[4];
+    CGVertexStream stream = CGConstructVertexStream(vertices, sizeof(CGCompactVertex), 4);
+    CG_ERROR_CONDITION(!CGMakeQuadrangleVertices(quadrangle, &bounds, &stream), CGSTR("Failed to draw quadrangle."));
     if (property == NULL)
         property = cg_default_geo_property;
 
-    CG_BOOL has_reflex = CG_FALSE;
     unsigned int indices[6];
+    CGGetQuadrangleIndices(quadrangle->vertices, indices);
+    
+    //draw
+    CGGLBindVertexArray(window->quadrangle_vao);
+    CGGLUseProgram(cg_default_geo_shader_program);
+    glBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_QUADRANGLE_VBO]);
+    CGGLBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CGCompactVertex) * 4, vertices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_QUADRANGLE_EBO]);
+    CGGLBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * 6, indices, GL_DYNAMIC_DRAW);
+    CGSetPropertyUniforms(cg_geo_shader_program, property);
+    CGSetCompactVertexUniforms(cg_geo_shader_program, &bounds, depth);
+    CGSetRenderSizeUniforms(cg_geo_shader_program, window);
+    CGGLDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    
+    CGGLBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void CGGetQuadrangleIndices(const CGVector2* vertices, unsigned int* indices)
+{
     // triangulate
     for (int i = 0; i < 4; ++i)
     {
-        if (CGVector2Cross(quadrangle->vertices[((i - 1) + 4) % 4], quadrangle->vertices[(i + 1) % 4]) < 0)
+        if (CGVector2Cross(vertices[((i - 1) + 4) % 4], vertices[(i + 1) % 4]) < 0)
         {
-            has_reflex = CG_TRUE;
             indices[0] = i, indices[1] = (i + 1) % 4, indices[2] = (i + 2) % 4;
             indices[3] = i, indices[4] = (i + 2) % 4, indices[5] = (i + 3) % 4;
-            break;
+            return;
         }
     }
-    if (!has_reflex)
+    indices[0] = 0, indices[1] = 1, indices[2] = 2;
+    indices[3] = 0, indices[4] = 2, indices[5] = 3;
+}
+
+CGColoredTriangle CGConstructColoredTriangle(const CGVector2* vertices, const CGColor* colors)
+{
+    CGColoredTriangle result;
+    for (int i = 0; i < 3; ++i)
     {
-        indices[0] = 0, indices[1] = 1, indices[2] = 2;
-        indices[3] = 0, indices[4] = 2, indices[5] = 3;
+        result.vertices[i] = vertices[i];
+        result.colors[i] = colors[i];
     }
-    
-    //draw
-    glBindVertexArray(window->quadrangle_vao);
-    glUseProgram(cg_default_geo_shader_program);
-    glBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_QUADRANGLE_VBO]);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 12, vertices);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_QUADRANGLE_EBO]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * 6, indices, GL_DYNAMIC_DRAW);
-    CGSetPropertyUniforms(cg_geo_shader_program, property);
-    CGSetShaderUniform1f(cg_geo_shader_program, "render_width", (float)window->width / 2.0f);
-    CGSetShaderUniform1f(cg_geo_shader_program, "render_height", (float)window->height / 2.0f);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    
-    glBindVertexArray(0);
+    result.is_temp = CG_FALSE;
+    return result;
+}
+
+CGColoredTriangle* CGCreateColoredTriangle(const CGVector2* vertices, const CGColor* colors, CG_BOOL is_temp)
+{
+    CG_ERROR_COND_RETURN(vertices == NULL || colors == NULL, NULL, CGSTR("Cannot create colored triangle with NULL vertices or colors."));
+    CGColoredTriangle* result = (CGColoredTriangle*)CGMalloc(sizeof(CGColoredTriangle));
+    CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for colored triangle."));
+    *result = CGConstructColoredTriangle(vertices, colors);
+    result->is_temp = is_temp;
+    CGRegisterResource(result, free);
+    return result;
+}
+
+CGColoredQuadrangle CGConstructColoredQuadrangle(const CGVector2* vertices, const CGColor* colors)
+{
+    CGColoredQuadrangle result;
+    for (int i = 0; i < 4; ++i)
+    {
+        result.vertices[i] = vertices[i];
+        result.colors[i] = colors[i];
+    }
+    result.is_temp = CG_FALSE;
+    return result;
+}
+
+CGColoredQuadrangle* CGCreateColoredQuadrangle(const CGVector2* vertices, const CGColor* colors, CG_BOOL is_temp)
+{
+    CG_ERROR_COND_RETURN(vertices == NULL || colors == NULL, NULL, CGSTR("Cannot create colored quadrangle with NULL vertices or colors."));
+    CGColoredQuadrangle* result = (CGColoredQuadrangle*)CGMalloc(sizeof(CGColoredQuadrangle));
+    CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for colored quadrangle."));
+    *result = CGConstructColoredQuadrangle(vertices, colors);
+    result->is_temp = is_temp;
+    CGRegisterResource(result, free);
+    return result;
+}
+
+static CGUByte CGColorChannelToUByte(float channel)
+{
+    if (channel <= 0.0f)
+        return 0;
+    if (channel >= 1.0f)
+        return 255;
+    return (CGUByte)(channel * 255.0f + 0.5f);
+}
+
+/**
+ * @brief Make sure that the colored geometry batch can hold more vertices.
+ * 
+ * @param vertex_count The count of the vertices that are going to be added.
+ * @return CG_BOOL CG_TRUE if the batch has enough space.
+ */
+static CG_BOOL CGReserveColoredGeometryBatch(unsigned int vertex_count)
+{
+    if (cg_colored_geo_batch_size + vertex_count <= cg_colored_geo_batch_capacity)
+        return CG_TRUE;
+    unsigned int new_capacity = cg_colored_geo_batch_capacity == 0 ? 256 : cg_colored_geo_batch_capacity;
+    while (new_capacity < cg_colored_geo_batch_size + vertex_count)
+        new_capacity *= 2;
+    CGColoredVertex* new_batch = (CGColoredVertex*)CGRealloc(cg_colored_geo_batch, sizeof(CGColoredVertex) * new_capacity);
+    CG_ERROR_COND_RETURN(new_batch == NULL, CG_FALSE, CGSTR("Failed to allocate memory for colored geometry batch."));
+    cg_colored_geo_batch = new_batch;
+    cg_colored_geo_batch_capacity = new_capacity;
+    return CG_TRUE;
+}
+
+/**
+ * @brief Add a vertex to the colored geometry batch. The batch must have enough space.
+ * 
+ * @param model_mat The model matrix of the property.
+ * @param tint The color of the property.
+ * @param position The position of the vertex.
+ * @param color The color of the vertex.
+ * @param depth The depth of the vertex.
+ */
+static void CGPushColoredVertex(const float* model_mat, const CGColor* tint, CGVector2 position, const CGColor* color, float depth)
+{
+    CGColoredVertex* vertex = &cg_colored_geo_batch[cg_colored_geo_batch_size++];
+    vertex->position.x = model_mat[0] * position.x + model_mat[4] * position.y + model_mat[8] * depth + model_mat[12];
+    vertex->position.y = model_mat[1] * position.x + model_mat[5] * position.y + model_mat[9] * depth + model_mat[13];
+    vertex->depth = model_mat[2] * position.x + model_mat[6] * position.y + model_mat[10] * depth + model_mat[14];
+    if (cg_colored_geo_batch_size == 1)
+        cg_colored_geo_batch_bounds = CGConstructVertexBounds(&vertex->position, 1);
+    else
+        CGExpandVertexBounds(&cg_colored_geo_batch_bounds, vertex->position);
+    vertex->color[0] = CGColorChannelToUByte(color->r * tint->r);
+    vertex->color[1] = CGColorChannelToUByte(color->g * tint->g);
+    vertex->color[2] = CGColorChannelToUByte(color->b * tint->b);
+    vertex->color[3] = CGColorChannelToUByte(color->alpha * tint->alpha);
+}
+
+static void CGBatchColoredTriangle(const CGColoredTriangle* triangle, const CGRenderObjectProperty* property, float depth)
+{
+    CG_ERROR_CONDITION(triangle == NULL, CGSTR("Attempting to draw a NULL colored triangle object."));
+    if (property == NULL)
+        property = cg_default_colored_geo_property;
+    if (!CGReserveColoredGeometryBatch(3))
+        return;
+    float model_mat[16] = {0};
+    CGGetPropertyMatrix(property, model_mat);
+    for (int i = 0; i < 3; ++i)
+        CGPushColoredVertex(model_mat, &property->color, triangle->vertices[i], &triangle->colors[i], depth);
+}
+
+static void CGBatchColoredQuadrangle(const CGColoredQuadrangle* quadrangle, const CGRenderObjectProperty* property, float depth)
+{
+    CG_ERROR_CONDITION(quadrangle == NULL, CGSTR("Attempting to draw a NULL colored quadrangle object."));
+    if (property == NULL)
+        property = cg_default_colored_geo_property;
+    if (!CGReserveColoredGeometryBatch(6))
+        return;
+    float model_mat[16] = {0};
+    CGGetPropertyMatrix(property, model_mat);
+    unsigned int indices[6];
+    CGGetQuadrangleIndices(quadrangle->vertices, indices);
+    for (int i = 0; i < 6; ++i)
+        CGPushColoredVertex(model_mat, &property->color, quadrangle->vertices[indices[i]], &quadrangle->colors[indices[i]], depth);
+}
+
+static void CGFitColoredGeometryBatch(const CGWindow* window, unsigned int first_vertex, const CGVertexBounds* previous_bounds)
+{
+    if (first_vertex == 0 || first_vertex >= cg_colored_geo_batch_size)
+        return;
+    if (cg_colored_geo_batch_bounds.max_x - cg_colored_geo_batch_bounds.min_x <= CG_COLORED_GEOMETRY_BATCH_MAX_EXTENT
+        && cg_colored_geo_batch_bounds.max_y - cg_colored_geo_batch_bounds.min_y <= CG_COLORED_GEOMETRY_BATCH_MAX_EXTENT)
+        return;
+    // draw the vertices before the new ones, and start a new batch with the new ones
+    unsigned int vertex_count = cg_colored_geo_batch_size - first_vertex;
+    cg_colored_geo_batch_size = first_vertex;
+    cg_colored_geo_batch_bounds = *previous_bounds;
+    CGFlushColoredGeometryBatch(window);
+    memmove(cg_colored_geo_batch, cg_colored_geo_batch + first_vertex, sizeof(CGColoredVertex) * vertex_count);
+    cg_colored_geo_batch_size = vertex_count;
+    cg_colored_geo_batch_bounds = CGConstructVertexBounds(&cg_colored_geo_batch[0].position, 1);
+    for (unsigned int i = 1; i < vertex_count; ++i)
+        CGExpandVertexBounds(&cg_colored_geo_batch_bounds, cg_colored_geo_batch[i].position);
+}
+
+static void CGFlushColoredGeometryBatch(const CGWindow* window)
+{
+    if (cg_colored_geo_batch_size == 0)
+        return;
+    CG_ERROR_CONDITION(window == NULL || window->glfw_window_instance == NULL, CGSTR("Attempting to draw colored geometries on a NULL window."));
+    CGGladInitializeCheck();
+    if (window->gpu_profiler != NULL)
+        CGGPUProfilerSetZone(window->gpu_profiler, CG_GPU_ZONE_COLORED_BATCH);
+
+    if (cg_colored_geo_upload_stream.stride == 0)
+        CGInitVertexStream(&cg_colored_geo_upload_stream, sizeof(CGCompactColoredVertex), cg_colored_geo_batch_capacity);
+    CGResetVertexStream(&cg_colored_geo_upload_stream);
+    for (unsigned int i = 0; i < cg_colored_geo_batch_size; ++i)
+    {
+        const CGColoredVertex* vertex = &cg_colored_geo_batch[i];
+        if (!CGPushCompactColoredVertex(&cg_colored_geo_upload_stream, &cg_colored_geo_batch_bounds, vertex->position, vertex->color, vertex->depth))
+        {
+            cg_colored_geo_batch_size = 0;
+            return;
+        }
+    }
+
+    CGGLBindVertexArray(window->colored_geometry_vao);
+    CGGLUseProgram(cg_default_colored_geo_shader_program);
+    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_COLORED_GEOMETRY_VBO], 
+        sizeof(CGCompactColoredVertex) * cg_colored_geo_upload_stream.size, cg_colored_geo_upload_stream.data, GL_STREAM_DRAW);
+    CGSetShaderUniformVec4f(cg_default_colored_geo_shader_program, "position_bounds", 
+        cg_colored_geo_batch_bounds.min_x, cg_colored_geo_batch_bounds.min_y, 
+        cg_colored_geo_batch_bounds.max_x, cg_colored_geo_batch_bounds.max_y);
+    CGSetRenderSizeUniforms(cg_default_colored_geo_shader_program, window);
+    CGGLDrawArrays(GL_TRIANGLES, 0, cg_colored_geo_batch_size);
+
+    CGGLBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    cg_colored_geo_batch_size = 0;
+}
+
+struct CGPerformanceOverlay{
+    /**
+     * @brief The times of the recent frames in seconds, as a ring.
+     */
+    float frame_times[CG_PERFORMANCE_OVERLAY_HISTORY_SIZE];
+    unsigned int frame_count;
+    unsigned int next_frame;
+    /**
+     * @brief The time that the overlay was last drawn at. Negative before the first frame.
+     */
+    double last_draw_time;
+    /**
+     * @brief The time that the current second of resource loads started at.
+     */
+    double load_interval_start;
+    CGResourceLoadStats load_interval_start_stats;
+    /**
+     * @brief The resources loaded in the last second.
+     */
+    CGResourceLoadStats recent_loads;
+};
+
+/**
+ * @brief The size of a pixel of the overlay font, in window units.
+ */
+#define CG_OVERLAY_PIXEL_SIZE 2.0f
+#define CG_OVERLAY_MARGIN 8.0f
+#define CG_OVERLAY_LINE_HEIGHT (7.0f * CG_OVERLAY_PIXEL_SIZE)
+#define CG_OVERLAY_GRAPH_HEIGHT 48.0f
+/**
+ * @brief The frame time at the top of the frame time graph, in seconds.
+ */
+#define CG_OVERLAY_GRAPH_MAX_TIME (1.0f / 30.0f)
+
+/**
+ * @brief The characters of the overlay font, and their 3x5 bitmaps. Each row is 3 bits,
+ * from the top row in the highest bits.
+ */
+static const char cg_overlay_font_chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-/%";
+static const unsigned short cg_overlay_font[] = {
+    0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF,
+    0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B, 0x5BED, 0x7497, 0x126A,
+    0x5BAD, 0x4927, 0x5FED, 0x6B6D, 0x2B6A, 0x6BA4, 0x2B73, 0x6BAD, 0x388E, 0x7492,
+    0x5B6F, 0x5B6A, 0x5BFD, 0x5AAD, 0x5A92, 0x72A7, 0x0002, 0x0410, 0x01C0, 0x12A4,
+    0x52A5
+};
+
+void CGSetWindowPerformanceOverlay(CGWindow* window, CG_BOOL is_shown)
+{
+    CG_ERROR_CONDITION(window == NULL, CGSTR("Cannot set performance overlay of NULL window."));
+    if (!is_shown)
+    {
+        free(window->performance_overlay);
+        window->performance_overlay = NULL;
+        return;
+    }
+    if (window->performance_overlay != NULL)
+        return;
+    CGPerformanceOverlay* overlay = (CGPerformanceOverlay*)CGCalloc(1, sizeof(CGPerformanceOverlay));
+    CG_ERROR_CONDITION(overlay == NULL, CGSTR("Failed to allocate memory for performance overlay."));
+    overlay->last_draw_time = -1.0;
+    overlay->load_interval_start = CGGetCurrentTime();
+    overlay->load_interval_start_stats = CGGetResourceLoadStats();
+    window->performance_overlay = overlay;
+}
+
+CG_BOOL CGIsWindowPerformanceOverlayShown(const CGWindow* window)
+{
+    CG_ERROR_COND_RETURN(window == NULL, CG_FALSE, CGSTR("Cannot check performance overlay of NULL window."));
+    return window->performance_overlay != NULL;
+}
+
+// add a rectangle to the colored geometry batch. The position is the top left corner.
+static void CGBatchOverlayRect(float x, float y, float width, float height, const CGColor* color)
+{
+    static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    static const CGColor white = {1.0f, 1.0f, 1.0f, 1.0f};
+    if (!CGReserveColoredGeometryBatch(6))
+        return;
+    CGVector2 corners[4] = {{x, y}, {x + width, y}, {x + width, y - height}, {x, y - height}};
+    static const int indices[6] = {0, 1, 2, 0, 2, 3};
+    for (int i = 0; i < 6; ++i)
+        CGPushColoredVertex(identity, &white, corners[indices[i]], color, 0.0f);
+}
+
+// add a line of text to the colored geometry batch. Characters that are not in the font are drawn as spaces.
+static void CGBatchOverlayText(float x, float y, const char* text, const CGColor* color)
+{
+    for (; *text != '\0'; ++text, x += 4.0f * CG_OVERLAY_PIXEL_SIZE)
+    {
+        const char* found = strchr(cg_overlay_font_chars, *text);
+        if (*text == ' ' || found == NULL)
+            continue;
+        unsigned short bitmap = cg_overlay_font[found - cg_overlay_font_chars];
+        for (int row = 0; row < 5; ++row)
+        {
+            // the pixels of a row that are next to each other are drawn as one rectangle
+            int run_start = -1;
+            for (int column = 0; column <= 3; ++column)
+            {
+                CG_BOOL is_set = column < 3 && (bitmap >> (14 - row * 3 - column)) & 1;
+                if (is_set && run_start < 0)
+                    run_start = column;
+                else if (!is_set && run_start >= 0)
+                {
+                    CGBatchOverlayRect(x + run_start * CG_OVERLAY_PIXEL_SIZE, y - row * CG_OVERLAY_PIXEL_SIZE,
+                        (column - run_start) * CG_OVERLAY_PIXEL_SIZE, CG_OVERLAY_PIXEL_SIZE, color);
+                    run_start = -1;
+                }
+            }
+        }
+    }
+}
+
+static void CGFormatOverlayBytes(unsigned long long bytes, char* buffer, size_t buffer_size)
+{
+    if (bytes >= 1024ULL * 1024ULL)
+        snprintf(buffer, buffer_size, "%.1f MB", (double)bytes / (1024.0 * 1024.0));
+    else if (bytes >= 1024ULL)
+        snprintf(buffer, buffer_size, "%.1f KB", (double)bytes / 1024.0);
+    else
+        snprintf(buffer, buffer_size, "%u B", (unsigned int)bytes);
+}
+
+static void CGUpdatePerformanceOverlay(CGPerformanceOverlay* overlay)
+{
+    double now = CGGetCurrentTime();
+    if (overlay->last_draw_time >= 0.0)
+    {
+        overlay->frame_times[overlay->next_frame] = (float)(now - overlay->last_draw_time);
+        overlay->next_frame = (overlay->next_frame + 1) % CG_PERFORMANCE_OVERLAY_HISTORY_SIZE;
+        if (overlay->frame_count < CG_PERFORMANCE_OVERLAY_HISTORY_SIZE)
+            ++overlay->frame_count;
+    }
+    overlay->last_draw_time = now;
+    if (now - overlay->load_interval_start >= 1.0)
+    {
+        CGResourceLoadStats stats = CGGetResourceLoadStats();
+        overlay->recent_loads.load_count = stats.load_count - overlay->load_interval_start_stats.load_count;
+        overlay->recent_loads.bytes_loaded = stats.bytes_loaded - overlay->load_interval_start_stats.bytes_loaded;
+        overlay->recent_loads.load_time = stats.load_time - overlay->load_interval_start_stats.load_time;
+        overlay->load_interval_start_stats = stats;
+        overlay->load_interval_start = now;
+    }
+}
+
+static void CGDrawPerformanceOverlay(CGWindow* window)
+{
+    // the overlay is not part of the frame that it shows
+    CGFrameStats saved_stats = cg_frame_stats;
+    unsigned long long allocation_count = CGGetAllocationCount();
+
+    CGPerformanceOverlay* overlay = window->performance_overlay;
+    CGUpdatePerformanceOverlay(overlay);
+    float average_time = 0.0f, max_time = 0.0f;
+    for (unsigned int i = 0; i < overlay->frame_count; ++i)
+    {
+        average_time += overlay->frame_times[i];
+        if (overlay->frame_times[i] > max_time)
+            max_time = overlay->frame_times[i];
+    }
+    if (overlay->frame_count > 0)
+        average_time /= (float)overlay->frame_count;
+
+    const CGColor background = {0.0f, 0.0f, 0.0f, 0.6f};
+    const CGColor text_color = {1.0f, 1.0f, 1.0f, 1.0f};
+    const CGColor good_color = {0.3f, 0.9f, 0.3f, 1.0f};
+    const CGColor slow_color = {0.9f, 0.8f, 0.2f, 1.0f};
+    const CGColor bad_color = {0.9f, 0.25f, 0.2f, 1.0f};
+    const CGColor target_color = {1.0f, 1.0f, 1.0f, 0.4f};
+    const int line_count = 6;
+    float bar_width = CG_OVERLAY_PIXEL_SIZE;
+    float panel_width = CG_PERFORMANCE_OVERLAY_HISTORY_SIZE * bar_width + 2.0f * CG_OVERLAY_MARGIN;
+    float panel_height = line_count * CG_OVERLAY_LINE_HEIGHT + CG_OVERLAY_GRAPH_HEIGHT + 3.0f * CG_OVERLAY_MARGIN;
+    float left = -(float)window->width / 2.0f + CG_OVERLAY_MARGIN;
+    float top = (float)window->height / 2.0f - CG_OVERLAY_MARGIN;
+    CGBatchOverlayRect(left, top, panel_width, panel_height, &background);
+
+    const CGFrameStats* stats = &cg_last_frame_stats;
+    char lines[6][64];
+    char upload[16], texture_memory[16], loaded[16];
+    CGFormatOverlayBytes(stats->bytes_uploaded, upload, sizeof(upload));
+    CGFormatOverlayBytes(stats->texture_memory, texture_memory, sizeof(texture_memory));
+    CGFormatOverlayBytes(overlay->recent_loads.bytes_loaded, loaded, sizeof(loaded));
+    snprintf(lines[0], sizeof(lines[0]), "FPS %.1f  FRAME %.2f MS", 
+        average_time > 0.0f ? 1.0f / average_time : 0.0f, average_time * 1000.0f);
+    snprintf(lines[1], sizeof(lines[1]), "MAX %.2f MS", max_time * 1000.0f);
+    snprintf(lines[2], sizeof(lines[2]), "DRAW %u  OBJ %u  CULL %u", stats->draw_calls, stats->objects_submitted, stats->objects_culled);
+    snprintf(lines[3], sizeof(lines[3]), "UPLOAD %s  ALLOC %u", upload, stats->allocations);
+    snprintf(lines[4], sizeof(lines[4]), "TEX %s  +%u -%u", texture_memory, stats->textures_created, stats->textures_destroyed);
+    snprintf(lines[5], sizeof(lines[5]), "LOAD/S %u  %s  %.1f MS", 
+        overlay->recent_loads.load_count, loaded, overlay->recent_loads.load_time * 1000.0);
+    float x = left + CG_OVERLAY_MARGIN;
+    float y = top - CG_OVERLAY_MARGIN;
+    for (int i = 0; i < line_count; ++i, y -= CG_OVERLAY_LINE_HEIGHT)
+        CGBatchOverlayText(x, y, lines[i], &text_color);
+
+    // the frame time graph, from the oldest frame on the left
+    float graph_bottom = y - CG_OVERLAY_GRAPH_HEIGHT;
+    for (unsigned int i = 0; i < overlay->frame_count; ++i)
+    {
+        unsigned int index = (overlay->next_frame + CG_PERFORMANCE_OVERLAY_HISTORY_SIZE - overlay->frame_count + i) % CG_PERFORMANCE_OVERLAY_HISTORY_SIZE;
+        float frame_time = overlay->frame_times[index];
+        float height = frame_time / CG_OVERLAY_GRAPH_MAX_TIME * CG_OVERLAY_GRAPH_HEIGHT;
+        if (height > CG_OVERLAY_GRAPH_HEIGHT)
+            height = CG_OVERLAY_GRAPH_HEIGHT;
+        const CGColor* color = frame_time <= 1.0f / 59.0f ? &good_color : frame_time <= 1.0f / 29.0f ? &slow_color : &bad_color;
+        CGBatchOverlayRect(x + i * bar_width, graph_bottom + height, bar_width, height, color);
+    }
+    // the line of 60 frames per second
+    CGBatchOverlayRect(x, graph_bottom + CG_OVERLAY_GRAPH_HEIGHT / 2.0f, 
+        CG_PERFORMANCE_OVERLAY_HISTORY_SIZE * bar_width, 1.0f, &target_color);
+
+    glEnable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    // windows with partial redraw keep their frame in their own frame buffer, which must not keep the overlay
+    CG_BOOL is_redraw = window->redraw_state != NULL && window->redraw_state->frame_buffer != 0;
+    if (is_redraw)
+        glBindFramebuffer(GL_FRAMEBUFFER, window->offscreen_frame_buffer);
+    CGFlushColoredGeometryBatch(window);
+    if (is_redraw)
+        glBindFramebuffer(GL_FRAMEBUFFER, window->redraw_state->frame_buffer);
+
+    cg_frame_stats = saved_stats;
+    cg_frame_allocation_start += CGGetAllocationCount() - allocation_count;
 }
 
 static void CGSetTextureValue(unsigned int texture_id, CGImage* texture)
 {
     CG_ERROR_CONDITION(texture == NULL, CGSTR("Cannot bind a NULL texture."));
     CGGladInitializeCheck();
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    CGGLBindTexture(GL_TEXTURE_2D, texture_id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     switch(texture->channels)
     {
     case 1:
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, texture->width, texture->height, 0, GL_RED, GL_UNSIGNED_BYTE, texture->data);
+        CGGLTexImage2D(GL_TEXTURE_2D, 0, GL_R8, texture->width, texture->height, 0, GL_RED, GL_UNSIGNED_BYTE, texture->data);
         glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     case 3:
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, texture->width, texture->height, 0, GL_RGB, GL_UNSIGNED_BYTE, texture->data);
+        CGGLTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, texture->width, texture->height, 0, GL_RGB, GL_UNSIGNED_BYTE, texture->data);
         glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
         break;
     case 4:
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture->width, texture->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture->data);
+        CGGLTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture->width, texture->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture->data);
         break;
     default:
-        glBindTexture(GL_TEXTURE_2D, 0);
+        CGGLBindTexture(GL_TEXTURE_2D, 0);
         CG_ERROR_CONDITION(CG_TRUE, CGSTR("Invalid image channel count. CosGraphics currently only supports images with 3 or 4 channels."));
     }
     glGenerateMipmap(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    CGGLBindTexture(GL_TEXTURE_2D, 0);
 }
 
 unsigned int CGCreateTexture(CGImage* image)
@@ -1474,15 +3696,16 @@ unsigned int CGCreateTexture(CGImage* image)
     CG_ERROR_COND_RETURN(image == NULL, 0, CGSTR("Cannot create texture from NULL image."));
     CGGladInitializeCheck();
     unsigned int texture_id;
-    glGenTextures(1, &texture_id);
+    CGGLGenTextures(1, &texture_id);
     CGSetTextureValue(texture_id, image);
+    CGCommandRecorderTexture(texture_id, image->width, image->height, image->channels, image->data);
     return texture_id;
 }
 
 void CGDeleteTexture(unsigned int texture_id)
 {
     CGGladInitializeCheck();
-    glDeleteTextures(1, &texture_id);
+    CGGLDeleteTextures(1, &texture_id);
 }
 
 CGVisualImage* CGCreateVisualImage(const CGChar* img_rk, CGWindow* window, CG_BOOL is_temp)
@@ -1490,7 +3713,7 @@ CGVisualImage* CGCreateVisualImage(const CGChar* img_rk, CGWindow* window, CG_BO
     CG_ERROR_COND_RETURN(img_rk == NULL, NULL, CGSTR("Cannot create image with NULL texture path."));
     CG_ERROR_COND_RETURN(window == NULL || window->glfw_window_instance == NULL, NULL, CGSTR("Cannot create image with NULL window."));
     CGGladInitializeCheck();
-    CGVisualImage* visual_image = (CGVisualImage*)malloc(sizeof(CGVisualImage));
+    CGVisualImage* visual_image = (CGVisualImage*)CGMalloc(sizeof(CGVisualImage));
     CG_ERROR_COND_RETURN(visual_image == NULL, NULL, CGSTR("Failed to allocate memory for visual_image."));
     if (glfwGetCurrentContext() != window->glfw_window_instance)
         glfwMakeContextCurrent(window->glfw_window_instance);
@@ -1504,11 +3727,8 @@ CGVisualImage* CGCreateVisualImage(const CGChar* img_rk, CGWindow* window, CG_BO
     visual_image->clamp_top_left = (CGVector2){0.0f, 0.0f};
     visual_image->clamp_bottom_right = (CGVector2){image->width, image->height};
     visual_image->is_clamped = CG_FALSE;
-    if (image == NULL)
-    {
-        free(visual_image);
-        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to allocate memory for visual_image texture."));
-    }
+    visual_image->has_transparency = CGIsImageTransparent(image);
+    visual_image->is_premultiplied = CG_FALSE;
     visual_image->texture_id = CGGetTextureResource(img_rk);
     CGFree(image);
     CGRegisterResource(visual_image, CG_DELETER(CGDeleteVisualImage));
@@ -1519,7 +3739,7 @@ CGVisualImage* CGCopyVisualImage(CGVisualImage* visual_image)
 {
     CG_ERROR_COND_RETURN(visual_image == NULL, NULL, CGSTR("Cannot copy a NULL visual_image."));
     CGGladInitializeCheck();
-    CGVisualImage* result = (CGVisualImage*)malloc(sizeof(CGVisualImage));
+    CGVisualImage* result = (CGVisualImage*)CGMalloc(sizeof(CGVisualImage));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for visual image."));
     result->img_width = visual_image->img_width;
     result->img_height = visual_image->img_height;
@@ -1527,6 +3747,8 @@ CGVisualImage* CGCopyVisualImage(CGVisualImage* visual_image)
     result->clamp_top_left = visual_image->clamp_top_left;
     result->clamp_bottom_right = visual_image->clamp_bottom_right;
     result->is_clamped = visual_image->is_clamped;
+    result->has_transparency = visual_image->has_transparency;
+    result->is_premultiplied = visual_image->is_premultiplied;
     result->is_temp = CG_FALSE;
     CGWindow* in_window = result->in_window = visual_image->in_window;
     if (glfwGetCurrentContext() != in_window->glfw_window_instance)
@@ -1646,78 +3868,77 @@ static CG_BOOL CGGetGlyphsBitmap(const CGGlyphs* glyphs, CGUByte* bitmap, const
     return CG_TRUE;
 }
 
-static CG_BOOL CGGetTextTexture(const CGChar* text, FT_Face face, const CGTextProperty* text_property, 
-    unsigned int* texture_width, unsigned int* texture_height, unsigned int* result)
+static CGUByte* CGGetTextBitmap(const CGChar* text, FT_Face face, const CGTextProperty* text_property,
+    unsigned int* bitmap_width, unsigned int* bitmap_height)
 {
-    CG_ERROR_COND_RETURN(text == NULL, CG_FALSE, CGSTR("Cannot get texture id from NULL text."));
-    CG_ERROR_COND_RETURN(result == NULL, CG_FALSE, CGSTR("Cannot get texture id from NULL result."));
-    CG_ERROR_COND_RETURN(text_property == NULL, GL_FALSE, CGSTR("Cannot get texture id from NULL text property."));
-
-    CGGladInitializeCheck();
+    CG_ERROR_COND_RETURN(text == NULL, NULL, CGSTR("Cannot get bitmap from NULL text."));
+    CG_ERROR_COND_RETURN(text_property == NULL, NULL, CGSTR("Cannot get bitmap from NULL text property."));
+    CG_ERROR_COND_RETURN(bitmap_width == NULL || bitmap_height == NULL, NULL, CGSTR("Cannot get bitmap with NULL size."));
 
     CGGlyphs glyphs;
     glyphs.glyphs_dimension.horizontal_layout.max_char_height = 0;
     glyphs.glyphs_dimension.horizontal_layout.total_width = 0;
     glyphs.glyphs_count = CG_STRLEN(text);
-    glyphs.glyph_instances = (CGGlyphInstance*)malloc(glyphs.glyphs_count * sizeof(CGGlyphInstance));
-    CG_ERROR_COND_RETURN(glyphs.glyph_instances == NULL, CG_FALSE, CGSTR("Failed to allocate memory for glyphs."));
+    glyphs.glyph_instances = (CGGlyphInstance*)CGMalloc(glyphs.glyphs_count * sizeof(CGGlyphInstance));
+    CG_ERROR_COND_RETURN(glyphs.glyph_instances == NULL, NULL, CGSTR("Failed to allocate memory for glyphs."));
     if (FT_Set_Pixel_Sizes(face, text_property->text_width, text_property->text_height))
     {
         free(glyphs.glyph_instances);
-        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to set font pixel size."));
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to set font pixel size."));
     }
     if (!CGGetTextGlyphs(face, text, &glyphs, text_property))
     {
         free(glyphs.glyph_instances);
-        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to get glyphs from text."));
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to get glyphs from text."));
     }
 
-    CGUByte* image_data = (CGUByte*)malloc(
+    CGUByte* image_data = (CGUByte*)CGMalloc(
         glyphs.glyphs_dimension.horizontal_layout.total_width * glyphs.glyphs_dimension.horizontal_layout.max_char_height * 4);
-    if (image_data == NULL)
-    {
-        for (unsigned int i = 0; i < glyphs.glyphs_count; ++i)
-        {
-            if (glyphs.glyph_instances[i].glyph_instance != NULL)
-                FT_Done_Glyph(glyphs.glyph_instances[i].glyph_instance);
-        }
-        free(glyphs.glyph_instances);
-        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to allocate memory for text image."));
-    }
-    if (!CGGetGlyphsBitmap(&glyphs, image_data, text_property))
-    {
-        free(image_data);
-        for (unsigned int i = 0; i < glyphs.glyphs_count; ++i)
-        {
-            if (glyphs.glyph_instances[i].glyph_instance != NULL)
-                FT_Done_Glyph(glyphs.glyph_instances[i].glyph_instance);
-        }
-        free(glyphs.glyph_instances);
-        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to get bitmap from glyphs."));
-    }
+    CG_BOOL is_success = image_data != NULL && CGGetGlyphsBitmap(&glyphs, image_data, text_property);
     for (unsigned int i = 0; i < glyphs.glyphs_count; ++i)
     {
         if (glyphs.glyph_instances[i].glyph_instance != NULL)
             FT_Done_Glyph(glyphs.glyph_instances[i].glyph_instance);
     }
     free(glyphs.glyph_instances);
+    if (!is_success)
+    {
+        free(image_data);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to get bitmap from glyphs."));
+    }
+    *bitmap_width = glyphs.glyphs_dimension.horizontal_layout.total_width;
+    *bitmap_height = glyphs.glyphs_dimension.horizontal_layout.max_char_height;
+    return image_data;
+}
+
+static CG_BOOL CGGetTextTexture(const CGChar* text, FT_Face face, const CGTextProperty* text_property, 
+    unsigned int* texture_width, unsigned int* texture_height, unsigned int* result)
+{
+    CG_ERROR_COND_RETURN(text == NULL, CG_FALSE, CGSTR("Cannot get texture id from NULL text."));
+    CG_ERROR_COND_RETURN(result == NULL, CG_FALSE, CGSTR("Cannot get texture id from NULL result."));
+    CG_ERROR_COND_RETURN(text_property == NULL, GL_FALSE, CGSTR("Cannot get texture id from NULL text property."));
+
+    CGGladInitializeCheck();
+
+    unsigned int bitmap_width, bitmap_height;
+    CGUByte* image_data = CGGetTextBitmap(text, face, text_property, &bitmap_width, &bitmap_height);
+    CG_ERROR_COND_RETURN(image_data == NULL, CG_FALSE, CGSTR("Failed to get bitmap from text."));
     
-    glGenTextures(1, result);
-    glBindTexture(GL_TEXTURE_2D, *result);
+    CGGLGenTextures(1, result);
+    CGGLBindTexture(GL_TEXTURE_2D, *result);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 
-		glyphs.glyphs_dimension.horizontal_layout.total_width, glyphs.glyphs_dimension.horizontal_layout.max_char_height, 
-		0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
+	CGGLTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bitmap_width, bitmap_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
     glGenerateMipmap(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    CGGLBindTexture(GL_TEXTURE_2D, 0);
+    CGCommandRecorderTexture(*result, bitmap_width, bitmap_height, 4, image_data);
 
     free(image_data);
 
     if (texture_width != NULL)
-        *texture_width = glyphs.glyphs_dimension.horizontal_layout.total_width;
+        *texture_width = bitmap_width;
     if (texture_height != NULL)
-        *texture_height = glyphs.glyphs_dimension.horizontal_layout.max_char_height;
+        *texture_height = bitmap_height;
     return CG_TRUE;
 }
 
@@ -1761,7 +3982,10 @@ CGVisualImage* CGCreateTextVisualImageRaw(const CGChar* text, const CGChar* font
 
     // get texture
     unsigned int texture_width, texture_height, texture_id;
-    if (!CGGetTextTexture(text, face, &text_property, &texture_width, &texture_height, &texture_id))
+    CG_PROFILE_BEGIN(GetTextTexture);
+    CG_BOOL is_texture_created = CGGetTextTexture(text, face, &text_property, &texture_width, &texture_height, &texture_id);
+    CG_PROFILE_END(GetTextTexture);
+    if (!is_texture_created)
     {
         if (font_rk != NULL)
             FT_Done_Face(face);
@@ -1771,7 +3995,7 @@ CGVisualImage* CGCreateTextVisualImageRaw(const CGChar* text, const CGChar* font
     if (font_rk != NULL)
         FT_Done_Face(face);
 
-    CGVisualImage* result = (CGVisualImage*)malloc(sizeof(CGVisualImage));
+    CGVisualImage* result = (CGVisualImage*)CGMalloc(sizeof(CGVisualImage));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for visual_image."));
     result->in_window = window;
     result->is_temp = is_temp;
@@ -1781,12 +4005,45 @@ CGVisualImage* CGCreateTextVisualImageRaw(const CGChar* text, const CGChar* font
     result->clamp_top_left = (CGVector2){0.0f, 0.0f};
     result->clamp_bottom_right = (CGVector2){ (float)texture_width, (float)texture_height };
     result->is_clamped = CG_FALSE;
+    // only the glyphs of the text are opaque
+    result->has_transparency = CG_TRUE;
+    result->is_premultiplied = CG_FALSE;
     result->texture_id = texture_id;
 
     CGRegisterResource(result, CG_DELETER(CGDeleteVisualImage));
     return result;
 }
 
+CGImage* CGCreateTextImage(const CGChar* text, const CGChar* font_rk, CGTextProperty text_property)
+{
+    CG_ERROR_COND_RETURN(text == NULL, NULL, CGSTR("Cannot create text image with NULL text."));
+    // the text image is made on the CPU, so it can be made before any window is created
+    if (!CGResourceSystemInitialized())
+        CGInitResourceSystem();
+    if (!cg_is_freetype_initialized)
+        CGInitFreeType();
+    FT_Face face;
+    if (font_rk == NULL)
+        face = cg_ft_default_face;
+    else if (!CGCreateFreetypeFace(font_rk, &face))
+    {
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to create freetype face with rk: \"%s\"."), font_rk);
+    }
+    unsigned int bitmap_width, bitmap_height;
+    CGUByte* bitmap = CGGetTextBitmap(text, face, &text_property, &bitmap_width, &bitmap_height);
+    if (font_rk != NULL)
+        FT_Done_Face(face);
+    CG_ERROR_COND_RETURN(bitmap == NULL, NULL, CGSTR("Failed to get bitmap from text: %s"), text);
+    CGImage* image = CGCreateImage(bitmap_width, bitmap_height, 4, NULL);
+    if (image == NULL)
+    {
+        free(bitmap);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to create text image."));
+    }
+    image->data = bitmap;
+    return image;
+}
+
 static void CGDeleteVisualImage(CGVisualImage* visual_image)
 {
     if (visual_image == NULL)
@@ -1795,125 +4052,568 @@ static void CGDeleteVisualImage(CGVisualImage* visual_image)
     free(visual_image);
 }
 
-static void CGRenderVisualImage(CGVisualImage* visual_image, const CGRenderObjectProperty* property, CGWindow* window, float assigned_z)
+static void CGRenderVisualImage(CGVisualImage* visual_image, const CGRenderObjectProperty* property, CGWindow* window, float depth)
 {
     CG_ERROR_CONDITION(visual_image == NULL, CGSTR("Failed to draw visual_image: VisualImage must be specified to a non-null visual_image instance."));
     CG_ERROR_CONDITION(window == NULL || window->glfw_window_instance == NULL, CGSTR("Failed to draw visual_image: Attempting to draw visual_image on a NULL window"));
     CGGladInitializeCheck();
-    float* vertices = CGMakeVisualImageVertices(visual_image, assigned_z);
-    glBindVertexArray(window->visual_image_vao);
-    glUseProgram(cg_visual_image_shader_program);
+    CGVertexBounds bounds;
+    CGCompactImageVertex vertices[4];
+    CGVertexStream stream = CGConstructVertexStream(vertices, sizeof(CGCompactImageVertex), 4);
+    CG_ERROR_CONDITION(!CGMakeVisualImageVertices(visual_image, &bounds, &stream), CGSTR("Failed to draw visual_image."));
+    CGGLBindVertexArray(window->visual_image_vao);
+    CGGLUseProgram(cg_visual_image_shader_program);
     glBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_VISUAL_IMAGE_VBO]);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 20 * sizeof(float), vertices);
+    CGGLBufferSubData(GL_ARRAY_BUFFER, 0, 4 * sizeof(CGCompactImageVertex), vertices);
     if (property == NULL)
         property = cg_default_visual_image_property;
-    glBindTexture(GL_TEXTURE_2D, visual_image->texture_id);
+    CGGLBindTexture(GL_TEXTURE_2D, visual_image->texture_id);
     CGSetPropertyUniforms(cg_visual_image_shader_program, property);
-    CGSetShaderUniform1f(cg_visual_image_shader_program, "render_width", (float)window->width / 2.0f);
-    CGSetShaderUniform1f(cg_visual_image_shader_program, "render_height", (float)window->height / 2.0f);
+    CGSetCompactVertexUniforms(cg_visual_image_shader_program, &bounds, depth);
+    CGSetRenderSizeUniforms(cg_visual_image_shader_program, window);
     CGSetShaderUniform1i(cg_visual_image_shader_program, "is_clamped", visual_image->is_clamped);
     CGSetShaderUniformVec2f(cg_visual_image_shader_program, "clamp_top_left", visual_image->clamp_top_left);
     CGSetShaderUniformVec2f(cg_visual_image_shader_program, "clamp_bottom_right", visual_image->clamp_bottom_right);
     CGSetShaderUniformVec2f(cg_visual_image_shader_program, "image_dimension", (CGVector2){visual_image->img_width, visual_image->img_height});
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    if (visual_image->is_premultiplied)
+    {
+        // the texture already carries its alpha in its colors, so only the tint is premultiplied
+        CGColor color = property->color;
+        CGSetShaderUniformVec4f(cg_visual_image_shader_program, "color", 
+            color.r * color.alpha, color.g * color.alpha, color.b * color.alpha, color.alpha);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    CGGLDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    if (visual_image->is_premultiplied)
+    {
+        if (cg_current_render_layer != NULL)
+            glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        else
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    CGGLBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    CGGLBindTexture(GL_TEXTURE_2D, 0);
 }
 
-static void CGDrawGlyph( int offset, const FT_GlyphSlot glyph, const CGRenderObjectProperty* render_property, const CGWindow* window)
+static void CGDrawGlyph(CGVector2 pen, const FT_GlyphSlot glyph, const CGRenderObjectProperty* render_property, const CGWindow* window)
 {
     CG_ERROR_CONDITION(glyph == NULL, CGSTR("Failed to draw bitmap: Bitmap must be specified to a non-null bitmap instance."));
+    if (window->gpu_profiler != NULL)
+        CGGPUProfilerSetZone(window->gpu_profiler, CG_GPU_ZONE_TEXT);
 
     unsigned int texture_id = 0;
-    glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    CGGLGenTextures(1, &texture_id);
+    CGGLBindTexture(GL_TEXTURE_2D, texture_id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, glyph->bitmap.width, glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, glyph->bitmap.buffer);
+    CGGLTexImage2D(GL_TEXTURE_2D, 0, GL_R8, glyph->bitmap.width, glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, glyph->bitmap.buffer);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    glUseProgram(cg_bitmap_visual_image_shader_program);
-    glBindVertexArray(window->visual_image_vao);
+    CGGLUseProgram(cg_bitmap_visual_image_shader_program);
+    CGGLBindVertexArray(window->visual_image_vao);
     glBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_VISUAL_IMAGE_VBO]);
-    double bottom = ((double)glyph->bitmap_top - (double)glyph->bitmap.rows);
-    double right = (double)(glyph->bitmap_left + glyph->bitmap.width);
-    CGSetFloatArrayValue(20, cg_global_buffer_f20,
-        (double)(glyph->bitmap_left + offset), (double)glyph->bitmap_top, 0.0, 0.0, 0.0,
-        (double)(right + offset), (double)glyph->bitmap_top, 0.0, 1.0, 0.0,
-        (double)(right + offset), (double)bottom, 0.0, 1.0, 1.0,
-        (double)(glyph->bitmap_left + offset), (double)bottom, 0.0, 0.0, 1.0
-    );
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 20 * sizeof(float), cg_global_buffer_f20);
+    CGVertexBounds bounds;
+    bounds.min_x = pen.x + (float)glyph->bitmap_left;
+    bounds.min_y = pen.y + (float)glyph->bitmap_top - (float)glyph->bitmap.rows;
+    bounds.max_x = pen.x + (float)glyph->bitmap_left + (float)glyph->bitmap.width;
+    bounds.max_y = pen.y + (float)glyph->bitmap_top;
+    CGCompactImageVertex vertices[4];
+    CGVertexStream stream = CGConstructVertexStream(vertices, sizeof(CGCompactImageVertex), 4);
+    CGMakeImageRectVertices(&bounds, &stream);
+    CGGLBufferSubData(GL_ARRAY_BUFFER, 0, 4 * sizeof(CGCompactImageVertex), vertices);
     CGSetPropertyUniforms(cg_bitmap_visual_image_shader_program, render_property);
-    CGSetShaderUniform1f(cg_bitmap_visual_image_shader_program, "render_width", (float)window->width / 2.0f);
-    CGSetShaderUniform1f(cg_bitmap_visual_image_shader_program, "render_height", (float)window->height / 2.0f);
+    CGSetCompactVertexUniforms(cg_bitmap_visual_image_shader_program, &bounds, 0.0f);
+    CGSetRenderSizeUniforms(cg_bitmap_visual_image_shader_program, window);
     CGSetShaderUniformVec2f(cg_bitmap_visual_image_shader_program, "image_dimension", (CGVector2){glyph->bitmap.width, glyph->bitmap.rows});
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    CGGLDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    CGGLBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDeleteTextures(1, &texture_id);
+    CGGLBindTexture(GL_TEXTURE_2D, 0);
+    CGGLDeleteTextures(1, &texture_id);
 }
 
-CG_BOOL CGDrawText(const CGChar* text_rk, const CGChar* font_rk, CGTextProperty text_property, const CGRenderObjectProperty* render_property, const CGWindow* window)
+static unsigned long long CGHashFontKey(const CGChar* font_rk)
 {
-    CG_ERROR_COND_RETURN(text_rk == NULL, CG_FALSE, CGSTR("Cannot draw text with NULL text resource key."));
-    if (render_property == NULL)
-        render_property = cg_default_geo_property;
-    CGGladInitializeCheck();
-    
-    CGChar* text = (CGChar*)CGLoadResource(text_rk, NULL, NULL);
-    CG_ERROR_COND_RETURN(text == NULL, CG_FALSE, CGSTR("Failed to load text resource."));
-    FT_Face face;
+    // 0 is the default font
     if (font_rk == NULL)
-        face = cg_ft_default_face;
-    else if (!CGCreateFreetypeFace(font_rk, &face))
+        return 0;
+    return CGHashBytes(14695981039346656037ULL, font_rk, sizeof(CGChar) * CG_STRLEN(font_rk)) | 1;
+}
+
+static CGGlyphKey CGConstructTextGlyphKey(const CGChar* font_rk, const CGTextProperty* text_property)
+{
+    CGGlyphKey key;
+    key.font = CGHashFontKey(font_rk);
+    key.pixel_width = text_property->text_width;
+    key.pixel_height = text_property->text_height;
+    key.codepoint = 0;
+    return key;
+}
+
+// get the face of a font with the pixel size of the text. The face of a font that is not the default font must be freed.
+static CG_BOOL CGCreateTextFace(const CGChar* font_rk, const CGTextProperty* text_property, FT_Face* face)
+{
+    if (font_rk == NULL)
+        *face = cg_ft_default_face;
+    else if (!CGCreateFreetypeFace(font_rk, face))
     {
-        free(text);
         CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to create freetype face with rk: \"%s\"."), font_rk);
     }
-    if (FT_Set_Pixel_Sizes(face, text_property.text_width, text_property.text_height))
+    if (FT_Set_Pixel_Sizes(*face, text_property->text_width, text_property->text_height))
+    {
+        if (font_rk != NULL)
+            FT_Done_Face(*face);
+        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to set pixel size for font."));
+    }
+    return CG_TRUE;
+}
+
+static unsigned int CGGetGlyphAtlasTexture(unsigned int page)
+{
+    while (cg_glyph_atlas_texture_count <= page)
+    {
+        unsigned int page_size = CGGetGlyphAtlasPageSize(cg_glyph_atlas);
+        unsigned int* texture_id = &cg_glyph_atlas_textures[cg_glyph_atlas_texture_count++];
+        CGGLGenTextures(1, texture_id);
+        CGGLBindTexture(GL_TEXTURE_2D, *texture_id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        CGGLTexImage2D(GL_TEXTURE_2D, 0, GL_R8, page_size, page_size, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    }
+    return cg_glyph_atlas_textures[page];
+}
+
+/**
+ * @brief Add a rendered glyph to the glyph atlas. The bitmap of the glyph is not uploaded
+ * until @ref CGUploadAtlasGlyph is called, so that the glyphs of the page that is cleared
+ * can be drawn before it.
+ * 
+ * @param key The key of the glyph.
+ * @param glyph The rendered glyph.
+ * @param evicted_page This will be set to the page that is cleared to fit the glyph, or CG_GLYPH_ATLAS_NO_PAGE.
+ * @return const CGAtlasGlyph* The glyph in the atlas. Returns NULL if the glyph doesn't fit in a page.
+ */
+static const CGAtlasGlyph* CGAddGlyphToAtlas(const CGGlyphKey* key, const FT_GlyphSlot glyph, unsigned int* evicted_page)
+{
+    *evicted_page = CG_GLYPH_ATLAS_NO_PAGE;
+    if (cg_glyph_atlas == NULL)
+    {
+        cg_glyph_atlas = CGCreateGlyphAtlas(CG_GLYPH_ATLAS_DEFAULT_PAGE_SIZE, CG_GLYPH_ATLAS_DEFAULT_MAX_PAGE_COUNT);
+        if (cg_glyph_atlas == NULL)
+            return NULL;
+    }
+    return CGAddAtlasGlyph(cg_glyph_atlas, key, glyph->bitmap.width, glyph->bitmap.rows,
+        glyph->bitmap_left, glyph->bitmap_top, evicted_page);
+}
+
+// upload the bitmap of a glyph to the texture of its page in the glyph atlas
+static void CGUploadAtlasGlyph(const CGAtlasGlyph* atlas_glyph, const FT_GlyphSlot glyph)
+{
+    if (atlas_glyph->page == CG_GLYPH_ATLAS_NO_PAGE)
+        return;
+    // the padding is uploaded with the glyph, because the page may have had other glyphs there before
+    unsigned int width = atlas_glyph->width + 2 * CG_GLYPH_ATLAS_PADDING;
+    unsigned int height = atlas_glyph->height + 2 * CG_GLYPH_ATLAS_PADDING;
+    CGUByte* pixels = (CGUByte*)CGCalloc(width * height, sizeof(CGUByte));
+    CG_ERROR_CONDITION(pixels == NULL, CGSTR("Failed to allocate memory for glyph."));
+    for (unsigned int row = 0; row < atlas_glyph->height; ++row)
+    {
+        memcpy(pixels + (row + CG_GLYPH_ATLAS_PADDING) * width + CG_GLYPH_ATLAS_PADDING,
+            glyph->bitmap.buffer + row * glyph->bitmap.pitch, atlas_glyph->width);
+    }
+    CGGLBindTexture(GL_TEXTURE_2D, CGGetGlyphAtlasTexture(atlas_glyph->page));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    CGGLTexSubImage2D(GL_TEXTURE_2D, 0, atlas_glyph->x - CG_GLYPH_ATLAS_PADDING, atlas_glyph->y - CG_GLYPH_ATLAS_PADDING,
+        width, height, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    CGGLBindTexture(GL_TEXTURE_2D, 0);
+    free(pixels);
+}
+
+static CG_BOOL CGReserveTextQuads(unsigned int count)
+{
+    if (cg_text_quad_count + count <= cg_text_quad_capacity)
+        return CG_TRUE;
+    unsigned int new_capacity = cg_text_quad_capacity == 0 ? 256 : cg_text_quad_capacity;
+    while (new_capacity < cg_text_quad_count + count)
+        new_capacity *= 2;
+    CGTextQuad* new_quads = (CGTextQuad*)CGRealloc(cg_text_quads, sizeof(CGTextQuad) * new_capacity);
+    CG_ERROR_COND_RETURN(new_quads == NULL, CG_FALSE, CGSTR("Failed to allocate memory for text."));
+    cg_text_quads = new_quads;
+    cg_text_quad_capacity = new_capacity;
+    return CG_TRUE;
+}
+
+static void CGPushTextQuad(const CGAtlasGlyph* glyph, CGVector2 pen, const CGRenderObjectProperty* render_property, const CGWindow* window)
+{
+    if (glyph->page == CG_GLYPH_ATLAS_NO_PAGE)
+        return;
+    CGVertexBounds rect;
+    rect.min_x = pen.x + (float)glyph->left;
+    rect.min_y = pen.y + (float)glyph->top - (float)glyph->height;
+    rect.max_x = pen.x + (float)glyph->left + (float)glyph->width;
+    rect.max_y = pen.y + (float)glyph->top;
+    // draw the quads so far if the glyph would cost them their precision
+    if (cg_text_quad_count != 0
+        && (fmaxf(cg_text_quad_bounds.max_x, rect.max_x) - fminf(cg_text_quad_bounds.min_x, rect.min_x) > CG_TEXT_QUADS_MAX_EXTENT
+        || fmaxf(cg_text_quad_bounds.max_y, rect.max_y) - fminf(cg_text_quad_bounds.min_y, rect.min_y) > CG_TEXT_QUADS_MAX_EXTENT))
+        CGFlushTextQuads(render_property, window);
+    if (!CGReserveTextQuads(1))
+        return;
+    CGTextQuad* quad = &cg_text_quads[cg_text_quad_count++];
+    quad->rect = rect;
+    float page_size = (float)CGGetGlyphAtlasPageSize(cg_glyph_atlas);
+    quad->tex_top_left = CGConstructVector2((float)glyph->x / page_size, (float)glyph->y / page_size);
+    quad->tex_bottom_right = CGConstructVector2((float)(glyph->x + glyph->width) / page_size,
+        (float)(glyph->y + glyph->height) / page_size);
+    quad->page = glyph->page;
+    if (cg_text_quad_count == 1)
+        cg_text_quad_bounds = quad->rect;
+    else
+    {
+        cg_text_quad_bounds.min_x = fminf(cg_text_quad_bounds.min_x, quad->rect.min_x);
+        cg_text_quad_bounds.min_y = fminf(cg_text_quad_bounds.min_y, quad->rect.min_y);
+        cg_text_quad_bounds.max_x = fmaxf(cg_text_quad_bounds.max_x, quad->rect.max_x);
+        cg_text_quad_bounds.max_y = fmaxf(cg_text_quad_bounds.max_y, quad->rect.max_y);
+    }
+}
+
+// make the index buffer of the text long enough for the quads
+static void CGReserveTextIndices(unsigned int quad_count)
+{
+    if (quad_count <= cg_text_index_quad_count)
+        return;
+    unsigned int new_quad_count = cg_text_index_quad_count == 0 ? 256 : cg_text_index_quad_count;
+    while (new_quad_count < quad_count)
+        new_quad_count *= 2;
+    unsigned int* indices = (unsigned int*)CGMalloc(sizeof(unsigned int) * 6 * new_quad_count);
+    CG_ERROR_CONDITION(indices == NULL, CGSTR("Failed to allocate memory for text."));
+    for (unsigned int i = 0; i < new_quad_count; ++i)
+    {
+        unsigned int* quad_indices = indices + 6 * i;
+        quad_indices[0] = 4 * i;
+        quad_indices[1] = 4 * i + 1;
+        quad_indices[2] = 4 * i + 2;
+        quad_indices[3] = 4 * i;
+        quad_indices[4] = 4 * i + 2;
+        quad_indices[5] = 4 * i + 3;
+    }
+    // the element buffer is bound to the text vao, which is bound by the caller
+    CGBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_TEXT_EBO], sizeof(unsigned int) * 6 * new_quad_count, indices, GL_STATIC_DRAW);
+    free(indices);
+    cg_text_index_quad_count = new_quad_count;
+}
+
+// draw the text quads, with one draw call for each page of the glyph atlas
+static void CGFlushTextQuads(const CGRenderObjectProperty* render_property, const CGWindow* window)
+{
+    if (cg_text_quad_count == 0)
+        return;
+    if (window->gpu_profiler != NULL)
+        CGGPUProfilerSetZone(window->gpu_profiler, CG_GPU_ZONE_TEXT);
+
+    // the quads are put into the stream in the order of their pages
+    unsigned int page_counts[CG_GLYPH_ATLAS_DEFAULT_MAX_PAGE_COUNT] = {0};
+    for (unsigned int i = 0; i < cg_text_quad_count; ++i)
+        ++page_counts[cg_text_quads[i].page];
+    if (cg_text_upload_stream.stride == 0)
+        CGInitVertexStream(&cg_text_upload_stream, sizeof(CGCompactImageVertex), 4 * cg_text_quad_capacity);
+    CGResetVertexStream(&cg_text_upload_stream);
+    for (unsigned int page = 0; page < CG_GLYPH_ATLAS_DEFAULT_MAX_PAGE_COUNT; ++page)
+    {
+        for (unsigned int i = 0; i < cg_text_quad_count && page_counts[page] != 0; ++i)
+        {
+            const CGTextQuad* quad = &cg_text_quads[i];
+            if (quad->page == page && !CGMakeImageRectVerticesWithTexCoords(&cg_text_quad_bounds, &quad->rect,
+                quad->tex_top_left, quad->tex_bottom_right, &cg_text_upload_stream))
+            {
+                cg_text_quad_count = 0;
+                return;
+            }
+        }
+    }
+
+    CGGLUseProgram(cg_bitmap_visual_image_shader_program);
+    CGGLBindVertexArray(window->text_vao);
+    CGReserveTextIndices(cg_text_quad_count);
+    CGBindBuffer(GL_ARRAY_BUFFER, cg_gl_buffers[CG_GL_BUFFERS_TEXT_VBO],
+        sizeof(CGCompactImageVertex) * cg_text_upload_stream.size, cg_text_upload_stream.data, GL_STREAM_DRAW);
+    CGSetPropertyUniforms(cg_bitmap_visual_image_shader_program, render_property);
+    CGSetCompactVertexUniforms(cg_bitmap_visual_image_shader_program, &cg_text_quad_bounds, 0.0f);
+    CGSetRenderSizeUniforms(cg_bitmap_visual_image_shader_program, window);
+    unsigned int first_quad = 0;
+    for (unsigned int page = 0; page < CG_GLYPH_ATLAS_DEFAULT_MAX_PAGE_COUNT; ++page)
     {
-        free(text);
-        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to set pixel size for font."), font_rk);
+        if (page_counts[page] == 0)
+            continue;
+        CGGLBindTexture(GL_TEXTURE_2D, CGGetGlyphAtlasTexture(page));
+        CGGLDrawElements(GL_TRIANGLES, 6 * page_counts[page], GL_UNSIGNED_INT, (void*)(sizeof(unsigned int) * 6 * first_quad));
+        first_quad += page_counts[page];
     }
+    CGGLBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    CGGLBindTexture(GL_TEXTURE_2D, 0);
+    cg_text_quad_count = 0;
+}
 
+/**
+ * @brief Lay out a text into the text quads. The quads that are laid out before are drawn
+ * when a page of the glyph atlas that they may use is cleared.
+ * 
+ * @param text The text.
+ * @param font_rk The resource key of the font. NULL for the default font.
+ * @param text_property The property of the text.
+ * @param position The position of the start of the baseline of the text.
+ * @param render_property The render property that the quads are drawn with.
+ * @param window The window that the quads are drawn on.
+ * @return CG_TRUE if the text is laid out. CG_FALSE if failed.
+ */
+static CG_BOOL CGLayoutText(const CGChar* text, const CGChar* font_rk, const CGTextProperty* text_property, CGVector2 position,
+    const CGRenderObjectProperty* render_property, const CGWindow* window)
+{
+    CGGlyphKey key = CGConstructTextGlyphKey(font_rk, text_property);
+    // the face is only created when a glyph is not in the atlas
+    FT_Face face = NULL;
+    CG_BOOL result = CG_TRUE;
     unsigned int char_count = CG_STRLEN(text);
-    int offset = 0;
+    CGVector2 pen = position;
     for (unsigned int i = 0; i < char_count; ++i)
     {
         if (text[i] == ' ')
         {
-            offset += text_property.space_width + text_property.kerning;
+            pen.x += (float)(text_property->space_width + text_property->kerning);
             continue;
         }
-        if (!CGGetGlyphFromFace(face, text[i]))
+        key.codepoint = (unsigned int)text[i];
+        const CGAtlasGlyph* glyph = cg_glyph_atlas == NULL ? NULL : CGFindAtlasGlyph(cg_glyph_atlas, &key);
+        if (glyph == NULL)
         {
-            if (font_rk != NULL)
-                FT_Done_Face(face);
-            CG_ERROR(CGSTR("Failed to load glyph with char: \'%c\' (unicode: %#x)."), text[i], text[i]);
-            free(text);
-            return CG_FALSE;
+            if (face == NULL && !CGCreateTextFace(font_rk, text_property, &face))
+            {
+                result = CG_FALSE;
+                break;
+            }
+            if (!CGGetGlyphFromFace(face, text[i]))
+            {
+                CG_ERROR(CGSTR("Failed to load glyph with char: \'%c\' (unicode: %#x)."), text[i], text[i]);
+                result = CG_FALSE;
+                break;
+            }
+            unsigned int evicted_page;
+            glyph = CGAddGlyphToAtlas(&key, face->glyph, &evicted_page);
+            if (glyph == NULL)
+            {
+                // glyphs that don't fit in a page are drawn from a texture of their own
+                CGDrawGlyph(pen, face->glyph, render_property, window);
+                pen.x += (float)(face->glyph->bitmap.width + text_property->kerning);
+                continue;
+            }
+            if (evicted_page != CG_GLYPH_ATLAS_NO_PAGE)
+                CGFlushTextQuads(render_property, window);
+            CGUploadAtlasGlyph(glyph, face->glyph);
         }
-        CGDrawGlyph(offset, face->glyph, render_property, window);
-            offset += face->glyph->bitmap.width + text_property.kerning;
+        CGPushTextQuad(glyph, pen, render_property, window);
+        pen.x += (float)(glyph->width + text_property->kerning);
     }
 
-    if (font_rk != NULL)
+    if (face != NULL && font_rk != NULL)
         FT_Done_Face(face);
+    return result;
+}
+
+CG_BOOL CGDrawText(const CGChar* text_rk, const CGChar* font_rk, CGTextProperty text_property, const CGRenderObjectProperty* render_property, const CGWindow* window)
+{
+    CG_ERROR_COND_RETURN(text_rk == NULL, CG_FALSE, CGSTR("Cannot draw text with NULL text resource key."));
+    CGChar* text = (CGChar*)CGLoadResource(text_rk, NULL, NULL);
+    CG_ERROR_COND_RETURN(text == NULL, CG_FALSE, CGSTR("Failed to load text resource."));
+    CG_BOOL result = CGDrawTextRaw(text, font_rk, text_property, render_property, window);
     free(text);
+    return result;
+}
+
+/**
+ * @brief Check that text can be drawn into a window now, and bind the frame buffer that it is drawn into.
+ * Text of windows with partial redraw or idle mode is drawn after CGWindowDraw, so that it is not
+ * cleared by CGWindowDraw. Windows with partial redraw get it on top of the presented frame, so that
+ * it is not kept in the frame of the next redraw.
+ * 
+ * @param window The window.
+ * @param is_skipped Set to CG_TRUE if the frame is skipped by idle mode, so the text is not drawn.
+ * @return CG_BOOL CG_FALSE if text cannot be drawn into the window now.
+ */
+static CG_BOOL CGBeginWindowText(const CGWindow* window, CG_BOOL* is_skipped)
+{
+    *is_skipped = CG_FALSE;
+    // text drawn into a render layer is kept in the layer
+    if (cg_current_render_layer != NULL || (window->redraw_state == NULL && !window->sub_property.idle_mode))
+        return CG_TRUE;
+    CG_ERROR_COND_RETURN(!window->is_drawn, CG_FALSE,
+        CGSTR("Text of windows with partial redraw or idle mode must be drawn after CGWindowDraw."));
+    // the last frame is still on the screen with its text
+    *is_skipped = window->is_idle;
+    if (!*is_skipped && window->redraw_state != NULL && window->redraw_state->frame_buffer != 0)
+        glBindFramebuffer(GL_FRAMEBUFFER, window->offscreen_frame_buffer);
+    return CG_TRUE;
+}
+
+// bind the frame buffer that the objects of the window are drawn into again
+static void CGEndWindowText(const CGWindow* window)
+{
+    if (cg_current_render_layer == NULL && window->redraw_state != NULL && window->redraw_state->frame_buffer != 0)
+        glBindFramebuffer(GL_FRAMEBUFFER, window->redraw_state->frame_buffer);
+}
+
+CG_BOOL CGDrawTextRaw(const CGChar* text, const CGChar* font_rk, CGTextProperty text_property, const CGRenderObjectProperty* render_property, const CGWindow* window)
+{
+    CG_ERROR_COND_RETURN(text == NULL, CG_FALSE, CGSTR("Cannot draw NULL text."));
+    CG_BOOL is_skipped;
+    if (!CGBeginWindowText(window, &is_skipped))
+        return CG_FALSE;
+    if (window->command_recorder != NULL)
+        CGCommandRecorderDrawText(window->command_recorder, text, font_rk, &text_property, CGConstructVector2(0.0f, 0.0f), render_property);
+    if (is_skipped)
+        return CG_TRUE;
+    if (render_property == NULL)
+        render_property = cg_default_geo_property;
+    CGGladInitializeCheck();
+
+    CG_BOOL result = CGLayoutText(text, font_rk, &text_property, CGConstructVector2(0.0f, 0.0f), render_property, window);
+    CGFlushTextQuads(render_property, window);
+    CGEndWindowText(window);
+    return result;
+}
+
+typedef struct{
+    CGChar* text;
+    /**
+     * @brief The resource key of the font. NULL for the default font.
+     */
+    CGChar* font_rk;
+    CGTextProperty text_property;
+    CGVector2 position;
+}CGTextBatchItem;
+
+struct CGTextBatch{
+    CGTextBatchItem* items;
+    unsigned int size;
+    unsigned int capacity;
+};
+
+static void CGDeleteTextBatch(CGTextBatch* batch)
+{
+    if (batch == NULL)
+        return;
+    CGClearTextBatch(batch);
+    free(batch->items);
+    free(batch);
+}
+
+CGTextBatch* CGCreateTextBatch()
+{
+    CGTextBatch* batch = (CGTextBatch*)CGCalloc(1, sizeof(CGTextBatch));
+    CG_ERROR_COND_RETURN(batch == NULL, NULL, CGSTR("Failed to allocate memory for text batch."));
+    CGRegisterResource(batch, CG_DELETER(CGDeleteTextBatch));
+    return batch;
+}
+
+static CGChar* CGCopyString(const CGChar* string)
+{
+    unsigned int size = sizeof(CGChar) * (CG_STRLEN(string) + 1);
+    CGChar* result = (CGChar*)CGMalloc(size);
+    if (result != NULL)
+        memcpy(result, string, size);
+    return result;
+}
+
+CG_BOOL CGAddTextToBatch(CGTextBatch* batch, const CGChar* text, const CGChar* font_rk, CGTextProperty text_property, CGVector2 position)
+{
+    CG_ERROR_COND_RETURN(batch == NULL, CG_FALSE, CGSTR("Cannot add text to a NULL text batch."));
+    CG_ERROR_COND_RETURN(text == NULL, CG_FALSE, CGSTR("Cannot add NULL text to a text batch."));
+    if (batch->size == batch->capacity)
+    {
+        unsigned int new_capacity = batch->capacity == 0 ? 16 : batch->capacity * 2;
+        CGTextBatchItem* new_items = (CGTextBatchItem*)CGRealloc(batch->items, sizeof(CGTextBatchItem) * new_capacity);
+        CG_ERROR_COND_RETURN(new_items == NULL, CG_FALSE, CGSTR("Failed to allocate memory for text batch."));
+        batch->items = new_items;
+        batch->capacity = new_capacity;
+    }
+    CGTextBatchItem* item = &batch->items[batch->size];
+    item->text = CGCopyString(text);
+    item->font_rk = font_rk == NULL ? NULL : CGCopyString(font_rk);
+    if (item->text == NULL || (font_rk != NULL && item->font_rk == NULL))
+    {
+        free(item->text);
+        free(item->font_rk);
+        CG_ERROR_COND_RETURN(CG_TRUE, CG_FALSE, CGSTR("Failed to allocate memory for text batch."));
+    }
+    item->text_property = text_property;
+    item->position = position;
+    ++batch->size;
     return CG_TRUE;
 }
 
+void CGClearTextBatch(CGTextBatch* batch)
+{
+    CG_ERROR_CONDITION(batch == NULL, CGSTR("Cannot clear a NULL text batch."));
+    for (unsigned int i = 0; i < batch->size; ++i)
+    {
+        free(batch->items[i].text);
+        free(batch->items[i].font_rk);
+    }
+    batch->size = 0;
+}
+
+unsigned int CGGetTextBatchSize(const CGTextBatch* batch)
+{
+    CG_ERROR_COND_RETURN(batch == NULL, 0, CGSTR("Cannot get the size of a NULL text batch."));
+    return batch->size;
+}
+
+CG_BOOL CGDrawTextBatch(const CGTextBatch* batch, const CGRenderObjectProperty* render_property, const CGWindow* window)
+{
+    CG_ERROR_COND_RETURN(batch == NULL, CG_FALSE, CGSTR("Cannot draw a NULL text batch."));
+    CG_ERROR_COND_RETURN(window == NULL || window->glfw_window_instance == NULL, CG_FALSE, CGSTR("Cannot draw text batch on a NULL window."));
+    CG_BOOL is_skipped;
+    if (!CGBeginWindowText(window, &is_skipped))
+        return CG_FALSE;
+    if (window->command_recorder != NULL)
+    {
+        for (unsigned int i = 0; i < batch->size; ++i)
+        {
+            const CGTextBatchItem* item = &batch->items[i];
+            CGCommandRecorderDrawText(window->command_recorder, item->text, item->font_rk, &item->text_property, item->position, render_property);
+        }
+    }
+    if (is_skipped)
+        return CG_TRUE;
+    if (render_property == NULL)
+        render_property = cg_default_geo_property;
+    CGGladInitializeCheck();
+
+    CG_BOOL result = CG_TRUE;
+    for (unsigned int i = 0; i < batch->size; ++i)
+    {
+        const CGTextBatchItem* item = &batch->items[i];
+        if (!CGLayoutText(item->text, item->font_rk, &item->text_property, item->position, render_property, window))
+            result = CG_FALSE;
+    }
+    CGFlushTextQuads(render_property, window);
+    CGEndWindowText(window);
+    return result;
+}
+
 CGPolygonVertex* CGCreatePolygonVertex(CGVector2 position)
 {
-    CGPolygonVertex* result = (CGPolygonVertex*)malloc(sizeof(CGPolygonVertex));
+    CGPolygonVertex* result = (CGPolygonVertex*)CGMalloc(sizeof(CGPolygonVertex));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for polygon vertex."));
     result->position = position;
+    result->color = CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f);
     result->previous = NULL;
     result->next = NULL;
     return result;
@@ -1923,7 +4623,7 @@ CGPolygon* CGCreatePolygon(CGVector2* vertices, unsigned int vertex_count, CG_BO
 {
     CG_ERROR_COND_RETURN(vertices == NULL, NULL, CGSTR("Cannot create polygon with NULL vertices."));
     CG_ERROR_COND_RETURN(vertex_count < 3, NULL, CGSTR("Cannot create polygon with less than 3 vertices."));
-    CGPolygon* result = (CGPolygon*)malloc(sizeof(CGPolygon));
+    CGPolygon* result = (CGPolygon*)CGMalloc(sizeof(CGPolygon));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for polygon."));
     result->vertex_head = CGCreatePolygonVertex(vertices[0]);
     CG_ERROR_COND_RETURN(result->vertex_head == NULL, NULL, CGSTR("Failed to create polygon vertex."));
@@ -1942,6 +4642,17 @@ CGPolygon* CGCreatePolygon(CGVector2* vertices, unsigned int vertex_count, CG_BO
     return result;
 }
 
+CGPolygon* CGCreateColoredPolygon(CGVector2* vertices, CGColor* colors, unsigned int vertex_count, CG_BOOL is_temp)
+{
+    CG_ERROR_COND_RETURN(colors == NULL, NULL, CGSTR("Cannot create colored polygon with NULL colors."));
+    CGPolygon* result = CGCreatePolygon(vertices, vertex_count, is_temp);
+    CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to create colored polygon."));
+    CGPolygonVertex* p = result->vertex_head;
+    for (unsigned int i = 0; i < vertex_count; ++i, p = p->next)
+        p->color = colors[i];
+    return result;
+}
+
 static void CGDeletePolygon(CGPolygon* polygon)
 {
     if (polygon == NULL)
@@ -1999,9 +4710,9 @@ void CGDeletePolygonVertex(CGPolygonVertex* node)
 
 CGTriangleListNode* CGCreateTriangleListNode(CGTriangle triangle)
 {
-    CGTriangleListNode* result = (CGTriangleListNode*)malloc(sizeof(CGTriangleListNode));
+    CGTriangleListNode* result = (CGTriangleListNode*)CGMalloc(sizeof(CGTriangleListNode));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for triangle list node."));
-    result->triangle = (CGTriangle*)malloc(sizeof(CGTriangle));
+    result->triangle = (CGTriangle*)CGMalloc(sizeof(CGTriangle));
     *result->triangle = triangle;
     result->next = NULL;
     return result;
@@ -2017,7 +4728,7 @@ void CGDeleteTriangleListNode(CGTriangleListNode* node)
 static CGTriangleListNode* CGCreateTriangleListNodeMove(CGTriangle* triangle)
 {
     CG_ERROR_COND_RETURN(triangle == NULL, NULL, CGSTR("Cannot create triangle list node from NULL triangle."));
-    CGTriangleListNode* result = (CGTriangleListNode*)malloc(sizeof(CGTriangleListNode));
+    CGTriangleListNode* result = (CGTriangleListNode*)CGMalloc(sizeof(CGTriangleListNode));
     CG_ERROR_COND_RETURN(result == NULL, NULL, CGSTR("Failed to allocate memory for triangle list node."));
     result->triangle = triangle;
     result->next = NULL;
@@ -2039,20 +4750,24 @@ static CG_BOOL CGIsVertexEar(CGPolygonVertex* vertex)
     return CG_TRUE;
 }
 
-CGTriangleListNode* CGTriangulatePolygon(CGPolygon* polygon, CG_BOOL is_triangles_temp)
+static CG_BOOL CGClipPolygonEars(CGPolygon* polygon, CG_BOOL is_copy_forced, CGPolygonEarCallback callback, void* user_data)
 {
-    CG_ERROR_COND_RETURN(polygon == NULL, NULL, CGSTR("Cannot triangulate NULL polygon."));
+    CG_ERROR_COND_RETURN(polygon == NULL, CG_FALSE, CGSTR("Cannot triangulate NULL polygon."));
+    CG_ERROR_COND_RETURN(polygon->vertex_head == NULL, CG_FALSE, CGSTR("Cannot triangulate polygon without vertices."));
     CGPolygonVertex* polygon_vertex_head;
-    if (!polygon->is_temp)
+    CG_BOOL is_consuming = polygon->is_temp && !is_copy_forced;
+    if (!is_consuming)
     {
         polygon_vertex_head = CGCreatePolygonVertex(polygon->vertex_head->position);
-        CG_ERROR_COND_RETURN(polygon_vertex_head == NULL, NULL, CGSTR("Failed to create polygon vertex."));
+        CG_ERROR_COND_RETURN(polygon_vertex_head == NULL, CG_FALSE, CGSTR("Failed to create polygon vertex."));
+        polygon_vertex_head->color = polygon->vertex_head->color;
         polygon_vertex_head->next = polygon_vertex_head;
         polygon_vertex_head->previous = polygon_vertex_head;
         for (CGPolygonVertex* p = polygon->vertex_head->next; p != polygon->vertex_head; p = p->next)
         {
             CGPolygonVertex* node = CGCreatePolygonVertex(p->position);
-            CG_ERROR_COND_RETURN(node == NULL, NULL, CGSTR("Failed to create polygon vertex."));
+            CG_ERROR_COND_RETURN(node == NULL, CG_FALSE, CGSTR("Failed to create polygon vertex."));
+            node->color = p->color;
             node->next = polygon_vertex_head;
             node->previous = polygon_vertex_head->previous;
             node->next->previous = node;
@@ -2062,23 +4777,20 @@ CGTriangleListNode* CGTriangulatePolygon(CGPolygon* polygon, CG_BOOL is_triangle
     else
         polygon_vertex_head = polygon->vertex_head;
     
-    CGTriangleListNode* result_head = NULL;
+    CG_BOOL succeed = CG_TRUE;
     CGPolygonVertex* p = polygon_vertex_head;
-    while (polygon_vertex_head->next->next != polygon_vertex_head->previous)
+    while (succeed && polygon_vertex_head->next->next != polygon_vertex_head->previous)
     {
         if (CGVector2Cross(CGVector2Sub(p->position, p->previous->position), CGVector2Sub(p->next->position, p->position)) == 0.0f)
         {
+            if (p == polygon_vertex_head)
+                polygon_vertex_head = polygon_vertex_head->next;
             p = p->previous;
             CGDeletePolygonVertex(p->next);
         }
         if (CGIsVertexEar(p))
         {
-            CGTriangleListNode* node = 
-                CGCreateTriangleListNodeMove(
-                    CGCreateTriangle(p->previous->position, p->position, p->next->position, is_triangles_temp));
-            CG_ERROR_COND_RETURN(node == NULL, NULL, CGSTR("Failed to create triangle list node."));
-            node->next = result_head;
-            result_head = node;
+            succeed = callback(p->previous, p, p->next, user_data);
             if (p == polygon_vertex_head)
                 polygon_vertex_head = polygon_vertex_head->next;
             p = p->previous;
@@ -2087,24 +4799,54 @@ CGTriangleListNode* CGTriangulatePolygon(CGPolygon* polygon, CG_BOOL is_triangle
         else
             p = p->next;
     }
-    CGTriangleListNode* node = CGCreateTriangleListNodeMove(CGCreateTriangle(
-            polygon_vertex_head->previous->position, 
-            polygon_vertex_head->position, 
-            polygon_vertex_head->next->position, 
-            is_triangles_temp));
-    
-    node->next = result_head;
-    result_head = node;
+    if (succeed)
+        succeed = callback(polygon_vertex_head->previous, polygon_vertex_head, polygon_vertex_head->next, user_data);
 
-    free(polygon_vertex_head->previous);
-    free(polygon_vertex_head->next);
+    for (p = polygon_vertex_head->next; p != polygon_vertex_head;)
+    {
+        CGPolygonVertex* temp = p;
+        p = p->next;
+        free(temp);
+    }
     free(polygon_vertex_head);
-    if (polygon->is_temp)
+    if (is_consuming)
         polygon->vertex_head = NULL;
-    return result_head;
+    return succeed;
+}
+
+/**
+ * @brief Data used by @ref CGTriangulatePolygon to collect clipped triangles.
+ */
+typedef struct{
+    CGTriangleListNode* result_head;
+    CG_BOOL is_triangles_temp;
+}CGTriangulateData;
+
+static CG_BOOL CGAppendClippedTriangle(const CGPolygonVertex* vert_1, const CGPolygonVertex* vert_2, const CGPolygonVertex* vert_3, void* user_data)
+{
+    CGTriangulateData* data = (CGTriangulateData*)user_data;
+    CGTriangleListNode* node = 
+        CGCreateTriangleListNodeMove(
+            CGCreateTriangle(vert_1->position, vert_2->position, vert_3->position, data->is_triangles_temp));
+    CG_ERROR_COND_RETURN(node == NULL, CG_FALSE, CGSTR("Failed to create triangle list node."));
+    node->next = data->result_head;
+    data->result_head = node;
+    return CG_TRUE;
+}
+
+CGTriangleListNode* CGTriangulatePolygon(CGPolygon* polygon, CG_BOOL is_triangles_temp)
+{
+    CG_ERROR_COND_RETURN(polygon == NULL, NULL, CGSTR("Cannot triangulate NULL polygon."));
+    CGTriangulateData data;
+    data.result_head = NULL;
+    data.is_triangles_temp = is_triangles_temp;
+    CG_PROFILE_BEGIN(TriangulatePolygon);
+    CGClipPolygonEars(polygon, CG_FALSE, CGAppendClippedTriangle, &data);
+    CG_PROFILE_END(TriangulatePolygon);
+    return data.result_head;
 }
 
-static void CGRenderPolygon(CGPolygon* polygon, const CGRenderObjectProperty* property, CGWindow* window, float assigned_z)
+static void CGRenderPolygon(CGPolygon* polygon, const CGRenderObjectProperty* property, CGWindow* window, float depth)
 {
     CG_ERROR_CONDITION(polygon == NULL, CGSTR("Failed to draw polygon: Polygon must be specified to a non-null polygon instance."));
     CG_ERROR_CONDITION(window == NULL || window->glfw_window_instance == NULL, CGSTR("Failed to draw polygon: Attempting to draw polygon on a NULL window"));
@@ -2112,10 +4854,44 @@ static void CGRenderPolygon(CGPolygon* polygon, const CGRenderObjectProperty* pr
     CGTriangleListNode* triangles = CGTriangulatePolygon(polygon, CG_TRUE);
     for (CGTriangleListNode* p = triangles; p != NULL;)
     {
-        CGRenderTriangle(p->triangle, property, window, assigned_z);
+        CGRenderTriangle(p->triangle, property, window, depth);
         CGFree(p->triangle);
         CGTriangleListNode* temp = p;
         p = p->next;
         free(temp);
     }
+}
+
+/**
+ * @brief Data used by @ref CGBatchColoredPolygon to add clipped triangles into the batch.
+ */
+typedef struct{
+    const float* model_mat;
+    const CGColor* tint;
+    float depth;
+}CGColoredPolygonBatchData;
+
+static CG_BOOL CGBatchClippedTriangle(const CGPolygonVertex* vert_1, const CGPolygonVertex* vert_2, const CGPolygonVertex* vert_3, void* user_data)
+{
+    CGColoredPolygonBatchData* data = (CGColoredPolygonBatchData*)user_data;
+    if (!CGReserveColoredGeometryBatch(3))
+        return CG_FALSE;
+    CGPushColoredVertex(data->model_mat, data->tint, vert_1->position, &vert_1->color, data->depth);
+    CGPushColoredVertex(data->model_mat, data->tint, vert_2->position, &vert_2->color, data->depth);
+    CGPushColoredVertex(data->model_mat, data->tint, vert_3->position, &vert_3->color, data->depth);
+    return CG_TRUE;
+}
+
+static void CGBatchColoredPolygon(CGPolygon* polygon, const CGRenderObjectProperty* property, float depth)
+{
+    CG_ERROR_CONDITION(polygon == NULL, CGSTR("Failed to draw colored polygon: Polygon must be specified to a non-null polygon instance."));
+    if (property == NULL)
+        property = cg_default_colored_geo_property;
+    float model_mat[16] = {0};
+    CGGetPropertyMatrix(property, model_mat);
+    CGColoredPolygonBatchData data;
+    data.model_mat = model_mat;
+    data.tint = &property->color;
+    data.depth = depth;
+    CGClipPolygonEars(polygon, CG_FALSE, CGBatchClippedTriangle, &data);
 }
\ No newline at end of file
@@ -3,11 +3,12 @@ extern "C" {
 #endif
 #include "cos_graphics/graphics.h"
 #include "cos_graphics/log.h"
+#include "cos_graphics/utils.h"
 #include <stdlib.h>
 
 CGLinkedListNode* CGCreateLinkedListNode(void* data, int type)
 {
-    CGLinkedListNode* node = (CGLinkedListNode*)malloc(sizeof(CGLinkedListNode));
+    CGLinkedListNode* node = (CGLinkedListNode*)CGMalloc(sizeof(CGLinkedListNode));
     CG_ERROR_COND_RETURN(node == NULL, NULL, CGSTR("Failed to allocate memory for linked list node"));
     node->data = data;
     node->identifier = type;
@@ -0,0 +1,481 @@
+#include "cos_graphics/spatial_index.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/utils.h"
+#include "cos_graphics/log.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Cell coordinates are clamped in this range, so that huge positions don't overflow.
+ */
+#define CG_SPATIAL_INDEX_MAX_CELL_COORD (1 << 28)
+
+/**
+ * @brief A cell of the grid, and the ids of the items that overlap it.
+ */
+typedef struct{
+    int x;
+    int y;
+    unsigned int* items;
+    unsigned int size;
+    unsigned int capacity;
+}CGSpatialIndexCell;
+
+/**
+ * @brief An item and where it is stored in the grid.
+ */
+typedef struct{
+    CGSpatialIndexItem item;
+    /**
+     * @brief The range of cells that the item is stored in (min x, min y, max x, max y).
+     */
+    int cell_range[4];
+    /**
+     * @brief Is the item too large to be stored in the cells.
+     */
+    CG_BOOL is_oversized;
+    CG_BOOL is_used;
+    /**
+     * @brief The last query that found the item, so that an item in several cells is found once.
+     */
+    unsigned int query_stamp;
+    /**
+     * @brief The id of the next unused entry.
+     */
+    unsigned int next_free;
+}CGSpatialIndexEntry;
+
+struct CGSpatialIndex{
+    float cell_size;
+    /**
+     * @brief The entries of the items. The id of an item is its entry index + 1.
+     */
+    CGSpatialIndexEntry* entries;
+    unsigned int entry_count;
+    unsigned int entry_capacity;
+    unsigned int free_head;
+    unsigned int item_count;
+    /**
+     * @brief The cells that have ever been used.
+     */
+    CGSpatialIndexCell* cells;
+    unsigned int cell_count;
+    unsigned int cell_capacity;
+    /**
+     * @brief Open addressing hash table from cell coordinates to cell index + 1. 0 for empty slots.
+     */
+    unsigned int* cell_table;
+    unsigned int cell_table_size;
+    /**
+     * @brief The ids of the items that are too large to be stored in the cells.
+     */
+    unsigned int* oversized_items;
+    unsigned int oversized_size;
+    unsigned int oversized_capacity;
+    unsigned int query_stamp;
+    unsigned int next_sequence;
+    /**
+     * @brief The items hit by the last pick or rectangle query, reused between queries.
+     */
+    CGSpatialIndexItem* hits;
+    unsigned int hit_count;
+    unsigned int hit_capacity;
+};
+
+static void CGDeleteSpatialIndex(CGSpatialIndex* index)
+{
+    if (index == NULL)
+        return;
+    for (unsigned int i = 0; i < index->cell_count; ++i)
+        free(index->cells[i].items);
+    free(index->cells);
+    free(index->cell_table);
+    free(index->entries);
+    free(index->oversized_items);
+    free(index->hits);
+    free(index);
+}
+
+CGSpatialIndex* CGCreateSpatialIndex(float cell_size)
+{
+    CG_ERROR_COND_RETURN(!(cell_size > 0.0f), NULL, CGSTR("Failed to create spatial index: Cell size must be larger than 0."));
+    CGSpatialIndex* index = (CGSpatialIndex*)CGCalloc(1, sizeof(CGSpatialIndex));
+    CG_ERROR_COND_RETURN(index == NULL, NULL, CGSTR("Failed to allocate memory for spatial index."));
+    index->cell_size = cell_size;
+    CGRegisterResource(index, CG_DELETER(CGDeleteSpatialIndex));
+    return index;
+}
+
+static CG_BOOL CGPushSpatialIndexId(unsigned int** ids, unsigned int* size, unsigned int* capacity, unsigned int id)
+{
+    if (*size == *capacity)
+    {
+        unsigned int new_capacity = *capacity == 0 ? 4 : *capacity * 2;
+        unsigned int* new_ids = (unsigned int*)CGRealloc(*ids, sizeof(unsigned int) * new_capacity);
+        CG_ERROR_COND_RETURN(new_ids == NULL, CG_FALSE, CGSTR("Failed to allocate memory for spatial index."));
+        *ids = new_ids;
+        *capacity = new_capacity;
+    }
+    (*ids)[(*size)++] = id;
+    return CG_TRUE;
+}
+
+static void CGEraseSpatialIndexId(unsigned int* ids, unsigned int* size, unsigned int id)
+{
+    for (unsigned int i = 0; i < *size; ++i)
+    {
+        if (ids[i] == id)
+        {
+            ids[i] = ids[--(*size)];
+            return;
+        }
+    }
+}
+
+static unsigned int CGHashSpatialIndexCell(int x, int y)
+{
+    unsigned int hash = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u;
+    return hash ^ (hash >> 16);
+}
+
+static CGSpatialIndexCell* CGFindSpatialIndexCell(const CGSpatialIndex* index, int x, int y)
+{
+    if (index->cell_table_size == 0)
+        return NULL;
+    unsigned int mask = index->cell_table_size - 1;
+    for (unsigned int slot = CGHashSpatialIndexCell(x, y) & mask; index->cell_table[slot] != 0; slot = (slot + 1) & mask)
+    {
+        CGSpatialIndexCell* cell = &index->cells[index->cell_table[slot] - 1];
+        if (cell->x == x && cell->y == y)
+            return cell;
+    }
+    return NULL;
+}
+
+static CG_BOOL CGGrowSpatialIndexCellTable(CGSpatialIndex* index)
+{
+    unsigned int new_size = index->cell_table_size == 0 ? 64 : index->cell_table_size * 2;
+    unsigned int* new_table = (unsigned int*)CGCalloc(new_size, sizeof(unsigned int));
+    CG_ERROR_COND_RETURN(new_table == NULL, CG_FALSE, CGSTR("Failed to allocate memory for spatial index."));
+    unsigned int mask = new_size - 1;
+    for (unsigned int i = 0; i < index->cell_count; ++i)
+    {
+        unsigned int slot = CGHashSpatialIndexCell(index->cells[i].x, index->cells[i].y) & mask;
+        while (new_table[slot] != 0)
+            slot = (slot + 1) & mask;
+        new_table[slot] = i + 1;
+    }
+    free(index->cell_table);
+    index->cell_table = new_table;
+    index->cell_table_size = new_size;
+    return CG_TRUE;
+}
+
+static CGSpatialIndexCell* CGGetSpatialIndexCell(CGSpatialIndex* index, int x, int y)
+{
+    CGSpatialIndexCell* cell = CGFindSpatialIndexCell(index, x, y);
+    if (cell != NULL)
+        return cell;
+    // keep the table at most half full
+    if ((index->cell_count + 1) * 2 > index->cell_table_size && !CGGrowSpatialIndexCellTable(index))
+        return NULL;
+    if (index->cell_count == index->cell_capacity)
+    {
+        unsigned int new_capacity = index->cell_capacity == 0 ? 32 : index->cell_capacity * 2;
+        CGSpatialIndexCell* new_cells = (CGSpatialIndexCell*)CGRealloc(index->cells, sizeof(CGSpatialIndexCell) * new_capacity);
+        CG_ERROR_COND_RETURN(new_cells == NULL, NULL, CGSTR("Failed to allocate memory for spatial index."));
+        index->cells = new_cells;
+        index->cell_capacity = new_capacity;
+    }
+    cell = &index->cells[index->cell_count++];
+    cell->x = x;
+    cell->y = y;
+    cell->items = NULL;
+    cell->size = 0;
+    cell->capacity = 0;
+    unsigned int mask = index->cell_table_size - 1;
+    unsigned int slot = CGHashSpatialIndexCell(x, y) & mask;
+    while (index->cell_table[slot] != 0)
+        slot = (slot + 1) & mask;
+    index->cell_table[slot] = index->cell_count;
+    return cell;
+}
+
+static int CGGetSpatialIndexCellCoord(const CGSpatialIndex* index, float value)
+{
+    float coord = floorf(value / index->cell_size);
+    if (!(coord > -CG_SPATIAL_INDEX_MAX_CELL_COORD))
+        return -CG_SPATIAL_INDEX_MAX_CELL_COORD;
+    if (coord > CG_SPATIAL_INDEX_MAX_CELL_COORD)
+        return CG_SPATIAL_INDEX_MAX_CELL_COORD;
+    return (int)coord;
+}
+
+static void CGGetSpatialIndexCellRange(const CGSpatialIndex* index, const CGAABB* bounds, int* range)
+{
+    range[0] = CGGetSpatialIndexCellCoord(index, bounds->min.x);
+    range[1] = CGGetSpatialIndexCellCoord(index, bounds->min.y);
+    range[2] = CGGetSpatialIndexCellCoord(index, bounds->max.x);
+    range[3] = CGGetSpatialIndexCellCoord(index, bounds->max.y);
+}
+
+static double CGGetSpatialIndexCellRangeCount(const int* range)
+{
+    return ((double)range[2] - range[0] + 1) * ((double)range[3] - range[1] + 1);
+}
+
+static CG_BOOL CGInsertSpatialIndexEntry(CGSpatialIndex* index, CGSpatialIndexEntry* entry)
+{
+    CGGetSpatialIndexCellRange(index, &entry->item.bounds, entry->cell_range);
+    entry->is_oversized = CGGetSpatialIndexCellRangeCount(entry->cell_range) > CG_SPATIAL_INDEX_MAX_ITEM_CELLS;
+    if (entry->is_oversized)
+        return CGPushSpatialIndexId(&index->oversized_items, &index->oversized_size, &index->oversized_capacity, entry->item.id);
+    for (int y = entry->cell_range[1]; y <= entry->cell_range[3]; ++y)
+    {
+        for (int x = entry->cell_range[0]; x <= entry->cell_range[2]; ++x)
+        {
+            CGSpatialIndexCell* cell = CGGetSpatialIndexCell(index, x, y);
+            if (cell == NULL || !CGPushSpatialIndexId(&cell->items, &cell->size, &cell->capacity, entry->item.id))
+                return CG_FALSE;
+        }
+    }
+    return CG_TRUE;
+}
+
+static void CGEraseSpatialIndexEntry(CGSpatialIndex* index, CGSpatialIndexEntry* entry)
+{
+    if (entry->is_oversized)
+    {
+        CGEraseSpatialIndexId(index->oversized_items, &index->oversized_size, entry->item.id);
+        return;
+    }
+    for (int y = entry->cell_range[1]; y <= entry->cell_range[3]; ++y)
+    {
+        for (int x = entry->cell_range[0]; x <= entry->cell_range[2]; ++x)
+        {
+            CGSpatialIndexCell* cell = CGFindSpatialIndexCell(index, x, y);
+            if (cell != NULL)
+                CGEraseSpatialIndexId(cell->items, &cell->size, entry->item.id);
+        }
+    }
+}
+
+static CGSpatialIndexEntry* CGGetSpatialIndexEntry(const CGSpatialIndex* index, unsigned int id)
+{
+    if (index == NULL || id == CG_SPATIAL_INDEX_INVALID_ID || id > index->entry_count)
+        return NULL;
+    CGSpatialIndexEntry* entry = &index->entries[id - 1];
+    return entry->is_used ? entry : NULL;
+}
+
+unsigned int CGAddSpatialIndexItem(CGSpatialIndex* index, void* object, int object_type, CGRenderObjectProperty* property)
+{
+    CG_ERROR_COND_RETURN(index == NULL, CG_SPATIAL_INDEX_INVALID_ID, CGSTR("Cannot add item to NULL spatial index."));
+    CGAABB bounds;
+    if (!CGGetRenderObjectBounds(object, object_type, property, &bounds))
+        return CG_SPATIAL_INDEX_INVALID_ID;
+    unsigned int id = index->free_head;
+    if (id == CG_SPATIAL_INDEX_INVALID_ID)
+    {
+        if (index->entry_count == index->entry_capacity)
+        {
+            unsigned int new_capacity = index->entry_capacity == 0 ? 64 : index->entry_capacity * 2;
+            CGSpatialIndexEntry* new_entries = (CGSpatialIndexEntry*)CGRealloc(index->entries, sizeof(CGSpatialIndexEntry) * new_capacity);
+            CG_ERROR_COND_RETURN(new_entries == NULL, CG_SPATIAL_INDEX_INVALID_ID, CGSTR("Failed to allocate memory for spatial index."));
+            index->entries = new_entries;
+            index->entry_capacity = new_capacity;
+        }
+        id = ++index->entry_count;
+    }
+    else
+        index->free_head = index->entries[id - 1].next_free;
+
+    CGSpatialIndexEntry* entry = &index->entries[id - 1];
+    entry->item.id = id;
+    entry->item.object = object;
+    entry->item.object_type = object_type;
+    entry->item.property = property;
+    entry->item.bounds = bounds;
+    entry->item.sequence = index->next_sequence++;
+    entry->is_used = CG_TRUE;
+    entry->query_stamp = index->query_stamp;
+    entry->next_free = CG_SPATIAL_INDEX_INVALID_ID;
+    ++index->item_count;
+    if (!CGInsertSpatialIndexEntry(index, entry))
+    {
+        CGRemoveSpatialIndexItem(index, id);
+        return CG_SPATIAL_INDEX_INVALID_ID;
+    }
+    return id;
+}
+
+CG_BOOL CGUpdateSpatialIndexItem(CGSpatialIndex* index, unsigned int id)
+{
+    CGSpatialIndexEntry* entry = CGGetSpatialIndexEntry(index, id);
+    CG_ERROR_COND_RETURN(entry == NULL, CG_FALSE, CGSTR("Cannot update spatial index item %u: The item is not in the index."), id);
+    CGAABB bounds;
+    if (!CGGetRenderObjectBounds(entry->item.object, entry->item.object_type, entry->item.property, &bounds))
+        return CG_FALSE;
+    int range[4];
+    CGGetSpatialIndexCellRange(index, &bounds, range);
+    entry->item.bounds = bounds;
+    // objects that move inside their cells don't need to be moved in the grid
+    if (memcmp(range, entry->cell_range, sizeof(range)) == 0)
+        return CG_TRUE;
+    CGEraseSpatialIndexEntry(index, entry);
+    if (!CGInsertSpatialIndexEntry(index, entry))
+    {
+        CGRemoveSpatialIndexItem(index, id);
+        return CG_FALSE;
+    }
+    return CG_TRUE;
+}
+
+void CGRemoveSpatialIndexItem(CGSpatialIndex* index, unsigned int id)
+{
+    CGSpatialIndexEntry* entry = CGGetSpatialIndexEntry(index, id);
+    CG_ERROR_CONDITION(entry == NULL, CGSTR("Cannot remove spatial index item %u: The item is not in the index."), id);
+    CGEraseSpatialIndexEntry(index, entry);
+    entry->is_used = CG_FALSE;
+    entry->next_free = index->free_head;
+    index->free_head = id;
+    --index->item_count;
+}
+
+const CGSpatialIndexItem* CGGetSpatialIndexItem(const CGSpatialIndex* index, unsigned int id)
+{
+    CGSpatialIndexEntry* entry = CGGetSpatialIndexEntry(index, id);
+    return entry == NULL ? NULL : &entry->item;
+}
+
+unsigned int CGGetSpatialIndexItemCount(const CGSpatialIndex* index)
+{
+    CG_ERROR_COND_RETURN(index == NULL, 0, CGSTR("Cannot get item count of NULL spatial index."));
+    return index->item_count;
+}
+
+static unsigned int CGQuerySpatialIndexIds(CGSpatialIndex* index, const unsigned int* ids, unsigned int size,
+    const CGAABB* rect, CGSpatialIndexQueryCallback callback, void* user_data)
+{
+    unsigned int result = 0;
+    for (unsigned int i = 0; i < size; ++i)
+    {
+        CGSpatialIndexEntry* entry = &index->entries[ids[i] - 1];
+        if (entry->query_stamp == index->query_stamp)
+            continue;
+        entry->query_stamp = index->query_stamp;
+        if (!CGIsAABBOverlapping(&entry->item.bounds, rect))
+            continue;
+        if (callback != NULL)
+            callback(&entry->item, user_data);
+        ++result;
+    }
+    return result;
+}
+
+unsigned int CGQuerySpatialIndex(CGSpatialIndex* index, const CGAABB* rect, CGSpatialIndexQueryCallback callback, void* user_data)
+{
+    CG_ERROR_COND_RETURN(index == NULL || rect == NULL, 0, CGSTR("Cannot query NULL spatial index or rectangle."));
+    if (++index->query_stamp == 0)
+    {
+        // the stamps wrapped around, so the stamps of the entries might match the new stamp
+        for (unsigned int i = 0; i < index->entry_count; ++i)
+            index->entries[i].query_stamp = 0;
+        index->query_stamp = 1;
+    }
+    unsigned int result = 0;
+    int range[4];
+    CGGetSpatialIndexCellRange(index, rect, range);
+    if (CGGetSpatialIndexCellRangeCount(range) > index->cell_count)
+    {
+        // the rectangle covers more cells than the ones used, so just go through the used ones
+        for (unsigned int i = 0; i < index->cell_count; ++i)
+        {
+            CGSpatialIndexCell* cell = &index->cells[i];
+            if (cell->x >= range[0] && cell->x <= range[2] && cell->y >= range[1] && cell->y <= range[3])
+                result += CGQuerySpatialIndexIds(index, cell->items, cell->size, rect, callback, user_data);
+        }
+    }
+    else
+    {
+        for (int y = range[1]; y <= range[3]; ++y)
+        {
+            for (int x = range[0]; x <= range[2]; ++x)
+            {
+                CGSpatialIndexCell* cell = CGFindSpatialIndexCell(index, x, y);
+                if (cell != NULL)
+                    result += CGQuerySpatialIndexIds(index, cell->items, cell->size, rect, callback, user_data);
+            }
+        }
+    }
+    result += CGQuerySpatialIndexIds(index, index->oversized_items, index->oversized_size, rect, callback, user_data);
+    return result;
+}
+
+/**
+ * @brief Data used by @ref CGCollectSpatialIndexHit to collect the items hit by a query.
+ */
+typedef struct{
+    CGSpatialIndex* index;
+    const CGAABB* rect;
+    CG_BOOL is_success;
+}CGSpatialIndexHitTest;
+
+static void CGCollectSpatialIndexHit(const CGSpatialIndexItem* item, void* user_data)
+{
+    CGSpatialIndexHitTest* hit_test = (CGSpatialIndexHitTest*)user_data;
+    CGSpatialIndex* index = hit_test->index;
+    if (!hit_test->is_success || !CGIsRenderObjectOverlappingRect(item->object, item->object_type, item->property, hit_test->rect))
+        return;
+    if (index->hit_count == index->hit_capacity)
+    {
+        unsigned int new_capacity = index->hit_capacity == 0 ? 16 : index->hit_capacity * 2;
+        CGSpatialIndexItem* new_hits = (CGSpatialIndexItem*)CGRealloc(index->hits, sizeof(CGSpatialIndexItem) * new_capacity);
+        if (new_hits == NULL)
+        {
+            CG_ERROR(CGSTR("Failed to allocate memory for spatial index query."));
+            hit_test->is_success = CG_FALSE;
+            return;
+        }
+        index->hits = new_hits;
+        index->hit_capacity = new_capacity;
+    }
+    index->hits[index->hit_count++] = *item;
+}
+
+static int CGCompareSpatialIndexHit(const void* hit_1, const void* hit_2)
+{
+    const CGSpatialIndexItem* lhs = (const CGSpatialIndexItem*)hit_1;
+    const CGSpatialIndexItem* rhs = (const CGSpatialIndexItem*)hit_2;
+    // objects with smaller z are drawn later, so they are on top
+    float lhs_z = lhs->property != NULL ? lhs->property->z : 0.0f;
+    float rhs_z = rhs->property != NULL ? rhs->property->z : 0.0f;
+    if (lhs_z != rhs_z)
+        return lhs_z < rhs_z ? -1 : 1;
+    return lhs->sequence > rhs->sequence ? -1 : (lhs->sequence < rhs->sequence ? 1 : 0);
+}
+
+unsigned int CGQueryRect(CGWindow* window, const CGAABB* rect, CGSpatialIndexItem* results, unsigned int max_count)
+{
+    CG_ERROR_COND_RETURN(window == NULL || rect == NULL, 0, CGSTR("Cannot query NULL window or rectangle."));
+    CG_ERROR_COND_RETURN(window->spatial_index == NULL, 0, CGSTR("Cannot query window without a spatial index."));
+    CGSpatialIndex* index = window->spatial_index;
+    CGSpatialIndexHitTest hit_test = {index, rect, CG_TRUE};
+    index->hit_count = 0;
+    CGQuerySpatialIndex(index, rect, CGCollectSpatialIndexHit, &hit_test);
+    if (!hit_test.is_success)
+        return 0;
+    if (results != NULL && max_count != 0)
+    {
+        qsort(index->hits, index->hit_count, sizeof(CGSpatialIndexItem), CGCompareSpatialIndexHit);
+        memcpy(results, index->hits, sizeof(CGSpatialIndexItem) * (index->hit_count < max_count ? index->hit_count : max_count));
+    }
+    return index->hit_count;
+}
+
+unsigned int CGPick(CGWindow* window, CGVector2 point, CGSpatialIndexItem* results, unsigned int max_count)
+{
+    CGAABB rect = {point, point};
+    return CGQueryRect(window, &rect, results, max_count);
+}
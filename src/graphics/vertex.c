@@ -0,0 +1,165 @@
+#include "cos_graphics/vertex.h"
+#include "cos_graphics/log.h"
+#include "cos_graphics/utils.h"
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned short CGQuantizeUnorm16(float value)
+{
+    if (!(value > 0.0f))
+        return 0;
+    if (value >= 1.0f)
+        return CG_UNORM16_MAX;
+    return (unsigned short)(value * (float)CG_UNORM16_MAX + 0.5f);
+}
+
+unsigned int CGQuantizeUnorm32(float value)
+{
+    if (!(value > 0.0f))
+        return 0;
+    if (value >= 1.0f)
+        return CG_UNORM32_MAX;
+    return (unsigned int)((double)value * (double)CG_UNORM32_MAX + 0.5);
+}
+
+float CGDequantizeUnorm16(unsigned short value)
+{
+    return (float)value / (float)CG_UNORM16_MAX;
+}
+
+CGVertexBounds CGConstructVertexBounds(const CGVector2* positions, unsigned int count)
+{
+    CGVertexBounds result = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+    CG_ERROR_COND_RETURN(positions == NULL && count != 0, result, CGSTR("Cannot construct vertex bounds out of NULL positions."));
+    for (unsigned int i = 0; i < count; ++i)
+        CGExpandVertexBounds(&result, positions[i]);
+    return result;
+}
+
+void CGExpandVertexBounds(CGVertexBounds* bounds, CGVector2 position)
+{
+    CG_ERROR_CONDITION(bounds == NULL, CGSTR("Cannot expand NULL vertex bounds."));
+    if (position.x < bounds->min_x)
+        bounds->min_x = position.x;
+    if (position.y < bounds->min_y)
+        bounds->min_y = position.y;
+    if (position.x > bounds->max_x)
+        bounds->max_x = position.x;
+    if (position.y > bounds->max_y)
+        bounds->max_y = position.y;
+}
+
+void CGQuantizePosition(const CGVertexBounds* bounds, CGVector2 position, unsigned short* result)
+{
+    CG_ERROR_CONDITION(bounds == NULL || result == NULL, CGSTR("Cannot quantize position with NULL bounds or result."));
+    float width = bounds->max_x - bounds->min_x;
+    float height = bounds->max_y - bounds->min_y;
+    // a bounds without area maps every position to its minimum
+    result[0] = width > 0.0f ? CGQuantizeUnorm16((position.x - bounds->min_x) / width) : 0;
+    result[1] = height > 0.0f ? CGQuantizeUnorm16((position.y - bounds->min_y) / height) : 0;
+}
+
+CGVector2 CGDequantizePosition(const CGVertexBounds* bounds, const unsigned short* quantized)
+{
+    CG_ERROR_COND_RETURN(bounds == NULL || quantized == NULL, CGConstructVector2(0.0f, 0.0f),
+        CGSTR("Cannot dequantize position with NULL bounds or quantized value."));
+    return CGConstructVector2(
+        bounds->min_x + (bounds->max_x - bounds->min_x) * CGDequantizeUnorm16(quantized[0]),
+        bounds->min_y + (bounds->max_y - bounds->min_y) * CGDequantizeUnorm16(quantized[1]));
+}
+
+CGVertexStream CGConstructVertexStream(void* buffer, unsigned int stride, unsigned int capacity)
+{
+    CGVertexStream result;
+    result.data = buffer;
+    result.stride = stride;
+    result.size = 0;
+    result.capacity = buffer == NULL ? 0 : capacity;
+    result.is_owner = CG_FALSE;
+    return result;
+}
+
+CG_BOOL CGInitVertexStream(CGVertexStream* stream, unsigned int stride, unsigned int initial_capacity)
+{
+    CG_ERROR_COND_RETURN(stream == NULL, CG_FALSE, CGSTR("Cannot initialize NULL vertex stream."));
+    CG_ERROR_COND_RETURN(stride == 0, CG_FALSE, CGSTR("Cannot initialize vertex stream with stride 0."));
+    stream->data = NULL;
+    stream->stride = stride;
+    stream->size = 0;
+    stream->capacity = 0;
+    stream->is_owner = CG_TRUE;
+    if (initial_capacity == 0)
+        return CG_TRUE;
+    stream->data = CGMalloc((size_t)stride * initial_capacity);
+    CG_ERROR_COND_RETURN(stream->data == NULL, CG_FALSE, CGSTR("Failed to allocate memory for vertex stream."));
+    stream->capacity = initial_capacity;
+    return CG_TRUE;
+}
+
+void CGReleaseVertexStream(CGVertexStream* stream)
+{
+    if (stream == NULL)
+        return;
+    if (stream->is_owner)
+        free(stream->data);
+    stream->data = NULL;
+    stream->size = 0;
+    stream->capacity = 0;
+}
+
+void CGResetVertexStream(CGVertexStream* stream)
+{
+    CG_ERROR_CONDITION(stream == NULL, CGSTR("Cannot reset NULL vertex stream."));
+    stream->size = 0;
+}
+
+void* CGReserveVertexStream(CGVertexStream* stream, unsigned int count)
+{
+    CG_ERROR_COND_RETURN(stream == NULL, NULL, CGSTR("Cannot reserve space in NULL vertex stream."));
+    if (stream->size + count > stream->capacity)
+    {
+        CG_ERROR_COND_RETURN(!stream->is_owner, NULL, CGSTR("Vertex stream is full."));
+        unsigned int new_capacity = stream->capacity == 0 ? 64 : stream->capacity;
+        while (new_capacity < stream->size + count)
+            new_capacity *= 2;
+        void* new_data = CGRealloc(stream->data, (size_t)stream->stride * new_capacity);
+        CG_ERROR_COND_RETURN(new_data == NULL, NULL, CGSTR("Failed to allocate memory for vertex stream."));
+        stream->data = new_data;
+        stream->capacity = new_capacity;
+    }
+    void* result = (CGUByte*)stream->data + (size_t)stream->stride * stream->size;
+    stream->size += count;
+    return result;
+}
+
+CG_BOOL CGPushCompactVertex(CGVertexStream* stream, const CGVertexBounds* bounds, CGVector2 position)
+{
+    CGCompactVertex* vertex = (CGCompactVertex*)CGReserveVertexStream(stream, 1);
+    if (vertex == NULL)
+        return CG_FALSE;
+    CGQuantizePosition(bounds, position, vertex->position);
+    return CG_TRUE;
+}
+
+CG_BOOL CGPushCompactImageVertex(CGVertexStream* stream, const CGVertexBounds* bounds, CGVector2 position, CGVector2 tex_coord)
+{
+    CGCompactImageVertex* vertex = (CGCompactImageVertex*)CGReserveVertexStream(stream, 1);
+    if (vertex == NULL)
+        return CG_FALSE;
+    CGQuantizePosition(bounds, position, vertex->position);
+    vertex->tex_coord[0] = CGQuantizeUnorm16(tex_coord.x);
+    vertex->tex_coord[1] = CGQuantizeUnorm16(tex_coord.y);
+    return CG_TRUE;
+}
+
+CG_BOOL CGPushCompactColoredVertex(CGVertexStream* stream, const CGVertexBounds* bounds, CGVector2 position, const CGUByte* color, float depth)
+{
+    CGCompactColoredVertex* vertex = (CGCompactColoredVertex*)CGReserveVertexStream(stream, 1);
+    if (vertex == NULL)
+        return CG_FALSE;
+    CGQuantizePosition(bounds, position, vertex->position);
+    memcpy(vertex->color, color, sizeof(vertex->color));
+    vertex->depth = CGQuantizeUnorm32(depth);
+    return CG_TRUE;
+}
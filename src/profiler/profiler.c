@@ -0,0 +1,226 @@
+#include "cos_graphics/profiler.h"
+#include "cos_graphics/utils.h"
+#include "cos_graphics/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef CG_TG_WIN
+    #include <windows.h>
+    #define CG_THREAD_LOCAL __declspec(thread)
+#else
+    #define CG_THREAD_LOCAL _Thread_local
+#endif
+
+/**
+ * @brief A zone recorded by a thread. The times are in seconds.
+ */
+typedef struct{
+    const char* name;
+    double start_time;
+    double duration;
+}CGProfilerZone;
+
+/**
+ * @brief The zones recorded by a thread. Only the thread writes into its buffer, and it
+ * publishes each zone by increasing the count, so that recording never takes a lock.
+ */
+typedef struct CGProfilerThreadBuffer{
+    CGProfilerZone zones[CG_PROFILER_THREAD_BUFFER_SIZE];
+    volatile unsigned int count;
+    /**
+     * @brief The session that the zones belong to. The buffer is cleared by its thread
+     * the first time it records in a new session.
+     */
+    volatile unsigned int session;
+    unsigned int thread_id;
+    struct CGProfilerThreadBuffer* next;
+}CGProfilerThreadBuffer;
+
+/**
+ * @brief The buffers of all the threads that recorded a zone. The buffers are kept until the
+ * process exits, because the threads may record into them at any time.
+ */
+static CGProfilerThreadBuffer* volatile cg_profiler_buffers = NULL;
+static CG_THREAD_LOCAL CGProfilerThreadBuffer* cg_thread_buffer = NULL;
+static volatile unsigned int cg_profiler_thread_count = 0;
+
+/**
+ * @brief The current session. 0 before the first session.
+ */
+static volatile unsigned int cg_profiler_session = 0;
+static volatile unsigned int cg_is_profiler_session_active = CG_FALSE;
+static volatile unsigned int cg_profiler_dropped_count = 0;
+static double cg_profiler_session_start_time = 0.0;
+
+#ifdef CG_TG_WIN
+static inline unsigned int CGAtomicLoad(volatile unsigned int* value)
+{
+    return (unsigned int)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+}
+
+static inline void CGAtomicStore(volatile unsigned int* value, unsigned int new_value)
+{
+    InterlockedExchange((volatile LONG*)value, (LONG)new_value);
+}
+
+static inline unsigned int CGAtomicIncrement(volatile unsigned int* value)
+{
+    return (unsigned int)InterlockedIncrement((volatile LONG*)value);
+}
+
+static inline void* CGAtomicLoadPointer(void* volatile* target)
+{
+    return InterlockedCompareExchangePointer(target, NULL, NULL);
+}
+
+static inline CG_BOOL CGAtomicCompareExchangePointer(void* volatile* target, void* expected, void* desired)
+{
+    return InterlockedCompareExchangePointer(target, desired, expected) == expected;
+}
+#else
+static inline unsigned int CGAtomicLoad(volatile unsigned int* value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void CGAtomicStore(volatile unsigned int* value, unsigned int new_value)
+{
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+static inline unsigned int CGAtomicIncrement(volatile unsigned int* value)
+{
+    return __atomic_add_fetch(value, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline void* CGAtomicLoadPointer(void* volatile* target)
+{
+    return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+}
+
+static inline CG_BOOL CGAtomicCompareExchangePointer(void* volatile* target, void* expected, void* desired)
+{
+    return __atomic_compare_exchange_n(target, &expected, desired, CG_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#endif
+
+static CGProfilerThreadBuffer* CGGetProfilerThreadBuffer()
+{
+    if (cg_thread_buffer != NULL)
+        return cg_thread_buffer;
+    CGProfilerThreadBuffer* buffer = (CGProfilerThreadBuffer*)calloc(1, sizeof(CGProfilerThreadBuffer));
+    if (buffer == NULL)
+        return NULL;
+    buffer->thread_id = CGAtomicIncrement(&cg_profiler_thread_count);
+    CGProfilerThreadBuffer* head;
+    do {
+        head = (CGProfilerThreadBuffer*)CGAtomicLoadPointer((void* volatile*)&cg_profiler_buffers);
+        buffer->next = head;
+    } while (!CGAtomicCompareExchangePointer((void* volatile*)&cg_profiler_buffers, head, buffer));
+    cg_thread_buffer = buffer;
+    return buffer;
+}
+
+void CGBeginProfilerSession()
+{
+    CGAtomicStore(&cg_is_profiler_session_active, CG_FALSE);
+    cg_profiler_session_start_time = CGGetMonotonicTime();
+    CGAtomicStore(&cg_profiler_dropped_count, 0);
+    CGAtomicIncrement(&cg_profiler_session);
+    CGAtomicStore(&cg_is_profiler_session_active, CG_TRUE);
+}
+
+CG_BOOL CGIsProfilerSessionActive()
+{
+    return (CG_BOOL)CGAtomicLoad(&cg_is_profiler_session_active);
+}
+
+unsigned int CGGetProfilerDroppedCount()
+{
+    return CGAtomicLoad(&cg_profiler_dropped_count);
+}
+
+double CGProfilerBeginZone()
+{
+    if (!CGAtomicLoad(&cg_is_profiler_session_active))
+        return -1.0;
+    return CGGetMonotonicTime();
+}
+
+void CGProfilerEndZone(const char* name, double start_time)
+{
+    if (start_time < 0.0)
+        return;
+    double end_time = CGGetMonotonicTime();
+    if (!CGAtomicLoad(&cg_is_profiler_session_active))
+        return;
+    unsigned int session = CGAtomicLoad(&cg_profiler_session);
+    CGProfilerThreadBuffer* buffer = CGGetProfilerThreadBuffer();
+    if (buffer == NULL)
+    {
+        CGAtomicIncrement(&cg_profiler_dropped_count);
+        return;
+    }
+    if (buffer->session != session)
+    {
+        // the count is cleared first, so that the zones of the last session are never read as this session
+        CGAtomicStore(&buffer->count, 0);
+        CGAtomicStore(&buffer->session, session);
+    }
+    unsigned int count = buffer->count;
+    if (count >= CG_PROFILER_THREAD_BUFFER_SIZE)
+    {
+        CGAtomicIncrement(&cg_profiler_dropped_count);
+        return;
+    }
+    buffer->zones[count].name = name;
+    buffer->zones[count].start_time = start_time;
+    buffer->zones[count].duration = end_time - start_time;
+    CGAtomicStore(&buffer->count, count + 1);
+}
+
+static CG_BOOL CGWriteProfilerTrace(const CGChar* path, unsigned int session)
+{
+    char path_c[512];
+    CGCharToChar(path, path_c, sizeof(path_c));
+    FILE* file = fopen(path_c, "w");
+    CG_ERROR_COND_RETURN(file == NULL, CG_FALSE, CGSTR("Failed to open profiler trace file."));
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    CG_BOOL is_first = CG_TRUE;
+    CGProfilerThreadBuffer* buffers = (CGProfilerThreadBuffer*)CGAtomicLoadPointer((void* volatile*)&cg_profiler_buffers);
+    for (CGProfilerThreadBuffer* buffer = buffers; buffer != NULL; buffer = buffer->next)
+    {
+        if (CGAtomicLoad(&buffer->session) != session)
+            continue;
+        unsigned int count = CGAtomicLoad(&buffer->count);
+        if (count == 0)
+            continue;
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+            is_first ? "" : ",", buffer->thread_id, buffer->thread_id);
+        is_first = CG_FALSE;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const CGProfilerZone* zone = &buffer->zones[i];
+            // zones that started before the session are only partly in it
+            if (zone->start_time < cg_profiler_session_start_time)
+                continue;
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                zone->name, buffer->thread_id,
+                (zone->start_time - cg_profiler_session_start_time) * 1000000.0, zone->duration * 1000000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    CG_BOOL is_success = !ferror(file);
+    is_success = fclose(file) == 0 && is_success;
+    CG_ERROR_COND_RETURN(!is_success, CG_FALSE, CGSTR("Failed to write profiler trace file."));
+    return CG_TRUE;
+}
+
+CG_BOOL CGEndProfilerSession(const CGChar* path)
+{
+    CG_ERROR_COND_RETURN(!CGAtomicLoad(&cg_is_profiler_session_active), CG_FALSE, CGSTR("Cannot end profiler session: No session is started."));
+    CGAtomicStore(&cg_is_profiler_session_active, CG_FALSE);
+    if (path == NULL)
+        return CG_TRUE;
+    return CGWriteProfilerTrace(path, CGAtomicLoad(&cg_profiler_session));
+}
@@ -2,6 +2,7 @@
 #include "cos_graphics/graphics.h"
 #include "cos_graphics/log.h"
 #include "cos_graphics/utils.h"
+#include "cos_graphics/profiler.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -17,7 +18,7 @@
     static void CGGetExecDir(CGChar* buff, unsigned int size)
     {
 #ifdef CG_USE_WCHAR
-        char* temp = (char*)malloc(size * sizeof(char));
+        char* temp = (char*)CGMalloc(size * sizeof(char));
         CG_ERROR_COND_EXIT(temp == NULL, -1, CGSTR("Failed to allocate memory for temp buffer."));
         GetModuleFileName(NULL, temp, size - 1);
         char* p = temp + strlen(temp) - 1;
@@ -40,7 +41,7 @@
     static void CGGetExecDir(CGChar* buff, unsigned int size)
     {
 #ifdef CG_USE_WCHAR
-        char* temp = (char*)malloc(size * sizeof(char));
+        char* temp = (char*)CGMalloc(size * sizeof(char));
         CG_ERROR_COND_EXIT(temp == NULL, -1, CGSTR("Failed to allocate memory for temp buffer."));
         readlink("/proc/self/exe", temp, size - 1);
         char* p = temp + size - 1;
@@ -144,11 +145,11 @@ void CGInitResourceSystem()
     CGChar buff[256];
     CGGetExecDir(buff, 256);
     unsigned int temp_size = sizeof(CGChar) * (CG_STRLEN(buff) + CG_STRLEN(cg_resource_file_name) + 2);
-    cg_resource_file_path = (CGChar*)malloc(temp_size);
+    cg_resource_file_path = (CGChar*)CGMalloc(temp_size);
     CG_ERROR_CONDITION(cg_resource_file_path == NULL, CGSTR("Failed to allocate memory for resource file path."));
     CG_SPRINTF(cg_resource_file_path, temp_size, CGSTR("%s%c%s"), buff, CG_FILE_SPLITTER, cg_resource_file_name);
     temp_size = sizeof(CGChar) * (CG_STRLEN(buff) + CG_STRLEN(cg_resource_finder_name) + 2);
-    cg_resource_finder_path = (CGChar*)malloc(temp_size);
+    cg_resource_finder_path = (CGChar*)CGMalloc(temp_size);
     if (cg_resource_finder_path == NULL)
     {
         free(cg_resource_file_path);
@@ -159,9 +160,9 @@ void CGInitResourceSystem()
     
     mem_res_head = CGCreateLinkedListNode(NULL, CG_MEM_RES_TYPE_HEAD);
     cg_release_queue_head = CGCreateLinkedListNode(NULL, CG_MEM_RES_TYPE_HEAD);
-    cg_texture_res_head = (CGTextureResource*)malloc(sizeof(CGTextureResource));
+    cg_texture_res_head = (CGTextureResource*)CGMalloc(sizeof(CGTextureResource));
     CG_ERROR_CONDITION(cg_texture_res_head == NULL, CGSTR("Failed to allocate memory for texture resource head."));
-    cg_reusable_res_head = (CGReusableResource*)malloc(sizeof(CGReusableResource));
+    cg_reusable_res_head = (CGReusableResource*)CGMalloc(sizeof(CGReusableResource));
     if (cg_reusable_res_head == NULL)
     {
         free(cg_texture_res_head);
@@ -179,15 +180,33 @@ void CGInitResourceSystem()
 }
 
 
+/**
+ * @brief Statistics of the loads since the program started.
+ */
+static CGResourceLoadStats cg_resource_load_stats = {0};
+
+static void CGCountResourceLoad(unsigned long long size, double start_time)
+{
+    ++cg_resource_load_stats.load_count;
+    cg_resource_load_stats.bytes_loaded += size;
+    cg_resource_load_stats.load_time += CGGetMonotonicTime() - start_time;
+}
+
+CGResourceLoadStats CGGetResourceLoadStats()
+{
+    return cg_resource_load_stats;
+}
+
 /// Disk functions ///
 CGByte* CGLoadFile(const CGChar* file_path)
 {
+    double start_time = CGGetMonotonicTime();
     FILE* file = CGFOpen(file_path, "rb");
     CG_ERROR_COND_RETURN(file == NULL, NULL, CGSTR("Failed to open file at path: %s."), file_path);
     fseek(file, 0, SEEK_END);
     unsigned int file_size = ftell(file);
 
-    CGByte* file_data = (CGByte*)malloc((file_size + 1) * sizeof(CGByte) + sizeof(CGChar));
+    CGByte* file_data = (CGByte*)CGMalloc((file_size + 1) * sizeof(CGByte) + sizeof(CGChar));
     if (file_data == NULL)
     {
         fclose(file);
@@ -200,12 +219,13 @@ CGByte* CGLoadFile(const CGChar* file_path)
     // Adding a '\0' at the end of the file data to make sure that text data can be used as string.
     *(CGChar*)(file_data + file_size) = (CGChar)'\0';
     fclose(file);
+    CGCountResourceLoad(file_size, start_time);
     return file_data;
 }
 
 CGImage* CGCreateImage(int width, int height, int channels, CGUByte* data)
 {
-    CGImage* image = (CGImage*)malloc(sizeof(CGImage));
+    CGImage* image = (CGImage*)CGMalloc(sizeof(CGImage));
 
     // this check is required in release mode
     if (image == NULL)
@@ -219,7 +239,7 @@ CGImage* CGCreateImage(int width, int height, int channels, CGUByte* data)
     int image_size = width * height * channels;
     if (data != NULL)
     {
-        image->data = (CGUByte*)malloc(sizeof(CGUByte) * image_size);
+        image->data = (CGUByte*)CGMalloc(sizeof(CGUByte) * image_size);
         if (image->data == NULL)
         {
             free(image);
@@ -233,8 +253,25 @@ CGImage* CGCreateImage(int width, int height, int channels, CGUByte* data)
     return image;
 }
 
+CG_BOOL CGIsImageTransparent(const CGImage* image)
+{
+    CG_ERROR_COND_RETURN(image == NULL, CG_FALSE, CGSTR("Cannot check transparency of a NULL image."));
+    // only gray-alpha and RGBA images have an alpha channel
+    if (image->data == NULL || (image->channels != 2 && image->channels != 4))
+        return CG_FALSE;
+    int pixel_count = image->width * image->height;
+    for (int i = 0; i < pixel_count; ++i)
+    {
+        if (image->data[i * image->channels + image->channels - 1] != 255)
+            return CG_TRUE;
+    }
+    return CG_FALSE;
+}
+
 CGImage* CGLoadImage(const CGChar* file_path)
 {
+    CG_PROFILE_BEGIN(LoadImage);
+    double start_time = CGGetMonotonicTime();
     CGImage* image = CGCreateImage(0, 0, 0, NULL);
 #ifdef CG_USE_WCHAR
     {
@@ -250,6 +287,8 @@ CGImage* CGLoadImage(const CGChar* file_path)
         free(image);
         CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to load image from path: %s"), file_path);
     }
+    CGCountResourceLoad((unsigned long long)image->width * image->height * image->channels, start_time);
+    CG_PROFILE_END(LoadImage);
     return image;
 }
 
@@ -297,7 +336,7 @@ void CGSetFloatArrayValue(unsigned int count, float* array, ...)
 
 CGMemRes* CGCreateMemRes(void* data, void (*deleter)(void*))
 {
-    CGMemRes* mem_res = (CGMemRes*)malloc(sizeof(CGMemRes));
+    CGMemRes* mem_res = (CGMemRes*)CGMalloc(sizeof(CGMemRes));
     CG_ERROR_COND_RETURN(mem_res == NULL, NULL, CGSTR("Failed to allocate memory for memory resource."));
     mem_res->data = data;
     mem_res->deleter = deleter;
@@ -427,6 +466,8 @@ void CGResourceSystemUpdate()
 CGByte* CGLoadResource(const CGChar* resource_key, int* size, CGChar* type)
 {
     CG_PRINT_VERBOSE(CGSTR("Loading resource with key: %s"), resource_key);
+    CG_PROFILE_BEGIN(LoadResource);
+    double start_time = CGGetMonotonicTime();
     CG_ERROR_COND_RETURN(mem_res_head == NULL, NULL, CGSTR("Memory resource system not initialized."));
     FILE* file = CGFOpen(cg_resource_finder_path, "rb");
     CG_ERROR_COND_EXIT(file == NULL, -1, CGSTR("Failed to open resource finder file at path: %s."), cg_resource_finder_path);
@@ -467,12 +508,14 @@ CGByte* CGLoadResource(const CGChar* resource_key, int* size, CGChar* type)
             file = CGFOpen(cg_resource_file_path, "rb");
             CG_ERROR_COND_EXIT(file == NULL, -1, CGSTR("Failed to open resource file."));
             fseek(file, data_location, SEEK_SET);
-            CGByte* data = (CGByte*)malloc((data_size + 1) * sizeof(CGByte));
+            CGByte* data = (CGByte*)CGMalloc((data_size + 1) * sizeof(CGByte));
             CG_ERROR_COND_EXIT(data == NULL, -1, CGSTR("Failed to allocate memory for resource data."));
             CGFRead(data, sizeof(CGByte), data_size, file);
             data[data_size] = '\0';
             fclose(file);
             CG_PRINT_VERBOSE(CGSTR("Resource with key: %s is successfully loaded."), resource_key);
+            CGCountResourceLoad(data_size, start_time);
+            CG_PROFILE_END(LoadResource);
             return data;
         }
         fseek(file, 2 * sizeof(unsigned int), SEEK_CUR);
@@ -515,9 +558,9 @@ void CGRegisterTextureResource(const CGChar* key, unsigned int texture_id)
             }
         }
     }
-    CGTextureResource* result = (CGTextureResource*)malloc(sizeof(CGTextureResource));
+    CGTextureResource* result = (CGTextureResource*)CGMalloc(sizeof(CGTextureResource));
     CG_ERROR_CONDITION(result == NULL, CGSTR("Failed to allocate memory for texture resource."));
-    result->key = (CGChar*)malloc(sizeof(CGChar) * (CG_STRLEN(key) + 1));
+    result->key = (CGChar*)CGMalloc(sizeof(CGChar) * (CG_STRLEN(key) + 1));
     if (result->key == NULL)
     {
         free(result);
@@ -545,7 +588,7 @@ unsigned int CGGetTextureResource(const CGChar* file_rk)
         }
     }
 
-    CGTextureResource* result = (CGTextureResource*)malloc(sizeof(CGTextureResource));
+    CGTextureResource* result = (CGTextureResource*)CGMalloc(sizeof(CGTextureResource));
     CG_ERROR_COND_RETURN(result == NULL, 0, CGSTR("Failed to allocate memory for texture resource."));
     CGImage* temp_image = CGLoadImageFromResource(file_rk);
     if (temp_image == NULL)
@@ -553,7 +596,7 @@ unsigned int CGGetTextureResource(const CGChar* file_rk)
         free(result);
         CG_ERROR_COND_RETURN(CG_TRUE, 0, CGSTR("Failed to load image."));
     }
-    result->key = (CGChar*)malloc(sizeof(CGChar) * (CG_STRLEN(file_rk) + 1));
+    result->key = (CGChar*)CGMalloc(sizeof(CGChar) * (CG_STRLEN(file_rk) + 1));
     if (result->key == NULL)
     {
         free(result);
@@ -642,9 +685,9 @@ CGUByte* CGLoadReusableResource(const CGChar* key, void (*deleter)(void*), unsig
             return p->next->data;
         }
     }
-    CGReusableResource* resource = (CGReusableResource*)malloc(sizeof(CGReusableResource));
+    CGReusableResource* resource = (CGReusableResource*)CGMalloc(sizeof(CGReusableResource));
     CG_ERROR_COND_RETURN(resource == NULL, NULL, CGSTR("Failed to allocate memory for reusable resource."));
-    resource->key = (CGChar*)malloc(sizeof(CGChar) * (CG_STRLEN(key) + 1));
+    resource->key = (CGChar*)CGMalloc(sizeof(CGChar) * (CG_STRLEN(key) + 1));
     if (resource->key == NULL)
     {
         free(resource);
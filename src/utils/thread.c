@@ -0,0 +1,232 @@
+#include "cos_graphics/thread.h"
+#include "cos_graphics/log.h"
+#include <stdlib.h>
+
+#ifdef CG_TG_WIN
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #include <time.h>
+    #include <errno.h>
+#endif
+
+#if defined(CG_TG_WIN) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+    #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+struct CGThread{
+#ifdef CG_TG_WIN
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    CGThreadFunction function;
+    void* user_data;
+};
+
+struct CGMutex{
+#ifdef CG_TG_WIN
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+};
+
+struct CGCondition{
+#ifdef CG_TG_WIN
+    CONDITION_VARIABLE condition;
+#else
+    pthread_cond_t condition;
+#endif
+};
+
+#ifdef CG_TG_WIN
+    static DWORD WINAPI CGThreadEntry(LPVOID parameter)
+    {
+        CGThread* thread = (CGThread*)parameter;
+        thread->function(thread->user_data);
+        return 0;
+    }
+#else
+    static void* CGThreadEntry(void* parameter)
+    {
+        CGThread* thread = (CGThread*)parameter;
+        thread->function(thread->user_data);
+        return NULL;
+    }
+#endif
+
+CGThread* CGCreateThread(CGThreadFunction function, void* user_data)
+{
+    CG_ERROR_COND_RETURN(function == NULL, NULL, CGSTR("Failed to create thread: Function cannot be NULL."));
+    CGThread* thread = (CGThread*)malloc(sizeof(CGThread));
+    CG_ERROR_COND_RETURN(thread == NULL, NULL, CGSTR("Failed to allocate memory for thread."));
+    thread->function = function;
+    thread->user_data = user_data;
+#ifdef CG_TG_WIN
+    thread->handle = CreateThread(NULL, 0, CGThreadEntry, thread, 0, NULL);
+    CG_BOOL is_success = thread->handle != NULL;
+#else
+    CG_BOOL is_success = pthread_create(&thread->handle, NULL, CGThreadEntry, thread) == 0;
+#endif
+    if (!is_success)
+    {
+        free(thread);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to create thread."));
+    }
+    return thread;
+}
+
+void CGJoinThread(CGThread* thread)
+{
+    CG_ERROR_CONDITION(thread == NULL, CGSTR("Cannot join NULL thread."));
+#ifdef CG_TG_WIN
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    free(thread);
+}
+
+unsigned int CGGetProcessorCount()
+{
+#ifdef CG_TG_WIN
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+#endif
+}
+
+void CGSleepThread(double seconds)
+{
+    if (seconds <= 0.0)
+        return;
+#ifdef CG_TG_WIN
+    // Sleep is only as precise as the system timer (15.6 ms by default), so a high resolution
+    // waitable timer is used when the system supports it
+    HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (timer == NULL)
+    {
+        Sleep((DWORD)(seconds * 1000.0));
+        return;
+    }
+    LARGE_INTEGER due_time;
+    // negative for a time relative to now, in units of 100 nanoseconds
+    due_time.QuadPart = -(LONGLONG)(seconds * 10000000.0);
+    SetWaitableTimer(timer, &due_time, 0, NULL, NULL, FALSE);
+    WaitForSingleObject(timer, INFINITE);
+    CloseHandle(timer);
+#else
+    struct timespec duration;
+    duration.tv_sec = (time_t)seconds;
+    duration.tv_nsec = (long)((seconds - (double)duration.tv_sec) * 1000000000.0);
+    #ifdef CG_TG_LINUX
+        // the monotonic clock is not changed when the system time is set
+        while (clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, &duration) == EINTR);
+    #else
+        while (nanosleep(&duration, &duration) == -1 && errno == EINTR);
+    #endif
+#endif
+}
+
+CGMutex* CGCreateMutex()
+{
+    CGMutex* mutex = (CGMutex*)malloc(sizeof(CGMutex));
+    CG_ERROR_COND_RETURN(mutex == NULL, NULL, CGSTR("Failed to allocate memory for mutex."));
+#ifdef CG_TG_WIN
+    InitializeSRWLock(&mutex->lock);
+#else
+    if (pthread_mutex_init(&mutex->lock, NULL) != 0)
+    {
+        free(mutex);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to create mutex."));
+    }
+#endif
+    return mutex;
+}
+
+void CGDeleteMutex(CGMutex* mutex)
+{
+    if (mutex == NULL)
+        return;
+#ifndef CG_TG_WIN
+    pthread_mutex_destroy(&mutex->lock);
+#endif
+    free(mutex);
+}
+
+void CGLockMutex(CGMutex* mutex)
+{
+#ifdef CG_TG_WIN
+    AcquireSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+void CGUnlockMutex(CGMutex* mutex)
+{
+#ifdef CG_TG_WIN
+    ReleaseSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+CGCondition* CGCreateCondition()
+{
+    CGCondition* condition = (CGCondition*)malloc(sizeof(CGCondition));
+    CG_ERROR_COND_RETURN(condition == NULL, NULL, CGSTR("Failed to allocate memory for condition variable."));
+#ifdef CG_TG_WIN
+    InitializeConditionVariable(&condition->condition);
+#else
+    if (pthread_cond_init(&condition->condition, NULL) != 0)
+    {
+        free(condition);
+        CG_ERROR_COND_RETURN(CG_TRUE, NULL, CGSTR("Failed to create condition variable."));
+    }
+#endif
+    return condition;
+}
+
+void CGDeleteCondition(CGCondition* condition)
+{
+    if (condition == NULL)
+        return;
+#ifndef CG_TG_WIN
+    pthread_cond_destroy(&condition->condition);
+#endif
+    free(condition);
+}
+
+void CGWaitCondition(CGCondition* condition, CGMutex* mutex)
+{
+#ifdef CG_TG_WIN
+    SleepConditionVariableSRW(&condition->condition, &mutex->lock, INFINITE, 0);
+#else
+    pthread_cond_wait(&condition->condition, &mutex->lock);
+#endif
+}
+
+void CGSignalCondition(CGCondition* condition)
+{
+#ifdef CG_TG_WIN
+    WakeConditionVariable(&condition->condition);
+#else
+    pthread_cond_signal(&condition->condition);
+#endif
+}
+
+void CGBroadcastCondition(CGCondition* condition)
+{
+#ifdef CG_TG_WIN
+    WakeAllConditionVariable(&condition->condition);
+#else
+    pthread_cond_broadcast(&condition->condition);
+#endif
+}
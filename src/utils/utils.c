@@ -1,6 +1,17 @@
 #include "cos_graphics/utils.h"
 #include "cos_graphics/log.h"
 #include <string.h>
+#include <stdlib.h>
+#ifdef CG_TG_WIN
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+/**
+ * @brief The count of allocations done by the library.
+ */
+static unsigned long long cg_allocation_count = 0;
 
 void CGCharToChar(const CGChar* str, char* buffer, unsigned int buffer_size)
 {
@@ -24,4 +35,43 @@ void CharToCGChar(const char* str, CGChar* buffer, unsigned int buffer_size)
     for (; str[i] != '\0' && i < buffer_size; ++i)
         buffer[i] = (CGChar)str[i];
     buffer[i] = (CGChar)'\0';
+}
+
+void* CGMalloc(size_t size)
+{
+    ++cg_allocation_count;
+    return malloc(size);
+}
+
+void* CGCalloc(size_t count, size_t size)
+{
+    ++cg_allocation_count;
+    return calloc(count, size);
+}
+
+void* CGRealloc(void* data, size_t size)
+{
+    ++cg_allocation_count;
+    return realloc(data, size);
+}
+
+unsigned long long CGGetAllocationCount()
+{
+    return cg_allocation_count;
+}
+
+double CGGetMonotonicTime()
+{
+#ifdef CG_TG_WIN
+    static LARGE_INTEGER frequency = {0};
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1000000000.0;
+#endif
 }
\ No newline at end of file
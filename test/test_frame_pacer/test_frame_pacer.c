@@ -0,0 +1,66 @@
+#include "test_frame_pacer.h"
+#include "cos_graphics/frame_pacer.h"
+#include "cos_graphics/resource.h"
+#include "cos_graphics/graphics.h"
+#include "../unit_test/unit_test.h"
+
+void CGTestFramePacer1()
+{
+    // without a target the frames are only measured
+    CGFramePacer* pacer = CGCreateFramePacer(0.0);
+    CGT_EXPECT_NOT_NULL(pacer);
+    for (int i = 0; i < 3; ++i)
+        CGPaceFrame(pacer);
+    CGFrameTiming timing = CGGetFrameTiming(pacer);
+    CGT_EXPECT_INT_EQUAL(timing.frame_count, 2);
+    CGT_EXPECT_INT_EQUAL(timing.missed_count, 0);
+    CGT_EXPECT_REAL_EQUAL(timing.wait_time, 0.0, 0.001);
+    CGFree(pacer);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestFramePacer2()
+{
+    CGFramePacer* pacer = CGCreateFramePacer(200.0);
+    for (int i = 0; i < 11; ++i)
+        CGPaceFrame(pacer);
+    CGFrameTiming timing = CGGetFrameTiming(pacer);
+    CGT_EXPECT_INT_EQUAL(timing.frame_count, 10);
+    // the frames never end before their deadline
+    CGT_EXPECT_INT_EQUAL(timing.min_frame_time >= 0.005 - 0.0001, CG_TRUE);
+    CGT_EXPECT_REAL_EQUAL(timing.average_frame_time, 0.005, 0.001);
+    CGFree(pacer);
+    CGT_EXPECT_NO_ERROR();
+}
+
+static double CGTestGetTime(void* user_data)
+{
+    return *(double*)user_data;
+}
+
+void CGTestFramePacer3()
+{
+    CGSetFixedStepTimeSource(10.0, 0.5);
+    CGT_EXPECT_INT_EQUAL(CGGetTimeSource(), CG_TIME_SOURCE_FIXED_STEP);
+    CGT_EXPECT_REAL_EQUAL(CGGetCurrentTime(), 10.0, 0.0001);
+    // the pacer doesn't wait for a simulated time, so the frames take the step instead of a second
+    CGFramePacer* pacer = CGCreateFramePacer(1.0);
+    for (int i = 0; i < 3; ++i)
+    {
+        CGPaceFrame(pacer);
+        CGTickRenderEnd();
+    }
+    CGFrameTiming timing = CGGetFrameTiming(pacer);
+    CGT_EXPECT_INT_EQUAL(timing.frame_count, 2);
+    CGT_EXPECT_INT_EQUAL(timing.missed_count, 0);
+    CGT_EXPECT_REAL_EQUAL(timing.frame_time, 0.5, 0.0001);
+    CGT_EXPECT_REAL_EQUAL(CGGetCurrentTime(), 11.5, 0.0001);
+    CGFree(pacer);
+
+    double time = 3.0;
+    CGSetTimeSourceCallback(CGTestGetTime, &time);
+    CGT_EXPECT_REAL_EQUAL(CGGetCurrentTime(), 3.0, 0.0001);
+    CGSetRealTimeSource();
+    CGT_EXPECT_INT_EQUAL(CGGetTimeSource(), CG_TIME_SOURCE_REAL);
+    CGT_EXPECT_NO_ERROR();
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef _CGT_FRAME_PACER_H_
+#define _CGT_FRAME_PACER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void CGTestFramePacer1();
+void CGTestFramePacer2();
+void CGTestFramePacer3();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "test_glyph_atlas.h"
+#include "cos_graphics/glyph_atlas.h"
+#include "cos_graphics/resource.h"
+#include "../unit_test/unit_test.h"
+
+static CGGlyphKey CGTestConstructGlyphKey(unsigned int codepoint, unsigned int pixel_size)
+{
+    CGGlyphKey key = {1, pixel_size, pixel_size, codepoint};
+    return key;
+}
+
+void CGTestGlyphAtlas1()
+{
+    CGGlyphAtlas* atlas = CGCreateGlyphAtlas(64, 1);
+    CGT_EXPECT_NOT_NULL(atlas);
+    CGGlyphKey key = CGTestConstructGlyphKey('a', 16);
+    CGT_EXPECT_INT_EQUAL((CGFindAtlasGlyph(atlas, &key) == NULL), CG_TRUE);
+    const CGAtlasGlyph* glyph = CGAddAtlasGlyph(atlas, &key, 10, 12, 1, 11, NULL);
+    CGT_EXPECT_NOT_NULL(glyph);
+    CGT_EXPECT_INT_EQUAL(glyph->page, 0);
+    CGT_EXPECT_INT_EQUAL(glyph->x, CG_GLYPH_ATLAS_PADDING);
+    CGT_EXPECT_INT_EQUAL(glyph->y, CG_GLYPH_ATLAS_PADDING);
+    CGT_EXPECT_INT_EQUAL(CGGetGlyphAtlasPageCount(atlas), 1);
+
+    // the same character in another size is another glyph
+    CGGlyphKey other_size_key = CGTestConstructGlyphKey('a', 20);
+    CGT_EXPECT_INT_EQUAL((CGFindAtlasGlyph(atlas, &other_size_key) == NULL), CG_TRUE);
+    const CGAtlasGlyph* other_glyph = CGAddAtlasGlyph(atlas, &other_size_key, 12, 10, 1, 9, NULL);
+    CGT_EXPECT_NOT_NULL(other_glyph);
+    // put on the right of the first glyph, in the same shelf
+    CGT_EXPECT_INT_EQUAL(other_glyph->x, 10 + 3 * CG_GLYPH_ATLAS_PADDING);
+
+    glyph = CGFindAtlasGlyph(atlas, &key);
+    CGT_EXPECT_NOT_NULL(glyph);
+    CGT_EXPECT_INT_EQUAL(glyph->width, 10);
+    CGT_EXPECT_INT_EQUAL(glyph->height, 12);
+    CGT_EXPECT_INT_EQUAL(glyph->top, 11);
+    CGT_EXPECT_INT_EQUAL(CGGetGlyphAtlasGlyphCount(atlas), 2);
+    CGFree(atlas);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestGlyphAtlas2()
+{
+    CGGlyphAtlas* atlas = CGCreateGlyphAtlas(16, 1);
+    // glyphs without pixels don't take space
+    CGGlyphKey empty_key = CGTestConstructGlyphKey('\t', 16);
+    const CGAtlasGlyph* glyph = CGAddAtlasGlyph(atlas, &empty_key, 0, 0, 0, 0, NULL);
+    CGT_EXPECT_NOT_NULL(glyph);
+    CGT_EXPECT_INT_EQUAL(glyph->page, CG_GLYPH_ATLAS_NO_PAGE);
+    CGT_EXPECT_INT_EQUAL(CGGetGlyphAtlasPageCount(atlas), 0);
+    // glyphs larger than a page are not added
+    CGGlyphKey large_key = CGTestConstructGlyphKey('W', 16);
+    CGT_EXPECT_INT_EQUAL((CGAddAtlasGlyph(atlas, &large_key, 15, 15, 0, 15, NULL) == NULL), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL((CGFindAtlasGlyph(atlas, &large_key) == NULL), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGGetGlyphAtlasGlyphCount(atlas), 1);
+    CGFree(atlas);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestGlyphAtlasEviction1()
+{
+    // every page fits 4 glyphs of 6 * 6 pixels
+    CGGlyphAtlas* atlas = CGCreateGlyphAtlas(16, 2);
+    unsigned int evicted_page = 0;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        CGGlyphKey key = CGTestConstructGlyphKey(i, 6);
+        const CGAtlasGlyph* glyph = CGAddAtlasGlyph(atlas, &key, 6, 6, 0, 6, &evicted_page);
+        CGT_EXPECT_NOT_NULL(glyph);
+        CGT_EXPECT_INT_EQUAL(glyph->page, i / 4);
+        CGT_EXPECT_INT_EQUAL(evicted_page, CG_GLYPH_ATLAS_NO_PAGE);
+    }
+    CGT_EXPECT_INT_EQUAL(CGGetGlyphAtlasPageCount(atlas), 2);
+
+    // page 0 is used after page 1, so page 1 is cleared for the next glyph
+    CGGlyphKey used_key = CGTestConstructGlyphKey(0, 6);
+    CGT_EXPECT_NOT_NULL(CGFindAtlasGlyph(atlas, &used_key));
+    CGGlyphKey new_key = CGTestConstructGlyphKey(8, 6);
+    const CGAtlasGlyph* glyph = CGAddAtlasGlyph(atlas, &new_key, 6, 6, 0, 6, &evicted_page);
+    CGT_EXPECT_NOT_NULL(glyph);
+    CGT_EXPECT_INT_EQUAL(evicted_page, 1);
+    CGT_EXPECT_INT_EQUAL(glyph->page, 1);
+    CGT_EXPECT_INT_EQUAL(CGGetGlyphAtlasGlyphCount(atlas), 5);
+    CGT_EXPECT_NOT_NULL(CGFindAtlasGlyph(atlas, &used_key));
+    CGGlyphKey evicted_key = CGTestConstructGlyphKey(5, 6);
+    CGT_EXPECT_INT_EQUAL((CGFindAtlasGlyph(atlas, &evicted_key) == NULL), CG_TRUE);
+    CGFree(atlas);
+    CGT_EXPECT_NO_ERROR();
+}
@@ -0,0 +1,17 @@
+#ifndef _CGT_GLYPH_ATLAS_H_
+#define _CGT_GLYPH_ATLAS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void CGTestGlyphAtlas1();
+void CGTestGlyphAtlas2();
+
+void CGTestGlyphAtlasEviction1();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,13 @@
 #include "test_graphics.h"
 #include "cos_graphics/graphics.h"
+#include "cos_graphics/spatial_index.h"
+#include "cos_graphics/gpu_profiler.h"
+#include "cos_graphics/command_recorder.h"
+#include "cos_graphics/frame_capture.h"
+#include "cos_graphics/frame_encoder.h"
 #include "../unit_test/unit_test.h"
+#include <stdio.h>
+#include <string.h>
 
 CGWindow* window;
 
@@ -98,6 +105,984 @@ void CGGraphicsTestCGVector2Sub3()
     CGT_EXPECT_NO_ERROR();
 }
 
+void CGTestGetRenderObjectBounds1()
+{
+    CGQuadrangle quadrangle = CGConstructQuadrangle(
+        CGConstructVector2(0.0f, 0.0f), CGConstructVector2(2.0f, 0.0f),
+        CGConstructVector2(2.0f, 1.0f), CGConstructVector2(0.0f, 1.0f));
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(10.0f, 5.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    CGAABB bounds;
+    CGT_EXPECT_INT_EQUAL(CGGetRenderObjectBounds(&quadrangle, CG_RD_TYPE_QUADRANGLE, property, &bounds), CG_TRUE);
+    CGT_EXPECT_REAL_EQUAL(bounds.min.x, 10.0f, 0.0001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.min.y, 5.0f, 0.0001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.max.x, 12.0f, 0.0001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.max.y, 6.0f, 0.0001f);
+    CGFree(property);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestGetRenderObjectBounds2()
+{
+    CGQuadrangle quadrangle = CGConstructQuadrangle(
+        CGConstructVector2(-2.0f, -1.0f), CGConstructVector2(2.0f, -1.0f),
+        CGConstructVector2(2.0f, 1.0f), CGConstructVector2(-2.0f, 1.0f));
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 3.14159265f / 2.0f);
+    CGAABB bounds;
+    CGT_EXPECT_INT_EQUAL(CGGetRenderObjectBounds(&quadrangle, CG_RD_TYPE_QUADRANGLE, property, &bounds), CG_TRUE);
+    CGT_EXPECT_REAL_EQUAL(bounds.min.x, -1.0f, 0.001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.min.y, -2.0f, 0.001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.max.x, 1.0f, 0.001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.max.y, 2.0f, 0.001f);
+    CGFree(property);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestIsAABBOverlapping1()
+{
+    CGAABB aabb_1 = { { 0.0f, 0.0f }, { 2.0f, 2.0f } };
+    CGAABB aabb_2 = { { 1.0f, 1.0f }, { 3.0f, 3.0f } };
+    CGAABB aabb_3 = { { 2.5f, -1.0f }, { 4.0f, 0.5f } };
+    CGT_EXPECT_INT_EQUAL(CGIsAABBOverlapping(&aabb_1, &aabb_2), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGIsAABBOverlapping(&aabb_1, &aabb_3), CG_FALSE);
+    CGT_EXPECT_INT_EQUAL(CGIsAABBOverlapping(&aabb_2, &aabb_3), CG_FALSE);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestIsRenderObjectOverlappingRect1()
+{
+    CGVector2 vertices[3] = { { 0.0f, 0.0f }, { 4.0f, 0.0f }, { 0.0f, 4.0f } };
+    CGTriangle triangle = CGConstructTriangle(vertices[0], vertices[1], vertices[2]);
+    CGAABB inside = { { 1.0f, 1.0f }, { 1.0f, 1.0f } };
+    // inside the bounding box of the triangle, but not inside the triangle
+    CGAABB outside = { { 3.0f, 3.0f }, { 3.5f, 3.5f } };
+    CGAABB crossing = { { 1.5f, 1.5f }, { 3.0f, 3.0f } };
+    CGT_EXPECT_INT_EQUAL(CGIsRenderObjectOverlappingRect(&triangle, CG_RD_TYPE_TRIANGLE, NULL, &inside), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGIsRenderObjectOverlappingRect(&triangle, CG_RD_TYPE_TRIANGLE, NULL, &outside), CG_FALSE);
+    CGT_EXPECT_INT_EQUAL(CGIsRenderObjectOverlappingRect(&triangle, CG_RD_TYPE_TRIANGLE, NULL, &crossing), CG_TRUE);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestPick1()
+{
+    CGSpatialIndex* index = CGCreateSpatialIndex(CG_SPATIAL_INDEX_DEFAULT_CELL_SIZE);
+    CGQuadrangle quadrangle = CGConstructQuadrangle(
+        CGConstructVector2(-10.0f, -10.0f), CGConstructVector2(10.0f, -10.0f),
+        CGConstructVector2(10.0f, 10.0f), CGConstructVector2(-10.0f, 10.0f));
+    CGRenderObjectProperty* back_property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    CGRenderObjectProperty* front_property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(5.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    back_property->z = 1.0f;
+    unsigned int back_id = CGAddSpatialIndexItem(index, &quadrangle, CG_RD_TYPE_QUADRANGLE, back_property);
+    unsigned int front_id = CGAddSpatialIndexItem(index, &quadrangle, CG_RD_TYPE_QUADRANGLE, front_property);
+    CGSetWindowSpatialIndex(window, index);
+
+    CGSpatialIndexItem results[2];
+    CGT_EXPECT_INT_EQUAL(CGPick(window, CGConstructVector2(0.0f, 0.0f), results, 2), 2);
+    CGT_EXPECT_INT_EQUAL(results[0].id, front_id);
+    CGT_EXPECT_INT_EQUAL(results[1].id, back_id);
+    CGT_EXPECT_INT_EQUAL(CGPick(window, CGConstructVector2(-8.0f, 0.0f), results, 2), 1);
+    CGT_EXPECT_INT_EQUAL(results[0].id, back_id);
+    CGT_EXPECT_INT_EQUAL(CGPick(window, CGConstructVector2(50.0f, 50.0f), results, 2), 0);
+
+    CGSetWindowSpatialIndex(window, NULL);
+    CGFree(back_property);
+    CGFree(front_property);
+    CGFree(index);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestRenderLayer1()
+{
+    CGRenderLayer* layer = CGCreateRenderLayer(64, 32, window);
+    CGT_EXPECT_NOT_NULL(layer);
+    CGT_EXPECT_INT_EQUAL(layer->visual_image.img_width, 64);
+    CGT_EXPECT_INT_EQUAL(layer->visual_image.img_height, 32);
+    CGT_EXPECT_INT_EQUAL(CGIsRenderLayerValid(layer), CG_FALSE);
+
+    CGQuadrangle outside = CGConstructQuadrangle(
+        CGConstructVector2(-10.0f, -10.0f), CGConstructVector2(10.0f, -10.0f),
+        CGConstructVector2(10.0f, 10.0f), CGConstructVector2(-10.0f, 10.0f));
+    CGDrawQuadrangle(&outside, NULL, window);
+    CGT_EXPECT_INT_EQUAL(CGBeginRenderLayer(layer), CG_TRUE);
+    // the objects drawn before the layer are set aside until it ends
+    CGT_EXPECT_INT_EQUAL(window->render_list_count, 0);
+    CGT_EXPECT_INT_EQUAL(CGBeginRenderLayer(layer), CG_FALSE);
+    CGResetError();
+    CGTriangle triangle = CGConstructTriangle(
+        CGConstructVector2(-8.0f, -8.0f), CGConstructVector2(8.0f, -8.0f), CGConstructVector2(0.0f, 8.0f));
+    CGDrawTriangle(&triangle, NULL, window);
+    CGEndRenderLayer(layer);
+    CGT_EXPECT_INT_EQUAL(window->render_list_count, 1);
+    CGT_EXPECT_INT_EQUAL(CGIsRenderLayerValid(layer), CG_TRUE);
+    CGWindowDraw(window);
+
+    CGInvalidateRenderLayer(layer);
+    CGT_EXPECT_INT_EQUAL(CGIsRenderLayerValid(layer), CG_FALSE);
+    CGFree(layer);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestPartialRedraw1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    sub_property.partial_redraw = CG_TRUE;
+    CGWindow* redraw_window = CGCreateWindow(64, 64, CGSTR("Partial Redraw"), sub_property);
+    CGT_EXPECT_NOT_NULL(redraw_window);
+    CGQuadrangle quadrangle = CGConstructQuadrangle(
+        CGConstructVector2(-4.0f, -4.0f), CGConstructVector2(4.0f, -4.0f),
+        CGConstructVector2(4.0f, 4.0f), CGConstructVector2(-4.0f, 4.0f));
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(-16.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    CGUByte left[4], right[4];
+
+    CGTickRenderStart(redraw_window);
+    CGDrawQuadrangle(&quadrangle, property, redraw_window);
+    CGWindowDraw(redraw_window);
+    CGReadPixels(redraw_window, 16, 32, 1, 1, left);
+    CGReadPixels(redraw_window, 48, 32, 1, 1, right);
+    CGT_EXPECT_INT_EQUAL(left[0], 255);
+    CGT_EXPECT_INT_NOT_EQUAL(right[0], 255);
+
+    // the quadrangle is kept from the last frame
+    CGTickRenderStart(redraw_window);
+    CGDrawQuadrangle(&quadrangle, property, redraw_window);
+    CGWindowDraw(redraw_window);
+    CGReadPixels(redraw_window, 16, 32, 1, 1, left);
+    CGT_EXPECT_INT_EQUAL(left[0], 255);
+
+    // both where it was and where it is are redrawn
+    property->transform = CGConstructVector2(16.0f, 0.0f);
+    CGTickRenderStart(redraw_window);
+    CGDrawQuadrangle(&quadrangle, property, redraw_window);
+    CGWindowDraw(redraw_window);
+    CGReadPixels(redraw_window, 16, 32, 1, 1, left);
+    CGReadPixels(redraw_window, 48, 32, 1, 1, right);
+    CGT_EXPECT_INT_NOT_EQUAL(left[0], 255);
+    CGT_EXPECT_INT_EQUAL(right[0], 255);
+
+    CGFree(property);
+    CGFree(redraw_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestIdleMode1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    sub_property.idle_mode = CG_TRUE;
+    CGWindow* idle_window = CGCreateWindow(64, 64, CGSTR("Idle"), sub_property);
+    CGT_EXPECT_NOT_NULL(idle_window);
+    // don't wait for events that never come to a headless window
+    CGSetWindowIdleTimeout(idle_window, 0.0);
+    CGTriangle triangle = CGConstructTriangle(
+        CGConstructVector2(-8.0f, -8.0f), CGConstructVector2(8.0f, -8.0f), CGConstructVector2(0.0f, 8.0f));
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    CG_BOOL is_idle[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i == 2)
+            property->transform = CGConstructVector2(4.0f, 0.0f);
+        if (i == 3)
+            CGRequestWindowRedraw(idle_window);
+        CGTickRenderStart(idle_window);
+        CGDrawTriangle(&triangle, property, idle_window);
+        CGWindowDraw(idle_window);
+        is_idle[i] = CGIsWindowIdle(idle_window);
+    }
+    CGT_EXPECT_INT_EQUAL(is_idle[0], CG_FALSE);
+    CGT_EXPECT_INT_EQUAL(is_idle[1], CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(is_idle[2], CG_FALSE);
+    CGT_EXPECT_INT_EQUAL(is_idle[3], CG_FALSE);
+
+    CGFree(property);
+    CGFree(idle_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestGPUProfiler1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* profiled_window = CGCreateWindow(64, 64, CGSTR("GPU Profiler"), sub_property);
+    CGT_EXPECT_NOT_NULL(profiled_window);
+    CGGPUProfiler* profiler = CGCreateGPUProfiler(profiled_window);
+    CGT_EXPECT_NOT_NULL(profiler);
+    CGCreateGPUProfiler(profiled_window);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGTriangle triangle = CGConstructTriangle(
+        CGConstructVector2(-8.0f, -8.0f), CGConstructVector2(8.0f, -8.0f), CGConstructVector2(0.0f, 8.0f));
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    const unsigned int frame_count = CG_GPU_PROFILER_FRAME_LATENCY * 2;
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        CGTickRenderStart(profiled_window);
+        CGDrawTriangle(&triangle, property, profiled_window);
+        CGWindowDraw(profiled_window);
+    }
+    // every frame older than the latency is either measured or dropped
+    CGGPUZoneStats stats = CGGetGPUZoneStats(profiler, CG_GPU_ZONE_FRAME);
+    CGT_EXPECT_INT_EQUAL(stats.sample_count + CGGetGPUProfilerDroppedCount(profiler), frame_count - CG_GPU_PROFILER_FRAME_LATENCY);
+    CGT_EXPECT_NO_ERROR();
+
+    CGFree(property);
+    CGFree(profiled_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestFrameStats1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* stats_window = CGCreateWindow(64, 64, CGSTR("Frame Stats"), sub_property);
+    CGT_EXPECT_NOT_NULL(stats_window);
+    CGTriangle triangle = CGConstructTriangle(
+        CGConstructVector2(-8.0f, -8.0f), CGConstructVector2(8.0f, -8.0f), CGConstructVector2(0.0f, 8.0f));
+    CGVector2 vertices[3] = {{-8.0f, -8.0f}, {8.0f, -8.0f}, {0.0f, 8.0f}};
+    CGColor colors[3] = {{1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}};
+    CGColoredTriangle colored_triangle = CGConstructColoredTriangle(vertices, colors);
+    // finish the work done before this test
+    CGTickRenderEnd();
+
+    CGTickRenderStart(stats_window);
+    CGDrawTriangle(&triangle, NULL, stats_window);
+    CGDrawColoredTriangle(&colored_triangle, NULL, stats_window);
+    CGDrawColoredTriangle(&colored_triangle, NULL, stats_window);
+    CGWindowDraw(stats_window);
+    CGTickRenderEnd();
+    CGFrameStats stats = CGGetFrameStats();
+    CGT_EXPECT_INT_EQUAL(stats.objects_submitted, 3);
+    CGT_EXPECT_INT_EQUAL(stats.objects_culled, 0);
+    CGT_EXPECT_INT_EQUAL(stats.objects_batched, 2);
+    // the colored triangles are drawn in one batch
+    CGT_EXPECT_INT_EQUAL(stats.draw_calls, 2);
+    CGT_EXPECT_INT_EQUAL(stats.vertices_submitted, 9);
+    CGT_EXPECT_INT_EQUAL(stats.indices_submitted, 0);
+    CGT_EXPECT_INT_EQUAL(stats.bytes_uploaded > 0, CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(stats.program_binds >= 2, CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(stats.allocations > 0, CG_TRUE);
+
+    CGFree(stats_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestPerformanceOverlay1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* overlay_window = CGCreateWindow(320, 240, CGSTR("Performance Overlay"), sub_property);
+    CGT_EXPECT_NOT_NULL(overlay_window);
+    CGSetWindowPerformanceOverlay(overlay_window, CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGIsWindowPerformanceOverlayShown(overlay_window), CG_TRUE);
+    CGTriangle triangle = CGConstructTriangle(
+        CGConstructVector2(-8.0f, -8.0f), CGConstructVector2(8.0f, -8.0f), CGConstructVector2(0.0f, 8.0f));
+    for (int i = 0; i < 2; ++i)
+    {
+        CGTickRenderStart(overlay_window);
+        CGDrawTriangle(&triangle, NULL, overlay_window);
+        CGWindowDraw(overlay_window);
+        CGTickRenderEnd();
+    }
+    // the overlay is drawn, but not counted
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 1);
+    // the background of the overlay darkens the frame
+    CGUByte inside[4] = {0}, outside[4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(overlay_window, 12, 12, 1, 1, inside), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(overlay_window, 300, 220, 1, 1, outside), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL((inside[0] < outside[0] || outside[0] == 0), CG_TRUE);
+
+    CGSetWindowPerformanceOverlay(overlay_window, CG_FALSE);
+    CGT_EXPECT_INT_EQUAL(CGIsWindowPerformanceOverlayShown(overlay_window), CG_FALSE);
+    CGFree(overlay_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestCommandRecorder1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* recorded_window = CGCreateWindow(64, 64, CGSTR("Command Recorder"), sub_property);
+    CGT_EXPECT_NOT_NULL(recorded_window);
+    CGCommandRecorder* recorder = CGCreateCommandRecorder(recorded_window, CGSTR("test_command_stream.cgcs"), 2);
+    CGT_EXPECT_NOT_NULL(recorder);
+    CGCreateCommandRecorder(recorded_window, CGSTR("test_command_stream.cgcs"), 2);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGTriangle triangle = CGConstructTriangle(
+        CGConstructVector2(-16.0f, -16.0f), CGConstructVector2(16.0f, -16.0f), CGConstructVector2(0.0f, 16.0f));
+    CGVector2 vertices[3] = {{-8.0f, -8.0f}, {8.0f, -8.0f}, {0.0f, 8.0f}};
+    CGColor colors[3] = {{1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}};
+    CGColoredTriangle colored_triangle = CGConstructColoredTriangle(vertices, colors);
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(-16.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    for (int i = 0; i < 3; ++i)
+    {
+        CGTickRenderStart(recorded_window);
+        CGDrawTriangle(&triangle, NULL, recorded_window);
+        CGDrawColoredTriangle(&colored_triangle, property, recorded_window);
+        CGWindowDraw(recorded_window);
+        CGTickRenderEnd();
+    }
+    // the third frame is not recorded
+    CGT_EXPECT_INT_EQUAL(CGGetCommandRecorderFrameCount(recorder), 2);
+    CGT_EXPECT_INT_EQUAL(CGIsCommandRecorderFinished(recorder), CG_TRUE);
+    CGUByte recorded[64 * 64 * 4];
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(recorded_window, 0, 0, 64, 64, recorded), CG_TRUE);
+
+    CGCommandReplay* replay = CGLoadCommandReplay(CGSTR("test_command_stream.cgcs"));
+    CGT_EXPECT_NOT_NULL(replay);
+    CGT_EXPECT_INT_EQUAL(CGGetCommandReplayFrameCount(replay), 2);
+    int width = 0, height = 0;
+    CGGetCommandReplayWindowSize(replay, &width, &height);
+    CGT_EXPECT_INT_EQUAL(width, 64);
+    CGT_EXPECT_INT_EQUAL(height, 64);
+    CGWindow* replay_window = CGCreateWindow(width, height, CGSTR("Command Replay"), sub_property);
+    CGT_EXPECT_NOT_NULL(replay_window);
+    unsigned int frame_count = 0;
+    while (CGReplayCommandFrame(replay, replay_window))
+    {
+        CGTickRenderEnd();
+        ++frame_count;
+    }
+    CGT_EXPECT_INT_EQUAL(frame_count, 2);
+    CGUByte replayed[64 * 64 * 4];
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(replay_window, 0, 0, 64, 64, replayed), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(memcmp(recorded, replayed, sizeof(recorded)), 0);
+    CGT_EXPECT_NO_ERROR();
+
+    CGFree(replay);
+    CGFree(property);
+    CGFree(recorder);
+    CGFree(replay_window);
+    CGFree(recorded_window);
+    remove("test_command_stream.cgcs");
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestTextBatch1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* text_window = CGCreateWindow(128, 64, CGSTR("Text Batch"), sub_property);
+    CGT_EXPECT_NOT_NULL(text_window);
+    CGTextBatch* batch = CGCreateTextBatch();
+    CGT_EXPECT_NOT_NULL(batch);
+    CGTextProperty text_property = CGConstructTextProperty(12, 12, 4, 1);
+    CGT_EXPECT_INT_EQUAL(CGAddTextToBatch(batch, CGSTR("Hello"), NULL, text_property, CGConstructVector2(-60.0f, 10.0f)), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGAddTextToBatch(batch, CGSTR("World"), NULL, text_property, CGConstructVector2(-60.0f, -10.0f)), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGGetTextBatchSize(batch), 2);
+    for (int i = 0; i < 2; ++i)
+    {
+        CGTickRenderStart(text_window);
+        CGWindowDraw(text_window);
+        CGDrawTextBatch(batch, NULL, text_window);
+        CGTickRenderEnd();
+    }
+    // every glyph is in the first page of the atlas, and no texture is created after the first frame
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 1);
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().textures_created, 0);
+    CGClearTextBatch(batch);
+    CGT_EXPECT_INT_EQUAL(CGGetTextBatchSize(batch), 0);
+    CGFree(batch);
+    CGFree(text_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestColoredGeometry1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* colored_window = CGCreateWindow(64, 64, CGSTR("Colored Geometry"), sub_property);
+    CGT_EXPECT_NOT_NULL(colored_window);
+    CGVector2 left_vertices[4] = {{-24.0f, -8.0f}, {-8.0f, -8.0f}, {-8.0f, 8.0f}, {-24.0f, 8.0f}};
+    CGVector2 right_vertices[4] = {{8.0f, -8.0f}, {24.0f, -8.0f}, {24.0f, 8.0f}, {8.0f, 8.0f}};
+    CGColor red[4] = {{1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}};
+    CGColor green[4] = {{0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}};
+    CGColoredQuadrangle left = CGConstructColoredQuadrangle(left_vertices, red);
+    CGColoredQuadrangle right = CGConstructColoredQuadrangle(right_vertices, green);
+    // finish the work done before this test
+    CGTickRenderEnd();
+
+    CGTickRenderStart(colored_window);
+    CGDrawColoredQuadrangle(&left, NULL, colored_window);
+    CGDrawColoredQuadrangle(&right, NULL, colored_window);
+    CGWindowDraw(colored_window);
+    CGTickRenderEnd();
+    // the differently colored quadrangles are drawn with one draw call
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 1);
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().objects_batched, 2);
+    CGUByte left_pixel[4] = {0}, right_pixel[4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(colored_window, 16, 32, 1, 1, left_pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(colored_window, 48, 32, 1, 1, right_pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(left_pixel[0], 255);
+    CGT_EXPECT_INT_EQUAL(left_pixel[1], 0);
+    CGT_EXPECT_INT_EQUAL(right_pixel[0], 0);
+    CGT_EXPECT_INT_EQUAL(right_pixel[1], 255);
+
+    CGFree(colored_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestColoredGeometry2()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* colored_window = CGCreateWindow(64, 64, CGSTR("Colored Geometry"), sub_property);
+    CGT_EXPECT_NOT_NULL(colored_window);
+    // a strip that reaches far out of the window
+    CGVector2 strip_vertices[4] = {{-100000.0f, -32.0f}, {-28.0f, -32.0f}, {-28.0f, -24.0f}, {-100000.0f, -24.0f}};
+    CGVector2 left_vertices[4] = {{-24.0f, -8.0f}, {-8.0f, -8.0f}, {-8.0f, 8.0f}, {-24.0f, 8.0f}};
+    CGVector2 right_vertices[4] = {{8.0f, -8.0f}, {24.0f, -8.0f}, {24.0f, 8.0f}, {8.0f, 8.0f}};
+    CGColor blue[4] = {{0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}};
+    CGColor red[4] = {{1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}};
+    CGColor green[4] = {{0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}};
+    CGColoredQuadrangle strip = CGConstructColoredQuadrangle(strip_vertices, blue);
+    CGColoredQuadrangle left = CGConstructColoredQuadrangle(left_vertices, red);
+    CGColoredQuadrangle right = CGConstructColoredQuadrangle(right_vertices, green);
+    CGTickRenderEnd();
+
+    CGTickRenderStart(colored_window);
+    CGDrawColoredQuadrangle(&strip, NULL, colored_window);
+    CGDrawColoredQuadrangle(&left, NULL, colored_window);
+    CGDrawColoredQuadrangle(&right, NULL, colored_window);
+    CGWindowDraw(colored_window);
+    CGTickRenderEnd();
+    // the strip is drawn alone, so that it doesn't cost the small quadrangles their precision
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 2);
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().objects_batched, 3);
+    CGUByte strip_pixel[4] = {0}, edge_pixel[4] = {0}, outside_pixel[4] = {0}, right_pixel[4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(colored_window, 0, 60, 1, 1, strip_pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(colored_window, 8, 32, 1, 1, edge_pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(colored_window, 7, 32, 1, 1, outside_pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(colored_window, 23, 32, 1, 1, right_pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(strip_pixel[2], 255);
+    CGT_EXPECT_INT_EQUAL(edge_pixel[0], 255);
+    CGT_EXPECT_INT_EQUAL(outside_pixel[0], 51);
+    CGT_EXPECT_INT_EQUAL(right_pixel[0], 255);
+
+    CGFree(colored_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestModifiedObjectOpacity1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* opacity_window = CGCreateWindow(64, 64, CGSTR("Modified Object Opacity"), sub_property);
+    CGT_EXPECT_NOT_NULL(opacity_window);
+    CGVector2 left_vertices[4] = {{-24.0f, -8.0f}, {-8.0f, -8.0f}, {-8.0f, 8.0f}, {-24.0f, 8.0f}};
+    CGVector2 right_vertices[4] = {{8.0f, -8.0f}, {24.0f, -8.0f}, {24.0f, 8.0f}, {8.0f, 8.0f}};
+    CGColor red[4] = {{1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}};
+    CGColoredQuadrangle left = CGConstructColoredQuadrangle(left_vertices, red);
+    CGColoredQuadrangle right = CGConstructColoredQuadrangle(right_vertices, red);
+    float identity[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f};
+    CGRenderObjectProperty* modified_property = CGCreateRenderObjectProperty(
+        CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f), CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    CGT_EXPECT_NOT_NULL(modified_property);
+    modified_property->modify_matrix = identity;
+    CGTickRenderEnd();
+
+    // the object with a modify matrix is blended as a translucent object
+    CGTickRenderStart(opacity_window);
+    CGDrawColoredQuadrangle(&left, NULL, opacity_window);
+    CGDrawColoredQuadrangle(&right, modified_property, opacity_window);
+    CGWindowDraw(opacity_window);
+    CGTickRenderEnd();
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 2);
+
+    // unless the caller marks it opaque
+    modified_property->is_opaque = CG_TRUE;
+    CGTickRenderStart(opacity_window);
+    CGDrawColoredQuadrangle(&left, NULL, opacity_window);
+    CGDrawColoredQuadrangle(&right, modified_property, opacity_window);
+    CGWindowDraw(opacity_window);
+    CGTickRenderEnd();
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 1);
+
+    CGFree(modified_property);
+    CGFree(opacity_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestIsRenderObjectOverlappingRect2()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* polygon_window = CGCreateWindow(64, 64, CGSTR("Temporary Polygon"), sub_property);
+    CGT_EXPECT_NOT_NULL(polygon_window);
+    CGVector2 vertices[4] = {{-8.0f, -8.0f}, {8.0f, -8.0f}, {8.0f, 8.0f}, {-8.0f, 8.0f}};
+    CGColor colors[4] = {{1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}};
+    CGPolygon* polygon = CGCreateColoredPolygon(vertices, colors, 4, CG_TRUE);
+    CGT_EXPECT_NOT_NULL(polygon);
+    CGAABB inside = { { 0.0f, 0.0f }, { 1.0f, 1.0f } };
+    CGTickRenderEnd();
+
+    // hit testing a temporary polygon must not consume its vertices before it is drawn
+    CGT_EXPECT_INT_EQUAL(CGIsRenderObjectOverlappingRect(polygon, CG_RD_TYPE_COLORED_POLYGON, NULL, &inside), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGIsRenderObjectOverlappingRect(polygon, CG_RD_TYPE_COLORED_POLYGON, NULL, &inside), CG_TRUE);
+    CGT_EXPECT_NOT_NULL(polygon->vertex_head);
+    CGTickRenderStart(polygon_window);
+    CGDrawColoredPolygon(polygon, NULL, polygon_window);
+    CGWindowDraw(polygon_window);
+    CGTickRenderEnd();
+    CGUByte pixel[4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(polygon_window, 32, 32, 1, 1, pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(pixel[0], 255);
+    CGT_EXPECT_INT_EQUAL(pixel[1], 0);
+
+    CGFree(polygon_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestReadPixels1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* headless_window = CGCreateWindow(64, 64, CGSTR("Read Pixels"), sub_property);
+    CGT_EXPECT_NOT_NULL(headless_window);
+    int buffer_width = 0, buffer_height = 0;
+    CGGetWindowFrameBufferSize(headless_window, &buffer_width, &buffer_height);
+    CGT_EXPECT_INT_EQUAL(buffer_width, 64);
+    CGT_EXPECT_INT_EQUAL(buffer_height, 64);
+    // a green quadrangle that covers the top left quarter of the window
+    CGVector2 vertices[4] = {{-32.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 32.0f}, {-32.0f, 32.0f}};
+    CGColor green[4] = {{0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}};
+    CGColoredQuadrangle quadrangle = CGConstructColoredQuadrangle(vertices, green);
+    CGTickRenderEnd();
+
+    CGTickRenderStart(headless_window);
+    CGDrawColoredQuadrangle(&quadrangle, NULL, headless_window);
+    CGWindowDraw(headless_window);
+    CGTickRenderEnd();
+    CGUByte top_left[4] = {0}, inner_corner[4] = {0}, bottom_left[4] = {0}, bottom_right[4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 0, 0, 1, 1, top_left), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 31, 31, 1, 1, inner_corner), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 0, 63, 1, 1, bottom_left), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 63, 63, 1, 1, bottom_right), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(top_left[1], 255);
+    CGT_EXPECT_INT_EQUAL(top_left[3], 255);
+    CGT_EXPECT_INT_EQUAL(inner_corner[1], 255);
+    // the frame buffer starts from the bottom row, so the bottom of the window must not be green
+    CGT_EXPECT_INT_EQUAL(bottom_left[1], 51);
+    CGT_EXPECT_INT_EQUAL(bottom_right[1], 51);
+    // the rows of the result are ordered from the top row to the bottom row
+    CGUByte column[8] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 0, 31, 1, 2, column), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(column[1], 255);
+    CGT_EXPECT_INT_EQUAL(column[5], 51);
+    CGT_EXPECT_NO_ERROR();
+
+    // areas out of the frame buffer cannot be read
+    CGUByte area[8 * 8 * 4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 60, 60, 8, 8, area), CG_FALSE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, -1, 0, 1, 1, area), CG_FALSE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 0, 0, 0, 1, area), CG_FALSE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+
+    CGFree(headless_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+/**
+ * @brief The frames checked by @ref CGTestCheckCapturedFrame.
+ */
+typedef struct{
+    const CGUByte* expected_pixels;
+    unsigned int frame_count;
+    unsigned int next_index;
+    CG_BOOL is_matching;
+}CGTestFrameCaptureData;
+
+static void CGTestCheckCapturedFrame(const CGCapturedFrame* frame, void* user_data)
+{
+    CGTestFrameCaptureData* data = (CGTestFrameCaptureData*)user_data;
+    if (frame->index != data->next_index || frame->width != 64 || frame->height != 64)
+        data->is_matching = CG_FALSE;
+    // the captured rows start from the bottom, and the rows read by CGReadPixels start from the top
+    size_t row_size = (size_t)frame->width * 4;
+    for (int i = 0; i < frame->height && data->is_matching; ++i)
+    {
+        if (memcmp(frame->pixels + row_size * i, data->expected_pixels + row_size * (frame->height - 1 - i), row_size) != 0)
+            data->is_matching = CG_FALSE;
+    }
+    data->next_index = frame->index + 1;
+    ++data->frame_count;
+}
+
+void CGTestFrameCapture1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* captured_window = CGCreateWindow(64, 64, CGSTR("Frame Capture"), sub_property);
+    CGT_EXPECT_NOT_NULL(captured_window);
+    CGVector2 vertices[4] = {{-32.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 32.0f}, {-32.0f, 32.0f}};
+    CGColor green[4] = {{0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}};
+    CGColoredQuadrangle quadrangle = CGConstructColoredQuadrangle(vertices, green);
+    static CGUByte expected_pixels[64 * 64 * 4];
+    CGTestFrameCaptureData data = {expected_pixels, 0, 0, CG_TRUE};
+    CGFrameCapture* capture = CGCreateFrameCapture(captured_window, CG_FRAME_CAPTURE_DEFAULT_BUFFER_COUNT, CGTestCheckCapturedFrame, &data);
+    CGT_EXPECT_NOT_NULL(capture);
+    CGTickRenderEnd();
+
+    // capture more frames than the buffers of the ring, so that the oldest frames are handed over while capturing
+    const unsigned int frame_count = CG_FRAME_CAPTURE_DEFAULT_BUFFER_COUNT * 2 + 1;
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        CGTickRenderStart(captured_window);
+        CGDrawColoredQuadrangle(&quadrangle, NULL, captured_window);
+        CGWindowDraw(captured_window);
+        if (i == 0)
+        {
+            CGT_EXPECT_INT_EQUAL(CGReadPixels(captured_window, 0, 0, 64, 64, expected_pixels), CG_TRUE);
+        }
+        CGT_EXPECT_INT_EQUAL(CGCaptureFrame(capture), CG_TRUE);
+        CGTickRenderEnd();
+    }
+    CGT_EXPECT_INT_EQUAL(data.frame_count, frame_count - CG_FRAME_CAPTURE_DEFAULT_BUFFER_COUNT);
+    CGT_EXPECT_INT_EQUAL(CGFinishFrameCapture(capture), CG_FRAME_CAPTURE_DEFAULT_BUFFER_COUNT);
+    CGT_EXPECT_INT_EQUAL(data.frame_count, frame_count);
+    CGT_EXPECT_INT_EQUAL(data.next_index, frame_count);
+    CGT_EXPECT_INT_EQUAL(data.is_matching, CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGFinishFrameCapture(capture), 0);
+
+    CGFree(capture);
+    CGFree(captured_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+static void CGTestEncodeCapturedFrame(const CGCapturedFrame* frame, void* user_data)
+{
+    CGFrameEncoder** encoders = (CGFrameEncoder**)user_data;
+    CGT_EXPECT_INT_EQUAL(CGEncodeFrame(encoders[0], frame, CG_TRUE), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGEncodeFrame(encoders[1], frame, CG_TRUE), CG_TRUE);
+}
+
+void CGTestFrameEncoder1()
+{
+    // the path of PNG frames is used as a format, so it can only have one conversion of the frame index
+    CGT_EXPECT_INT_EQUAL((CGCreateFrameEncoder(CG_FRAME_FORMAT_PNG, CGSTR("test_frame.png"), 0, 1, 1) == NULL), CG_TRUE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGT_EXPECT_INT_EQUAL((CGCreateFrameEncoder(CG_FRAME_FORMAT_PNG, CGSTR("test_frame_%u_%s.png"), 0, 1, 1) == NULL), CG_TRUE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGT_EXPECT_INT_EQUAL((CGCreateFrameEncoder(CG_FRAME_FORMAT_PNG, CGSTR("test_frame_%u_%u.png"), 0, 1, 1) == NULL), CG_TRUE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGFrameEncoder* percent_encoder = CGCreateFrameEncoder(CG_FRAME_FORMAT_PNG, CGSTR("test_frame_100%%_%05d.png"), 0, 1, 1);
+    CGT_EXPECT_NOT_NULL(percent_encoder);
+    CGFree(percent_encoder);
+
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* encoded_window = CGCreateWindow(64, 64, CGSTR("Frame Encoder"), sub_property);
+    CGT_EXPECT_NOT_NULL(encoded_window);
+    CGVector2 vertices[4] = {{-32.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 32.0f}, {-32.0f, 32.0f}};
+    CGColor green[4] = {{0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}};
+    CGColoredQuadrangle quadrangle = CGConstructColoredQuadrangle(vertices, green);
+    CGFrameEncoder* encoders[2] = {
+        CGCreateFrameEncoder(CG_FRAME_FORMAT_PNG, CGSTR("test_frame_%02u.png"), 0, 2, CG_FRAME_ENCODER_DEFAULT_QUEUE_SIZE),
+        CGCreateFrameEncoder(CG_FRAME_FORMAT_Y4M, CGSTR("test_frames.y4m"), 30, 2, CG_FRAME_ENCODER_DEFAULT_QUEUE_SIZE)};
+    CGT_EXPECT_NOT_NULL(encoders[0]);
+    CGT_EXPECT_NOT_NULL(encoders[1]);
+    CGFrameCapture* capture = CGCreateFrameCapture(encoded_window, CG_FRAME_CAPTURE_DEFAULT_BUFFER_COUNT, CGTestEncodeCapturedFrame, encoders);
+    CGT_EXPECT_NOT_NULL(capture);
+    CGTickRenderEnd();
+
+    const unsigned int frame_count = 4;
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        CGTickRenderStart(encoded_window);
+        CGDrawColoredQuadrangle(&quadrangle, NULL, encoded_window);
+        CGWindowDraw(encoded_window);
+        CGCaptureFrame(capture);
+        CGTickRenderEnd();
+    }
+    CGFinishFrameCapture(capture);
+    CGFree(capture);
+    CGFinishFrameEncoder(encoders[0]);
+    CGT_EXPECT_INT_EQUAL(CGGetFrameEncoderDroppedCount(encoders[0]), 0);
+    CGT_EXPECT_INT_EQUAL(CGGetFrameEncoderFailedCount(encoders[0]), 0);
+    CGFree(encoders[0]);
+    // the stream is not finished before it is freed, so freeing it must encode the frames left in the queue
+    CGFree(encoders[1]);
+    CGT_EXPECT_NO_ERROR();
+
+    char path[64];
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        snprintf(path, sizeof(path), "test_frame_%02u.png", i);
+        FILE* png_file = fopen(path, "rb");
+        CGT_EXPECT_NOT_NULL(png_file);
+        if (png_file != NULL)
+        {
+            CGUByte signature[8] = {0};
+            CGT_EXPECT_INT_EQUAL(fread(signature, 1, 8, png_file), 8);
+            CGT_EXPECT_INT_EQUAL(signature[1], 'P');
+            fclose(png_file);
+        }
+        remove(path);
+    }
+
+    FILE* stream = fopen("test_frames.y4m", "rb");
+    CGT_EXPECT_NOT_NULL(stream);
+    if (stream != NULL)
+    {
+        const char* header = "YUV4MPEG2 W64 H64 F30:1 Ip A1:1 C444\n";
+        char read_header[64] = {0};
+        CGT_EXPECT_INT_EQUAL(fread(read_header, 1, strlen(header), stream), strlen(header));
+        CGT_EXPECT_STRING_EQUAL(read_header, header);
+        // the frames are 4:4:4, so each has 3 planes of 64 * 64 bytes after its tag
+        size_t frame_size = strlen("FRAME\n") + 64 * 64 * 3;
+        char tag[7] = {0};
+        CGT_EXPECT_INT_EQUAL(fread(tag, 1, 6, stream), 6);
+        CGT_EXPECT_STRING_EQUAL(tag, "FRAME\n");
+        // the first row is the top row, whose left half is green
+        int luma = fgetc(stream);
+        CGT_EXPECT_INT_EQUAL(luma, 144);
+        fseek(stream, 0, SEEK_END);
+        CGT_EXPECT_INT_EQUAL(ftell(stream), (long)(strlen(header) + frame_size * frame_count));
+        fclose(stream);
+    }
+    remove("test_frames.y4m");
+
+    CGFree(encoded_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+// check if any pixel in the rows of a frame read by CGReadPixels is not the clear color
+static CG_BOOL CGTestHasDrawnPixel(const CGUByte* pixels, int width, int first_row, int row_count)
+{
+    for (int i = first_row * width * 4; i < (first_row + row_count) * width * 4; i += 4)
+    {
+        if (pixels[i] != 51 || pixels[i + 1] != 51 || pixels[i + 2] != 51)
+            return CG_TRUE;
+    }
+    return CG_FALSE;
+}
+
+void CGTestPartialRedrawText1()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    sub_property.partial_redraw = CG_TRUE;
+    sub_property.idle_mode = CG_TRUE;
+    CGWindow* text_window = CGCreateWindow(128, 64, CGSTR("Partial Redraw Text"), sub_property);
+    CGT_EXPECT_NOT_NULL(text_window);
+    CGSetWindowIdleTimeout(text_window, 0.0);
+    CGTextBatch* batch = CGCreateTextBatch();
+    CGT_EXPECT_NOT_NULL(batch);
+    CGT_EXPECT_INT_EQUAL(CGAddTextToBatch(batch, CGSTR("Hello"), NULL, CGConstructTextProperty(12, 12, 4, 1), CGConstructVector2(-60.0f, 10.0f)), CG_TRUE);
+    // the quadrangle is in the bottom half of the window, and the text is in the top half
+    CGQuadrangle quadrangle = CGConstructQuadrangle(
+        CGConstructVector2(-8.0f, -30.0f), CGConstructVector2(8.0f, -30.0f),
+        CGConstructVector2(8.0f, -10.0f), CGConstructVector2(-8.0f, -10.0f));
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(-32.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    static CGUByte first_frame[128 * 64 * 4], pixels[128 * 64 * 4];
+    CGTickRenderEnd();
+
+    // text drawn before CGWindowDraw would be cleared by it
+    CGTickRenderStart(text_window);
+    CGDrawQuadrangle(&quadrangle, property, text_window);
+    CGT_EXPECT_INT_EQUAL(CGDrawTextBatch(batch, NULL, text_window), CG_FALSE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGWindowDraw(text_window);
+    CGT_EXPECT_INT_EQUAL(CGDrawTextBatch(batch, NULL, text_window), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(text_window, 0, 0, 128, 64, first_frame), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGTestHasDrawnPixel(first_frame, 128, 0, 32), CG_TRUE);
+    CGTickRenderEnd();
+
+    // the skipped frame is still on the screen with its text, which is not drawn over it again
+    CGTickRenderStart(text_window);
+    CGDrawQuadrangle(&quadrangle, property, text_window);
+    CGWindowDraw(text_window);
+    CGT_EXPECT_INT_EQUAL(CGIsWindowIdle(text_window), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGDrawTextBatch(batch, NULL, text_window), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(text_window, 0, 0, 128, 64, pixels), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(memcmp(first_frame, pixels, sizeof(pixels)), 0);
+    CGTickRenderEnd();
+
+    // only the quadrangle is redrawn, and the text of the last frame is not kept in the redrawn frame
+    property->transform = CGConstructVector2(32.0f, 0.0f);
+    CGTickRenderStart(text_window);
+    CGDrawQuadrangle(&quadrangle, property, text_window);
+    CGWindowDraw(text_window);
+    CGT_EXPECT_INT_EQUAL(CGIsWindowIdle(text_window), CG_FALSE);
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(text_window, 0, 0, 128, 64, pixels), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGTestHasDrawnPixel(pixels, 128, 0, 32), CG_FALSE);
+    CGT_EXPECT_INT_EQUAL(CGTestHasDrawnPixel(pixels, 128, 32, 32), CG_TRUE);
+    CGTickRenderEnd();
+
+    CGFree(property);
+    CGFree(batch);
+    CGFree(text_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestRenderLayer2()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* headless_window = CGCreateWindow(64, 64, CGSTR("Render Layer"), sub_property);
+    CGT_EXPECT_NOT_NULL(headless_window);
+    CGRenderLayer* layer = CGCreateRenderLayer(64, 64, headless_window);
+    CGT_EXPECT_NOT_NULL(layer);
+    CGT_EXPECT_INT_EQUAL(layer->visual_image.is_premultiplied, CG_TRUE);
+    // a half transparent red quadrangle that covers the whole layer
+    CGVector2 vertices[4] = {{-32.0f, -32.0f}, {32.0f, -32.0f}, {32.0f, 32.0f}, {-32.0f, 32.0f}};
+    CGColor red[4] = {{1.0f, 0.0f, 0.0f, 0.5f}, {1.0f, 0.0f, 0.0f, 0.5f}, {1.0f, 0.0f, 0.0f, 0.5f}, {1.0f, 0.0f, 0.0f, 0.5f}};
+    CGColoredQuadrangle quadrangle = CGConstructColoredQuadrangle(vertices, red);
+    CGTickRenderEnd();
+
+    CGTickRenderStart(headless_window);
+    CGT_EXPECT_INT_EQUAL(CGBeginRenderLayer(layer), CG_TRUE);
+    CGDrawColoredQuadrangle(&quadrangle, NULL, headless_window);
+    CGEndRenderLayer(layer);
+    CGDrawVisualImage(&layer->visual_image, NULL, headless_window);
+    CGWindowDraw(headless_window);
+    CGTickRenderEnd();
+    CGUByte pixel[4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(headless_window, 32, 32, 1, 1, pixel), CG_TRUE);
+    // the layer blends like the quadrangle drawn straight into the window: 0.5 * 255 + 0.5 * 51,
+    // where applying the alpha twice would give 0.25 * 255 + 0.5 * 51
+    CGT_EXPECT_INT_EQUAL((pixel[0] >= 150 && pixel[0] <= 156), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL((pixel[1] >= 23 && pixel[1] <= 28), CG_TRUE);
+    CGT_EXPECT_NO_ERROR();
+
+    CGFree(layer);
+    CGFree(headless_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestCommandRecorder2()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* recorded_window = CGCreateWindow(128, 64, CGSTR("Text Recorder"), sub_property);
+    CGT_EXPECT_NOT_NULL(recorded_window);
+    CGCommandRecorder* recorder = CGCreateCommandRecorder(recorded_window, CGSTR("test_text_stream.cgcs"), 1);
+    CGT_EXPECT_NOT_NULL(recorder);
+    CGTextBatch* batch = CGCreateTextBatch();
+    CGT_EXPECT_NOT_NULL(batch);
+    CGTextProperty text_property = CGConstructTextProperty(12, 12, 4, 1);
+    CGAddTextToBatch(batch, CGSTR("Hello"), NULL, text_property, CGConstructVector2(-60.0f, 10.0f));
+    CGAddTextToBatch(batch, CGSTR("World"), NULL, text_property, CGConstructVector2(-60.0f, -20.0f));
+    for (int i = 0; i < 2; ++i)
+    {
+        CGTickRenderStart(recorded_window);
+        CGWindowDraw(recorded_window);
+        CGDrawTextBatch(batch, NULL, recorded_window);
+        CGTickRenderEnd();
+    }
+    CGT_EXPECT_INT_EQUAL(CGIsCommandRecorderFinished(recorder), CG_TRUE);
+    static CGUByte recorded[128 * 64 * 4], replayed[128 * 64 * 4];
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(recorded_window, 0, 0, 128, 64, recorded), CG_TRUE);
+    // both texts of the batch are drawn, in the top half and in the bottom half of the window
+    CGT_EXPECT_INT_EQUAL(CGTestHasDrawnPixel(recorded, 128, 0, 32), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGTestHasDrawnPixel(recorded, 128, 32, 32), CG_TRUE);
+
+    // the texts are replayed at their positions in the batch
+    CGCommandReplay* replay = CGLoadCommandReplay(CGSTR("test_text_stream.cgcs"));
+    CGT_EXPECT_NOT_NULL(replay);
+    CGWindow* replay_window = CGCreateWindow(128, 64, CGSTR("Text Replay"), sub_property);
+    CGT_EXPECT_NOT_NULL(replay_window);
+    CGT_EXPECT_INT_EQUAL(CGReplayCommandFrame(replay, replay_window), CG_TRUE);
+    CGTickRenderEnd();
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(replay_window, 0, 0, 128, 64, replayed), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(memcmp(recorded, replayed, sizeof(recorded)), 0);
+    CGT_EXPECT_NO_ERROR();
+
+    CGFree(replay);
+    CGFree(batch);
+    CGFree(recorder);
+    CGFree(replay_window);
+    CGFree(recorded_window);
+    remove("test_text_stream.cgcs");
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestTextBatch2()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* text_window = CGCreateWindow(128, 64, CGSTR("Text Batch Extent"), sub_property);
+    CGT_EXPECT_NOT_NULL(text_window);
+    CGTextBatch* batch = CGCreateTextBatch();
+    CGT_EXPECT_NOT_NULL(batch);
+    CGTextProperty text_property = CGConstructTextProperty(12, 12, 4, 1);
+    CGAddTextToBatch(batch, CGSTR("Hello"), NULL, text_property, CGConstructVector2(-60.0f, 10.0f));
+    CGAddTextToBatch(batch, CGSTR("World"), NULL, text_property, CGConstructVector2(-60.0f, -10.0f));
+    CGTickRenderEnd();
+    CGTickRenderStart(text_window);
+    CGWindowDraw(text_window);
+    CGDrawTextBatch(batch, NULL, text_window);
+    CGTickRenderEnd();
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 1);
+
+    // a text far away from the others would cost them their precision, so it is drawn separately
+    CGAddTextToBatch(batch, CGSTR("Far"), NULL, text_property, CGConstructVector2(8000.0f, 10.0f));
+    CGTickRenderStart(text_window);
+    CGWindowDraw(text_window);
+    CGDrawTextBatch(batch, NULL, text_window);
+    CGTickRenderEnd();
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().draw_calls, 2);
+    CGFree(batch);
+    CGFree(text_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestFrameStats2()
+{
+    CGWindowSubProperty sub_property = CGConstructDefaultWindowSubProperty();
+    sub_property.headless = CG_TRUE;
+    CGWindow* stats_window = CGCreateWindow(64, 64, CGSTR("Frame Stats Culling"), sub_property);
+    CGT_EXPECT_NOT_NULL(stats_window);
+    CGQuadrangle quadrangle = CGConstructQuadrangle(
+        CGConstructVector2(-8.0f, -8.0f), CGConstructVector2(8.0f, -8.0f),
+        CGConstructVector2(8.0f, 8.0f), CGConstructVector2(-8.0f, 8.0f));
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(1000.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    CGTickRenderEnd();
+
+    // the object is culled with the property that it has when the window is drawn
+    CGTickRenderStart(stats_window);
+    CGDrawQuadrangle(&quadrangle, property, stats_window);
+    property->transform = CGConstructVector2(0.0f, 0.0f);
+    CGWindowDraw(stats_window);
+    CGTickRenderEnd();
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().objects_culled, 0);
+    CGUByte pixel[4] = {0};
+    CGT_EXPECT_INT_EQUAL(CGReadPixels(stats_window, 32, 32, 1, 1, pixel), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(pixel[0], 255);
+
+    CGTickRenderStart(stats_window);
+    CGDrawQuadrangle(&quadrangle, property, stats_window);
+    property->transform = CGConstructVector2(1000.0f, 0.0f);
+    CGWindowDraw(stats_window);
+    CGTickRenderEnd();
+    CGT_EXPECT_INT_EQUAL(CGGetFrameStats().objects_culled, 1);
+    CGFree(property);
+    CGFree(stats_window);
+    CGT_EXPECT_NO_ERROR();
+}
+
 void CGTestCGSetWindowPosition1()
 {
     CGSetWindowPosition(window, (CGVector2){ 0.0f, 0.0f });
@@ -26,6 +26,55 @@ void CGTestCGSetWindowPosition3();
 void CGTestCGSetKeyCallback1();
 void CGTestCGSetKeyCallback2();
 
+void CGTestGetRenderObjectBounds1();
+void CGTestGetRenderObjectBounds2();
+
+void CGTestIsAABBOverlapping1();
+
+void CGTestIsRenderObjectOverlappingRect1();
+
+void CGTestIsRenderObjectOverlappingRect2();
+
+void CGTestColoredGeometry1();
+
+void CGTestColoredGeometry2();
+
+void CGTestModifiedObjectOpacity1();
+
+void CGTestReadPixels1();
+
+void CGTestFrameCapture1();
+
+void CGTestFrameEncoder1();
+
+void CGTestPick1();
+
+void CGTestRenderLayer1();
+
+void CGTestRenderLayer2();
+
+void CGTestPartialRedraw1();
+
+void CGTestIdleMode1();
+
+void CGTestGPUProfiler1();
+
+void CGTestFrameStats1();
+
+void CGTestFrameStats2();
+
+void CGTestPerformanceOverlay1();
+
+void CGTestCommandRecorder1();
+
+void CGTestCommandRecorder2();
+
+void CGTestTextBatch1();
+
+void CGTestTextBatch2();
+
+void CGTestPartialRedrawText1();
+
 void CGGraphicsTestEnd();
 
 
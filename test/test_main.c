@@ -2,6 +2,11 @@
 #include "test_utils/test_utils.h"
 #include "test_resource/test_resource.h"
 #include "test_graphics/test_graphics.h"
+#include "test_vertex/test_vertex.h"
+#include "test_spatial_index/test_spatial_index.h"
+#include "test_glyph_atlas/test_glyph_atlas.h"
+#include "test_frame_pacer/test_frame_pacer.h"
+#include "test_profiler/test_profiler.h"
 int main()
 {
     CGStartUnitTest();
@@ -33,11 +38,62 @@ int main()
     CGTestCGSetWindowPosition3();
     CGTestCGSetKeyCallback1();
     CGTestCGSetKeyCallback2();
+    CGTestGetRenderObjectBounds1();
+    CGTestGetRenderObjectBounds2();
+    CGTestIsAABBOverlapping1();
+    CGTestIsRenderObjectOverlappingRect1();
+    CGTestIsRenderObjectOverlappingRect2();
+    CGTestColoredGeometry1();
+    CGTestColoredGeometry2();
+    CGTestModifiedObjectOpacity1();
+    CGTestReadPixels1();
+    CGTestFrameCapture1();
+    CGTestFrameEncoder1();
+    CGTestPick1();
+    CGTestRenderLayer1();
+    CGTestRenderLayer2();
+    CGTestPartialRedraw1();
+    CGTestIdleMode1();
+    CGTestGPUProfiler1();
+    CGTestFrameStats1();
+    CGTestFrameStats2();
+    CGTestPerformanceOverlay1();
+    CGTestCommandRecorder1();
+    CGTestCommandRecorder2();
+    CGTestTextBatch1();
+    CGTestTextBatch2();
+    CGTestPartialRedrawText1();
+
+    CGTestQuantizeUnorm161();
+    CGTestQuantizeUnorm162();
+    CGTestQuantizeUnorm321();
+    CGTestQuantizePosition1();
+    CGTestQuantizePosition2();
+    CGTestVertexStream1();
+    CGTestVertexStream2();
+
+    CGTestSpatialIndexQuery1();
+    CGTestSpatialIndexQuery2();
+    CGTestSpatialIndexUpdate1();
+    CGTestSpatialIndexRemove1();
+
+    CGTestGlyphAtlas1();
+    CGTestGlyphAtlas2();
+    CGTestGlyphAtlasEviction1();
+
+    CGTestFramePacer1();
+    CGTestFramePacer2();
+    CGTestFramePacer3();
+
+    CGTestProfiler1();
+
     CGGraphicsTestEnd();
     
     CGTestResourceStart();
     CGTestResourceLoadFile1();
     CGTestResourceLoadFile2();
+    CGTestIsImageTransparent1();
+    CGTestIsImageTransparent2();
     CGTestResourceEnd();
 
     CGEndUnitTest();
@@ -0,0 +1,30 @@
+#include "test_profiler.h"
+#include "cos_graphics/profiler.h"
+#include "../unit_test/unit_test.h"
+#include <stdio.h>
+#include <string.h>
+
+void CGTestProfiler1()
+{
+    // zones out of a session are not recorded
+    CGProfilerEndZone("TestZoneOutside", CGProfilerBeginZone());
+    CGBeginProfilerSession();
+    CGT_EXPECT_INT_EQUAL(CGIsProfilerSessionActive(), CG_TRUE);
+    CGProfilerEndZone("TestZone", CGProfilerBeginZone());
+    CGT_EXPECT_INT_EQUAL(CGEndProfilerSession(CGSTR("profiler_trace.json")), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGIsProfilerSessionActive(), CG_FALSE);
+    CGT_EXPECT_NO_ERROR();
+
+    FILE* file = fopen("profiler_trace.json", "r");
+    CGT_EXPECT_NOT_NULL(file);
+    char content[1024] = {0};
+    fread(content, 1, sizeof(content) - 1, file);
+    fclose(file);
+    remove("profiler_trace.json");
+    CGT_EXPECT_INT_EQUAL((strstr(content, "\"name\":\"TestZone\"") != NULL), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL((strstr(content, "TestZoneOutside") == NULL), CG_TRUE);
+
+    CGEndProfilerSession(NULL);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef _CGT_PROFILER_H_
+#define _CGT_PROFILER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void CGTestProfiler1();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -27,4 +27,22 @@ void CGTestResourceLoadFile2()
     free(data);
 }
 
+void CGTestIsImageTransparent1()
+{
+    CGUByte data[8] = {10, 20, 30, 255, 40, 50, 60, 255};
+    CGImage image = {2, 1, 4, data};
+    CGT_EXPECT_INT_EQUAL(CGIsImageTransparent(&image), CG_FALSE);
+    data[7] = 254;
+    CGT_EXPECT_INT_EQUAL(CGIsImageTransparent(&image), CG_TRUE);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestIsImageTransparent2()
+{
+    CGUByte data[6] = {0, 0, 0, 0, 0, 0};
+    CGImage image = {2, 1, 3, data};
+    CGT_EXPECT_INT_EQUAL(CGIsImageTransparent(&image), CG_FALSE);
+    CGT_EXPECT_NO_ERROR();
+}
+
 //todo: add more tests
\ No newline at end of file
@@ -11,6 +11,8 @@ void CGTestResourceStart();
 void CGTestResourceEnd();
 void CGTestResourceLoadFile1();
 void CGTestResourceLoadFile2();
+void CGTestIsImageTransparent1();
+void CGTestIsImageTransparent2();
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,89 @@
+#include "test_spatial_index.h"
+#include "cos_graphics/spatial_index.h"
+#include "cos_graphics/resource.h"
+#include "../unit_test/unit_test.h"
+
+static CGQuadrangle CGTestConstructSquare(float x, float y, float size)
+{
+    return CGConstructQuadrangle(CGConstructVector2(x, y), CGConstructVector2(x + size, y),
+        CGConstructVector2(x + size, y + size), CGConstructVector2(x, y + size));
+}
+
+void CGTestSpatialIndexQuery1()
+{
+    CGSpatialIndex* index = CGCreateSpatialIndex(10.0f);
+    CGT_EXPECT_NOT_NULL(index);
+    CGQuadrangle squares[3] = {
+        CGTestConstructSquare(0.0f, 0.0f, 5.0f),
+        CGTestConstructSquare(100.0f, 100.0f, 5.0f),
+        // covers several cells, but should be found once
+        CGTestConstructSquare(-25.0f, -25.0f, 30.0f)
+    };
+    for (int i = 0; i < 3; ++i)
+    {
+        CGT_EXPECT_INT_NOT_EQUAL(CGAddSpatialIndexItem(index, &squares[i], CG_RD_TYPE_QUADRANGLE, NULL), CG_SPATIAL_INDEX_INVALID_ID);
+    }
+    CGT_EXPECT_INT_EQUAL(CGGetSpatialIndexItemCount(index), 3);
+    CGAABB rect = { { -1.0f, -1.0f }, { 1.0f, 1.0f } };
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &rect, NULL, NULL), 2);
+    CGAABB far_rect = { { 90.0f, 90.0f }, { 99.0f, 99.0f } };
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &far_rect, NULL, NULL), 0);
+    CGAABB large_rect = { { -1000.0f, -1000.0f }, { 1000.0f, 1000.0f } };
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &large_rect, NULL, NULL), 3);
+    CGFree(index);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestSpatialIndexQuery2()
+{
+    // objects larger than CG_SPATIAL_INDEX_MAX_ITEM_CELLS cells are stored apart from the cells
+    CGSpatialIndex* index = CGCreateSpatialIndex(1.0f);
+    CGQuadrangle square = CGTestConstructSquare(-50.0f, -50.0f, 100.0f);
+    CGT_EXPECT_INT_NOT_EQUAL(CGAddSpatialIndexItem(index, &square, CG_RD_TYPE_QUADRANGLE, NULL), CG_SPATIAL_INDEX_INVALID_ID);
+    CGAABB rect = { { 10.0f, 10.0f }, { 10.5f, 10.5f } };
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &rect, NULL, NULL), 1);
+    CGAABB out_rect = { { 60.0f, 60.0f }, { 61.0f, 61.0f } };
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &out_rect, NULL, NULL), 0);
+    CGFree(index);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestSpatialIndexUpdate1()
+{
+    CGSpatialIndex* index = CGCreateSpatialIndex(10.0f);
+    CGQuadrangle square = CGTestConstructSquare(0.0f, 0.0f, 5.0f);
+    CGRenderObjectProperty* property = CGCreateRenderObjectProperty(CGConstructColor(1.0f, 1.0f, 1.0f, 1.0f),
+        CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 1.0f), 0.0f);
+    unsigned int id = CGAddSpatialIndexItem(index, &square, CG_RD_TYPE_QUADRANGLE, property);
+    CGAABB origin_rect = { { 1.0f, 1.0f }, { 2.0f, 2.0f } };
+    CGAABB moved_rect = { { 201.0f, 1.0f }, { 202.0f, 2.0f } };
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &origin_rect, NULL, NULL), 1);
+    property->transform = CGConstructVector2(200.0f, 0.0f);
+    CGT_EXPECT_INT_EQUAL(CGUpdateSpatialIndexItem(index, id), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &origin_rect, NULL, NULL), 0);
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &moved_rect, NULL, NULL), 1);
+    CGT_EXPECT_REAL_EQUAL(CGGetSpatialIndexItem(index, id)->bounds.min.x, 200.0f, 0.0001f);
+    CGFree(property);
+    CGFree(index);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestSpatialIndexRemove1()
+{
+    CGSpatialIndex* index = CGCreateSpatialIndex(10.0f);
+    CGQuadrangle square = CGTestConstructSquare(0.0f, 0.0f, 5.0f);
+    unsigned int id = CGAddSpatialIndexItem(index, &square, CG_RD_TYPE_QUADRANGLE, NULL);
+    CGRemoveSpatialIndexItem(index, id);
+    CGT_EXPECT_INT_EQUAL(CGGetSpatialIndexItemCount(index), 0);
+    CG_BOOL is_item_removed = CGGetSpatialIndexItem(index, id) == NULL;
+    CGT_EXPECT_INT_EQUAL(is_item_removed, CG_TRUE);
+    CGAABB rect = { { 1.0f, 1.0f }, { 2.0f, 2.0f } };
+    CGT_EXPECT_INT_EQUAL(CGQuerySpatialIndex(index, &rect, NULL, NULL), 0);
+    CGRemoveSpatialIndexItem(index, id);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    // the id of the removed item is reused
+    CGT_EXPECT_INT_EQUAL(CGAddSpatialIndexItem(index, &square, CG_RD_TYPE_QUADRANGLE, NULL), id);
+    CGFree(index);
+    CGT_EXPECT_NO_ERROR();
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef _CGT_SPATIAL_INDEX_H_
+#define _CGT_SPATIAL_INDEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void CGTestSpatialIndexQuery1();
+void CGTestSpatialIndexQuery2();
+
+void CGTestSpatialIndexUpdate1();
+
+void CGTestSpatialIndexRemove1();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "test_vertex.h"
+#include "cos_graphics/vertex.h"
+#include "../unit_test/unit_test.h"
+
+void CGTestQuantizeUnorm161()
+{
+    CGT_EXPECT_INT_EQUAL(CGQuantizeUnorm16(0.0f), 0);
+    CGT_EXPECT_INT_EQUAL(CGQuantizeUnorm16(1.0f), CG_UNORM16_MAX);
+    CGT_EXPECT_REAL_EQUAL(CGDequantizeUnorm16(CGQuantizeUnorm16(0.5f)), 0.5f, 0.0001f);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestQuantizeUnorm162()
+{
+    CGT_EXPECT_INT_EQUAL(CGQuantizeUnorm16(-1.0f), 0);
+    CGT_EXPECT_INT_EQUAL(CGQuantizeUnorm16(2.0f), CG_UNORM16_MAX);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestQuantizeUnorm321()
+{
+    CGT_EXPECT_INT_EQUAL(CGQuantizeUnorm32(-1.0f), 0);
+    CGT_EXPECT_INT_EQUAL(CGQuantizeUnorm32(1.0f), CG_UNORM32_MAX);
+    // neighbouring depths of a frame with a million objects stay different
+    CGT_EXPECT_INT_NOT_EQUAL(CGQuantizeUnorm32(1.0f / 1000001.0f), CGQuantizeUnorm32(2.0f / 1000001.0f));
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestQuantizePosition1()
+{
+    CGVector2 positions[3] = {{-100.0f, 20.0f}, {37.5f, -60.25f}, {250.0f, 80.0f}};
+    CGVertexBounds bounds = CGConstructVertexBounds(positions, 3);
+    CGT_EXPECT_REAL_EQUAL(bounds.min_x, -100.0f, 0.0001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.min_y, -60.25f, 0.0001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.max_x, 250.0f, 0.0001f);
+    CGT_EXPECT_REAL_EQUAL(bounds.max_y, 80.0f, 0.0001f);
+    for (int i = 0; i < 3; ++i)
+    {
+        unsigned short quantized[2];
+        CGQuantizePosition(&bounds, positions[i], quantized);
+        CGVector2 result = CGDequantizePosition(&bounds, quantized);
+        CGT_EXPECT_REAL_EQUAL(result.x, positions[i].x, 0.01f);
+        CGT_EXPECT_REAL_EQUAL(result.y, positions[i].y, 0.01f);
+    }
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestQuantizePosition2()
+{
+    CGVector2 positions[2] = {{5.0f, 5.0f}, {5.0f, 5.0f}};
+    CGVertexBounds bounds = CGConstructVertexBounds(positions, 2);
+    unsigned short quantized[2];
+    CGQuantizePosition(&bounds, positions[0], quantized);
+    CGT_EXPECT_INT_EQUAL(quantized[0], 0);
+    CGT_EXPECT_INT_EQUAL(quantized[1], 0);
+    CGVector2 result = CGDequantizePosition(&bounds, quantized);
+    CGT_EXPECT_REAL_EQUAL(result.x, 5.0f, 0.0001f);
+    CGT_EXPECT_REAL_EQUAL(result.y, 5.0f, 0.0001f);
+    CGT_EXPECT_NO_ERROR();
+}
+
+void CGTestVertexStream1()
+{
+    CGCompactVertex vertices[2];
+    CGVertexStream stream = CGConstructVertexStream(vertices, sizeof(CGCompactVertex), 2);
+    CGVertexBounds bounds = {0.0f, 0.0f, 10.0f, 10.0f};
+    CGT_EXPECT_INT_EQUAL(CGPushCompactVertex(&stream, &bounds, CGConstructVector2(0.0f, 10.0f)), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(CGPushCompactVertex(&stream, &bounds, CGConstructVector2(10.0f, 0.0f)), CG_TRUE);
+    CGT_EXPECT_INT_EQUAL(stream.size, 2);
+    CGT_EXPECT_INT_EQUAL(vertices[0].position[0], 0);
+    CGT_EXPECT_INT_EQUAL(vertices[0].position[1], CG_UNORM16_MAX);
+    CGT_EXPECT_INT_EQUAL(vertices[1].position[0], CG_UNORM16_MAX);
+    CGT_EXPECT_INT_EQUAL(vertices[1].position[1], 0);
+    CGT_EXPECT_NO_ERROR();
+    // the buffer of the caller doesn't grow
+    CGT_EXPECT_INT_EQUAL(CGPushCompactVertex(&stream, &bounds, CGConstructVector2(5.0f, 5.0f)), CG_FALSE);
+    CGT_EXPECT_ERROR();
+    CGResetError();
+    CGT_EXPECT_INT_EQUAL(stream.size, 2);
+}
+
+void CGTestVertexStream2()
+{
+    CGVertexStream stream;
+    CGT_EXPECT_INT_EQUAL(CGInitVertexStream(&stream, sizeof(CGCompactImageVertex), 1), CG_TRUE);
+    CGVertexBounds bounds = {-1.0f, -1.0f, 1.0f, 1.0f};
+    for (int i = 0; i < 100; ++i)
+    {
+        CGT_EXPECT_INT_EQUAL(CGPushCompactImageVertex(&stream, &bounds, CGConstructVector2(0.0f, 0.0f), CGConstructVector2(1.0f, 0.5f)), CG_TRUE);
+    }
+    CGT_EXPECT_INT_EQUAL(stream.size, 100);
+    CGT_EXPECT_INT_EQUAL(stream.capacity >= 100, CG_TRUE);
+    CGCompactImageVertex* last = (CGCompactImageVertex*)stream.data + 99;
+    CGT_EXPECT_INT_EQUAL(last->tex_coord[0], CG_UNORM16_MAX);
+    CGResetVertexStream(&stream);
+    CGT_EXPECT_INT_EQUAL(stream.size, 0);
+    CGReleaseVertexStream(&stream);
+    CGT_EXPECT_INT_EQUAL(stream.data, NULL);
+    CGT_EXPECT_NO_ERROR();
+}
@@ -0,0 +1,22 @@
+#ifndef _CGT_VERTEX_H_
+#define _CGT_VERTEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void CGTestQuantizeUnorm161();
+void CGTestQuantizeUnorm162();
+void CGTestQuantizeUnorm321();
+
+void CGTestQuantizePosition1();
+void CGTestQuantizePosition2();
+
+void CGTestVertexStream1();
+void CGTestVertexStream2();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif